@@ -7,6 +7,7 @@
 #include "teqp/algorithms/critical_pure.hpp"
 #include "teqp/algorithms/VLE_types.hpp"
 #include "teqp/algorithms/VLE_pure.hpp"
+#include "teqp/math/krylov.hpp"
 #include <Eigen/Dense>
 
 // Imports from boost for numerical integration
@@ -68,12 +69,14 @@ auto linsolve(const A& a, const B& b) {
 * \param axtol Absolute tolerance on steps in independent variables
 * \param relxtol Relative tolerance on steps in independent variables
 * \param maxiter Maximum number of iterations permitted
+* \param flags The cancellation token and deadline, checked at each iteration; when either has expired the partial result
+* is returned with VLE_return_code::cancelled or VLE_return_code::deadline_expired
 * 
 * Note: if a mole fraction is zero in the provided vector, the molar concentrations in 
 * this component will not be allowed to change (they will stay zero, avoiding the possibility that 
 * they go to a negative value, which can cause trouble for some EOS)
 */
-inline auto mix_VLE_Tx(const AbstractModel& model, double T, const Eigen::ArrayXd& rhovecL0, const Eigen::ArrayXd& rhovecV0, const Eigen::ArrayXd& xspec, double atol, double reltol, double axtol, double relxtol, int maxiter) {
+inline auto mix_VLE_Tx(const AbstractModel& model, double T, const Eigen::ArrayXd& rhovecL0, const Eigen::ArrayXd& rhovecV0, const Eigen::ArrayXd& xspec, double atol, double reltol, double axtol, double relxtol, int maxiter, const std::optional<MixVLETxFlags>& flags_ = std::nullopt) {
     using Scalar = double;
 
     const Eigen::Index N = rhovecL0.size();
@@ -90,8 +93,14 @@ inline auto mix_VLE_Tx(const AbstractModel& model, double T, const Eigen::ArrayX
     auto RT = model.get_R(xspec) * T;
 
     VLE_return_code return_code = VLE_return_code::unset;
+    auto flags = flags_.value_or(MixVLETxFlags{});
 
     for (int iter = 0; iter < maxiter; ++iter) {
+        TEQP_COUNT(solver_iterations, 1);
+        if (auto reason = check_interruption(flags); reason != diagnostics::TerminationReason::none) {
+            return_code = (reason == diagnostics::TerminationReason::cancelled) ? VLE_return_code::cancelled : VLE_return_code::deadline_expired;
+            break;
+        }
 
         auto [PsirL, PsirgradL, hessianL] = model.build_Psir_fgradHessian_autodiff(T, rhovecL);
         auto [PsirV, PsirgradV, hessianV] = model.build_Psir_fgradHessian_autodiff(T, rhovecV);
@@ -349,6 +358,12 @@ inline auto mix_VLE_Tp(const AbstractModel& model, double T, double pgiven, cons
     }
     else {
         for (auto iter = 0; iter < flags.maxiter; ++iter) {
+            TEQP_COUNT(solver_iterations, 1);
+            if (auto reason = check_interruption(flags); reason != diagnostics::TerminationReason::none) {
+                return_code = (reason == diagnostics::TerminationReason::cancelled) ? VLE_return_code::cancelled : VLE_return_code::deadline_expired;
+                message = diagnostics::get_name(reason);
+                break;
+            }
             Eigen::VectorXd rv(2 * N); rv.setZero();
             functor(x, rv);
             functor.df(x, J);
@@ -374,6 +389,7 @@ inline auto mix_VLE_Tp(const AbstractModel& model, double T, double pgiven, cons
 
     MixVLEReturn r;
     r.return_code = return_code;
+    r.message = message;
     r.num_iter = static_cast<int>(niter);
     r.num_fev = static_cast<int>(nfev);
     r.r = final_r;
@@ -426,16 +442,23 @@ inline auto mixture_VLE_px(const AbstractModel& model, double p_spec, const Eige
     VLE_return_code return_code = VLE_return_code::unset;
 
     for (int iter = 0; iter < flags.maxiter; ++iter) {
+        TEQP_COUNT(solver_iterations, 1);
+        if (auto reason = check_interruption(flags); reason != diagnostics::TerminationReason::none) {
+            return_code = (reason == diagnostics::TerminationReason::cancelled) ? VLE_return_code::cancelled : VLE_return_code::deadline_expired;
+            break;
+        }
 
         auto RL = model.get_R(xmolar_spec);
         auto RLT = RL * T;
         auto RVT = RLT; // Note: this should not be exactly the same if you use mole-fraction-weighted gas constants
         
-        // calculations from the EOS in the isochoric thermodynamics formalism
-        auto [PsirL, PsirgradL, hessianL] = model.build_Psir_fgradHessian_autodiff(T, rhovecL);
-        auto [PsirV, PsirgradV, hessianV] = model.build_Psir_fgradHessian_autodiff(T, rhovecV);
-        auto DELTAdmu_dT_res = (model.build_d2PsirdTdrhoi_autodiff(T, rhovecL.eval())
-                              - model.build_d2PsirdTdrhoi_autodiff(T, rhovecV.eval())).eval();
+        // calculations from the EOS in the isochoric thermodynamics formalism, all the derivatives of a phase from one evaluation
+        const auto derL = model.build_Psir_derivative_bundle_autodiff(T, rhovecL.eval());
+        const auto derV = model.build_Psir_derivative_bundle_autodiff(T, rhovecV.eval());
+        const auto &PsirL = derL.Psir, &PsirV = derV.Psir;
+        const auto &PsirgradL = derL.gradient, &PsirgradV = derV.gradient;
+        const auto &hessianL = derL.Hessian, &hessianV = derV.Hessian;
+        auto DELTAdmu_dT_res = (derL.d2PsirdTdrhoi - derV.d2PsirdTdrhoi).eval();
 
         auto make_diag = [](const Eigen::ArrayXd& v) -> Eigen::ArrayXXd {
             Eigen::MatrixXd A = Eigen::MatrixXd::Identity(v.size(), v.size());
@@ -470,10 +493,10 @@ inline auto mixture_VLE_px(const AbstractModel& model, double p_spec, const Eige
         J.block(0, 1, N, N) = HtotL; // These are the concentration derivatives
         J.block(0, N+1, N, N) = -HtotV; // These are the concentration derivatives
         // Pressure contributions in Jacobian
-        J(N, 0) = model.get_dpdT_constrhovec(T, rhovecL)/p_spec;
+        J(N, 0) = derL.dpdT()/p_spec;
         J.block(N, 1, 1, N) = dpdrhovecL.transpose()/p_spec;
         // No vapor concentration derivatives
-        J(N+1, 0) = model.get_dpdT_constrhovec(T, rhovecV)/p_spec;
+        J(N+1, 0) = derV.dpdT()/p_spec;
         // No liquid concentration derivatives
         J.block(N+1, N+1, 1, N) = dpdrhovecV.transpose()/p_spec;
         // Mole fraction contributions in Jacobian
@@ -521,11 +544,212 @@ inline auto mixture_VLE_px(const AbstractModel& model, double p_spec, const Eige
     return std::make_tuple(return_code, T, rhovecLfinal, rhovecVfinal);
 }
 
+/**
+* \brief The Jacobian of the bubble or dew point equations with respect to [T, rhovecA, rhovecB] at given pressure, or [rhovecA, rhovecB] at given temperature
+* \param model The model to operate on
+* \param isothermal True if the temperature is specified, otherwise the pressure is
+* \param T Temperature
+* \param rhovecA The molar concentrations of the phase whose composition is specified
+* \param rhovecB The molar concentrations of the other phase
+*
+* The rows are the equalities of the chemical potentials, then of the pressures (one row, pA-pB, at given temperature; two rows,
+* pA-p and pB-p, at given pressure), then the N-1 first mole fractions of phase A. Also returned is the pressure of phase A.
+*/
+inline auto get_bubble_dew_Jacobian(const AbstractModel& model, const bool isothermal, const double T, const Eigen::ArrayXd& rhovecA, const Eigen::ArrayXd& rhovecB) {
+    const Eigen::Index N = rhovecA.size();
+    const auto derA = model.build_Psir_derivative_bundle_autodiff(T, rhovecA);
+    const auto derB = model.build_Psir_derivative_bundle_autodiff(T, rhovecB);
+    const Eigen::Index o = (isothermal) ? 0 : 1; // The offset of the concentrations in the columns
+    Eigen::MatrixXd J = Eigen::MatrixXd::Zero(2*N + o, 2*N + o);
+    
+    // Chemical potentials
+    if (!isothermal) {
+        J.block(0, 0, N, 1) = (derA.dchempotdT() - derB.dchempotdT()).matrix();
+    }
+    J.block(0, o, N, N) = derA.Psi_Hessian();
+    J.block(0, o + N, N, N) = -derB.Psi_Hessian();
+    // Pressures
+    if (isothermal) {
+        J.block(N, 0, 1, N) = derA.dpdrhovec().matrix().transpose();
+        J.block(N, N, 1, N) = -derB.dpdrhovec().matrix().transpose();
+    }
+    else {
+        J(N, 0) = derA.dpdT();
+        J.block(N, 1, 1, N) = derA.dpdrhovec().matrix().transpose();
+        J(N + 1, 0) = derB.dpdT();
+        J.block(N + 1, 1 + N, 1, N) = derB.dpdrhovec().matrix().transpose();
+    }
+    // Mole fractions, with dxi/drhoj = (rho*Kronecker(i,j)-rho_i)/rho^2
+    const double rhoA = rhovecA.sum();
+    for (auto i = 0; i < N - 1; ++i) {
+        for (auto j = 0; j < N; ++j) {
+            J(N + 1 + o + i, o + j) = ((i == j) ? rhoA - rhovecA[i] : -rhovecA[i])/(rhoA*rhoA);
+        }
+    }
+    return std::make_tuple(J, derA.p());
+}
+
+/**
+* \brief Bubble or dew points at many compositions, all at the same pressure or all at the same temperature
+* \param model The model to operate on
+* \param isothermal True if the temperature is specified, otherwise the pressure is
+* \param Tp The specified temperature, or pressure
+* \param compositions The mole fractions of the specified phase (the liquid for bubble points, the vapor for dew points), one point per row
+* \param T0 The initial temperature, only used at given pressure
+* \param rhovecL0 Initial values for the liquid molar concentrations, for the first point that is solved
+* \param rhovecV0 Initial values for the vapor molar concentrations, for the first point that is solved
+* \param options The options
+*
+* The points are solved with mixture_VLE_px at given pressure and with mix_VLE_Tx (binary mixtures only) at given temperature.
+* Each point starts from the solution of the preceding one, moved along the tangent of the solution with respect to the
+* specified composition, which is obtained from the Jacobian of the equations at the preceding solution. If that fails,
+* the point is retried from the preceding solution itself. A point that still fails is reported in its entry and the next
+* point continues from the last successful solution.
+*/
+inline BubbleDewBatchResult bubble_dew_batch(const AbstractModel& model, const bool isothermal, const double Tp, const Eigen::Ref<const Eigen::ArrayXXd>& compositions, const double T0, const Eigen::ArrayXd& rhovecL0, const Eigen::ArrayXd& rhovecV0, const std::optional<BubbleDewOptions>& options_ = std::nullopt) {
+    auto opt = options_.value_or(BubbleDewOptions{});
+    const Eigen::Index N = compositions.cols(), Npts = compositions.rows();
+    if (rhovecL0.size() != N || rhovecV0.size() != N) {
+        throw InvalidArgument("lengths of rhovecs and the number of columns of the compositions must be the same in bubble_dew_batch");
+    }
+    if (isothermal && N != 2) {
+        throw InvalidArgument("Only binary mixtures are supported at given temperature in bubble_dew_batch");
+    }
+    
+    // The specified phase is A, the other one is B
+    Eigen::ArrayXd rhovecA = (opt.dew) ? rhovecV0 : rhovecL0, rhovecB = (opt.dew) ? rhovecL0 : rhovecV0;
+    double T = (isothermal) ? Tp : T0;
+    Eigen::ArrayXd xprev = rhovecA/rhovecA.sum();
+    
+    BubbleDewBatchResult result;
+    result.points.resize(Npts);
+    
+    // The path through the compositions: from the point closest to the composition of the guess, always to the closest point not yet visited
+    std::vector<bool> visited(Npts, false);
+    Eigen::ArrayXd last = xprev;
+    for (auto k = 0; k < Npts; ++k) {
+        Eigen::Index inext = k;
+        if (opt.reorder) {
+            double dmin = std::numeric_limits<double>::infinity();
+            for (auto i = 0; i < Npts; ++i) {
+                double d = (compositions.row(i).transpose() - last).matrix().squaredNorm();
+                if (!visited[i] && d < dmin) { dmin = d; inext = i; }
+            }
+            visited[inext] = true;
+            last = compositions.row(inext).transpose();
+        }
+        result.order.push_back(static_cast<std::size_t>(inext));
+    }
+    
+    // Solve for one point from the given guess of the state
+    auto solve = [&](const Eigen::ArrayXd& x, double Tguess, const Eigen::ArrayXd& rhovecAguess, const Eigen::ArrayXd& rhovecBguess) {
+        BubbleDewPoint pt;
+        Eigen::ArrayXd A, B;
+        try {
+            if (isothermal) {
+                std::tie(pt.return_code, A, B) = mix_VLE_Tx(model, T, rhovecAguess, rhovecBguess, x, opt.flags.atol, opt.flags.reltol, opt.flags.axtol, opt.flags.relxtol, opt.flags.maxiter, MixVLETxFlags{opt.flags.cancellation, opt.flags.deadline});
+                pt.T = T;
+            }
+            else {
+                std::tie(pt.return_code, pt.T, A, B) = mixture_VLE_px(model, Tp, x, Tguess, rhovecAguess, rhovecBguess, opt.flags);
+            }
+        }
+        catch (const std::exception& e) {
+            pt.message = e.what();
+            return std::make_tuple(pt, A, B);
+        }
+        bool converged = pt.return_code == VLE_return_code::xtol_satisfied || pt.return_code == VLE_return_code::functol_satisfied;
+        if (!converged) {
+            pt.message = "Not converged";
+        }
+        else if (!A.isFinite().all() || !B.isFinite().all() || !std::isfinite(pt.T) || (A < 0).any() || (B < 0).any()) {
+            pt.message = "Not a valid solution";
+        }
+        else if (std::abs(B.sum()/A.sum() - 1) < opt.trivial_tol) {
+            pt.message = "Converged to the trivial solution";
+        }
+        else {
+            pt.success = true;
+        }
+        return std::make_tuple(pt, A, B);
+    };
+    
+    bool have_solution = false; // False until a point has been solved; the initial guess is not a solution
+    Eigen::MatrixXd J;
+    for (auto k = 0U; k < result.order.size(); ++k) {
+        const auto i = result.order[k];
+        auto& dest = result.points[i];
+        if (auto reason = check_interruption(opt.flags); reason != diagnostics::TerminationReason::none) {
+            // The remaining points are not attempted
+            for (auto kk = k; kk < result.order.size(); ++kk) {
+                auto& skipped = result.points[result.order[kk]];
+                skipped.return_code = (reason == diagnostics::TerminationReason::cancelled) ? VLE_return_code::cancelled : VLE_return_code::deadline_expired;
+                skipped.message = diagnostics::get_name(reason);
+            }
+            break;
+        }
+        const Eigen::ArrayXd x = compositions.row(i).transpose();
+        
+        std::vector<std::tuple<double, Eigen::ArrayXd, Eigen::ArrayXd>> guesses;
+        if (opt.predictor && have_solution) {
+            // First-order predictor: J du = [0, ..., 0, dx_0, ..., dx_{N-2}] from the derivative of the equations with respect to the specified mole fractions
+            Eigen::VectorXd rhs = Eigen::VectorXd::Zero(J.rows());
+            rhs.tail(N - 1) = (x - xprev).head(N - 1).matrix();
+            Eigen::VectorXd du = J.colPivHouseholderQr().solve(rhs);
+            const Eigen::Index o = (isothermal) ? 0 : 1;
+            Eigen::ArrayXd Apred = rhovecA + du.segment(o, N).array(), Bpred = rhovecB + du.segment(o + N, N).array();
+            double Tpred = (isothermal) ? T : T + du(0);
+            if (du.allFinite() && (Apred > 0).all() && (Bpred > 0).all() && Tpred > 0) {
+                guesses.emplace_back(Tpred, Apred, Bpred);
+            }
+        }
+        guesses.emplace_back(T, rhovecA, rhovecB);
+        
+        for (const auto& [Tguess, Aguess, Bguess] : guesses) {
+            auto [pt, A, B] = solve(x, Tguess, Aguess, Bguess);
+            dest = pt;
+            if (pt.success) {
+                T = pt.T;
+                rhovecA = A;
+                rhovecB = B;
+                xprev = x;
+                have_solution = true;
+                double pA;
+                std::tie(J, pA) = get_bubble_dew_Jacobian(model, isothermal, T, rhovecA, rhovecB);
+                dest.p = (isothermal) ? pA : Tp;
+                dest.rhovecL = (opt.dew) ? rhovecB : rhovecA;
+                dest.rhovecV = (opt.dew) ? rhovecA : rhovecB;
+                break;
+            }
+        }
+    }
+    for (const auto& pt : result.points) {
+        if (!pt.success) { result.num_failed++; }
+    }
+    return result;
+}
+
+/**
+* \brief Bubble or dew points at many compositions and the same pressure, see bubble_dew_batch
+*/
+inline auto bubble_dew_batch_p(const AbstractModel& model, const double p, const Eigen::Ref<const Eigen::ArrayXXd>& compositions, const double T0, const Eigen::ArrayXd& rhovecL0, const Eigen::ArrayXd& rhovecV0, const std::optional<BubbleDewOptions>& options = std::nullopt) {
+    return bubble_dew_batch(model, false, p, compositions, T0, rhovecL0, rhovecV0, options);
+}
+
+/**
+* \brief Bubble or dew points at many compositions and the same temperature, see bubble_dew_batch (binary mixtures only)
+*/
+inline auto bubble_dew_batch_T(const AbstractModel& model, const double T, const Eigen::Ref<const Eigen::ArrayXXd>& compositions, const Eigen::ArrayXd& rhovecL0, const Eigen::ArrayXd& rhovecV0, const std::optional<BubbleDewOptions>& options = std::nullopt) {
+    return bubble_dew_batch(model, true, T, compositions, T, rhovecL0, rhovecV0, options);
+}
+
 inline auto get_drhovecdp_Tsat(const AbstractModel& model, const double &T, const Eigen::ArrayXd& rhovecL, const Eigen::ArrayXd& rhovecV) {
     //tic = timeit.default_timer();
     using Scalar = double;
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hliq = model.build_Psi_Hessian_autodiff(T, rhovecL).eval();
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hvap = model.build_Psi_Hessian_autodiff(T, rhovecV).eval();
+    // All the derivatives of each phase come from one evaluation
+    const auto derL = model.build_Psir_derivative_bundle_autodiff(T, rhovecL), derV = model.build_Psir_derivative_bundle_autodiff(T, rhovecV);
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hliq = derL.Psi_Hessian();
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hvap = derV.Psi_Hessian();
     //Hvap[~np.isfinite(Hvap)] = 1e20;
     //Hliq[~np.isfinite(Hliq)] = 1e20;
 
@@ -546,10 +770,10 @@ inline auto get_drhovecdp_Tsat(const AbstractModel& model, const double &T, cons
     }
     else{
         // Special treatment for infinite dilution
-        auto murL = model.build_Psir_gradient_autodiff(T, rhovecL);
-        auto murV = model.build_Psir_gradient_autodiff(T, rhovecV);
-        auto RL = model.get_R(rhovecL / rhovecL.sum());
-        auto RV = model.get_R(rhovecV / rhovecV.sum());
+        const auto& murL = derL.gradient;
+        const auto& murV = derV.gradient;
+        auto RL = derL.R;
+        auto RV = derV.R;
 
         // First, for the liquid part
         for (auto i = 0; i < N; ++i) {
@@ -600,8 +824,10 @@ inline auto get_drhovecdT_psat(const AbstractModel& model, const double &T, cons
     if (rhovecL.size() != 2) { throw std::invalid_argument("Binary mixtures only"); }
     assert(rhovecL.size() == rhovecV.size());
 
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hliq = model.build_Psi_Hessian_autodiff(T, rhovecL).eval();
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hvap = model.build_Psi_Hessian_autodiff(T, rhovecV).eval();
+    // All the derivatives of each phase come from one evaluation
+    const auto derL = model.build_Psir_derivative_bundle_autodiff(T, rhovecL), derV = model.build_Psir_derivative_bundle_autodiff(T, rhovecV);
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hliq = derL.Psi_Hessian();
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hvap = derV.Psi_Hessian();
 
     auto N = rhovecL.size();
     Eigen::MatrixXd A = decltype(Hliq)::Zero(N, N);
@@ -616,9 +842,9 @@ inline auto get_drhovecdT_psat(const AbstractModel& model, const double &T, cons
         A(1, 0) = Hliq.row(0).dot(rhovecL.matrix());
         A(1, 1) = Hliq.row(1).dot(rhovecL.matrix());
 
-        auto DELTAdmu_dT = (model.get_dchempotdT_autodiff(T, rhovecV) - model.get_dchempotdT_autodiff(T, rhovecL)).eval();
-        b(0) = DELTAdmu_dT.matrix().dot(rhovecV.matrix()) - model.get_dpdT_constrhovec(T, rhovecV);
-        b(1) = -model.get_dpdT_constrhovec(T, rhovecL);
+        auto DELTAdmu_dT = (derV.dchempotdT() - derL.dchempotdT()).eval();
+        b(0) = DELTAdmu_dT.matrix().dot(rhovecV.matrix()) - derV.dpdT();
+        b(1) = -derL.dpdT();
         // Calculate the derivatives of the liquid phase
         drhovecdT_liq = linsolve(A, b);
         // Calculate the derivatives of the vapor phase
@@ -626,17 +852,17 @@ inline auto get_drhovecdT_psat(const AbstractModel& model, const double &T, cons
     }
     else{
         // Special treatment for infinite dilution
-        auto murL = model.build_Psir_gradient_autodiff(T, rhovecL);
-        auto murV = model.build_Psir_gradient_autodiff(T, rhovecV);
-        auto RL = model.get_R(rhovecL / rhovecL.sum());
-        auto RV = model.get_R(rhovecV / rhovecV.sum());
+        const auto& murL = derL.gradient;
+        const auto& murV = derV.gradient;
+        auto RL = derL.R;
+        auto RV = derV.R;
 
         // The dot product contains terms of the type:
         // rho'_i (R ln(rho"_i /rho'_i) + d mu ^ r"_i/d T - d mu^r'_i/d T)
 
         // Residual contribution to the difference in temperature derivative of chemical potential
         // It should be fine to evaluate with zero densities:
-        auto DELTAdmu_dT_res = (model.build_d2PsirdTdrhoi_autodiff(T, rhovecV) - model.build_d2PsirdTdrhoi_autodiff(T, rhovecL)).eval();
+        auto DELTAdmu_dT_res = (derV.d2PsirdTdrhoi - derL.d2PsirdTdrhoi).eval();
         // Now the ideal-gas part causes trouble, so multiply by the rhovec, once with liquid, another with vapor
         // Start off with the assumption that the rhovec is all positive (fix elements later)
         auto DELTAdmu_dT_rhoV_ideal = (rhovecV*(RV*log(rhovecV/rhovecL))).eval();
@@ -650,8 +876,8 @@ inline auto get_drhovecdT_psat(const AbstractModel& model, const double &T, cons
         }
         double DELTAdmu_dT_rhoV = rhovecV.matrix().dot(DELTAdmu_dT_res.matrix()) + DELTAdmu_dT_rhoV_ideal.sum();
         
-        b(0) = DELTAdmu_dT_rhoV - model.get_dpdT_constrhovec(T, rhovecV);
-        b(1) = -model.get_dpdT_constrhovec(T, rhovecL);
+        b(0) = DELTAdmu_dT_rhoV - derV.dpdT();
+        b(1) = -derL.dpdT();
 
         // First, for the liquid part
         for (auto i = 0; i < N; ++i) {
@@ -696,7 +922,7 @@ inline auto get_drhovecdT_psat(const AbstractModel& model, const double &T, cons
 }
 
 /***
-* \brief Derivative of molar concentration vectors w.r.t. T along an isopleth of the phase envelope for binary mixtures
+* \brief Derivative of molar concentration vectors w.r.t. T along an isopleth of the phase envelope
 * 
 * The liquid phase will have its mole fractions held constant
 * 
@@ -708,29 +934,70 @@ inline auto get_drhovecdT_psat(const AbstractModel& model, const double &T, cons
 * 
 * To keep the vapor mole fraction constant, just swap the input molar concentrations to this function, the first concentration 
 * vector is always the one with fixed mole fractions
+* 
+* If the Krylov options are provided, the Hessians are not built; their products with vectors are obtained by forward-over-forward
+* differentiation and the linear system for the vapor phase is solved with GMRES, which is cheaper for mixtures with many components
 */
-inline auto get_drhovecdT_xsat(const AbstractModel& model, const double& T, const Eigen::ArrayXd& rhovecL, const Eigen::ArrayXd& rhovecV) {
+inline auto get_drhovecdT_xsat(const AbstractModel& model, const double& T, const Eigen::ArrayXd& rhovecL, const Eigen::ArrayXd& rhovecV, const std::optional<KrylovOptions>& krylov = std::nullopt) {
     using Scalar = double;
-    if (rhovecL.size() != 2) { throw std::invalid_argument("Binary mixtures only"); }
-    assert(rhovecL.size() == rhovecV.size());
+    if (rhovecL.size() != rhovecV.size()) { throw std::invalid_argument("Both molar concentration arrays must be of the same size"); }
+    if (!((rhovecL != 0).all() && (rhovecV != 0).all())) {
+        throw std::invalid_argument("Infinite dilution not yet supported");
+    }
 
     Eigen::ArrayXd molefracL = rhovecL / rhovecL.sum();
-    Eigen::ArrayXd deltas = (model.get_dchempotdT_autodiff(T, rhovecV) - model.get_dchempotdT_autodiff(T, rhovecL)).eval();
-    Scalar deltabeta = (model.get_dpdT_constrhovec(T, rhovecV)- model.get_dpdT_constrhovec(T, rhovecL));
     Eigen::ArrayXd deltarho = (rhovecV - rhovecL).eval();
-
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hliq = model.build_Psi_Hessian_autodiff(T, rhovecL).eval();
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hvap = model.build_Psi_Hessian_autodiff(T, rhovecV).eval();
-    
     Eigen::MatrixXd drhodT_liq, drhodT_vap;
-    if ((rhovecL != 0).all() && (rhovecV != 0).all()) {
+    
+    if (!krylov) {
+        // All the derivatives of each phase come from one evaluation
+        const auto derL = model.build_Psir_derivative_bundle_autodiff(T, rhovecL), derV = model.build_Psir_derivative_bundle_autodiff(T, rhovecV);
+        
+        Eigen::ArrayXd deltas = (derV.dchempotdT() - derL.dchempotdT()).eval();
+        Scalar deltabeta = (derV.dpdT() - derL.dpdT());
+        
+        Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hliq = derL.Psi_Hessian();
+        Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hvap = derV.Psi_Hessian();
+        
         auto num = (deltas.matrix().dot(rhovecV.matrix()) - deltabeta); // numerator, a scalar
         auto den = (Hliq*(deltarho.matrix())).dot(molefracL.matrix()); // denominator, a scalar
         drhodT_liq = num/den*molefracL;
         drhodT_vap = linsolve(Hvap, ((Hliq * drhodT_liq).array() - deltas.array()).eval());
     }
     else {
-        throw std::invalid_argument("Infinite dilution not yet supported");
+        // Matrix-free: the Hessians only appear through their products with vectors, so for many components
+        // neither is built. The temperature derivatives of a phase take N+1 passes through the model
+        auto get_Tderivs = [&model, &T](const Eigen::ArrayXd& rhovec) {
+            double rho = rhovec.sum();
+            Eigen::ArrayXd x = rhovec / rho;
+            double R = model.get_R(x);
+            Eigen::ArrayXd d2PsirdTdrhoi = model.build_d2PsirdTdrhoi_autodiff(T, rhovec);
+            auto Ar = model.get_Ar10n(T, rho, x); // Ar00 and Ar10 in one pass
+            double dPsirdT = rho*R*(Ar[0] - Ar[1]);
+            double dpdT = rho*R - dPsirdT + (rhovec*d2PsirdTdrhoi).sum();
+            Eigen::ArrayXd dmudT = d2PsirdTdrhoi + R*(1.0 + log(rhovec));
+            return std::make_tuple(R, dpdT, dmudT);
+        };
+        auto [RL, dpdTL, dmudTL] = get_Tderivs(rhovecL);
+        auto [RV, dpdTV, dmudTV] = get_Tderivs(rhovecV);
+        Eigen::ArrayXd deltas = (dmudTV - dmudTL).eval();
+        Scalar deltabeta = dpdTV - dpdTL;
+        
+        // The product of the Hessian of Psi of a phase with a vector, the ideal-gas part being diagonal
+        auto HPsi = [&model, &T](const Eigen::ArrayXd& rhovec, double R, const Eigen::ArrayXd& v) -> Eigen::ArrayXd {
+            return (model.build_Psir_Hessian_vector_product_autodiff(T, rhovec, v) + R*T*v/rhovec).eval();
+        };
+        
+        auto num = (deltas.matrix().dot(rhovecV.matrix()) - deltabeta); // numerator, a scalar
+        // The denominator is x'.(H' deltarho), a single vector-Hessian-vector product
+        auto den = model.get_Psir_vector_Hessian_vector_product_autodiff(T, rhovecL, molefracL, deltarho) + (RL*T*molefracL*deltarho/rhovecL).sum();
+        drhodT_liq = num/den*molefracL;
+        Eigen::VectorXd RHS = (num/den*HPsi(rhovecL, RL, molefracL) - deltas).matrix();
+        auto solved = gmres([&](const Eigen::VectorXd& v) { return HPsi(rhovecV, RV, v.array()).matrix().eval(); }, RHS, krylov.value());
+        if (!solved.converged) {
+            throw IterationError("GMRES did not converge for the vapor concentration derivatives in get_drhovecdT_xsat; residual norm: " + std::to_string(solved.residual_norm));
+        }
+        drhodT_vap = solved.x;
     }
     return std::make_tuple(drhodT_liq, drhodT_vap);
 }
@@ -878,10 +1145,34 @@ inline auto trace_VLE_isotherm_binary(const AbstractModel &model, double T, cons
         }
     }
     std::string termination_reason;
+
+    // Build an event at the current state, to be emitted to the sink of the diagnostics
+    using diagnostics::EventKind;
+    using diagnostics::TerminationReason;
+    auto make_event = [&](EventKind kind, int step, const state_type& x) {
+        diagnostics::TraceEvent e("trace_VLE_isotherm_binary", kind, step);
+        e.t = t; e.dt = dt; e.T = T;
+        e.set_state(Eigen::Map<const Eigen::ArrayXd>(&(x[0]), 2*N));
+        return e;
+    };
+    auto terminate = [&](TerminationReason reason, int step, std::string_view msg) {
+        termination_reason = diagnostics::get_name(reason);
+        if (auto sink = diagnostics::get_sink(opt, 10)) {
+            auto e = make_event(EventKind::termination, step, x0);
+            e.reason = reason;
+            e.set_message(msg);
+            sink->emit(e);
+        }
+    };
     
     // Then trace...
     int retry_count = 0;
     for (auto istep = 0; istep < opt.max_steps; ++istep) {
+        TEQP_COUNT(trace_steps, 1);
+        if (auto reason = check_interruption(opt); reason != TerminationReason::none) {
+            terminate(reason, istep, "");
+            break;
+        }
 
         auto store_point = [&]() {
             //// Calculate some other parameters, for debugging
@@ -897,7 +1188,11 @@ inline auto trace_VLE_isotherm_binary(const AbstractModel &model, double T, cons
                 xprime(x0, last_drhodt, -1.0);
             }
             catch (...) {
-                std::cout << "Something bad happened; couldn't calculate xprime in store_point" << std::endl;
+                if (auto sink = diagnostics::get_sink(opt, 0)) {
+                    auto e = make_event(EventKind::integration_failure, istep, x0);
+                    e.set_message("could not calculate xprime in store_point");
+                    sink->emit(e);
+                }
             }
 
             // Store the data in a JSON structure
@@ -919,7 +1214,11 @@ inline auto trace_VLE_isotherm_binary(const AbstractModel &model, double T, cons
                 point["crit. conditions V"] = model.get_criticality_conditions(T, rhovecV);
             }
             JSONdata.push_back(point);
-            //std::cout << JSONdata.back().dump() << std::endl;
+            if (auto sink = diagnostics::get_sink(opt, 10)) {
+                auto e = make_event(EventKind::step, istep, x0);
+                e.residual_norm = std::abs(pL - pV);
+                sink->emit(e);
+            }
         };
         if (istep == 0 && retry_count == 0) {
             store_point();
@@ -933,11 +1232,19 @@ inline auto trace_VLE_isotherm_binary(const AbstractModel &model, double T, cons
             try {
                 res = controlled_stepper.try_step(xprime, x0, t, dt);
             }
+            catch (const std::exception& e) {
+                terminate(TerminationReason::integration_failure, istep, e.what());
+                break;
+            }
             catch (...) {
+                terminate(TerminationReason::integration_failure, istep, "unknown exception");
                 break;
             }
 
             if (res != controlled_step_result::success) {
+                if (auto sink = diagnostics::get_sink(opt, 10)) {
+                    sink->emit(make_event(EventKind::step_rejected, istep, x0));
+                }
                 // Try again, with a smaller step size
                 istep--;
                 retry_count++;
@@ -954,14 +1261,19 @@ inline auto trace_VLE_isotherm_binary(const AbstractModel &model, double T, cons
                 eul.do_step(xprime, x0, t, dt);
                 t += dt;
             }
+            catch (const std::exception& e) {
+                terminate(TerminationReason::integration_failure, istep, e.what());
+                break;
+            }
             catch (...) {
+                terminate(TerminationReason::integration_failure, istep, "unknown exception");
                 break;
             }
         }
         else {
             throw InvalidArgument("integration order is invalid:" + std::to_string(opt.integration_order));
         }
-        auto stop_requested = [&]() {
+        auto stop_requested = [&]() -> TerminationReason {
             //// Calculate some other parameters, for debugging
             auto N = x0.size() / 2;
             auto rhovecL = Eigen::Map<const Eigen::ArrayXd>(&(x0[0]), N);
@@ -975,20 +1287,21 @@ inline auto trace_VLE_isotherm_binary(const AbstractModel &model, double T, cons
                 auto condsL = model.get_criticality_conditions(T, rhovecL);
                 auto condsV = model.get_criticality_conditions(T, rhovecV);
                 if (condsL[0] < opt.crit_termination || condsV[0] < opt.crit_termination){
-                    return true;
+                    return TerminationReason::unstable;
                 }
             }
             if (p > opt.p_termination){
-                return true;
+                return TerminationReason::pressure_limit;
             }
             if ((x < 0).any() || (x > 1).any() || (y < 0).any() || (y > 1).any() || (!rhovecL.isFinite()).any() || (!rhovecV.isFinite()).any()) {
-                return true;
+                return TerminationReason::composition_out_of_range;
             }
             else {
-                return false;
+                return TerminationReason::none;
             }
         };
-        if (stop_requested()) {
+        if (auto reason = stop_requested(); reason != TerminationReason::none) {
+            terminate(reason, istep, "");
             break;
         }
         // Polish the solution
@@ -999,14 +1312,14 @@ inline auto trace_VLE_isotherm_binary(const AbstractModel &model, double T, cons
             auto [return_code, rhovecLnew, rhovecVnew] = model.mix_VLE_Tx(T, rhovecL, rhovecV, x, 1e-10, 1e-8, 1e-10, 1e-8, 10);
             
             if (((rhovecL-rhovecLnew).cwiseAbs() > opt.polish_reltol_rho*rhovecL).any()){
-                std::string msg;
+                std::string msg = "Polishing changed a molar concentration by more than " + std::to_string(opt.polish_reltol_rho*100) + " %";
                 if (opt.polish_exception_on_fail){
                     throw IterationFailure(msg);
                 }
-                else{
-                    if (opt.verbosity > 0){
-                        std::cout << msg << std::endl;
-                    }
+                else if (auto sink = diagnostics::get_sink(opt, 0)) {
+                    auto e = make_event(EventKind::polish_failure, istep, x0);
+                    e.set_message(msg);
+                    sink->emit(e);
                 }
             }
             else{
@@ -1020,6 +1333,9 @@ inline auto trace_VLE_isotherm_binary(const AbstractModel &model, double T, cons
 
         std::swap(previous_drhodt, last_drhodt);
         store_point(); // last_drhodt is updated;
+        if (istep == opt.max_steps - 1) {
+            terminate(TerminationReason::max_steps, istep, "maximum number of steps were taken");
+        }
         
     }
     if (opt.revision == 1){
@@ -1137,9 +1453,33 @@ auto trace_VLE_isobar_binary(const Model& model, double p, double T0, const Eige
     }
     std::string termination_reason;
 
+    // Build an event at the current state, to be emitted to the sink of the diagnostics
+    using diagnostics::EventKind;
+    using diagnostics::TerminationReason;
+    auto make_event = [&](EventKind kind, int step, const state_type& x) {
+        diagnostics::TraceEvent e("trace_VLE_isobar_binary", kind, step);
+        e.t = t; e.dt = dt; e.T = x[0];
+        e.set_state(Eigen::Map<const Eigen::ArrayXd>(&(x[1]), 2*N));
+        return e;
+    };
+    auto terminate = [&](TerminationReason reason, int step, std::string_view msg) {
+        termination_reason = diagnostics::get_name(reason);
+        if (auto sink = diagnostics::get_sink(opt, 10)) {
+            auto e = make_event(EventKind::termination, step, x0);
+            e.reason = reason;
+            e.set_message(msg);
+            sink->emit(e);
+        }
+    };
+
     // Then trace...
     int retry_count = 0;
     for (auto istep = 0; istep < opt.max_steps; ++istep) {
+        TEQP_COUNT(trace_steps, 1);
+        if (auto reason = check_interruption(opt); reason != TerminationReason::none) {
+            terminate(reason, istep, "");
+            break;
+        }
 
         auto store_point = [&]() {
             //// Calculate some other parameters, for debugging
@@ -1156,7 +1496,11 @@ auto trace_VLE_isobar_binary(const Model& model, double p, double T0, const Eige
                 xprime(x0, last_drhodt, -1.0);
             }
             catch (...) {
-                std::cout << "Something bad happened; couldn't calculate xprime in store_point" << std::endl;
+                if (auto sink = diagnostics::get_sink(opt, 0)) {
+                    auto e = make_event(EventKind::integration_failure, istep, x0);
+                    e.set_message("could not calculate xprime in store_point");
+                    sink->emit(e);
+                }
             }
 
             // Store the data in a JSON structure
@@ -1178,7 +1522,11 @@ auto trace_VLE_isobar_binary(const Model& model, double p, double T0, const Eige
                 point["crit. conditions V"] = model.get_criticality_conditions(T, rhovecV);
             }
             JSONdata.push_back(point);
-            //std::cout << JSONdata.back().dump() << std::endl;
+            if (auto sink = diagnostics::get_sink(opt, 10)) {
+                auto e = make_event(EventKind::step, istep, x0);
+                e.residual_norm = std::abs(pL - pV);
+                sink->emit(e);
+            }
         };
         if (istep == 0 && retry_count == 0) {
             store_point();
@@ -1192,11 +1540,19 @@ auto trace_VLE_isobar_binary(const Model& model, double p, double T0, const Eige
             try {
                 res = controlled_stepper.try_step(xprime, x0, t, dt);
             }
+            catch (const std::exception& e) {
+                terminate(TerminationReason::integration_failure, istep, e.what());
+                break;
+            }
             catch (...) {
+                terminate(TerminationReason::integration_failure, istep, "unknown exception");
                 break;
             }
 
             if (res != controlled_step_result::success) {
+                if (auto sink = diagnostics::get_sink(opt, 10)) {
+                    sink->emit(make_event(EventKind::step_rejected, istep, x0));
+                }
                 // Try again, with a smaller step size
                 istep--;
                 retry_count++;
@@ -1213,14 +1569,19 @@ auto trace_VLE_isobar_binary(const Model& model, double p, double T0, const Eige
                 eul.do_step(xprime, x0, t, dt);
                 t += dt;
             }
+            catch (const std::exception& e) {
+                terminate(TerminationReason::integration_failure, istep, e.what());
+                break;
+            }
             catch (...) {
+                terminate(TerminationReason::integration_failure, istep, "unknown exception");
                 break;
             }
         }
         else {
             throw InvalidArgument("integration order is invalid:" + std::to_string(opt.integration_order));
         }
-        auto stop_requested = [&]() {
+        auto stop_requested = [&]() -> TerminationReason {
             //// Calculate some other parameters, for debugging
             auto N = (x0.size()-1) / 2;
             auto& T = x0[0];
@@ -1233,17 +1594,18 @@ auto trace_VLE_isobar_binary(const Model& model, double p, double T0, const Eige
                 auto condsL = model.get_criticality_conditions(T, rhovecL);
                 auto condsV = model.get_criticality_conditions(T, rhovecV);
                 if (condsL[0] < opt.crit_termination || condsV[0] < opt.crit_termination) {
-                    return true;
+                    return TerminationReason::unstable;
                 }
             }
             if ((x < 0).any() || (x > 1).any() || (y < 0).any() || (y > 1).any() || (!rhovecL.isFinite()).any() || (!rhovecV.isFinite()).any()) {
-                return true;
+                return TerminationReason::composition_out_of_range;
             }
             else {
-                return false;
+                return TerminationReason::none;
             }
         };
-        if (stop_requested()) {
+        if (auto reason = stop_requested(); reason != TerminationReason::none) {
+            terminate(reason, istep, "");
             break;
         }
         // Polish the solution
@@ -1255,14 +1617,14 @@ auto trace_VLE_isobar_binary(const Model& model, double p, double T0, const Eige
             auto [return_code, Tnew, rhovecLnew, rhovecVnew] = model.mixture_VLE_px(p, x, T, rhovecL, rhovecV);
 
             if (((rhovecL-rhovecLnew).cwiseAbs() > opt.polish_reltol_rho*rhovecL).any()){
-                std::string msg;
+                std::string msg = "Polishing changed a molar concentration by more than " + std::to_string(opt.polish_reltol_rho*100) + " %";
                 if (opt.polish_exception_on_fail){
                     throw IterationFailure(msg);
                 }
-                else{
-                    if (opt.verbosity > 0){
-                        std::cout << msg << std::endl;
-                    }
+                else if (auto sink = diagnostics::get_sink(opt, 0)) {
+                    auto e = make_event(EventKind::polish_failure, istep, x0);
+                    e.set_message(msg);
+                    sink->emit(e);
                 }
             }
             else{
@@ -1278,9 +1640,27 @@ auto trace_VLE_isobar_binary(const Model& model, double p, double T0, const Eige
 
         std::swap(previous_drhodt, last_drhodt);
         store_point(); // last_drhodt is updated;
+        if (istep == opt.max_steps - 1) {
+            terminate(TerminationReason::max_steps, istep, "maximum number of steps were taken");
+        }
 
     }
-    return JSONdata;
+    if (opt.revision == 1){
+        return JSONdata;
+    }
+    else if (opt.revision == 2){
+        nlohmann::json meta{
+            {"termination_reason", termination_reason}
+        };
+        return nlohmann::json{
+            {"meta", meta},
+            {"data", JSONdata}
+        };
+    }
+    else
+    {
+        throw teqp::InvalidArgument("revision is not valid");
+    }
 }
 
 #define VLE_FUNCTIONS_TO_WRAP \
@@ -1293,7 +1673,9 @@ auto trace_VLE_isobar_binary(const Model& model, double p, double T0, const Eige
     X(trace_critical_arclength_binary) \
     X(mixture_VLE_px) \
     X(mix_VLE_Tp) \
-    X(mix_VLE_Tx)
+    X(mix_VLE_Tx) \
+    X(bubble_dew_batch_p) \
+    X(bubble_dew_batch_T)
 
 #define X(f) template <typename TemplatedModel, typename ...Params, \
 typename = typename std::enable_if<not std::is_base_of<teqp::cppinterface::AbstractModel, TemplatedModel>::value>::type> \
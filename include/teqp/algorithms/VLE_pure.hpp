@@ -5,6 +5,9 @@
 //  Created by Bell, Ian H. (Fed) on 5/3/23.
 //
 #pragma once
+#include <algorithm>
+#include <limits>
+#include <tuple>
 #include <type_traits>
 #include "teqp/cpp/teqpcpp.hpp"
 #include "teqp/derivs.hpp"
@@ -110,6 +113,7 @@ auto do_pure_VLE_T(Residual &resid, Scalar rhoL, Scalar rhoV, int maxiter) {
     auto r0 = resid.call(rhovec);
     auto J = resid.Jacobian(rhovec);
     for (int iter = 0; iter < maxiter; ++iter){
+        TEQP_COUNT(solver_iterations, 1);
         if (iter > 0) {
             r0 = resid.call(rhovec);
             J = resid.Jacobian(rhovec);
@@ -169,6 +173,32 @@ inline auto dpsatdT_pure(const teqp::cppinterface::AbstractModel& model, double
     return dpsatdT;
 }
 
+/***
+ * \brief Calculate the derivatives of the saturated densities with respect to temperature for a pure fluid
+ * \param model The model to operate on
+ * \param T Temperature
+ * \param rhoL Liquid density
+ * \param rhoV Vapor density
+ * \param z Mole fractions, to select the pure fluid in a mixture model
+ *
+ * The slope of the vapor pressure curve is obtained from the Clapeyron equation, as in dpsatdT_pure, and the derivatives of each phase
+ * come from a single call to get_deriv_mat2, rather than one derivative pass for each of \f$\alpha^r_{01}\f$, \f$\alpha^r_{02}\f$, \f$\alpha^r_{10}\f$ and \f$\alpha^r_{11}\f$
+ * \f[
+ * \left(\frac{d\rho}{dT}\right)_{\sigma} = \frac{(dp/dT)_{\sigma} - (\partial p/\partial T)_{\rho}}{(\partial p/\partial \rho)_{T}}
+ * \f]
+ */
+inline auto get_drhodT_sat_pure(const teqp::cppinterface::AbstractModel& model, double T, double rhoL, double rhoV, const Eigen::ArrayXd& z) {
+    double R = model.get_R(z);
+    auto L = model.get_deriv_mat2(T, rhoL, z), V = model.get_deriv_mat2(T, rhoV, z);
+    double dpsatdT = R*((V(0,1) + V(1,0)) - (L(0,1) + L(1,0)))/(1/rhoV - 1/rhoL);
+    auto drhodT = [&](const auto& A, double rho){
+        double dpdrho = R*T*(1 + 2*A(0,1) + A(0,2));
+        double dpdT = R*rho*(1 + A(0,1) - A(1,1));
+        return (dpsatdT - dpdT)/dpdrho;
+    };
+    return std::make_tuple(drhodT(L, rhoL), drhodT(V, rhoV));
+}
+
 /***
  \brief Starting at the critical point, trace the VLE down to a temperature of interest
  
@@ -180,6 +210,14 @@ inline auto dpsatdT_pure(const teqp::cppinterface::AbstractModel& model, double
  1. Solve for the true critical point satisfying \f$(\partial p/\partial \rho)_{T}=(\partial^2p/\partial\rho^2)_{T}=0\f$
  2. Take a small step away from the critical point (this is where the beta=0.5 assumption is invoked)
  3. Integrate from the near critical temperature to the temperature of interest
+ 
+ By default (or if "integration" is "adaptive"), the integration is carried out in \f$\tau=T_c/T\f$ with error control. The logarithms of the densities
+ are predicted with the slopes from the Clapeyron equation (see get_drhodT_sat_pure), and then polished with pure_VLE_T; the difference between
+ the predicted and polished values is the estimate of the error of the step. A step is rejected if that difference exceeds "rtol" (default 1e-2),
+ and otherwise the next step is scaled with the square root of the ratio of "rtol" to the error (the predictor is first order), so the steps grow
+ away from the critical point. The optional fields are "init_dtau" (default 1/Tred-1, the distance of the start from the critical point) and "max_steps" (default 1000).
+ 
+ If "integration" is "fixed", the legacy integration in "Nstep" equal steps in temperature is used, with the Euler predictor if "with_deriv" is true.
  */
 inline auto pure_trace_VLE(const teqp::cppinterface::AbstractModel& model, const double T, const nlohmann::json &spec){
     // Start at the true critical point, from the specified guess value
@@ -194,35 +232,77 @@ inline auto pure_trace_VLE(const teqp::cppinterface::AbstractModel& model, const
     auto [Tc, rhoc] = solve_pure_critical(model, spec.at("Tcguess").get<double>(), spec.at("rhocguess").get<double>(), pure_spec);
     
     // Small step towards lower temperature close to critical temperature
-    double Tclose = spec.at("Tred").get<double>()*Tc;
+    double Tred = spec.at("Tred").get<double>();
+    double Tclose = Tred*Tc;
     auto rhoLrhoV = extrapolate_from_critical(model, Tc, rhoc, Tclose, z);
     auto rhoLrhoVpolished = pure_VLE_T(model, Tclose, rhoLrhoV[0], rhoLrhoV[1], spec.value("NVLE", 10), z);
     if (rhoLrhoVpolished[0] == rhoLrhoVpolished[1]){
         throw teqp::IterationError("Converged to trivial solution");
     }
     
+    std::string integration = spec.value("integration", "adaptive");
+    if (integration == "adaptive"){
+        const double rtol = spec.value("rtol", 1e-2);
+        const int max_steps = spec.value("max_steps", 1000);
+        const int NVLE = spec.value("NVLE", 10);
+        const double tau_end = Tc/T;
+        double tau = Tc/Tclose, Tcurrent = Tclose;
+        const double dir = (tau_end > tau) ? 1.0 : -1.0;
+        double h = spec.value("init_dtau", 1.0/Tred - 1.0);
+        
+        auto [drhodTL, drhodTV] = get_drhodT_sat_pure(model, Tcurrent, rhoLrhoVpolished[0], rhoLrhoVpolished[1], z);
+        for (auto istep = 0; dir*(tau_end - tau) > 0; ++istep){
+            if (istep >= max_steps){
+                throw teqp::IterationError("Maximum number of steps reached in pure_trace_VLE");
+            }
+            // The last step lands on the temperature of interest
+            const double hstep = dir*std::min(h, std::abs(tau_end - tau));
+            const double taunew = tau + hstep, Tnew = (taunew == tau_end) ? T : Tc/taunew;
+            
+            // Predictor for the logarithms of the densities, with dT/dtau = -T^2/Tc
+            const double dTdtau = -Tcurrent*Tcurrent/Tc;
+            const double lnrhoL = log(rhoLrhoVpolished[0]) + drhodTL/rhoLrhoVpolished[0]*dTdtau*hstep;
+            const double lnrhoV = log(rhoLrhoVpolished[1]) + drhodTV/rhoLrhoVpolished[1]*dTdtau*hstep;
+            
+            // Corrector
+            auto polished = pure_VLE_T(model, Tnew, exp(lnrhoL), exp(lnrhoV), NVLE, z);
+            bool ok = polished.isFinite().all() && (polished > 0).all() && polished[0] > polished[1];
+            double err = (ok) ? std::max(std::abs(log(polished[0]) - lnrhoL), std::abs(log(polished[1]) - lnrhoV)) : std::numeric_limits<double>::infinity();
+            
+            if (!ok || err > rtol){
+                // Reject the step and try again with a smaller one
+                h *= (ok) ? std::max(0.2, 0.9*sqrt(rtol/err)) : 0.25;
+                if (h < 1e-12){
+                    throw teqp::IterationError("Step size too small in pure_trace_VLE at T=" + std::to_string(Tcurrent));
+                }
+                continue;
+            }
+            // Accept the step, and grow it if the error allows
+            tau = taunew;
+            Tcurrent = Tnew;
+            rhoLrhoVpolished = polished;
+            h = std::abs(hstep)*std::clamp(0.9*sqrt(rtol/std::max(err, 1e-16)), 0.2, 4.0);
+            if (dir*(tau_end - tau) > 0){
+                std::tie(drhodTL, drhodTV) = get_drhodT_sat_pure(model, Tcurrent, rhoLrhoVpolished[0], rhoLrhoVpolished[1], z);
+            }
+        }
+        return rhoLrhoVpolished;
+    }
+    else if (integration != "fixed"){
+        throw teqp::InvalidArgument("integration must be one of 'adaptive' or 'fixed'; it is: " + integration);
+    }
+    
     // "Integrate" down to temperature of interest
     int Nstep = spec.at("Nstep");
-    double R = model.R(z);
     bool with_deriv = spec.at("with_deriv");
     double dT = -(Tclose-T)/(Nstep-1);
     
     for (auto T_: Eigen::ArrayXd::LinSpaced(Nstep, Tclose, T)){
         rhoLrhoVpolished = pure_VLE_T(model, T_, rhoLrhoVpolished[0], rhoLrhoVpolished[1], spec.value("NVLE", 10), z);
         
-        //auto pL = rhoLrhoVpolished[0]*R*T_*(1 + tdx::get_Ar01(model, T_, rhoLrhoVpolished[0], z));
-        //auto pV = rhoLrhoVpolished[1]*R*T_*(1 + tdx::get_Ar01(model, T_, rhoLrhoVpolished[1], z));
-        //std::cout << pL << " " << pV << " " << pL/pV-1 <<  std::endl;
         if (with_deriv){
             // Get drho/dT for both phases
-            auto dpsatdT = dpsatdT_pure(model, T_, rhoLrhoVpolished[0], rhoLrhoVpolished[1], z);
-            auto get_drhodT = [&z, R, dpsatdT](const AbstractModel& model, double T, double rho){
-                auto dpdrho = R*T*(1 + 2*model.get_Ar01(T, rho, z) + model.get_Ar02(T, rho, z));
-                auto dpdT = R*rho*(1 + model.get_Ar01(T, rho, z) - model.get_Ar11(T, rho, z));
-                return -dpdT/dpdrho + dpsatdT/dpdrho;
-            };
-            auto drhodTL = get_drhodT(model, T_, rhoLrhoVpolished[0]);
-            auto drhodTV = get_drhodT(model, T_, rhoLrhoVpolished[1]);
+            auto [drhodTL, drhodTV] = get_drhodT_sat_pure(model, T_, rhoLrhoVpolished[0], rhoLrhoVpolished[1], z);
             // Use the obtained derivative to calculate the step in rho from deltarho = (drhodT)*dT
             auto DeltarhoL = dT*drhodTL, DeltarhoV = dT*drhodTV;
             rhoLrhoVpolished[0] += DeltarhoL;
@@ -242,6 +322,7 @@ inline auto pure_trace_VLE(const teqp::cppinterface::AbstractModel& model, const
 
 #define VLE_PURE_FUNCTIONS_TO_WRAP \
     X(dpsatdT_pure) \
+    X(get_drhodT_sat_pure) \
     X(pure_VLE_T) \
     X(pure_trace_VLE)
 
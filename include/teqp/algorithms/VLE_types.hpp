@@ -1,5 +1,8 @@
 #pragma once
 
+#include "teqp/algorithms/diagnostics.hpp"
+#include "teqp/algorithms/cancellation.hpp"
+
 namespace teqp{
 
 struct TVLEOptions {
@@ -9,15 +12,21 @@ struct TVLEOptions {
     double polish_reltol_rho = 0.05;
     bool calc_criticality = false;
     bool terminate_unstable = false;
+    std::shared_ptr<diagnostics::EventSink> sink; ///< If set, the steps, failures, and termination of the tracing are emitted to this sink rather than printed according to the verbosity
+    std::optional<CancellationToken> cancellation; ///< If set and cancelled, stop at the next step and return the partial result
+    std::optional<Deadline> deadline; ///< If set and expired, stop at the next step and return the partial result
 };
 
 struct PVLEOptions {
     double init_dt = 1e-5, abs_err = 1e-8, rel_err = 1e-8, max_dt = 100000, init_c = 1.0, crit_termination = 1e-12;
-    int max_steps = 1000, integration_order = 5, verbosity = 0;
+    int max_steps = 1000, integration_order = 5, revision = 1, verbosity = 0;
     bool polish = true, polish_exception_on_fail = false;
     double polish_reltol_rho = 0.05;
     bool calc_criticality = false;
     bool terminate_unstable = false;
+    std::shared_ptr<diagnostics::EventSink> sink; ///< If set, the steps, failures, and termination of the tracing are emitted to this sink rather than printed according to the verbosity
+    std::optional<CancellationToken> cancellation; ///< If set and cancelled, stop at the next step and return the partial result
+    std::optional<Deadline> deadline; ///< If set and expired, stop at the next step and return the partial result
 };
 
 struct MixVLEpxFlags {
@@ -26,6 +35,14 @@ struct MixVLEpxFlags {
     axtol = 1e-10,
     relxtol = 1e-10;
     int maxiter = 10;
+    std::optional<CancellationToken> cancellation; ///< If set and cancelled, stop at the next iteration and return the partial result
+    std::optional<Deadline> deadline; ///< If set and expired, stop at the next iteration and return the partial result
+};
+
+/// The interruption of mix_VLE_Tx, whose tolerances are passed as arguments
+struct MixVLETxFlags {
+    std::optional<CancellationToken> cancellation; ///< If set and cancelled, stop at the next iteration and return the partial result
+    std::optional<Deadline> deadline; ///< If set and expired, stop at the next iteration and return the partial result
 };
 
 struct MixVLETpFlags {
@@ -35,9 +52,11 @@ struct MixVLETpFlags {
     relxtol = 1e-10,
     relaxation = 1.0;
     int maxiter = 10;
+    std::optional<CancellationToken> cancellation; ///< If set and cancelled, stop at the next iteration and return the partial result
+    std::optional<Deadline> deadline; ///< If set and expired, stop at the next iteration and return the partial result
 };
 
-enum class VLE_return_code { unset, xtol_satisfied, functol_satisfied, maxfev_met, maxiter_met, notfinite_step };
+enum class VLE_return_code { unset, xtol_satisfied, functol_satisfied, maxfev_met, maxiter_met, notfinite_step, cancelled, deadline_expired };
 
 struct MixVLEReturn {
     bool success = false;
@@ -49,4 +68,27 @@ struct MixVLEReturn {
     Eigen::ArrayXd r, initial_r;
 };
 
+struct BubbleDewOptions {
+    bool dew = false; ///< If true, the compositions are those of the vapor (dew points), otherwise those of the liquid (bubble points)
+    bool reorder = true; ///< If true, the points are solved along a path through the compositions, starting from the one closest to the guess; otherwise in the given order
+    bool predictor = true; ///< If true, the guess for each point is extrapolated to first order in composition from the solution of the preceding point; otherwise that solution is used as is
+    double trivial_tol = 1e-6; ///< A solution whose phases differ in molar density by less than this, relative to that of the specified phase, is rejected as trivial
+    MixVLEpxFlags flags; ///< The tolerances and the maximum number of iterations of the solution of each point; if cancelled or expired, the remaining points are not attempted
+};
+
+struct BubbleDewPoint {
+    bool success = false;
+    VLE_return_code return_code = VLE_return_code::unset;
+    std::string message = ""; ///< Why the point failed, if it did
+    double T = -1, ///< Temperature, in K
+    p = -1; ///< Pressure, in Pa
+    Eigen::ArrayXd rhovecL, rhovecV; ///< The molar concentrations of the phases, in mol/m^3
+};
+
+struct BubbleDewBatchResult {
+    std::vector<BubbleDewPoint> points; ///< The solutions, in the order of the given compositions
+    std::vector<std::size_t> order; ///< The indices of the compositions in the order they were solved
+    int num_failed = 0; ///< The number of points that failed or were not attempted
+};
+
 }
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <limits>
+#include <optional>
+#include <vector>
+
 #include "teqp/derivs.hpp"
 #include "teqp/exceptions.hpp"
 #include "teqp/algorithms/VLLE_types.hpp"
@@ -13,23 +17,105 @@ namespace teqp {
 namespace VLLE {
     
     using namespace teqp::cppinterface;
-    /***
-    * \brief Do a vapor-liquid-liquid phase equilibrium problem for a mixture (binary only for now)
+
+    /**
+    * \brief The derivatives of one phase that are needed by the three-phase solvers and tracers
+    *
+    * They are evaluated once per phase and state and shared between the residuals and Jacobians of the polishers, the derivatives
+    * along the three-phase curve and the criticality conditions, rather than each of those making its own derivative passes
+    */
+    struct VLLEPhaseDerivatives {
+        double T, ///< Temperature, in K
+            R, ///< The gas constant for the composition of the phase
+            Psir, ///< \f$\Psi^r\f$
+            p, ///< Pressure, in Pa
+            dpdT = std::numeric_limits<double>::quiet_NaN(); ///< \f$(\partial p/\partial T)_{\vec\rho}\f$, only if the temperature derivatives were requested
+        Eigen::ArrayXd rhovec, ///< The molar concentrations
+            Psirgrad, ///< \f$\partial\Psi^r/\partial\rho_i\f$
+            dpdrhovec, ///< \f$(\partial p/\partial\rho_i)_T\f$
+            mu, ///< The concentration-dependent part of the chemical potential, \f$\partial\Psi^r/\partial\rho_i+RT\ln\rho_i\f$
+            dmudT; ///< \f$(\partial \mu_i/\partial T)_{\vec\rho}\f$ of mu, only if the temperature derivatives were requested
+        Eigen::MatrixXd PsiHessian; ///< The Hessian of \f$\Psi\f$ (residual and ideal-gas) w.r.t. the molar concentrations
+    };
+
+    /**
+    * \brief Evaluate the derivatives of one phase
     * \param model The model to operate on
     * \param T Temperature
-    * \param rhovecVinit Initial values for vapor mole concentrations
-    * \param rhovecL1init Initial values for liquid #1 mole concentrations
-    * \param rhovecL2init Initial values for liquid #2 mole concentrations
-    * \param atol Absolute tolerance on function values
-    * \param reltol Relative tolerance on function values
-    * \param axtol Absolute tolerance on steps in independent variables
-    * \param relxtol Relative tolerance on steps in independent variables
-    * \param maxiter Maximum number of iterations permitted
+    * \param rhovec The molar concentrations
+    * \param with_T If true, also evaluate the temperature derivatives, which are not needed by the polishers at constant temperature
     */
+    inline auto get_VLLE_phase_derivatives(const AbstractModel& model, double T, const EArrayd& rhovec, bool with_T = true) {
+        VLLEPhaseDerivatives d;
+        d.T = T;
+        d.rhovec = rhovec;
+        double rho = rhovec.sum();
+        Eigen::ArrayXd molefrac = rhovec/rho;
+        d.R = model.get_R(molefrac);
+        double RT = d.R*T;
+        
+        // Psir and its derivatives in one pass, also in temperature if needed
+        IsochoricDerivativeBundle b;
+        if (with_T){
+            b = model.build_Psir_derivative_bundle_autodiff(T, rhovec);
+        }
+        else{
+            std::tie(b.Psir, b.gradient, b.Hessian) = model.build_Psir_fgradHessian_autodiff(T, rhovec);
+        }
+        d.Psir = b.Psir;
+        d.Psirgrad = b.gradient;
+        d.p = rho*RT - b.Psir + (rhovec*b.gradient).sum(); // The (array*array).sum is a dot product
+        d.dpdrhovec = RT + (b.Hessian*rhovec.matrix()).array();
+        d.mu = b.gradient + RT*log(rhovec);
+        d.PsiHessian = b.Hessian;
+        d.PsiHessian.diagonal().array() += RT/rhovec;
+        
+        if (with_T){
+            d.dpdT = rho*d.R - b.dPsirdT + (rhovec*b.d2PsirdTdrhoi).sum();
+            // The constant R of the ideal-gas part is omitted, it cancels between phases
+            d.dmudT = b.d2PsirdTdrhoi + d.R*log(rhovec);
+        }
+        return d;
+    }
+
+    /**
+    * \brief The criticality conditions of a phase, reusing the Hessian of its derivatives
+    *
+    * The same as AbstractModel::get_criticality_conditions for a phase with all concentrations non-zero, but only the derivatives
+    * along the eigenvector need to be evaluated
+    */
+    inline EArray2 get_criticality_conditions(const AbstractModel& model, const VLLEPhaseDerivatives& d) {
+        if ((d.rhovec == 0).any()) {
+            return model.get_criticality_conditions(d.T, d.rhovec);
+        }
+        Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> es(d.PsiHessian);
+        Eigen::MatrixXd vectors = es.eigenvectors();
+        // Align as in the critical tracing
+        Eigen::Index ind;
+        d.rhovec.minCoeff(&ind);
+        if (vectors.col(ind).minCoeff() < 0) {
+            vectors *= -1.0;
+        }
+        Eigen::ArrayXd v0 = vectors.col(0);
+        auto psir_derivs = model.get_Psir_sigma_derivs(d.T, d.rhovec, v0);
+        double RT = d.R*d.T;
+        double psi02 = (RT*v0.pow(2)/d.rhovec).sum(), psi03 = (-RT*v0.pow(3)/d.rhovec.pow(2)).sum();
+        return (EArray2() << psir_derivs[2] + psi02, psir_derivs[3] + psi03).finished();
+    }
+
+    namespace detail {
     
-    inline auto mix_VLLE_T(const AbstractModel& model, double T, const EArrayd& rhovecVinit, const EArrayd& rhovecL1init, const EArrayd& rhovecL2init, double atol, double reltol, double axtol, double relxtol, int maxiter) {
+    /**
+    * \brief Newton iterations for the three-phase equilibrium at a given temperature, and at a given pressure if p_spec is provided
+    *
+    * A binary three-phase state is fixed by the temperature; a ternary one has one more degree of freedom, which is taken up by the pressure
+    */
+    inline auto mix_VLLE_T_impl(const AbstractModel& model, double T, const std::optional<double>& p_spec, const EArrayd& rhovecVinit, const EArrayd& rhovecL1init, const EArrayd& rhovecL2init, double atol, double reltol, double axtol, double relxtol, int maxiter) {
 
         const Eigen::Index N = rhovecVinit.size();
+        if (2*N + 2 + (p_spec ? 1 : 0) != 3*N) {
+            throw teqp::InvalidArgument("The three-phase equilibrium of a mixture of " + std::to_string(N) + " components is not fully specified by the temperature" + std::string(p_spec ? " and the pressure" : ""));
+        }
         Eigen::MatrixXd J(3 * N, 3 * N); J.setZero();
         Eigen::VectorXd r(3 * N), x(3 * N);
 
@@ -45,53 +131,42 @@ namespace VLLE {
 
         for (int iter = 0; iter < maxiter; ++iter) {
 
-            auto [PsirV, PsirgradV, hessianV] = model.build_Psir_fgradHessian_autodiff(T, rhovecV);
-            auto [PsirL1, PsirgradL1, hessianL1] = model.build_Psir_fgradHessian_autodiff(T, rhovecL1);
-            auto [PsirL2, PsirgradL2, hessianL2] = model.build_Psir_fgradHessian_autodiff(T, rhovecL2);
-            
-            auto HtotV = model.build_Psi_Hessian_autodiff(T, rhovecV);
-            auto HtotL1 = model.build_Psi_Hessian_autodiff(T, rhovecL1);
-            auto HtotL2 = model.build_Psi_Hessian_autodiff(T, rhovecL2);
-
-            auto zV = rhovecV/rhovecV.sum(), zL1 = rhovecL1 / rhovecL1.sum(), zL2 = rhovecL2 / rhovecL2.sum();
-            double RTL1 = model.get_R(zL1)*T, RTL2 = model.get_R(zL2)*T, RTV = model.get_R(zV)*T;
-
-            auto rhoL1 = rhovecL1.sum();
-            auto rhoL2 = rhovecL2.sum();
-            auto rhoV = rhovecV.sum();
-            double pL1 = rhoL1 * RTL1 - PsirL1 + (rhovecL1.array() * PsirgradL1.array()).sum(); // The (array*array).sum is a dot product
-            double pL2 = rhoL2 * RTL2 - PsirL2 + (rhovecL2.array() * PsirgradL2.array()).sum(); // The (array*array).sum is a dot product
-            double pV = rhoV * RTV - PsirV + (rhovecV.array() * PsirgradV.array()).sum();
-            auto dpdrhovecL1 = RTL1 + (hessianL1 * rhovecL1.matrix()).array();
-            auto dpdrhovecL2 = RTL2 + (hessianL2 * rhovecL2.matrix()).array();
-            auto dpdrhovecV = RTV + (hessianV * rhovecV.matrix()).array();
+            auto V = get_VLLE_phase_derivatives(model, T, rhovecV, false);
+            auto L1 = get_VLLE_phase_derivatives(model, T, rhovecL1, false);
+            auto L2 = get_VLLE_phase_derivatives(model, T, rhovecL2, false);
 
             // 2N rows are equality of chemical equilibria
-            r.head(N) = PsirgradV + RTV*log(rhovecV) - (PsirgradL1 + RTL1*log(rhovecL1));
-            r.segment(N,N) = PsirgradL1 + RTL1 * log(rhovecL1) - (PsirgradL2 + RTL2 * log(rhovecL2));
-            // Followed by N pressure equilibria
-            r(2*N) = pV - pL1;
-            r(2*N+1) = pL1 - pL2;
+            r.head(N) = V.mu - L1.mu;
+            r.segment(N,N) = L1.mu - L2.mu;
+            // Followed by 2 pressure equilibria
+            r(2*N) = V.p - L1.p;
+            r(2*N+1) = L1.p - L2.p;
 
             // Chemical potential contributions in Jacobian
-            J.block(0,0,N,N) = HtotV;
-            J.block(0,N,N,N) = -HtotL1;
+            J.block(0,0,N,N) = V.PsiHessian;
+            J.block(0,N,N,N) = -L1.PsiHessian;
             //J.block(0,2*N,N,N) = 0;  (following the pattern, to make clear the structure)
             //J.block(N,0,N,N) = 0;   (following the pattern, to make clear the structure)
-            J.block(N, N, N, N) = HtotL1;
-            J.block(N, 2 * N, N, N) = -HtotL2;
+            J.block(N, N, N, N) = L1.PsiHessian;
+            J.block(N, 2 * N, N, N) = -L2.PsiHessian;
             // Pressure contributions in Jacobian
-            J.block(2 * N, 0, 1, N) = dpdrhovecV.transpose();
-            J.block(2 * N, N, 1, N) = -dpdrhovecL1.transpose();
-            J.block(2 * N + 1, N, 1, N) = dpdrhovecL1.transpose();
-            J.block(2 * N + 1, 2 * N, 1, N) = -dpdrhovecL2.transpose();
+            J.block(2 * N, 0, 1, N) = V.dpdrhovec.matrix().transpose();
+            J.block(2 * N, N, 1, N) = -L1.dpdrhovec.matrix().transpose();
+            J.block(2 * N + 1, N, 1, N) = L1.dpdrhovec.matrix().transpose();
+            J.block(2 * N + 1, 2 * N, 1, N) = -L2.dpdrhovec.matrix().transpose();
+            
+            // And the pressure must equal the specified one, if given
+            if (p_spec) {
+                r(2*N+2) = V.p - p_spec.value();
+                J.block(2 * N + 2, 0, 1, N) = V.dpdrhovec.matrix().transpose();
+            }
 
             // Solve for the step
             Eigen::ArrayXd dx = J.colPivHouseholderQr().solve(-r);
             x.array() += dx;
 
             auto xtol_threshold = (axtol + relxtol * x.array().cwiseAbs()).eval();
-            if ((dx.array() < xtol_threshold).all()) {
+            if ((dx.array().cwiseAbs() < xtol_threshold).all()) {
                 return_code = VLLE_return_code::xtol_satisfied;
                 break;
             }
@@ -116,11 +191,49 @@ namespace VLLE {
         Eigen::ArrayXd rhovecVfinal = rhovecV, rhovecL1final = rhovecL1, rhovecL2final = rhovecL2;
         return std::make_tuple(return_code, rhovecVfinal, rhovecL1final, rhovecL2final);
     }
+    
+    }
+
+    /***
+    * \brief Do a vapor-liquid-liquid phase equilibrium problem for a binary mixture at given temperature
+    * \param model The model to operate on
+    * \param T Temperature
+    * \param rhovecVinit Initial values for vapor mole concentrations
+    * \param rhovecL1init Initial values for liquid #1 mole concentrations
+    * \param rhovecL2init Initial values for liquid #2 mole concentrations
+    * \param atol Absolute tolerance on function values
+    * \param reltol Relative tolerance on function values
+    * \param axtol Absolute tolerance on steps in independent variables
+    * \param relxtol Relative tolerance on steps in independent variables
+    * \param maxiter Maximum number of iterations permitted
+    */
+    inline auto mix_VLLE_T(const AbstractModel& model, double T, const EArrayd& rhovecVinit, const EArrayd& rhovecL1init, const EArrayd& rhovecL2init, double atol, double reltol, double axtol, double relxtol, int maxiter) {
+        return detail::mix_VLLE_T_impl(model, T, std::nullopt, rhovecVinit, rhovecL1init, rhovecL2init, atol, reltol, axtol, relxtol, maxiter);
+    }
 
     /***
-    * \brief Do a vapor-liquid-liquid phase equilibrium problem for a mixture (binary only for now)
+    * \brief Do a vapor-liquid-liquid phase equilibrium problem for a ternary mixture at given temperature and pressure
     * \param model The model to operate on
     * \param T Temperature
+    * \param p Pressure
+    * \param rhovecVinit Initial values for vapor mole concentrations
+    * \param rhovecL1init Initial values for liquid #1 mole concentrations
+    * \param rhovecL2init Initial values for liquid #2 mole concentrations
+    * \param atol Absolute tolerance on function values
+    * \param reltol Relative tolerance on function values
+    * \param axtol Absolute tolerance on steps in independent variables
+    * \param relxtol Relative tolerance on steps in independent variables
+    * \param maxiter Maximum number of iterations permitted
+    */
+    inline auto mix_VLLE_Tp(const AbstractModel& model, double T, double p, const EArrayd& rhovecVinit, const EArrayd& rhovecL1init, const EArrayd& rhovecL2init, double atol, double reltol, double axtol, double relxtol, int maxiter) {
+        return detail::mix_VLLE_T_impl(model, T, p, rhovecVinit, rhovecL1init, rhovecL2init, atol, reltol, axtol, relxtol, maxiter);
+    }
+
+    /***
+    * \brief Do a vapor-liquid-liquid phase equilibrium problem for a binary mixture at given pressure
+    * \param model The model to operate on
+    * \param p Pressure
+    * \param Tinit Initial value for temperature
     * \param rhovecVinit Initial values for vapor mole concentrations
     * \param rhovecL1init Initial values for liquid #1 mole concentrations
     * \param rhovecL2init Initial values for liquid #2 mole concentrations
@@ -134,6 +247,9 @@ namespace VLLE {
     inline auto mix_VLLE_p(const AbstractModel& model, double p, double Tinit, const EArrayd& rhovecVinit, const EArrayd& rhovecL1init, const EArrayd& rhovecL2init, double atol, double reltol, double axtol, double relxtol, int maxiter) {
 
         const Eigen::Index N = rhovecVinit.size();
+        if (N != 2) {
+            throw teqp::InvalidArgument("mix_VLLE_p is only for binary mixtures");
+        }
         Eigen::MatrixXd J(3*N+1, 3*N+1); J.setZero();
         Eigen::VectorXd r(3*N+1), x(3*N+1);
 
@@ -152,67 +268,41 @@ namespace VLLE {
         for (int iter = 0; iter < maxiter; ++iter) {
             T = x(x.size()-1);
 
-            auto [PsirV, PsirgradV, hessianV] = model.build_Psir_fgradHessian_autodiff(T, rhovecV);
-            auto [PsirL1, PsirgradL1, hessianL1] = model.build_Psir_fgradHessian_autodiff(T, rhovecL1);
-            auto [PsirL2, PsirgradL2, hessianL2] = model.build_Psir_fgradHessian_autodiff(T, rhovecL2);
-            
-            auto HtotV = model.build_Psi_Hessian_autodiff(T, rhovecV);
-            auto HtotL1 = model.build_Psi_Hessian_autodiff(T, rhovecL1);
-            auto HtotL2 = model.build_Psi_Hessian_autodiff(T, rhovecL2);
-
-            auto zV = rhovecV/rhovecV.sum(), zL1 = rhovecL1 / rhovecL1.sum(), zL2 = rhovecL2 / rhovecL2.sum();
-            double RL1 = model.get_R(zL1), RL2 = model.get_R(zL2), RV = model.get_R(zV);
-            double RTL1 = RL1*T, RTL2 = RL2*T, RTV = RV*T;
-
-            auto rhoL1 = rhovecL1.sum();
-            auto rhoL2 = rhovecL2.sum();
-            auto rhoV = rhovecV.sum();
-            double pL1 = rhoL1 * RTL1 - PsirL1 + (rhovecL1.array() * PsirgradL1.array()).sum(); // The (array*array).sum is a dot product
-            double pL2 = rhoL2 * RTL2 - PsirL2 + (rhovecL2.array() * PsirgradL2.array()).sum(); // The (array*array).sum is a dot product
-            double pV = rhoV * RTV - PsirV + (rhovecV.array() * PsirgradV.array()).sum();
-            auto dpdrhovecL1 = RTL1 + (hessianL1 * rhovecL1.matrix()).array();
-            auto dpdrhovecL2 = RTL2 + (hessianL2 * rhovecL2.matrix()).array();
-            auto dpdrhovecV = RTV + (hessianV * rhovecV.matrix()).array();
-            
-            auto DELTAVL1dmu_dT_res = (model.build_d2PsirdTdrhoi_autodiff(T, rhovecV.eval())
-                                  - model.build_d2PsirdTdrhoi_autodiff(T, rhovecL1.eval())).eval();
-            auto DELTAL1L2dmu_dT_res = (model.build_d2PsirdTdrhoi_autodiff(T, rhovecL1.eval())
-                                  - model.build_d2PsirdTdrhoi_autodiff(T, rhovecL2.eval())).eval();
-            auto DELTAVL1_dchempot_dT = (DELTAVL1dmu_dT_res + RV*log(rhovecV) - RL1*log(rhovecL1)).eval();
-            auto DELTAL1L2_dchempot_dT = (DELTAL1L2dmu_dT_res + RL1*log(rhovecL1) - RL2*log(rhovecL2)).eval();
+            auto V = get_VLLE_phase_derivatives(model, T, rhovecV);
+            auto L1 = get_VLLE_phase_derivatives(model, T, rhovecL1);
+            auto L2 = get_VLLE_phase_derivatives(model, T, rhovecL2);
 
             // 2N rows are equality of chemical equilibria
-            r.head(N) = PsirgradV + RTV*log(rhovecV) - (PsirgradL1 + RTL1*log(rhovecL1));
-            r.segment(N,N) = PsirgradL1 + RTL1 * log(rhovecL1) - (PsirgradL2 + RTL2 * log(rhovecL2));
+            r.head(N) = V.mu - L1.mu;
+            r.segment(N,N) = L1.mu - L2.mu;
             // Followed by 2 pressure equilibria for the phases
-            r(2*N) = pV - pL1;
-            r(2*N+1) = pL1 - pL2;
+            r(2*N) = V.p - L1.p;
+            r(2*N+1) = L1.p - L2.p;
             // And finally, the pressure must equal the specified one
-            r(2*N+2) = pV - p;
-            
+            r(2*N+2) = V.p - p;
 
             // Chemical potential contributions in Jacobian
-            J.block(0,0,N,N) = HtotV;
-            J.block(0,N,N,N) = -HtotL1;
+            J.block(0,0,N,N) = V.PsiHessian;
+            J.block(0,N,N,N) = -L1.PsiHessian;
             //J.block(0,2*N,N,N) = 0;  // For L2, following the pattern, to make clear the structure
-            J.block(0,2*N+2, N, 1) = DELTAVL1_dchempot_dT;
+            J.block(0,2*N+2, N, 1) = (V.dmudT - L1.dmudT).matrix();
             
             //J.block(N,0,N,N) = 0;   // For V, following the pattern, to make clear the structure)
-            J.block(N,N, N, N) = HtotL1;
-            J.block(N,2* N, N, N) = -HtotL2;
-            J.block(N,2*N+2, N, 1) = DELTAL1L2_dchempot_dT;
+            J.block(N,N, N, N) = L1.PsiHessian;
+            J.block(N,2* N, N, N) = -L2.PsiHessian;
+            J.block(N,2*N+2, N, 1) = (L1.dmudT - L2.dmudT).matrix();
             // So far, 2*N constraints...
             
             // Pressure contributions in Jacobian
-            J.block(2*N, 0, 1, N) = dpdrhovecV.transpose();
-            J.block(2*N, N, 1, N) = -dpdrhovecL1.transpose();
-            J(2*N, 2*N+2) = model.get_dpdT_constrhovec(T, rhovecV) - model.get_dpdT_constrhovec(T, rhovecL1);
-            J.block(2 * N + 1, N, 1, N) = dpdrhovecL1.transpose();
-            J.block(2 * N + 1, 2 * N, 1, N) = -dpdrhovecL2.transpose();
-            J(2*N+1, 2*N+2) = model.get_dpdT_constrhovec(T, rhovecL1) - model.get_dpdT_constrhovec(T, rhovecL2);
+            J.block(2*N, 0, 1, N) = V.dpdrhovec.matrix().transpose();
+            J.block(2*N, N, 1, N) = -L1.dpdrhovec.matrix().transpose();
+            J(2*N, 2*N+2) = V.dpdT - L1.dpdT;
+            J.block(2 * N + 1, N, 1, N) = L1.dpdrhovec.matrix().transpose();
+            J.block(2 * N + 1, 2 * N, 1, N) = -L2.dpdrhovec.matrix().transpose();
+            J(2*N+1, 2*N+2) = L1.dpdT - L2.dpdT;
             
-            J.block(2*N+2, 0, 1, N) = dpdrhovecV.transpose();
-            J(2*N+2, 2*N+2) = model.get_dpdT_constrhovec(T, rhovecV);
+            J.block(2*N+2, 0, 1, N) = V.dpdrhovec.matrix().transpose();
+            J(2*N+2, 2*N+2) = V.dpdT;
             // Takes us to 2*N + 3 constraints, or 3*N+1 for N=2
 
             // Solve for the step
@@ -221,7 +311,7 @@ namespace VLLE {
             T = x(x.size()-1);
 
             auto xtol_threshold = (axtol + relxtol * x.array().cwiseAbs()).eval();
-            if ((dx.array() < xtol_threshold).all()) {
+            if ((dx.array().cwiseAbs() < xtol_threshold).all()) {
                 return_code = VLLE_return_code::xtol_satisfied;
                 break;
             }
@@ -336,7 +426,7 @@ namespace VLLE {
                     double T = trace[0].at("T / K"); // All at same temperature
                     
                     // Polish the solution
-                    auto [code, rhoVfinal, rhoL1final, rhoL2final] = mix_VLLE_T(model, T, rhoV, rhoL1, rhoL2, 1e-10, 1e-10, 1e-10, 1e-10, opt.max_steps);
+                    auto [code, rhoVfinal, rhoL1final, rhoL2final] = mix_VLLE_T(model, T, rhoV, rhoL1, rhoL2, opt.atol, opt.reltol, opt.axtol, opt.relxtol, opt.max_steps);
                     
                     return nlohmann::json{
                         {"variables", "rhoV, rhoL1, rhoL2"},
@@ -349,7 +439,7 @@ namespace VLLE {
                     double p = trace[0].at("pL / Pa"); // all at same pressure
                     
                     // Polish the solution
-                    auto [code, Tfinal, rhoVfinal, rhoL1final, rhoL2final] = mix_VLLE_p(model, p, i.y, rhoV, rhoL1, rhoL2, 1e-10, 1e-10, 1e-10, 1e-10, opt.max_steps);
+                    auto [code, Tfinal, rhoVfinal, rhoL1final, rhoL2final] = mix_VLLE_p(model, p, i.y, rhoV, rhoL1, rhoL2, opt.atol, opt.reltol, opt.axtol, opt.relxtol, opt.max_steps);
                     
                     return nlohmann::json{
                         {"variables", "rhoV, rhoL1, rhoL2, T"},
@@ -409,7 +499,7 @@ namespace VLLE {
                     double T = traces[0][0].at(xkey);
                     
                     // Polish the solution
-                    auto [code, rhoVfinal, rhoL1final, rhoL2final] = mix_VLLE_T(model, T, rhoV, rhoL1, rhoL2, 1e-10, 1e-10, 1e-10, 1e-10, opt.max_steps);
+                    auto [code, rhoVfinal, rhoL1final, rhoL2final] = mix_VLLE_T(model, T, rhoV, rhoL1, rhoL2, opt.atol, opt.reltol, opt.axtol, opt.relxtol, opt.max_steps);
                     
                     return nlohmann::json{
                         {"variables", "rhoV, rhoL1, rhoL2"},
@@ -422,7 +512,7 @@ namespace VLLE {
                     double p = traces[0][0].at(xkey);
                     
                     // Polish the solution
-                    auto [code, Tfinal, rhoVfinal, rhoL1final, rhoL2final] = mix_VLLE_p(model, p, i.y, rhoV, rhoL1, rhoL2, 1e-10, 1e-10, 1e-10, 1e-10, opt.max_steps);
+                    auto [code, Tfinal, rhoVfinal, rhoL1final, rhoL2final] = mix_VLLE_p(model, p, i.y, rhoV, rhoL1, rhoL2, opt.atol, opt.reltol, opt.axtol, opt.relxtol, opt.max_steps);
                     
                     return nlohmann::json{
                         {"variables", "rhoV, rhoL1, rhoL2, T"},
@@ -478,47 +568,84 @@ namespace VLLE {
         return find_VLLE_gen_binary(model, traces, "P", options);
     }
 
-    inline auto get_drhovecdT_VLLE_binary(const AbstractModel& model, double T, const EArrayd &rhovecV, const EArrayd& rhovecL1, const EArrayd& rhovecL2){
-        
-        auto dot = [](const EArrayd&a, const EArrayd &b){ return a.cwiseProduct(b).sum(); };
+    /**
+    * \brief The derivatives of the molar concentrations of the three phases along the three-phase curve with respect to temperature
+    * \param V The derivatives of the vapor phase, with the temperature derivatives
+    * \param L1 The derivatives of liquid phase #1, with the temperature derivatives
+    * \param L2 The derivatives of liquid phase #2, with the temperature derivatives
+    *
+    * The equalities of the chemical potentials and pressures of the phases are differentiated with respect to temperature, giving
+    * 2N+2 linear equations for the 3N derivatives. That is enough for a binary mixture; for a ternary mixture the three-phase
+    * state has one more degree of freedom, and the derivatives are taken at constant pressure.
+    */
+    inline auto get_drhovecdT_VLLE(const VLLEPhaseDerivatives& V, const VLLEPhaseDerivatives& L1, const VLLEPhaseDerivatives& L2){
         
-        Eigen::MatrixXd LHS(2, 2);
-        Eigen::MatrixXd RHS(2, 1);
-        Eigen::MatrixXd PSIV = model.build_Psi_Hessian_autodiff(T, rhovecV);
-        Eigen::MatrixXd PSIL1 = model.build_Psi_Hessian_autodiff(T, rhovecL1);
-        Eigen::MatrixXd PSIL2 = model.build_Psi_Hessian_autodiff(T, rhovecL2);
-        double dpdTV = model.get_dpdT_constrhovec(T, rhovecV);
-        double dpdTL1 = model.get_dpdT_constrhovec(T, rhovecL1);
-        double dpdTL2 = model.get_dpdT_constrhovec(T, rhovecL2);
+        const Eigen::Index N = V.rhovec.size();
+        if (N != 2 && N != 3) {
+            throw teqp::InvalidArgument("The three-phase curve can only be traced in temperature for binary mixtures, or ternary mixtures at constant pressure");
+        }
+        Eigen::MatrixXd LHS(3*N, 3*N); LHS.setZero();
+        Eigen::VectorXd RHS(3*N);
         
-        // here mu is not the entire chemical potential, rather it is just the residual part and
+        // Chemical potentials, where mu is not the entire chemical potential, rather it is just the residual part and
         // the density-dependent part from the ideal-gas
-        double RV = model.R(rhovecV/rhovecV.sum());
-        double RL1 = model.R(rhovecL1/rhovecL1.sum());
-        double RL2 = model.R(rhovecL2/rhovecL2.sum());
-        EArrayd dmudTV = model.build_d2PsirdTdrhoi_autodiff(T, rhovecV) + RV*log(rhovecV);
-        EArrayd dmudTL1 = model.build_d2PsirdTdrhoi_autodiff(T, rhovecL1) + RL1*log(rhovecL1);
-        EArrayd dmudTL2 = model.build_d2PsirdTdrhoi_autodiff(T, rhovecL2) + RL2*log(rhovecL2);
-        
-        LHS.row(0) = PSIV*(rhovecL1-rhovecV).matrix();
-        LHS.row(1) = PSIV*(rhovecL2-rhovecV).matrix();
-        RHS(0) = dot(dmudTL1-dmudTV, rhovecL1) - (dpdTL1-dpdTV);
-        RHS(1) = dot(dmudTL2-dmudTV, rhovecL2) - (dpdTL2-dpdTV);
+        LHS.block(0, 0, N, N) = V.PsiHessian;
+        LHS.block(0, N, N, N) = -L1.PsiHessian;
+        RHS.head(N) = -(V.dmudT - L1.dmudT).matrix();
+        LHS.block(N, N, N, N) = L1.PsiHessian;
+        LHS.block(N, 2*N, N, N) = -L2.PsiHessian;
+        RHS.segment(N, N) = -(L1.dmudT - L2.dmudT).matrix();
         
-        Eigen::ArrayXd drhovecVdT = LHS.colPivHouseholderQr().solve(RHS);
-        Eigen::VectorXd AV = PSIV*drhovecVdT.matrix();
-        Eigen::ArrayXd drhovecL1dT = PSIL1.colPivHouseholderQr().solve((AV.array() - (dmudTL1-dmudTV)).matrix());
-        Eigen::ArrayXd drhovecL2dT = PSIL2.colPivHouseholderQr().solve((AV.array() - (dmudTL2-dmudTV)).matrix());
+        // Pressures
+        LHS.block(2*N, 0, 1, N) = V.dpdrhovec.matrix().transpose();
+        LHS.block(2*N, N, 1, N) = -L1.dpdrhovec.matrix().transpose();
+        RHS(2*N) = -(V.dpdT - L1.dpdT);
+        LHS.block(2*N+1, N, 1, N) = L1.dpdrhovec.matrix().transpose();
+        LHS.block(2*N+1, 2*N, 1, N) = -L2.dpdrhovec.matrix().transpose();
+        RHS(2*N+1) = -(L1.dpdT - L2.dpdT);
+        if (N == 3) {
+            // Constant pressure
+            LHS.block(2*N+2, 0, 1, N) = V.dpdrhovec.matrix().transpose();
+            RHS(2*N+2) = -V.dpdT;
+        }
         
+        Eigen::ArrayXd drhovecdT = LHS.colPivHouseholderQr().solve(RHS);
+        Eigen::ArrayXd drhovecVdT = drhovecdT.head(N), drhovecL1dT = drhovecdT.segment(N, N), drhovecL2dT = drhovecdT.tail(N);
         return std::make_tuple(drhovecVdT, drhovecL1dT, drhovecL2dT);
+    }
+
+    inline auto get_drhovecdT_VLLE_binary(const AbstractModel& model, double T, const EArrayd &rhovecV, const EArrayd& rhovecL1, const EArrayd& rhovecL2){
+        if (rhovecV.size() != 2) {
+            throw teqp::InvalidArgument("get_drhovecdT_VLLE_binary is only for binary mixtures");
+        }
+        return get_drhovecdT_VLLE(get_VLLE_phase_derivatives(model, T, rhovecV), get_VLLE_phase_derivatives(model, T, rhovecL1), get_VLLE_phase_derivatives(model, T, rhovecL2));
     };
 
     /**
     \brief Given an initial VLLE solution, trace the VLLE curve. We know the VLLE curve is a function of only one state variable by Gibbs' rule
+     
+    For a binary mixture the curve is traced in temperature. A ternary mixture has one more degree of freedom, so the curve is traced in
+    temperature at the pressure of the initial state, and the polishing is done at that pressure.
+     
+    The derivatives of each phase are evaluated once per state and reused: the last evaluation of the derivatives along the curve
+    after an accepted step provides the criticality conditions and the pressure, and the first evaluation of the following step.
      */
-    inline auto trace_VLLE_binary(const teqp::VLLE::AbstractModel& model, const double Tinit, const EArrayd& rhovecVinit, const EArrayd& rhovecL1init, const EArrayd& rhovecL2init, const std::optional<VLLETracerOptions>& options_ = std::nullopt){
+    inline auto trace_VLLE(const teqp::VLLE::AbstractModel& model, const double Tinit, const EArrayd& rhovecVinit, const EArrayd& rhovecL1init, const EArrayd& rhovecL2init, const std::optional<VLLETracerOptions>& options_ = std::nullopt){
         auto options = options_.value_or(VLLETracerOptions());
         
+        const Eigen::Index N = rhovecVinit.size();
+        if (rhovecL1init.size() != N || rhovecL2init.size() != N) {
+            throw teqp::InvalidArgument("The molar concentrations of the phases must have the same length");
+        }
+        if (N != 2 && N != 3) {
+            throw teqp::InvalidArgument("The three-phase curve can only be traced for binary mixtures, or ternary mixtures at constant pressure");
+        }
+        // The pressure is held fixed for ternary mixtures
+        std::optional<double> p_spec;
+        if (N == 3) {
+            p_spec = get_VLLE_phase_derivatives(model, Tinit, rhovecVinit, false).p;
+        }
+        
         // Typedefs for the types for odeint for simple Euler and RK45 integrators
         using state_type = std::vector<double>;
         using namespace boost::numeric::odeint;
@@ -526,17 +653,32 @@ namespace VLLE {
         typedef runge_kutta_cash_karp54< state_type > error_stepper_type;
         typedef controlled_runge_kutta< error_stepper_type > controlled_stepper_type;
         
+        // The derivatives of the phases at the last state they were evaluated at
+        struct {
+            double T = std::numeric_limits<double>::quiet_NaN();
+            state_type x;
+            std::vector<VLLEPhaseDerivatives> phases;
+        } cache;
+        auto get_phases = [&](const state_type& x, const double T) -> const std::vector<VLLEPhaseDerivatives>& {
+            if (!(T == cache.T && x == cache.x)) {
+                cache.T = std::numeric_limits<double>::quiet_NaN(); // Invalid until all the phases have been evaluated
+                cache.phases.clear();
+                for (auto k = 0; k < 3; ++k) {
+                    cache.phases.push_back(get_VLLE_phase_derivatives(model, T, Eigen::Map<const Eigen::ArrayXd>(&(x[0]) + k*N, N)));
+                }
+                cache.x = x;
+                cache.T = T;
+            }
+            return cache.phases;
+        };
+        
         auto xprime = [&](const state_type& x, state_type& dxdt, const double T)
         {
-            // Unpack the inputs
-            const auto rhovecV_ = Eigen::Map<const Eigen::ArrayXd>(&(x[0]), 2),
-                       rhovecL1_ = Eigen::Map<const Eigen::ArrayXd>(&(x[0]) + 2, 2),
-                       rhovecL2_ = Eigen::Map<const Eigen::ArrayXd>(&(x[0]) + 4, 2);
-            
-            auto [drhovecVdT, drhovecL1dT, drhovecL2dT] = VLLE::get_drhovecdT_VLLE_binary(model, T, rhovecV_, rhovecL1_, rhovecL2_);
-            Eigen::Map<Eigen::ArrayXd>(&(dxdt[0]), 2) = drhovecVdT;
-            Eigen::Map<Eigen::ArrayXd>(&(dxdt[0]) + 2, 2) = drhovecL1dT;
-            Eigen::Map<Eigen::ArrayXd>(&(dxdt[0]) + 4, 2) = drhovecL2dT;
+            const auto& phases = get_phases(x, T);
+            auto [drhovecVdT, drhovecL1dT, drhovecL2dT] = VLLE::get_drhovecdT_VLLE(phases[0], phases[1], phases[2]);
+            Eigen::Map<Eigen::ArrayXd>(&(dxdt[0]), N) = drhovecVdT;
+            Eigen::Map<Eigen::ArrayXd>(&(dxdt[0]) + N, N) = drhovecL1dT;
+            Eigen::Map<Eigen::ArrayXd>(&(dxdt[0]) + 2*N, N) = drhovecL2dT;
         };
         
         // Define the tolerances
@@ -545,10 +687,10 @@ namespace VLLE {
         
         // Copy variables into the stepping array
         double T = Tinit, dT = options.init_dT;
-        state_type x0(3*2);
-        Eigen::Map<Eigen::ArrayXd>(&(x0[0]), 2) = rhovecVinit;
-        Eigen::Map<Eigen::ArrayXd>(&(x0[0]) + 2, 2) = rhovecL1init;
-        Eigen::Map<Eigen::ArrayXd>(&(x0[0]) + 4, 2) = rhovecL2init;
+        state_type x0(3*N);
+        Eigen::Map<Eigen::ArrayXd>(&(x0[0]), N) = rhovecVinit;
+        Eigen::Map<Eigen::ArrayXd>(&(x0[0]) + N, N) = rhovecL1init;
+        Eigen::Map<Eigen::ArrayXd>(&(x0[0]) + 2*N, N) = rhovecL2init;
         
         nlohmann::json data_collector = nlohmann::json::array();
         for (auto iter = 0; iter < options.max_step_count; ++iter) {
@@ -577,24 +719,33 @@ namespace VLLE {
             // Reduce step size if greater than the specified max step size
             dT = std::min(dT, options.max_dT);
             
-            const auto rhovecV = Eigen::Map<const Eigen::ArrayXd>(&(x0[0]), 2),
-                       rhovecL1 = Eigen::Map<const Eigen::ArrayXd>(&(x0[0]) + 2, 2),
-                       rhovecL2 = Eigen::Map<const Eigen::ArrayXd>(&(x0[0]) + 4, 2);
+            const auto rhovecV = Eigen::Map<const Eigen::ArrayXd>(&(x0[0]), N),
+                       rhovecL1 = Eigen::Map<const Eigen::ArrayXd>(&(x0[0]) + N, N),
+                       rhovecL2 = Eigen::Map<const Eigen::ArrayXd>(&(x0[0]) + 2*N, N);
             
             // Polish if requested
             if (options.polish){
-                auto [code, rhovecVnew, rhovecL1new, rhovecL2new] = teqp::VLLE::mix_VLLE_T(model, T, rhovecV, rhovecL1, rhovecL2, 1e-10, 1e-10, 1e-10, 1e-10, options.max_polish_steps);
-                Eigen::Map<Eigen::ArrayXd>(&(x0[0]), 2) = rhovecVnew;
-                Eigen::Map<Eigen::ArrayXd>(&(x0[0]) + 2, 2) = rhovecL1new;
-                Eigen::Map<Eigen::ArrayXd>(&(x0[0]) + 4, 2) = rhovecL2new;
+                auto [code, rhovecVnew, rhovecL1new, rhovecL2new] = teqp::VLLE::detail::mix_VLLE_T_impl(model, T, p_spec, rhovecV, rhovecL1, rhovecL2, options.polish_atol, options.polish_reltol, options.polish_axtol, options.polish_relxtol, options.max_polish_steps);
+                Eigen::Map<Eigen::ArrayXd>(&(x0[0]), N) = rhovecVnew;
+                Eigen::Map<Eigen::ArrayXd>(&(x0[0]) + N, N) = rhovecL1new;
+                Eigen::Map<Eigen::ArrayXd>(&(x0[0]) + 2*N, N) = rhovecL2new;
             }
             
-            auto critV = model.get_criticality_conditions(T, rhovecV);
-            auto critL1 = model.get_criticality_conditions(T, rhovecL1);
-            auto critL2 = model.get_criticality_conditions(T, rhovecL2);
-            double rhomolarV = rhovecV.sum();
-            auto molefracV = rhovecV/rhomolarV;
-            auto pV = rhomolarV*model.get_R(molefracV)*T*(1.0 + model.get_Ar01(T, rhomolarV, molefracV));
+            EArray2 critV, critL1, critL2;
+            double pV = std::numeric_limits<double>::quiet_NaN();
+            try {
+                const auto& phases = get_phases(x0, T);
+                critV = get_criticality_conditions(model, phases[0]);
+                critL1 = get_criticality_conditions(model, phases[1]);
+                critL2 = get_criticality_conditions(model, phases[2]);
+                pV = phases[0].p;
+            }
+            catch (const std::exception &e) {
+                if (options.verbosity > 0) {
+                    std::cout << e.what() << std::endl;
+                }
+                break;
+            }
             if (!std::isfinite(pV)){
                 if (options.verbosity > 0) {
                     std::cout << "Calculated pressure is not finite" << std::endl;
@@ -620,9 +771,10 @@ namespace VLLE {
             }
             
             if (options.terminate_composition){
-                auto c0 = (Eigen::ArrayXd(3) << rhovecL1[0]/rhovecL1.sum(), rhovecL2[0]/rhovecL2.sum(), rhovecV[0]/rhovecV.sum()).finished();
-                auto diffs = (Eigen::ArrayXd(3) << c0[0]-c0[1], c0[0]-c0[2], c0[1]-c0[2]).finished();
-                if ((diffs.cwiseAbs() < options.terminate_composition_tol).any()){
+                // Stop when the compositions of two of the phases have become the same
+                Eigen::ArrayXd xL1 = rhovecL1/rhovecL1.sum(), xL2 = rhovecL2/rhovecL2.sum(), xV = rhovecV/rhovecV.sum();
+                auto diffs = (Eigen::ArrayXd(3) << (xL1-xL2).cwiseAbs().maxCoeff(), (xL1-xV).cwiseAbs().maxCoeff(), (xL2-xV).cwiseAbs().maxCoeff()).finished();
+                if ((diffs < options.terminate_composition_tol).any()){
                     break;
                 }
             }
@@ -648,5 +800,15 @@ namespace VLLE {
         return data_collector;
     }
 
+    /**
+    \brief Given an initial VLLE solution of a binary mixture, trace the VLLE curve; see trace_VLLE
+     */
+    inline auto trace_VLLE_binary(const teqp::VLLE::AbstractModel& model, const double Tinit, const EArrayd& rhovecVinit, const EArrayd& rhovecL1init, const EArrayd& rhovecL2init, const std::optional<VLLETracerOptions>& options_ = std::nullopt){
+        if (rhovecVinit.size() != 2) {
+            throw teqp::InvalidArgument("trace_VLLE_binary is only for binary mixtures; use trace_VLLE");
+        }
+        return trace_VLLE(model, Tinit, rhovecVinit, rhovecL1init, rhovecL2init, options_);
+    }
+
 }
 }
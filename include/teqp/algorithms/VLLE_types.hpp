@@ -18,6 +18,10 @@ struct SelfIntersectionSolution {
 struct VLLEFinderOptions {
     int max_steps = 20; ///< The maximum number of steps allowed in polisher
     double rho_trivial_threshold = 1e-16; ///< The relative difference between densities of liquid solutions that indicates a non-trivial solution has been found
+    double atol = 1e-10; ///< Absolute tolerance on function values in polisher
+    double reltol = 1e-10; ///< Relative tolerance on function values in polisher
+    double axtol = 1e-10; ///< Absolute tolerance on steps in independent variables in polisher
+    double relxtol = 1e-10; ///< Relative tolerance on steps in independent variables in polisher
 };
 
 struct VLLETracerOptions{
@@ -29,6 +33,10 @@ struct VLLETracerOptions{
     double max_dT = 10;
     bool polish = true;
     int max_polish_steps = 10;
+    double polish_atol = 1e-10; ///< Absolute tolerance on function values in polisher
+    double polish_reltol = 1e-10; ///< Relative tolerance on function values in polisher
+    double polish_axtol = 1e-10; ///< Absolute tolerance on steps in independent variables in polisher
+    double polish_relxtol = 1e-10; ///< Relative tolerance on steps in independent variables in polisher
     bool terminate_composition = true;
     double terminate_composition_tol = 1e-4;
     double T_limit = 100000;
@@ -4,6 +4,7 @@
 
 #include "teqp/cpp/teqpcpp.hpp"
 #include "teqp/models/multifluid_ancillaries.hpp"
+#include "teqp/algorithms/cancellation.hpp"
 
 namespace teqp{
 namespace ancillaries{
@@ -11,7 +12,13 @@ namespace ancillaries{
 using namespace teqp;
 using namespace teqp::cppinterface;
 
-auto build_ancillaries(const AbstractModel& model, double Tcritguess, double rhocritguess, double Tmin, std::optional<nlohmann::json> flags_ = std::nullopt)
+/**
+ Build the ancillary equations for the saturated densities and vapor pressure of a pure fluid by marching down from the critical point to Tmin
+
+ If the cancellation token is cancelled or the deadline expires during the march, the ancillaries are fit to the points obtained so far,
+ their minimum temperature is that of the last point, and their description gives the reason for the termination
+ */
+auto build_ancillaries(const AbstractModel& model, double Tcritguess, double rhocritguess, double Tmin, std::optional<nlohmann::json> flags_ = std::nullopt, const std::optional<CancellationToken>& cancellation = std::nullopt, const std::optional<Deadline>& deadline = std::nullopt)
 {
     nlohmann::json flags = flags_.value_or(nlohmann::json::object());
     
@@ -44,7 +51,12 @@ auto build_ancillaries(const AbstractModel& model, double Tcritguess, double rho
     };
     
     std::vector<double> Thetas_, rhoLs_, rhoVs_, pLs_;
+    std::string description = "I'm a description";
     for (int i = 0; i < Npts; ++i){
+        if (auto reason = check_interruption(cancellation, deadline); reason != diagnostics::TerminationReason::none){
+            description = std::string("partial: ") + diagnostics::get_name(reason);
+            break;
+        }
         auto T = Tclosec - dT*i;
         auto rhovec = model.pure_VLE_T(T, rhoL, rhoV, 10);
         rhoL = rhovec[0]; rhoV = rhovec[1];
@@ -61,13 +73,20 @@ auto build_ancillaries(const AbstractModel& model, double Tcritguess, double rho
         pLs_.push_back(pL);
     }
     auto N = Thetas_.size();
+    // Exponents of the fits below
+    Eigen::ArrayXd exponents = Eigen::ArrayXd::LinSpaced(10, 0, 4.5);
+    if (N < static_cast<std::size_t>(exponents.size())){
+        throw IterationFailure("Too few points (" + std::to_string(N) + ") were obtained before the building of the ancillaries was interrupted (" + description + ")");
+    }
+    if (N < static_cast<std::size_t>(Npts)){
+        Tmin = (1-Thetas_.back())*Tcrittrue;
+    }
     auto pLs = Eigen::Map<Eigen::ArrayXd>(&(pLs_[0]), N);
     auto rhoLs = Eigen::Map<Eigen::ArrayXd>(&(rhoLs_[0]), N);
     auto rhoVs = Eigen::Map<Eigen::ArrayXd>(&(rhoVs_[0]), N);
     auto Thetass = Eigen::Map<Eigen::ArrayXd>(&(Thetas_[0]), N);
     
     // Solve the least-squares problem for the polynomial coefficients
-    Eigen::ArrayXd exponents = Eigen::ArrayXd::LinSpaced(10, 0, 4.5);
     Eigen::MatrixXd A(N,exponents.size());
     Eigen::VectorXd bL(N), bV(N), bpL(N);
     for (auto i = 0; i < exponents.size(); ++i){
@@ -95,7 +114,7 @@ auto build_ancillaries(const AbstractModel& model, double Tcritguess, double rho
         {"Tmax", Tcrittrue},
         {"Tmin", Tmin},
         {"type", "rhoLnoexp"},
-        {"description", "I'm a description"},
+        {"description", description},
         {"n", toj(cLarray)},
         {"t", toj(exponents)},
         {"reducing_value", rhocrittrue},
@@ -106,7 +125,7 @@ auto build_ancillaries(const AbstractModel& model, double Tcritguess, double rho
         {"Tmax", Tcrittrue},
         {"Tmin", Tmin},
         {"type", "type"},
-        {"description", "I'm a description"},
+        {"description", description},
         {"n", toj(cVarray)},
         {"t", toj(exponents)},
         {"reducing_value", rhocrittrue},
@@ -117,7 +136,7 @@ auto build_ancillaries(const AbstractModel& model, double Tcritguess, double rho
         {"Tmax", Tcrittrue},
         {"Tmin", Tmin},
         {"type", "type"},
-        {"description", "I'm a description"},
+        {"description", description},
         {"n", toj(cpLarray)},
         {"t", toj(exponents)},
         {"reducing_value", pcrittrue},
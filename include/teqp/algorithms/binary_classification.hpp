@@ -0,0 +1,379 @@
+#pragma once
+
+/**
+ Classification of the phase behavior of many binary mixtures, for instance all the pairs of a collection of binary
+ interaction parameters, in the scheme of van Konynenburg and Scott.
+
+ For each pair, the critical locus is traced from both pure-fluid critical points with trace_critical_arclength_binary,
+ and a few VLE isotherms below the lower of the critical temperatures are traced from both pure fluids with
+ trace_VLE_isotherm_binary; the three-phase solutions on each isotherm are searched for with find_VLLE_T_binary.
+ The pairs are processed concurrently on a thread pool, each task building its own instance of the model, so that no
+ state is shared between the threads. The results are collected in columns (one entry per pair in each column).
+
+ The classification is a heuristic based on the topology of the traced curves:
+ - Type I: the critical locus is continuous and no three-phase solution was found
+ - Type II: the critical locus is continuous and a three-phase solution was found on at least one isotherm
+ - Type III: the critical locus is interrupted, and the branch starting at the less volatile component goes to high pressure
+ - Type IV: the critical locus is interrupted, both branches end at critical endpoints, and a three-phase solution was found at the lowest temperature
+ - Type V: as type IV, without a three-phase solution at the lowest temperature
+
+ The end of a critical branch is taken to be a critical endpoint if the critical phase there is in equilibrium with, or unstable
+ with respect to, a phase of distinctly different composition or density (the tangent plane stability test of the phase equilibrium
+ module). An interrupted locus whose branches do not both end at critical endpoints is not classified.
+
+ A pair is also not classified if one of its traces was cancelled or ran out of time, or a critical branch is empty, because the
+ curves then do not show the phase behavior. The type of such a pair is "unknown", with the reason in the unclassified column.
+
+ Type VI (closed-loop liquid-liquid immiscibility) cannot be detected from these curves and is never assigned.
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/post.hpp>
+
+#include "nlohmann/json.hpp"
+
+#include "teqp/exceptions.hpp"
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/algorithms/cancellation.hpp"
+#include "teqp/algorithms/VLE_pure.hpp"
+#include "teqp/algorithms/phase_equil.hpp"
+
+namespace teqp::algorithms::binary_classification{
+
+using teqp::cppinterface::AbstractModel;
+
+/// The types of binary phase diagrams of van Konynenburg and Scott
+enum class VKSType { unknown, I, II, III, IV, V, VI };
+inline const char* get_name(VKSType t) {
+    static const char* names[] = { "unknown", "I", "II", "III", "IV", "V", "VI" };
+    return names[static_cast<std::size_t>(t)];
+}
+
+/// A function returning a new instance of the model of a binary mixture of the named components
+using BinaryModelFactory = std::function<std::unique_ptr<AbstractModel>(const std::vector<std::string>&)>;
+
+struct BinaryClassificationOptions {
+    std::size_t Nthreads = std::max(1U, std::thread::hardware_concurrency()); ///< The number of threads in the pool
+    std::vector<double> reduced_temperatures = { 0.6, 0.8, 0.95 }; ///< The temperatures of the VLE isotherms, relative to the lower of the critical temperatures
+    double Tred_start = 0.999; ///< The reduced temperature at which the tracing of the pure-fluid VLE starts, see pure_trace_VLE
+    double endpoint_tol = 1e-3; ///< A critical branch ends at the other pure fluid if its mole fraction is within this of 1 and the temperature is within this (relative) of the critical temperature
+    double high_pressure_factor = 10.0; ///< A critical branch goes to high pressure if it ends above this multiple of the larger of the critical pressures
+    double critical_endpoint_tpd_tol = 1e-3; ///< The end of a critical branch is a critical endpoint if the tangent plane distance of a distinct trial phase is below this
+    double critical_endpoint_dx = 1e-2; ///< A trial phase is distinct from the critical phase if a mole fraction or the relative molar density differs by more than this
+    TCABOptions critical_options; ///< The options of the tracing of the critical locus; the revision is set to 2
+    TVLEOptions isotherm_options; ///< The options of the tracing of the isotherms; the revision is set to 1
+    VLLE::VLLEFinderOptions VLLE_options; ///< The options of the search for three-phase solutions
+    std::optional<CancellationToken> cancellation; ///< If set and cancelled, the pairs that have not started are skipped
+    std::optional<Deadline> deadline; ///< If set and expired, the pairs that have not started are skipped
+
+    BinaryClassificationOptions() {
+        critical_options.pure_endpoint_polish = true;
+        isotherm_options.p_termination = 1e8;
+        isotherm_options.crit_termination = 1e-4;
+    }
+};
+
+/// The classification of one binary mixture
+struct BinaryPairClassification {
+    std::string name0, name1;
+    VKSType type = VKSType::unknown;
+    double Tc0 = std::numeric_limits<double>::quiet_NaN(), ///< Critical temperature of the first component, in K
+        Tc1 = std::numeric_limits<double>::quiet_NaN(), ///< Critical temperature of the second component, in K
+        pc0 = std::numeric_limits<double>::quiet_NaN(), ///< Critical pressure of the first component, in Pa
+        pc1 = std::numeric_limits<double>::quiet_NaN(); ///< Critical pressure of the second component, in Pa
+    bool continuous_critical_locus = false; ///< True if a critical branch connects the two pure-fluid critical points
+    bool liquid_immiscibility = false; ///< True if a three-phase solution was found, or a critical branch goes to high pressure
+    bool azeotrope = false; ///< True if the compositions of the liquid and the vapor cross on one of the isotherms
+    int num_VLLE_isotherms = 0; ///< The number of isotherms with a three-phase solution
+    double elapsed_s = 0; ///< The wall-clock time spent on the pair
+    std::string error; ///< Empty unless the classification of the pair failed with an exception
+    std::string unclassified; ///< Empty unless the curves were traced but do not allow the pair to be classified; the reason otherwise
+};
+
+/// The classifications of many pairs, stored column by column
+struct BinaryClassificationColumns {
+    std::vector<std::string> name0, name1, type, error, unclassified;
+    std::vector<double> Tc0, Tc1, pc0, pc1, elapsed_s;
+    std::vector<bool> continuous_critical_locus, liquid_immiscibility, azeotrope;
+    std::vector<int> num_VLLE_isotherms;
+
+    void push_back(const BinaryPairClassification& r) {
+        name0.push_back(r.name0); name1.push_back(r.name1);
+        type.push_back(get_name(r.type)); error.push_back(r.error); unclassified.push_back(r.unclassified);
+        Tc0.push_back(r.Tc0); Tc1.push_back(r.Tc1); pc0.push_back(r.pc0); pc1.push_back(r.pc1);
+        elapsed_s.push_back(r.elapsed_s);
+        continuous_critical_locus.push_back(r.continuous_critical_locus);
+        liquid_immiscibility.push_back(r.liquid_immiscibility);
+        azeotrope.push_back(r.azeotrope);
+        num_VLLE_isotherms.push_back(r.num_VLLE_isotherms);
+    }
+    std::size_t size() const { return name0.size(); }
+
+    /// One array per column; non-finite values are stored as null
+    nlohmann::json to_json() const {
+        return {
+            {"name0", name0}, {"name1", name1}, {"type", type},
+            {"Tc0 / K", Tc0}, {"Tc1 / K", Tc1}, {"pc0 / Pa", pc0}, {"pc1 / Pa", pc1},
+            {"continuous_critical_locus", continuous_critical_locus},
+            {"liquid_immiscibility", liquid_immiscibility},
+            {"azeotrope", azeotrope},
+            {"num_VLLE_isotherms", num_VLLE_isotherms},
+            {"elapsed / s", elapsed_s},
+            {"error", error},
+            {"unclassified", unclassified}
+        };
+    }
+};
+
+/// The pairs of names (the fields "Name1" and "Name2") of a collection of binary interaction parameters, such as mixture_binary_pairs.json
+inline std::vector<std::vector<std::string>> get_binary_pairs(const nlohmann::json& BIPcollection) {
+    if (!BIPcollection.is_array()) {
+        throw teqp::InvalidArgument("The collection of binary interaction parameters must be an array");
+    }
+    std::vector<std::vector<std::string>> pairs;
+    for (const auto& el : BIPcollection) {
+        pairs.push_back({ el.at("Name1").get<std::string>(), el.at("Name2").get<std::string>() });
+    }
+    return pairs;
+}
+
+/**
+ \brief Whether the last point of a critical branch is a critical endpoint
+ \param model The model of the mixture
+ \param T Temperature of the critical point, in K
+ \param p Pressure of the critical point, in Pa
+ \param rhovec Molar concentrations of the critical point
+ \param opt The options
+
+ At a critical endpoint the critical phase coexists with another phase, and beyond it (if the branch was traced further into
+ the metastable region) it is unstable with respect to that phase; elsewhere on the branch the critical phase is stable. The
+ trial phases of the stability test that converge close to the critical phase itself are not considered, their tangent plane
+ distance vanishes at any critical point.
+ */
+inline bool ends_at_critical_endpoint(const AbstractModel& model, const double T, const double p, const Eigen::ArrayXd& rhovec, const BinaryClassificationOptions& opt) {
+    namespace pe = teqp::algorithms::phase_equil;
+    const double rho = rhovec.sum();
+    const Eigen::ArrayXd z = rhovec/rho;
+    if ((z <= 0).any()) {
+        return false; // A pure fluid
+    }
+    auto stab = pe::detail::stability_test(model, T, p, z, pe::detail::make_root(model, T, rho, z), pe::FlashOptions{});
+    if (stab.x.size() != z.size() || !(stab.tm_min < opt.critical_endpoint_tpd_tol)) {
+        return false;
+    }
+    return (stab.x - z).abs().maxCoeff() > opt.critical_endpoint_dx || std::abs(stab.rho/rho - 1) > opt.critical_endpoint_dx;
+}
+
+/**
+ \brief Classify the phase behavior of one binary mixture
+ \param model The model of the mixture
+ \param opt The options
+
+ The critical points of the pure fluids are started from the reducing temperatures and densities of the model at the
+ pure-fluid compositions, which are the critical points for the multifluid models. Failures of the tracers on individual
+ isotherms are not fatal; those of the critical tracing are.
+ */
+inline BinaryPairClassification classify_binary_pair(const AbstractModel& model, const BinaryClassificationOptions& opt = {}) {
+    BinaryPairClassification out;
+    auto tic = std::chrono::steady_clock::now();
+
+    // The pure-fluid critical points
+    std::array<double, 2> Tc, rhoc, pc;
+    for (auto i = 0; i < 2; ++i) {
+        Eigen::ArrayXd z = Eigen::ArrayXd::Zero(2); z[i] = 1.0;
+        Tc[i] = model.get_reducing_temperature(z);
+        rhoc[i] = model.get_reducing_density(z);
+        pc[i] = rhoc[i]*model.get_R(z)*Tc[i]*(1.0 + model.get_Ar01(Tc[i], rhoc[i], z));
+    }
+    out.Tc0 = Tc[0]; out.Tc1 = Tc[1]; out.pc0 = pc[0]; out.pc1 = pc[1];
+    const int iheavy = (Tc[0] > Tc[1]) ? 0 : 1; // The less volatile component
+
+    // The curves of an interrupted tracing do not show the phase behavior; the pair is left unknown
+    auto unclassified = [&](const std::string& reason) {
+        out.type = VKSType::unknown;
+        out.unclassified = reason;
+        out.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - tic).count();
+        return out;
+    };
+    auto is_interrupted = [](const std::string& reason) {
+        return reason == diagnostics::get_name(diagnostics::TerminationReason::cancelled) || reason == diagnostics::get_name(diagnostics::TerminationReason::deadline_expired);
+    };
+
+    // The critical branches starting at each pure fluid
+    auto critopt = opt.critical_options;
+    critopt.revision = 2;
+    if (!critopt.cancellation) { critopt.cancellation = opt.cancellation; }
+    if (!critopt.deadline) { critopt.deadline = opt.deadline; }
+    std::array<bool, 2> reaches_other{ false, false }, high_pressure{ false, false }, critical_endpoint{ false, false };
+    for (auto i = 0; i < 2; ++i) {
+        Eigen::ArrayXd rhovec0 = Eigen::ArrayXd::Zero(2); rhovec0[i] = rhoc[i];
+        auto trace = model.trace_critical_arclength_binary(Tc[i], rhovec0, std::nullopt, critopt);
+        const std::string reason = trace.at("meta").at("termination_reason");
+        if (is_interrupted(reason)) {
+            return unclassified(reason);
+        }
+        const auto& data = trace.at("data");
+        if (data.empty()) {
+            return unclassified("the critical branch starting at component " + std::to_string(i) + " is empty");
+        }
+        const auto& last = data.back();
+        const double rhoi = last.at(i == 0 ? "rho0 / mol/m^3" : "rho1 / mol/m^3"), rhoj = last.at(i == 0 ? "rho1 / mol/m^3" : "rho0 / mol/m^3");
+        const double T = last.at("T / K"), p = last.at("p / Pa");
+        reaches_other[i] = rhoi/(rhoi + rhoj) < opt.endpoint_tol && std::abs(T/Tc[1 - i] - 1) < opt.endpoint_tol;
+        high_pressure[i] = p > opt.high_pressure_factor*std::max(pc[0], pc[1]);
+        if (!reaches_other[i] && !high_pressure[i]) {
+            Eigen::ArrayXd rhovec(2);
+            rhovec << last.at("rho0 / mol/m^3").get<double>(), last.at("rho1 / mol/m^3").get<double>();
+            try {
+                critical_endpoint[i] = ends_at_critical_endpoint(model, T, p, rhovec, opt);
+            }
+            catch (const std::exception&) {
+                // No density roots for the stability test; not shown to be a critical endpoint
+            }
+        }
+    }
+    out.continuous_critical_locus = reaches_other[0] || reaches_other[1];
+
+    // Isotherms from both pure fluids, and the three-phase solutions on them
+    auto isoopt = opt.isotherm_options;
+    isoopt.revision = 2;
+    if (!isoopt.cancellation) { isoopt.cancellation = opt.cancellation; }
+    if (!isoopt.deadline) { isoopt.deadline = opt.deadline; }
+    const double Tcmin = std::min(Tc[0], Tc[1]);
+    std::vector<double> Tred = opt.reduced_temperatures;
+    std::sort(Tred.begin(), Tred.end());
+    bool VLLE_at_lowest = false;
+    for (auto k = 0U; k < Tred.size(); ++k) {
+        const double T = Tred[k]*Tcmin;
+        std::vector<nlohmann::json> traces;
+        for (auto i = 0; i < 2; ++i) {
+            try {
+                nlohmann::json spec{
+                    {"Tcguess", Tc[i]}, {"rhocguess", rhoc[i]}, {"Tred", opt.Tred_start},
+                    {"pure_spec", {{"alternative_pure_index", i}, {"alternative_length", 2}}}
+                };
+                auto rhoLrhoV = pure_trace_VLE(model, T, spec);
+                Eigen::ArrayXd rhovecL = Eigen::ArrayXd::Zero(2), rhovecV = Eigen::ArrayXd::Zero(2);
+                rhovecL[i] = rhoLrhoV[0];
+                rhovecV[i] = rhoLrhoV[1];
+                auto trace = model.trace_VLE_isotherm_binary(T, rhovecL, rhovecV, isoopt);
+                const std::string reason = trace.at("meta").at("termination_reason");
+                if (is_interrupted(reason)) {
+                    return unclassified(reason);
+                }
+                traces.push_back(trace.at("data"));
+            }
+            catch (const std::exception&) {
+                // This isotherm cannot be started from this pure fluid
+            }
+        }
+        for (const auto& trace : traces) {
+            // An azeotrope is where the difference of the compositions of the liquid and the vapor changes sign
+            double last_diff = 0;
+            for (const auto& pt : trace) {
+                const double xL = pt.at("xL_0 / mole frac."), xV = pt.at("xV_0 / mole frac.");
+                if (xL < opt.endpoint_tol || xL > 1 - opt.endpoint_tol) { continue; }
+                const double diff = xL - xV;
+                if (diff*last_diff < 0) { out.azeotrope = true; }
+                if (diff != 0) { last_diff = diff; }
+            }
+        }
+        if (traces.empty()) {
+            continue;
+        }
+        try {
+            auto solns = model.find_VLLE_T_binary(traces, opt.VLLE_options);
+            bool found = false;
+            for (const auto& soln : solns) {
+                auto code = static_cast<VLLE::VLLE_return_code>(soln.at("polisher_return_code").get<int>());
+                if (code == VLLE::VLLE_return_code::xtol_satisfied || code == VLLE::VLLE_return_code::functol_satisfied) {
+                    found = true;
+                }
+            }
+            if (found) {
+                out.num_VLLE_isotherms++;
+                if (k == 0) { VLLE_at_lowest = true; }
+            }
+        }
+        catch (const std::exception&) {
+            // No intersection could be polished on this isotherm
+        }
+    }
+    out.liquid_immiscibility = out.num_VLLE_isotherms > 0 || high_pressure[0] || high_pressure[1];
+
+    if (out.continuous_critical_locus) {
+        out.type = (out.num_VLLE_isotherms > 0) ? VKSType::II : VKSType::I;
+    }
+    else if (high_pressure[iheavy]) {
+        out.type = VKSType::III;
+    }
+    else if (critical_endpoint[0] && critical_endpoint[1]) {
+        out.type = (VLLE_at_lowest) ? VKSType::IV : VKSType::V;
+    }
+    else {
+        return unclassified("the critical locus is interrupted, but its branches do not both end at critical endpoints");
+    }
+    out.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - tic).count();
+    return out;
+}
+
+/**
+ \brief Classify many binary mixtures concurrently
+ \param pairs The names of the components of each mixture
+ \param factory The function building the model of a mixture; it is called once in each task, so it must be safe to call from several threads
+ \param opt The options
+
+ A pair whose model cannot be built or whose classification fails gets the type "unknown" and the message of the
+ exception in the error column; the other pairs are not affected.
+ */
+inline BinaryClassificationColumns classify_binary_pairs(const std::vector<std::vector<std::string>>& pairs, const BinaryModelFactory& factory, const BinaryClassificationOptions& opt = {}) {
+    for (const auto& pair : pairs) {
+        if (pair.size() != 2) {
+            throw teqp::InvalidArgument("Each pair must have two names");
+        }
+    }
+    std::vector<BinaryPairClassification> results(pairs.size());
+    {
+        boost::asio::thread_pool pool{ opt.Nthreads };
+        for (auto i = 0U; i < pairs.size(); ++i) {
+            auto payload = [&pair = pairs[i], &dest = results[i], &factory, &opt]() {
+                // Pairs that have not started when the classification is interrupted are skipped
+                auto reason = check_interruption(opt);
+                if (reason != diagnostics::TerminationReason::none) {
+                    dest.error = diagnostics::get_name(reason);
+                }
+                else {
+                    try {
+                        auto model = factory(pair);
+                        dest = classify_binary_pair(*model, opt);
+                    }
+                    catch (const std::exception& e) {
+                        dest.error = e.what();
+                    }
+                }
+                dest.name0 = pair[0];
+                dest.name1 = pair[1];
+            };
+            boost::asio::post(pool, payload);
+        }
+        pool.join();
+    }
+    BinaryClassificationColumns columns;
+    for (const auto& r : results) {
+        columns.push_back(r);
+    }
+    return columns;
+}
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+/**
+ Cooperative cancellation and wall-clock deadlines for the long-running algorithms (tracers, iterative VLE solvers,
+ building of ancillaries, parameter optimization).
+
+ The algorithms check the token and the deadline of their options at each step or iteration; when either has expired
+ they stop and return what has been obtained so far, flagged with the reason of the termination. Nothing is interrupted
+ preemptively, so the latency is bounded by the duration of one step.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+
+#include "teqp/algorithms/diagnostics.hpp"
+
+namespace teqp {
+
+/**
+ A token that can be cancelled from another thread. Copies share the same state, so the caller keeps a copy and
+ passes another one in the options of the algorithm.
+ */
+class CancellationToken {
+private:
+    std::shared_ptr<std::atomic<bool>> flag = std::make_shared<std::atomic<bool>>(false);
+public:
+    void cancel() const { flag->store(true, std::memory_order_relaxed); }
+    bool is_cancelled() const { return flag->load(std::memory_order_relaxed); }
+};
+
+/// A point in time on the monotonic clock after which an algorithm should stop
+class Deadline {
+private:
+    std::chrono::steady_clock::time_point tmax;
+public:
+    explicit Deadline(std::chrono::steady_clock::time_point tmax) : tmax(tmax) {}
+    /// The deadline the given number of seconds from now
+    static Deadline in_seconds(double seconds) {
+        return Deadline(std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds)));
+    }
+    bool expired() const { return std::chrono::steady_clock::now() >= tmax; }
+    /// The remaining time in seconds, negative once expired
+    double remaining_seconds() const { return std::chrono::duration<double>(tmax - std::chrono::steady_clock::now()).count(); }
+};
+
+/// The reason to interrupt an algorithm, or TerminationReason::none if it should go on
+inline diagnostics::TerminationReason check_interruption(const std::optional<CancellationToken>& cancellation, const std::optional<Deadline>& deadline) {
+    if (cancellation && cancellation->is_cancelled()) {
+        return diagnostics::TerminationReason::cancelled;
+    }
+    if (deadline && deadline->expired()) {
+        return diagnostics::TerminationReason::deadline_expired;
+    }
+    return diagnostics::TerminationReason::none;
+}
+
+/// The reason to interrupt an algorithm, from the cancellation and deadline fields of its options
+template<typename Options>
+diagnostics::TerminationReason check_interruption(const Options& opt) {
+    return check_interruption(opt.cancellation, opt.deadline);
+}
+
+}
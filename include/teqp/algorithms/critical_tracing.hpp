@@ -10,6 +10,7 @@
 #include "teqp/algorithms/critical_pure.hpp"
 #include "teqp/algorithms/critical_tracing_types.hpp"
 #include "teqp/exceptions.hpp"
+#include "teqp/instrumentation.hpp"
 
 // Imports from boost
 #include <boost/numeric/odeint/stepper/controlled_runge_kutta.hpp>
@@ -456,6 +457,26 @@ struct CriticalTracing {
 
         double t = 0, dt = options.init_dt;
 
+        // Build an event at the current state, to be emitted to the sink of the diagnostics
+        using diagnostics::EventKind;
+        using diagnostics::TerminationReason;
+        auto make_event = [&](EventKind kind, int step, const std::vector<double>& x) {
+            diagnostics::TraceEvent e("trace_critical_arclength_binary", kind, step);
+            e.t = t; e.dt = dt; e.T = x[0];
+            e.set_state(Eigen::Map<const Eigen::ArrayXd>(&(x[0]) + 1, x.size() - 1));
+            return e;
+        };
+        std::string termination_reason;
+        auto terminate = [&](TerminationReason reason, int step, const std::vector<double>& x, std::string_view msg) {
+            termination_reason = diagnostics::get_name(reason);
+            if (auto sink = diagnostics::get_sink(options, 10)) {
+                auto e = make_event(EventKind::termination, step, x);
+                e.reason = reason;
+                e.set_message(msg);
+                sink->emit(e);
+            }
+        };
+
         // Build the initial state array, with T followed by rhovec
         std::vector<double> x0(rhovec0.size() + 1); 
         x0[0] = T0;
@@ -499,6 +520,11 @@ struct CriticalTracing {
                 point["locally stable"] = is_locally_stable(model, T, rhovec, options.stability_rel_drho);
             }
             JSONdata.push_back(point);
+            if (auto sink = diagnostics::get_sink(options, 10)) {
+                auto e = make_event(EventKind::step, static_cast<int>(JSONdata.size()) - 1, x0);
+                e.residual_norm = conditions.matrix().norm();
+                sink->emit(e);
+            }
         };
 
         // Line writer
@@ -509,7 +535,6 @@ struct CriticalTracing {
             auto conditions = get_criticality_conditions(model, T, rhovec);
             out << z0 << "," << rhovec[0] << "," << rhovec[1] << "," << T << "," << rhotot * model.R(rhovec / rhovec.sum()) * T + model.get_pr(T, rhovec) << "," << c << "," << dt << "," << conditions(0) << "," << conditions(1) << std::endl;
             std::string sout(out.str());
-            std::cout << sout;
             if (ofs.is_open()) {
                 ofs << sout;
             }
@@ -533,6 +558,11 @@ struct CriticalTracing {
         }
 
         for (auto iter = 0; iter < options.max_step_count; ++iter) {
+            TEQP_COUNT(trace_steps, 1);
+            if (auto reason = check_interruption(options); reason != TerminationReason::none) {
+                terminate(reason, iter, x0, "");
+                break;
+            }
             
             // Calculate the derivatives at the beginning of the step
             auto dxdt_start_step = get_dxdt(x0);
@@ -547,13 +577,14 @@ struct CriticalTracing {
                     res = controlled_stepper.try_step(xprime, x0, t, dt);
                 }
                 catch (const std::exception &e) {
-                    if (options.verbosity > 0) {
-                        std::cout << e.what() << std::endl;
-                    }
+                    terminate(TerminationReason::integration_failure, iter, x0, e.what());
                     break;
                 }
 
                 if (res != controlled_step_result::success) {
+                    if (auto sink = diagnostics::get_sink(options, 10)) {
+                        sink->emit(make_event(EventKind::step_rejected, iter, x0));
+                    }
                     // Try again, with a smaller step size
                     iter--;
                     retry_count++;
@@ -576,7 +607,7 @@ struct CriticalTracing {
                     t += dt;
                 }
                 catch (const std::exception &e) {
-                    std::cout << e.what() << std::endl;
+                    terminate(TerminationReason::integration_failure, iter, x0, e.what());
                     break;
                 }
             }
@@ -586,9 +617,7 @@ struct CriticalTracing {
 
             auto z0 = rhovec[0] / rhovec.sum();
             if (z0 < 0 || z0 > 1) {
-                if (options.verbosity > 10) {
-                    std::cout << "Termination because z0 of " + std::to_string(z0) + " is outside [0, 1]" << std::endl;
-                }
+                terminate(TerminationReason::composition_out_of_range, iter, x0, "z0 of " + std::to_string(z0) + " is outside [0, 1]");
                 break;
             }
 
@@ -632,15 +661,13 @@ struct CriticalTracing {
                         break;
                     }
                     catch (std::exception& e) {
-                        if (options.verbosity > 10) {
-                            std::cout << "Tracing problem: " << e.what() << std::endl;
-                            std::cout << "Starting:: T:" << T << "; rhovec: " << rhovec << std::endl;
-                            auto conditions = get_criticality_conditions(model, T, rhovec);
-                            std::cout << "Starting crit. cond.: " << conditions << std::endl;
+                        if (auto sink = diagnostics::get_sink(options, 10)) {
+                            auto ev = make_event(EventKind::polish_failure, iter, x0);
                             try {
-                                auto [Tnew, rhovecnew] = polisher(model, T, rhovec);
-                                std::cout << "Ending:: T:" << Tnew << "; rhovec: " << rhovecnew << std::endl;
+                                ev.residual_norm = get_criticality_conditions(model, T, rhovec).matrix().norm();
                             } catch (...) {}
+                            ev.set_message(e.what());
+                            sink->emit(ev);
                         }
                     }
                 }
@@ -649,9 +676,7 @@ struct CriticalTracing {
                         throw IterationFailure("Polishing was not successful");
                     }
                     else{
-                        if (options.verbosity > 10){
-                            std::cout << "Termination because polishing failed" << std::endl;
-                        }
+                        terminate(TerminationReason::polishing_failed, iter, x0, "polishing failed");
                         break;
                     }
                 }
@@ -680,9 +705,7 @@ struct CriticalTracing {
             auto rhotot = rhovec.sum();
             z0 = rhovec[0] / rhotot;
             if (z0 < 0 || z0 > 1) {
-                if (options.verbosity > 10) {
-                    std::cout << "Termination because z0 of " + std::to_string(z0) + " is outside [0, 1]" << std::endl;
-                }
+                terminate(TerminationReason::composition_out_of_range, iter, x0, "z0 of " + std::to_string(z0) + " is outside [0, 1]");
                 break;
             }
 
@@ -690,15 +713,16 @@ struct CriticalTracing {
             store_point();
 
             if (counter_T_converged > options.small_T_count) {
-                if (options.verbosity > 10){
-                    std::cout << "Termination because maximum number of small steps were taken" << std::endl;
-                }
+                terminate(TerminationReason::small_steps, iter, x0, "maximum number of small steps were taken");
                 break;
             }
+            if (iter == options.max_step_count - 1) {
+                terminate(TerminationReason::max_steps, iter, x0, "maximum number of steps were taken");
+            }
         }
         // If the last step crosses a zero concentration, see if it corresponds to a pure fluid
         // and if so, iterate to find the pure fluid endpoint
-        if (options.pure_endpoint_polish) {
+        if (options.pure_endpoint_polish && check_interruption(options) == TerminationReason::none) {
             // Simple Euler step t
             auto dxdt = get_dxdt(x0);
             auto drhodt = extract_drhodt(dxdt);
@@ -734,7 +758,21 @@ struct CriticalTracing {
             }
         }
         //auto N = JSONdata.size();
-        return JSONdata;
+        if (options.revision == 1) {
+            return JSONdata;
+        }
+        else if (options.revision == 2) {
+            nlohmann::json meta{
+                {"termination_reason", termination_reason}
+            };
+            return nlohmann::json{
+                {"meta", meta},
+                {"data", JSONdata}
+            };
+        }
+        else {
+            throw teqp::InvalidArgument("revision is not valid");
+        }
     }
 
     /**
@@ -1,5 +1,8 @@
 # pragma once
 
+#include "teqp/algorithms/diagnostics.hpp"
+#include "teqp/algorithms/cancellation.hpp"
+
 namespace teqp {
 
 struct TCABOptions {
@@ -20,8 +23,12 @@ struct TCABOptions {
     bool calc_stability = false; ///< Calculate the local stability with the method of Deiters and Bell
     double stability_rel_drho = 0.001; ///< The relative size of the step (relative to the sum of the molar concentration vector) to be used when taking the step in the direction of \f$\sigma_1\f$ when assessing local stability
     int verbosity = 0; ///< The greater the verbosity, the more output you will get, especially about polishing failures
+    int revision = 1; ///< If 2, the data are returned in the "data" field and the termination reason in the "meta" field, otherwise the data are returned as root array
     bool polish_exception_on_fail = false; ///< If true, when polishing fails, throw an exception, otherwise, terminate tracing
     bool pure_endpoint_polish = false; ///< If true, if the last step crossed into negative concentrations, try to interpolate to find the pure fluid endpoint hiding in the data
+    std::shared_ptr<diagnostics::EventSink> sink; ///< If set, the steps, failures, and termination of the tracing are emitted to this sink rather than printed according to the verbosity
+    std::optional<CancellationToken> cancellation; ///< If set and cancelled, stop at the next step and return the partial result
+    std::optional<Deadline> deadline; ///< If set and expired, stop at the next step and return the partial result
 };
 
 struct EigenData {
@@ -0,0 +1,340 @@
+#pragma once
+
+/**
+ All the density roots of \f$p(T,\rho,\vec x)=p\f$ and the spinodals of an isotherm, for the identification of phases.
+
+ The pressure is approximated on \f$[0,\rho_{\max}]\f$ by a piecewise Chebyshev expansion whose intervals are bisected
+ until the expansion is resolved. The nodes of all the unresolved intervals (of all the state points in the batched
+ version) are evaluated together in one call to get_Arxy_batch per round of refinement. The roots of the expansion and
+ of its derivative are the eigenvalues of colleague matrices; they are then polished with Newton's method on the model
+ itself, so they are obtained to machine precision.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "teqp/exceptions.hpp"
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/algorithms/density_roots_types.hpp"
+
+namespace teqp{
+
+namespace density_roots_detail{
+
+/// Chebyshev coefficients from the values at the Chebyshev-Lobatto nodes \f$x_k=\cos(\pi k/M)\f$
+inline Eigen::ArrayXd fit(const Eigen::ArrayXd& f) {
+    const auto M = f.size() - 1;
+    Eigen::ArrayXd c(M + 1);
+    for (auto j = 0; j <= M; ++j) {
+        double s = 0;
+        for (auto k = 0; k <= M; ++k) {
+            double w = (k == 0 || k == M) ? 0.5 : 1.0;
+            s += w*f[k]*cos(EIGEN_PI*j*k/M);
+        }
+        c[j] = 2.0/M*s*((j == 0 || j == M) ? 0.5 : 1.0);
+    }
+    return c;
+}
+
+/// The coefficients of the derivative with respect to \f$x\f$ of \f$\sum_j c_jT_j(x)\f$
+inline Eigen::ArrayXd derivative(const Eigen::ArrayXd& c) {
+    const auto n = c.size() - 1;
+    if (n < 1) {
+        return Eigen::ArrayXd::Zero(1);
+    }
+    Eigen::ArrayXd d = Eigen::ArrayXd::Zero(n);
+    for (auto k = n - 1; k >= 0; --k) {
+        d[k] = ((k + 2 <= n - 1) ? d[k + 2] : 0.0) + 2.0*(k + 1)*c[k + 1];
+    }
+    d[0] /= 2.0;
+    return d;
+}
+
+/**
+ The real roots in \f$[-1,1]\f$ of \f$\sum_j c_jT_j(x)\f$, from the eigenvalues of the colleague matrix
+
+ Trailing coefficients smaller than tol relative to the largest one are dropped first; the roots are only approximate,
+ to within the resolution of the expansion
+ */
+inline std::vector<double> real_roots(const Eigen::ArrayXd& c, const double tol) {
+    std::vector<double> roots;
+    const double scale = c.abs().maxCoeff();
+    if (!(scale > 0)) {
+        return roots;
+    }
+    auto n = c.size() - 1;
+    while (n > 0 && std::abs(c[n]) <= tol*scale) { --n; }
+    if (n == 0) {
+        return roots;
+    }
+    if (n == 1) {
+        roots.push_back(-c[0]/c[1]);
+    }
+    else {
+        Eigen::MatrixXd C = Eigen::MatrixXd::Zero(n, n);
+        C(0, 1) = 1.0;
+        for (auto i = 1; i < n - 1; ++i) {
+            C(i, i - 1) = 0.5;
+            C(i, i + 1) = 0.5;
+        }
+        for (auto j = 0; j < n; ++j) {
+            C(n - 1, j) = -c[j]/(2.0*c[n]);
+        }
+        C(n - 1, n - 2) += 0.5;
+        Eigen::EigenSolver<Eigen::MatrixXd> es(C, false);
+        for (auto i = 0; i < n; ++i) {
+            auto lambda = es.eigenvalues()[i];
+            if (std::abs(lambda.imag()) < 1e-8) {
+                roots.push_back(lambda.real());
+            }
+        }
+    }
+    std::vector<double> inside;
+    for (auto x : roots) {
+        if (std::abs(x) <= 1 + 1e-8) {
+            inside.push_back(std::clamp(x, -1.0, 1.0));
+        }
+    }
+    return inside;
+}
+
+/// One interval of the piecewise expansion of the pressure of a state point
+struct Piece {
+    Eigen::Index state; ///< The index of the state point
+    double a, b; ///< The ends of the interval in density
+    int depth; ///< The number of bisections that led to this interval
+    Eigen::ArrayXd c; ///< The Chebyshev coefficients of the pressure, empty until sampled
+    double to_rho(double x) const { return a + (b - a)*(x + 1)/2; }
+};
+
+/**
+ Newton's method for a scalar function of density, where f returns the value and the derivative; the result is empty
+ if the iteration does not converge in the interval \f$(0,\rho_{\max}]\f$
+ */
+template<typename Function>
+std::optional<double> newton(const Function& f, double rho, const double rho_max, const int max_iter) {
+    for (auto iter = 0; iter < max_iter; ++iter) {
+        auto [y, dydrho] = f(rho);
+        if (!std::isfinite(y) || !std::isfinite(dydrho) || dydrho == 0) {
+            return std::nullopt;
+        }
+        double step = -y/dydrho;
+        rho += step;
+        if (!(rho > 0) || rho > rho_max) {
+            return std::nullopt;
+        }
+        if (std::abs(step) <= 4*std::numeric_limits<double>::epsilon()*rho || y == 0) {
+            return rho;
+        }
+    }
+    return std::nullopt;
+}
+
+/// Sort the values and remove those that agree with the preceding one to a relative tolerance
+inline void sort_unique(std::vector<double>& v, const double reltol = 1e-9) {
+    std::sort(v.begin(), v.end());
+    v.erase(std::unique(v.begin(), v.end(), [reltol](double x, double y) { return std::abs(y - x) <= reltol*std::abs(y); }), v.end());
+}
+
+}
+
+/**
+ \brief All the density roots and spinodals of many state points, the pressure proxies of all of them being refined together
+ \param model The model
+ \param T The temperatures, in K
+ \param p The pressures, in Pa
+ \param molefracs The mole fractions, one state point per row
+ \param options The options
+ */
+inline std::vector<DensityRootsResult> find_density_roots_batch(const teqp::cppinterface::AbstractModel& model, const Eigen::Ref<const Eigen::ArrayXd>& T, const Eigen::Ref<const Eigen::ArrayXd>& p, const Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic>>& molefracs, const std::optional<DensityRootsOptions>& options = std::nullopt) {
+    using namespace density_roots_detail;
+    const auto opt = options.value_or(DensityRootsOptions{});
+    const auto Nstate = T.size();
+    if (p.size() != Nstate || molefracs.rows() != Nstate) {
+        throw teqp::InvalidArgument("T, p, and the rows of molefracs must all be the same length");
+    }
+    if (opt.degree < 2 || opt.initial_intervals < 1 || opt.max_depth < 0) {
+        throw teqp::InvalidArgument("degree must be at least 2, initial_intervals at least 1, and max_depth non-negative");
+    }
+    const int M = opt.degree;
+
+    std::vector<DensityRootsResult> results(Nstate);
+    std::vector<Eigen::ArrayXd> x(Nstate);
+    std::vector<double> R(Nstate), rho_max(Nstate);
+    std::vector<Piece> pending, resolved;
+    for (auto i = 0; i < Nstate; ++i) {
+        if (!(T[i] > 0) || !std::isfinite(p[i])) {
+            throw teqp::InvalidArgument("Temperature must be positive and pressure finite");
+        }
+        x[i] = molefracs.row(i).transpose();
+        R[i] = model.get_R(x[i]);
+        if (opt.rho_max) {
+            rho_max[i] = opt.rho_max.value();
+        }
+        else {
+            try {
+                rho_max[i] = 4.0*model.get_reducing_density(x[i]);
+            }
+            catch (const teqp::NotImplementedError&) {
+                throw teqp::InvalidArgument("rho_max must be provided for a model without a reducing density");
+            }
+        }
+        if (!(rho_max[i] > 0)) {
+            throw teqp::InvalidArgument("rho_max must be positive");
+        }
+        for (auto k = 0; k < opt.initial_intervals; ++k) {
+            pending.push_back(Piece{ i, rho_max[i]*k/opt.initial_intervals, rho_max[i]*(k + 1)/opt.initial_intervals, 0, {} });
+        }
+    }
+
+    // Refinement of the proxies; one batched evaluation of the model per round
+    Eigen::ArrayXd xnodes(M + 1);
+    for (auto k = 0; k <= M; ++k) {
+        xnodes[k] = cos(EIGEN_PI*k/M);
+    }
+    while (!pending.empty()) {
+        const auto Npts = static_cast<Eigen::Index>(pending.size())*(M + 1);
+        Eigen::ArrayXd Tb(Npts), rhob(Npts);
+        Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic> xb(Npts, molefracs.cols());
+        for (auto j = 0U; j < pending.size(); ++j) {
+            const auto& piece = pending[j];
+            for (auto k = 0; k <= M; ++k) {
+                const auto row = j*(M + 1) + k;
+                Tb[row] = T[piece.state];
+                rhob[row] = piece.to_rho(xnodes[k]);
+                xb.row(row) = molefracs.row(piece.state);
+            }
+            results[piece.state].num_evaluations += M + 1;
+        }
+        Eigen::ArrayXd Ar01 = model.get_Arxy_batch(0, 1, Tb, rhob, xb);
+
+        std::vector<Piece> next;
+        for (auto j = 0U; j < pending.size(); ++j) {
+            auto& piece = pending[j];
+            const auto i = piece.state;
+            Eigen::ArrayXd rho = rhob.segment(j*(M + 1), M + 1);
+            Eigen::ArrayXd pvals = rho*R[i]*T[i]*(1.0 + Ar01.segment(j*(M + 1), M + 1));
+            bool resolved_piece = false;
+            if (pvals.allFinite()) {
+                piece.c = fit(pvals);
+                const double tail = std::max(std::abs(piece.c[M - 1]), std::abs(piece.c[M]));
+                resolved_piece = tail <= opt.coeff_tol*piece.c.abs().maxCoeff() || piece.depth >= opt.max_depth;
+            }
+            else {
+                // Keep only the part of the interval below the first node where the model cannot be evaluated,
+                // which locates the end of the domain of the model (the close packing, for instance)
+                auto k = M;
+                while (k >= 0 && std::isfinite(pvals[k])) { --k; }
+                if (k < M - 1 && piece.depth < opt.max_depth) {
+                    next.push_back(Piece{ i, piece.a, rho[k + 1], piece.depth + 1, {} });
+                }
+                continue;
+            }
+            if (resolved_piece) {
+                resolved.push_back(piece);
+            }
+            else {
+                const double mid = (piece.a + piece.b)/2;
+                next.push_back(Piece{ i, piece.a, mid, piece.depth + 1, {} });
+                next.push_back(Piece{ i, mid, piece.b, piece.depth + 1, {} });
+            }
+        }
+        pending = std::move(next);
+    }
+
+    // Candidates from the proxies
+    std::vector<std::vector<double>> root_guesses(Nstate), spinodal_guesses(Nstate);
+    for (const auto& piece : resolved) {
+        const auto i = piece.state;
+        results[i].num_intervals++;
+        Eigen::ArrayXd c = piece.c;
+        c[0] -= p[i];
+        for (auto xr : real_roots(c, opt.coeff_tol)) {
+            root_guesses[i].push_back(piece.to_rho(xr));
+        }
+        for (auto xs : real_roots(derivative(piece.c), opt.coeff_tol)) {
+            spinodal_guesses[i].push_back(piece.to_rho(xs));
+        }
+    }
+
+    // Polishing with the model, and classification of the roots
+    for (auto i = 0; i < Nstate; ++i) {
+        auto& res = results[i];
+        const double RT = R[i]*T[i];
+        auto count = [&res](auto&& A) { res.num_evaluations++; return A; };
+        auto f_root = [&](double rho) {
+            auto A = count(model.get_Ar02n(T[i], rho, x[i]));
+            return std::make_tuple(rho*RT*(1 + A[1]) - p[i], RT*(1 + 2*A[1] + A[2]));
+        };
+        auto f_spinodal = [&](double rho) {
+            auto A = count(model.get_Ar03n(T[i], rho, x[i]));
+            return std::make_tuple(RT*(1 + 2*A[1] + A[2]), RT*(2*A[1] + 4*A[2] + A[3])/rho);
+        };
+        // At low pressure the vapor root is much closer to the ideal-gas density than the proxy can resolve
+        if (p[i] > 0) {
+            root_guesses[i].push_back(p[i]/RT);
+        }
+
+        std::vector<double> rhos;
+        for (auto rho0 : root_guesses[i]) {
+            if (auto rho = newton(f_root, rho0, rho_max[i], opt.max_newton)) {
+                rhos.push_back(rho.value());
+            }
+        }
+        sort_unique(rhos);
+        double gmin = std::numeric_limits<double>::infinity();
+        for (auto rho : rhos) {
+            auto A = count(model.get_Ar02n(T[i], rho, x[i]));
+            DensityRoot root;
+            root.rho = rho;
+            root.dpdrho = RT*(1 + 2*A[1] + A[2]);
+            double Z = 1 + A[1];
+            root.g_RT = A[0] + Z - log(std::abs(Z)); // Z has the sign of the pressure
+            root.stability = (root.dpdrho > 0) ? DensityRootStability::metastable : DensityRootStability::unstable;
+            if (root.stability != DensityRootStability::unstable) {
+                gmin = std::min(gmin, root.g_RT);
+            }
+            res.roots.push_back(root);
+        }
+        for (auto& root : res.roots) {
+            if (root.stability == DensityRootStability::metastable && root.g_RT == gmin) {
+                root.stability = DensityRootStability::stable;
+                break;
+            }
+        }
+
+        std::vector<double> rhos_spinodal;
+        for (auto rho0 : spinodal_guesses[i]) {
+            if (auto rho = newton(f_spinodal, rho0, rho_max[i], opt.max_newton)) {
+                rhos_spinodal.push_back(rho.value());
+            }
+        }
+        sort_unique(rhos_spinodal);
+        for (auto rho : rhos_spinodal) {
+            auto A = count(model.get_Ar03n(T[i], rho, x[i]));
+            res.spinodals.push_back(DensitySpinodal{ rho, rho*RT*(1 + A[1]), RT*(2*A[1] + 4*A[2] + A[3])/rho });
+        }
+    }
+    return results;
+}
+
+/**
+ \brief All the density roots and spinodals at the given temperature, pressure and composition
+ \param model The model
+ \param T Temperature, in K
+ \param p Pressure, in Pa
+ \param molefrac The mole fractions
+ \param options The options
+ */
+inline DensityRootsResult find_density_roots(const teqp::cppinterface::AbstractModel& model, const double T, const double p, const Eigen::Ref<const Eigen::ArrayXd>& molefrac, const std::optional<DensityRootsOptions>& options = std::nullopt) {
+    Eigen::ArrayXd Tv = Eigen::ArrayXd::Constant(1, T), pv = Eigen::ArrayXd::Constant(1, p);
+    Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic> X = molefrac.transpose();
+    return find_density_roots_batch(model, Tv, pv, X, options).front();
+}
+
+}
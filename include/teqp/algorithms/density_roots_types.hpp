@@ -0,0 +1,65 @@
+#pragma once
+
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace teqp{
+
+/// The stability of a density root at given temperature, pressure and composition
+enum class DensityRootStability { stable, metastable, unstable };
+
+/// A solution of \f$p(T,\rho,\vec x)=p\f$ for the molar density
+struct DensityRoot {
+    double rho = std::numeric_limits<double>::quiet_NaN(); ///< Molar density, in mol/m^3
+    double dpdrho = std::numeric_limits<double>::quiet_NaN(); ///< \f$(\partial p/\partial\rho)_{T,\vec x}\f$, negative for mechanically unstable roots
+    double g_RT = std::numeric_limits<double>::quiet_NaN(); ///< The molar Gibbs energy over \f$RT\f$, up to a term that is the same for all the roots at the given temperature, pressure and composition
+    DensityRootStability stability = DensityRootStability::unstable;
+};
+
+/// A spinodal point, where \f$(\partial p/\partial\rho)_{T,\vec x}=0\f$
+struct DensitySpinodal {
+    double rho = std::numeric_limits<double>::quiet_NaN(); ///< Molar density, in mol/m^3
+    double p = std::numeric_limits<double>::quiet_NaN(); ///< Pressure, in Pa
+    double d2pdrho2 = std::numeric_limits<double>::quiet_NaN(); ///< \f$(\partial^2 p/\partial\rho^2)_{T,\vec x}\f$, negative at a vapor-like spinodal (local maximum of pressure) and positive at a liquid-like one (local minimum)
+};
+
+struct DensityRootsOptions {
+    std::optional<double> rho_max; ///< The upper end of the density axis that is searched, in mol/m^3; by default four times the reducing density of the model
+    int degree = 32; ///< The degree of the Chebyshev expansion of the pressure on each interval
+    int initial_intervals = 4; ///< The number of equal intervals the density axis is initially divided into
+    int max_depth = 12; ///< The maximum number of times an interval can be bisected
+    double coeff_tol = 1e-12; ///< An interval is resolved when its last two Chebyshev coefficients are smaller than this, relative to the largest one
+    int max_newton = 30; ///< The maximum number of Newton steps in the polishing of each root and spinodal
+};
+
+struct DensityRootsResult {
+    std::vector<DensityRoot> roots; ///< The density roots, by increasing density
+    std::vector<DensitySpinodal> spinodals; ///< The spinodals, by increasing density
+    int num_intervals = 0; ///< The number of intervals of the Chebyshev proxy of the pressure
+    int num_evaluations = 0; ///< The number of evaluations of the model, for the proxy and the polishing
+
+    /// The root with the lowest Gibbs energy among the mechanically stable ones, if there are any
+    std::optional<DensityRoot> stable_root() const {
+        for (const auto& r : roots){
+            if (r.stability == DensityRootStability::stable){ return r; }
+        }
+        return std::nullopt;
+    }
+    /// The mechanically stable root of lowest density, if there are any
+    std::optional<DensityRoot> vapor_root() const {
+        for (const auto& r : roots){
+            if (r.stability != DensityRootStability::unstable){ return r; }
+        }
+        return std::nullopt;
+    }
+    /// The mechanically stable root of highest density, if there are any
+    std::optional<DensityRoot> liquid_root() const {
+        for (auto it = roots.rbegin(); it != roots.rend(); ++it){
+            if (it->stability != DensityRootStability::unstable){ return *it; }
+        }
+        return std::nullopt;
+    }
+};
+
+}
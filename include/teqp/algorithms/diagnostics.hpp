@@ -0,0 +1,246 @@
+#pragma once
+
+/**
+ Structured diagnostics of the tracers (critical locus, isotherms and isobars of binary mixtures).
+
+ Rather than printing to the console, the tracers emit typed records (TraceEvent) to an EventSink that is set in their
+ options. Two sinks are provided:
+
+ - RingBufferSink: a bounded lock-free queue that can be filled from many threads at once and drained by a consumer.
+   When the buffer is full, new events are dropped (and counted) rather than blocking the tracer.
+ - StreamSink: formats each event on one line of a std::ostream; this is what the tracers fall back to, writing to
+   std::cout, when no sink is set and the verbosity is high enough, so the previous console output is retained.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+namespace teqp {
+namespace diagnostics {
+
+enum class EventKind { step, step_rejected, polish_failure, integration_failure, termination };
+inline const char* get_name(EventKind k) {
+    static const char* names[] = { "step", "step_rejected", "polish_failure", "integration_failure", "termination" };
+    return names[static_cast<std::size_t>(k)];
+}
+
+enum class TerminationReason { none, max_steps, composition_out_of_range, polishing_failed, small_steps, integration_failure, pressure_limit, unstable, cancelled, deadline_expired };
+inline const char* get_name(TerminationReason r) {
+    static const char* names[] = { "none", "max_steps", "composition_out_of_range", "polishing_failed", "small_steps", "integration_failure", "pressure_limit", "unstable", "cancelled", "deadline_expired" };
+    return names[static_cast<std::size_t>(r)];
+}
+
+/**
+ A record emitted by a tracer. It is trivially copyable so that it can be moved through a lock-free queue; the message
+ is truncated to a fixed length.
+ */
+struct TraceEvent {
+    static constexpr std::size_t N_state = 4, message_length = 120;
+    static constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+
+    const char* tracer = ""; ///< The name of the tracer, a string literal
+    EventKind kind = EventKind::step;
+    TerminationReason reason = TerminationReason::none; ///< Only meaningful for termination events
+    int step = -1; ///< The index of the step
+    double t = nan, ///< The value of the tracing variable
+        dt = nan, ///< The current step size in the tracing variable
+        T = nan, ///< Temperature, in K
+        residual_norm = nan; ///< A measure of the residual at the state: the norm of the criticality conditions for the critical locus, \f$|p_L-p_V|\f$ in Pa for the VLE tracers
+    int N_used = 0; ///< The number of entries of the state that are used
+    std::array<double, N_state> state; ///< The molar concentrations, in mol/m^3: \f$(\rho_0, \rho_1)\f$ on the critical locus, \f$(\rho_{L,0}, \rho_{L,1}, \rho_{V,0}, \rho_{V,1})\f$ for the VLE tracers
+    std::array<char, message_length> message{};
+
+    TraceEvent() { state.fill(nan); }
+    TraceEvent(const char* tracer, EventKind kind, int step) : tracer(tracer), kind(kind), step(step) { state.fill(nan); }
+
+    /// Copy the molar concentrations into the state, starting at the given offset
+    template<typename Vec>
+    void set_state(const Vec& rhovec, std::size_t offset = 0) {
+        for (auto i = 0; i < rhovec.size() && offset + i < N_state; ++i) {
+            state[offset + i] = rhovec[i];
+        }
+        N_used = std::max(N_used, static_cast<int>(std::min<std::size_t>(N_state, offset + rhovec.size())));
+    }
+    void set_message(std::string_view msg) {
+        auto n = std::min(msg.size(), message_length - 1);
+        std::copy(msg.begin(), msg.begin() + n, message.begin());
+        message[n] = '\0';
+    }
+    std::string_view get_message() const { return std::string_view(message.data()); }
+};
+static_assert(std::is_trivially_copyable_v<TraceEvent>);
+
+inline nlohmann::json to_json(const TraceEvent& e) {
+    return {
+        {"tracer", e.tracer},
+        {"kind", get_name(e.kind)},
+        {"reason", get_name(e.reason)},
+        {"step", e.step},
+        {"t", e.t},
+        {"dt", e.dt},
+        {"T / K", e.T},
+        {"residual norm", e.residual_norm},
+        {"state", std::vector<double>(e.state.begin(), e.state.begin() + e.N_used)},
+        {"message", std::string(e.get_message())}
+    };
+}
+
+/// The interface of the receivers of the events; emit may be called concurrently from several threads
+class EventSink {
+public:
+    virtual void emit(const TraceEvent& e) = 0;
+    virtual ~EventSink() = default;
+};
+
+/**
+ A bounded multi-producer multi-consumer lock-free queue of events (after D. Vyukov), each cell carrying a sequence
+ number that tells producers and consumers whether it is free or filled
+ */
+class RingBufferSink : public EventSink {
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        TraceEvent event;
+    };
+    const std::size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    alignas(64) std::atomic<std::size_t> enqueue_pos{ 0 };
+    alignas(64) std::atomic<std::size_t> dequeue_pos{ 0 };
+    std::atomic<std::size_t> m_dropped{ 0 };
+
+    static std::size_t round_up_pow2(std::size_t n) {
+        std::size_t p = 2;
+        while (p < n) { p <<= 1; }
+        return p;
+    }
+public:
+    /// The capacity is rounded up to a power of two
+    RingBufferSink(std::size_t capacity = 1024) : mask(round_up_pow2(capacity) - 1), cells(new Cell[mask + 1]) {
+        for (std::size_t i = 0; i <= mask; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    std::size_t capacity() const { return mask + 1; }
+    /// The number of events that were dropped because the buffer was full
+    std::size_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /// Enqueue the event, or drop it if the buffer is full
+    bool try_push(const TraceEvent& e) {
+        auto pos = enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            auto seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.event = e;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Dequeue the oldest event, if any
+    bool try_pop(TraceEvent& e) {
+        auto pos = dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            auto seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    e = cell.event;
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void emit(const TraceEvent& e) override { try_push(e); }
+
+    /// Dequeue all the events currently in the buffer
+    std::vector<TraceEvent> drain() {
+        std::vector<TraceEvent> out;
+        TraceEvent e;
+        while (try_pop(e)) { out.push_back(e); }
+        return out;
+    }
+};
+
+/// Write each event as one line of text to a stream; the lines of concurrent tracers are not interleaved
+class StreamSink : public EventSink {
+private:
+    std::ostream& os;
+    std::mutex mtx;
+public:
+    StreamSink(std::ostream& os) : os(os) {}
+    void emit(const TraceEvent& e) override {
+        std::stringstream ss;
+        ss << "[" << e.tracer << "] " << get_name(e.kind) << " step " << e.step;
+        if (e.kind == EventKind::termination) {
+            ss << " (" << get_name(e.reason) << ")";
+        }
+        if (std::isfinite(e.T)) {
+            ss << "; T: " << e.T << "; state:";
+            for (auto i = 0; i < e.N_used; ++i) { ss << " " << e.state[i]; }
+        }
+        if (std::isfinite(e.dt)) { ss << "; dt: " << e.dt; }
+        if (std::isfinite(e.residual_norm)) { ss << "; residual: " << e.residual_norm; }
+        if (!e.get_message().empty()) { ss << "; " << e.get_message(); }
+        ss << "\n";
+        std::lock_guard<std::mutex> lock(mtx);
+        os << ss.str() << std::flush;
+    }
+};
+
+inline StreamSink& console_sink() {
+    static StreamSink sink(std::cout);
+    return sink;
+}
+
+/**
+ The sink that is to receive events of a given level of detail from a tracer: the sink of the options if one is set,
+ otherwise the console if the verbosity of the options exceeds the threshold, otherwise nullptr and the event need not be built
+ */
+template<typename Options>
+EventSink* get_sink(const Options& opt, int verbosity_threshold) {
+    if (opt.sink) {
+        return opt.sink.get();
+    }
+    if (opt.verbosity > verbosity_threshold) {
+        return &console_sink();
+    }
+    return nullptr;
+}
+
+}
+}
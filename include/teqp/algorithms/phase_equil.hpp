@@ -1,6 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <optional>
+#include <set>
+#include <string>
+#include <vector>
 #include "teqp/exceptions.hpp"
 #include "teqp/cpp/teqpcpp.hpp"
 
@@ -96,6 +103,8 @@ struct SpecificationSidecar{
 
 struct AbstractSpecification{
     virtual std::tuple<double, Eigen::ArrayXd> r_Jacobian(const Eigen::ArrayXd& x, const SpecificationSidecar& sidecar) const = 0;
+    /// True if the specification needs the caloric derivatives of the phases (and therefore the ideal-gas model)
+    virtual bool needs_caloric() const { return false; }
     virtual ~AbstractSpecification() = default;
 };
 /***
@@ -193,6 +202,7 @@ private:
     const double m_s_JmolK;
 public:
     MolarEntropySpecification(double s_JmolK) : m_s_JmolK(s_JmolK) {};
+    virtual bool needs_caloric() const override { return true; }
     
     virtual std::tuple<double, Eigen::ArrayXd> r_Jacobian(const Eigen::ArrayXd& x, const SpecificationSidecar& sidecar) const override {
         double T = x[0];
@@ -230,6 +240,7 @@ private:
     const double m_u_Jmol;
 public:
     MolarInternalEnergySpecification(double u_Jmol) : m_u_Jmol(u_Jmol) {};
+    virtual bool needs_caloric() const override { return true; }
     
     virtual std::tuple<double, Eigen::ArrayXd> r_Jacobian(const Eigen::ArrayXd& x, const SpecificationSidecar& sidecar) const override {
         double T = x[0];
@@ -268,6 +279,7 @@ private:
     const double m_h_Jmol;
 public:
     MolarEnthalpySpecification(double h_Jmol) : m_h_Jmol(h_Jmol) {};
+    virtual bool needs_caloric() const override { return true; }
     
     virtual std::tuple<double, Eigen::ArrayXd> r_Jacobian(const Eigen::ArrayXd& x, const SpecificationSidecar& sidecar) const override {
         double T = x[0];
@@ -298,6 +310,41 @@ public:
     };
 };
 
+/**
+ \brief Calculate the derivatives of a phase: the residual ones always, and the caloric ones if the ideal-gas model is provided
+ 
+ All the derivatives of each model are obtained together from one call to build_Psir_derivative_bundle_autodiff,
+ rather than one call for each derivative
+ */
+inline auto calculate_phase_derivatives(const AbstractModel& resid, const AbstractModel* idealgas, const double R, const double T, const Eigen::ArrayXd& rhovec){
+    RequiredPhaseDerivatives der;
+    der.rho = rhovec.sum();
+    der.R = R;
+    const auto r = resid.build_Psir_derivative_bundle_autodiff(T, rhovec);
+    der.Psir = r.Psir;
+    der.gradient_Psir = r.gradient;
+    der.Hessian_Psir = r.Hessian;
+    der.d_Psir_dT = r.dPsirdT;
+    der.d_gradient_Psir_dT = r.d2PsirdTdrhoi;
+    
+    std::optional<CaloricPhaseDerivatives> cal;
+    if (idealgas != nullptr){
+        CaloricPhaseDerivatives c;
+        c.rho = der.rho;
+        c.R = R;
+        // The ideal-gas model goes through the same machinery, its "residual" Helmholtz energy being the ideal-gas one
+        const auto ig = idealgas->build_Psir_derivative_bundle_autodiff(T, rhovec);
+        c.Psiig = ig.Psir;
+        c.d_Psiig_dT = ig.dPsirdT;
+        c.d2_Psiig_dT2 = ig.d2PsirdT2;
+        c.d2_Psir_dT2 = r.d2PsirdT2;
+        c.gradient_Psiig = ig.gradient;
+        c.d_gradient_Psiig_dT = ig.d2PsirdTdrhoi;
+        cal = c;
+    }
+    return std::make_tuple(der, cal);
+}
+
 /**
  
  */
@@ -411,25 +458,21 @@ public:
         const Eigen::Map<const Eigen::ArrayXd> betas(&x[x.size()-Nphases], Nphases);
         double R = residptr.get_R(zbulk); // TODO: think about what to do when the phases have different R values and dR/drho_i is nonzero
         
-        // Calculate the required derivatives for each phase
-        // based on its temperature and molar concentrations
-        auto calculate_required_derivatives = [this, R](auto& modelref, double T, const Eigen::ArrayXd& rhovec) -> RequiredPhaseDerivatives{
-            RequiredPhaseDerivatives der;
-            der.rho = rhovec.sum();
-            der.R = R;
-            // Three in one via tuple unpacking
-            std::tie(der.Psir, der.gradient_Psir, der.Hessian_Psir) = modelref.build_Psir_fgradHessian_autodiff(T, rhovec);
-            // And then the temperature derivatives
-            // Psir = ar*R*T*rho
-            // d(Psir)/dT = d(rho*alphar*R*T)/dT = rho*R*d(alphar*T)/dT = rho*R*(T*dalphar/dT + alphar) = rho*R*(T*dalphar/dT) + Psir/T
-            // and T*dalphar/dT = -Ar10 so
-            der.d_Psir_dT = der.rho*R*(-modelref.get_Ar10(T, der.rho, rhovec/der.rho)) + der.Psir/T;
-            der.d_gradient_Psir_dT = modelref.build_d2PsirdTdrhoi_autodiff(T, rhovec);
-            return der;
-        };
+        // Calculate the derivatives of each phase based on its temperature and molar concentrations, with
+        // the caloric ones only if any of the specification equations require them
+        bool need_caloric = std::any_of(specifications.begin(), specifications.end(), [](const auto& spec){ return spec->needs_caloric(); });
+        if (need_caloric && !idealgasptr){
+            throw teqp::InvalidArgument("Must have connected the ideal gas pointer");
+        }
+        const AbstractModel* idealgas = (need_caloric) ? idealgasptr.value().get() : nullptr;
         std::vector<RequiredPhaseDerivatives> derivatives;
+        std::vector<CaloricPhaseDerivatives> caloricderivatives;
         for (auto iphase_ = 0; iphase_ < Nphases; ++iphase_){
-            derivatives.emplace_back(calculate_required_derivatives(this->residptr, T, rhovecs[iphase_]));
+            auto [der, cal] = calculate_phase_derivatives(residptr, idealgas, R, T, rhovecs[iphase_]);
+            derivatives.emplace_back(std::move(der));
+            if (cal){
+                caloricderivatives.emplace_back(std::move(cal.value()));
+            }
         }
         
         // First we have the equalities in (natural) logarithm of fugacity coefficient (always present)
@@ -455,17 +498,11 @@ public:
             // And Ncomp entries in the first column (of index 0) in the Jacobian for the
             // temperature derivative
             J.block(irow, 0, Ncomp, 1) = dlnfdT_phase0 - dlnfdT_phasei;
-            // And in the rows in the Jacobian, there is a block for each phase,
-            // including the first one with index 0, and the correct block needs to be selected
-            // which for first phase is of positive sign, and elsewhere, of negative sign
-            for (auto iphasej = 0; iphasej < Ncomp; ++iphasej){
-                if (iphasej == 0){
-                    J.block(irow, 1+iphasej*Ncomp, Ncomp, Ncomp) = dlnfdrho_phase0;
-                }
-                else{
-                    J.block(irow, 1+iphasej*Ncomp, Ncomp, Ncomp) = -dlnfdrho_phasei;
-                }
-            }
+            // And in the rows in the Jacobian, there is a block for the first phase with index 0, of
+            // positive sign, and one for the phase with index iphasei, of negative sign; the other phases
+            // do not appear in these equalities
+            J.block(irow, 1, Ncomp, Ncomp) = dlnfdrho_phase0;
+            J.block(irow, 1+iphasei*Ncomp, Ncomp, Ncomp) = -dlnfdrho_phasei;
             irow += Ncomp;
         }
         
@@ -480,14 +517,8 @@ public:
             Eigen::ArrayXd dpdrho_phasei = derivatives[iphasei].dpdrhovec(T, rhovecs[iphasei]);
             r[irow] = p_phase0 - p_phasei;
             J(irow, 0) = dpdT_phase0 - dpdT_phasei;
-            for (auto iphasej = 0; iphasej < Nphases; ++iphasej){
-                if (iphasej == 0){
-                    J.block(irow, 1+iphasej*Ncomp, 1, Ncomp) = dpdrho_phase0.transpose();
-                }
-                else{
-                    J.block(irow, 1+iphasej*Ncomp, 1, Ncomp) = -dpdrho_phasei.transpose();
-                }
-            }
+            J.block(irow, 1, 1, Ncomp) = dpdrho_phase0.transpose();
+            J.block(irow, 1+iphasei*Ncomp, 1, Ncomp) = -dpdrho_phasei.transpose();
             // Note: no Jacobian contribution for derivatives w.r.t. betas
             irow += 1;
         }
@@ -523,32 +554,7 @@ public:
         sidecar.ptr_dpdT_phase0 = &dpdT_phase0;
         sidecar.ptr_dpdrho_phase0 = &dpdrho_phase0;
         
-        // If any of the specification equations require caloric properties, calculate them
-        // for all phases
-        auto calculate_caloric_derivatives = [this, R](auto& modelref, auto& modelresid, double T, const Eigen::ArrayXd& rhovec) -> CaloricPhaseDerivatives{
-            CaloricPhaseDerivatives der;
-            der.rho = rhovec.sum();
-            der.R = R;
-            auto molefracs = (rhovec/der.rho).eval();
-            der.Psiig = modelref.get_Ar00(T, der.rho, molefracs)*R*T*der.rho;
-            // And then the temperature derivatives
-            // Psir = ar*R*T*rho
-            // d(Psir)/dT = d(rho*alphar*R*T)/dT = rho*R*d(alphar*T)/dT = rho*R*(T*dalphar/dT + alphar)
-            // and T*dalphar/dT = -Ar10 so
-            der.d_Psiig_dT = der.rho*R*(-modelref.get_Ar10(T, der.rho, molefracs)) + der.Psiig/T;
-            // d^2(Psir)/dT^2 = rho*R*(T*d2alphar/dT2 + dalphar/dT + dalphar/dT) = rho*R*(T*d2alphar/dT2 + 2*dalphar/dT) = rho*R/T*(T^2*d2alphar/dT2 + 2*T*dalphar/dT)
-            // And from Eqs. 3.46 and 3.47 from Span we get A20 for the term in (...)
-            der.d2_Psiig_dT2 = der.rho*R/T*modelref.get_Ar20(T, der.rho, molefracs);
-            der.d2_Psir_dT2 = der.rho*R/T*modelresid.get_Ar20(T, der.rho, molefracs);
-            der.gradient_Psiig = modelref.build_Psir_gradient_autodiff(T, rhovec);
-            der.d_gradient_Psiig_dT = modelref.build_d2PsirdTdrhoi_autodiff(T, rhovec);
-            return der;
-        };
-        std::vector<CaloricPhaseDerivatives> caloricderivatives;
-        if (this->idealgasptr){
-            for (auto iphase_ = 0; iphase_ < Nphases; ++iphase_){
-                caloricderivatives.emplace_back(calculate_caloric_derivatives(*this->idealgasptr->get(), residptr,  T, rhovecs[iphase_]));
-            }
+        if (need_caloric){
             sidecar.derivatives = &derivatives;
             sidecar.caloricderivatives = &caloricderivatives;
         }
@@ -580,4 +586,433 @@ public:
     }
 };
 
+/// The options of the energy-specified flashes
+struct FlashOptions{
+    std::optional<double> T_guess; ///< The initial temperature; by default the reducing temperature of the mixture
+    std::optional<double> rho_liquid_guess; ///< The starting molar density of the liquid-like density roots; by default 2.5 times the reducing density of the mixture
+    std::size_t max_phases = 2; ///< The maximum number of phases in equilibrium
+    int max_iter = 100; ///< The maximum number of Newton iterations for a given number of phases
+    double xtol = 1e-10; ///< The relative tolerance on the Newton steps in the independent variables
+    int max_phase_changes = 8; ///< The maximum number of times a phase can be added or removed
+    int max_SS_iter = 100; ///< The maximum number of successive substitution iterations of the stability test and the initial two-phase split
+    double stability_tol = 1e-8; ///< The tangent plane distance below which a trial phase indicates instability
+};
+
+/// The record of the Newton iterations for one number of phases
+struct FlashAttempt{
+    std::size_t Nphases = 0; ///< The number of phases
+    int num_iter = 0; ///< The number of Newton iterations
+    bool converged = false; ///< True if the steps satisfied the tolerance
+    double max_abs_r = std::numeric_limits<double>::quiet_NaN(); ///< The largest absolute residual at the last iteration
+};
+
+/// The result of an energy-specified flash
+struct FlashResult{
+    bool success = false;
+    std::string message = "";
+    std::size_t Nphases = 0; ///< The number of phases in equilibrium
+    double T = -1; ///< Temperature, in K
+    double p = -1; ///< Pressure, in Pa
+    std::vector<Eigen::ArrayXd> rhovecs; ///< The molar concentrations of each phase
+    Eigen::ArrayXd betas; ///< The molar phase fractions
+    int num_iter = 0; ///< The total number of Newton iterations
+    int num_stability_tests = 0; ///< The number of stability tests
+    int num_phase_changes = 0; ///< The number of times a phase was added or removed
+    std::vector<FlashAttempt> attempts; ///< The Newton iterations for each number of phases tried, in order
+};
+
+namespace detail{
+
+/**
+ \brief Solve for the molar density at given temperature, pressure and mole fractions
+ 
+ Newton iterations in \f$\ln\rho\f$, starting from a liquid-like or vapor-like density; NaN is returned if no mechanically stable root was found
+ */
+inline double get_rho_Tp(const AbstractModel& model, const double T, const double p, const Eigen::ArrayXd& x, const double rho0, const bool liquid, const int maxiter = 100){
+    const double R = model.get_R(x);
+    double lnrho = log(rho0);
+    for (auto iter = 0; iter < maxiter; ++iter){
+        double rho = exp(lnrho);
+        auto A = model.get_Ar02n(T, rho, x); // Ar00, Ar01 and Ar02 in one pass
+        double pcalc = rho*R*T*(1 + A[1]);
+        double dpdrho = R*T*(1 + 2*A[1] + A[2]);
+        if (!std::isfinite(pcalc) || !std::isfinite(dpdrho)){
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        if (dpdrho <= 0){
+            // Mechanically unstable; move away towards the side of the root being sought
+            lnrho += (liquid) ? 0.1 : -0.1;
+            continue;
+        }
+        double step = std::clamp(-(pcalc - p)/(rho*dpdrho), -1.0, 1.0);
+        lnrho += step;
+        if (std::abs(step) < 1e-12){
+            return exp(lnrho);
+        }
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+/// A density root at given temperature and pressure
+struct TpRoot{
+    double rho = std::numeric_limits<double>::quiet_NaN(); ///< Molar density
+    Eigen::ArrayXd lnphi; ///< The logarithms of the fugacity coefficients
+    double g = std::numeric_limits<double>::infinity(); ///< \f$\sum_i x_i\ln(x_i\varphi_i)\f$, the molar Gibbs energy up to a constant
+    bool found() const { return std::isfinite(rho); }
+};
+
+inline TpRoot make_root(const AbstractModel& model, const double T, const double rho, const Eigen::ArrayXd& x){
+    TpRoot root;
+    root.rho = rho;
+    root.lnphi = log(model.get_fugacity_coefficients(T, (rho*x).eval()));
+    root.g = (x > 0).select(x*(log(x) + root.lnphi), 0.0).sum();
+    return root;
+}
+
+/// The density root with the lowest Gibbs energy of the liquid-like and vapor-like ones
+inline TpRoot get_stable_root_Tp(const AbstractModel& model, const double T, const double p, const Eigen::ArrayXd& x, const FlashOptions& opt){
+    TpRoot best;
+    double rhoV0 = p/(model.get_R(x)*T);
+    double rhoL0 = opt.rho_liquid_guess.value_or(2.5*model.get_reducing_density(x));
+    for (auto [rho0, liquid] : {std::make_tuple(rhoV0, false), std::make_tuple(rhoL0, true)}){
+        double rho = get_rho_Tp(model, T, p, x, rho0, liquid);
+        if (std::isfinite(rho)){
+            auto root = make_root(model, T, rho, x);
+            if (root.g < best.g){
+                best = root;
+            }
+        }
+    }
+    return best;
+}
+
+/// The result of the tangent plane stability test
+struct StabilityResult{
+    bool stable = true;
+    double tm_min = 0; ///< The smallest modified tangent plane distance of the trial phases
+    Eigen::ArrayXd x; ///< The mole fractions of the most unstable trial phase
+    double rho = std::numeric_limits<double>::quiet_NaN(); ///< The molar density of the most unstable trial phase
+};
+
+/**
+ \brief Tangent plane stability test of a phase at given temperature and pressure, after Michelsen
+ 
+ The trial phases are initialized with K values from the liquid-like and vapor-like density roots of the tested composition
+ if both exist, and with nearly pure components, and converged by successive substitution
+ */
+inline StabilityResult stability_test(const AbstractModel& model, const double T, const double p, const Eigen::ArrayXd& z, const TpRoot& ref, const FlashOptions& opt){
+    const auto N = z.size();
+    Eigen::ArrayXd d = log(z) + ref.lnphi;
+    
+    std::vector<Eigen::ArrayXd> trials;
+    double rhoL = get_rho_Tp(model, T, p, z, opt.rho_liquid_guess.value_or(2.5*model.get_reducing_density(z)), true);
+    double rhoV = get_rho_Tp(model, T, p, z, p/(model.get_R(z)*T), false);
+    if (std::isfinite(rhoL) && std::isfinite(rhoV) && std::abs(rhoL/rhoV - 1) > 1e-6){
+        Eigen::ArrayXd K = exp(make_root(model, T, rhoL, z).lnphi - make_root(model, T, rhoV, z).lnphi);
+        trials.push_back(z*K);
+        trials.push_back(z/K);
+    }
+    for (auto i = 0; i < N; ++i){
+        Eigen::ArrayXd W = Eigen::ArrayXd::Constant(N, 1e-3); W[i] = 1.0;
+        trials.push_back(W);
+    }
+    
+    StabilityResult result;
+    for (auto W : trials){
+        TpRoot root;
+        bool converged = false;
+        for (auto iter = 0; iter < opt.max_SS_iter; ++iter){
+            Eigen::ArrayXd x = W/W.sum();
+            root = get_stable_root_Tp(model, T, p, x, opt);
+            if (!root.found()){
+                break;
+            }
+            Eigen::ArrayXd lnWnew = d - root.lnphi;
+            double change = (lnWnew - log(W)).abs().maxCoeff();
+            W = exp(lnWnew);
+            if (change < 1e-10){
+                converged = true;
+                break;
+            }
+        }
+        if (!root.found() || !W.allFinite()){
+            continue;
+        }
+        Eigen::ArrayXd x = W/W.sum();
+        if ((x - z).abs().maxCoeff() < 1e-5){
+            continue; // The trivial solution
+        }
+        // At the stationary point ln(W) = d - ln(phi), so the modified tangent plane distance is 1 - sum(W)
+        double tm = (converged) ? 1 - W.sum() : 1 + (W*(log(W) + root.lnphi - d - 1)).sum();
+        if (tm < result.tm_min){
+            result.tm_min = tm;
+            result.x = x;
+            result.rho = root.rho;
+        }
+    }
+    result.stable = !(result.tm_min < -opt.stability_tol);
+    return result;
+}
+
+/// Solve the Rachford-Rice equation for the molar fraction of the phase with mole fractions K*x, limited to [0,1]
+inline double rachford_rice(const Eigen::ArrayXd& z, const Eigen::ArrayXd& K){
+    double Kmax = K.maxCoeff(), Kmin = K.minCoeff();
+    if (Kmax <= 1){ return 0.0; }
+    if (Kmin >= 1){ return 1.0; }
+    auto f = [&](double beta){ return (z*(K-1)/(1+beta*(K-1))).sum(); };
+    auto dfdbeta = [&](double beta){ return -(z*(K-1).square()/(1+beta*(K-1)).square()).sum(); };
+    // f decreases monotonically between the asymptotes
+    double lo = std::max(1/(1-Kmax), -10.0), hi = std::min(1/(1-Kmin), 10.0);
+    double beta = 0.5*(std::max(lo, 0.0) + std::min(hi, 1.0));
+    for (auto iter = 0; iter < 100; ++iter){
+        double fval = f(beta);
+        if (fval > 0){ lo = beta; } else { hi = beta; }
+        double betanew = beta - fval/dfdbeta(beta);
+        if (!(betanew > lo && betanew < hi)){
+            betanew = 0.5*(lo + hi); // Bisection if Newton leaves the bracket
+        }
+        if (std::abs(betanew - beta) < 1e-14){
+            beta = betanew;
+            break;
+        }
+        beta = betanew;
+    }
+    return std::clamp(beta, 0.0, 1.0);
+}
+
+/**
+ \brief The initial state for the flashes: the stable single phase at the given temperature and pressure, or, if that is unstable,
+ the two-phase split obtained by successive substitution from the K values of the stationary point of the stability test
+ */
+inline auto initial_Tp_state(const AbstractModel& model, const double T, const double p, const Eigen::ArrayXd& z, const FlashOptions& opt, FlashResult& result){
+    using UnpackedVariables = GeneralizedPhaseEquilibrium::UnpackedVariables;
+    auto ref = get_stable_root_Tp(model, T, p, z, opt);
+    if (!ref.found()){
+        throw teqp::IterationError("No density root was found for the feed at T=" + std::to_string(T) + " K and p=" + std::to_string(p) + " Pa");
+    }
+    UnpackedVariables single(T, {(ref.rho*z).eval()}, Eigen::ArrayXd::Ones(1));
+    if (opt.max_phases < 2){
+        return single;
+    }
+    auto stab = stability_test(model, T, p, z, ref, opt);
+    result.num_stability_tests++;
+    if (stab.stable){
+        return single;
+    }
+    
+    Eigen::ArrayXd K = stab.x/z;
+    double beta = 0.5;
+    Eigen::ArrayXd x0 = z, x1 = stab.x;
+    TpRoot root0 = ref, root1 = make_root(model, T, stab.rho, stab.x);
+    for (auto iter = 0; iter < opt.max_SS_iter; ++iter){
+        beta = rachford_rice(z, K);
+        x0 = z/(1 + beta*(K-1)); x0 /= x0.sum();
+        x1 = K*x0; x1 /= x1.sum();
+        auto r0 = get_stable_root_Tp(model, T, p, x0, opt), r1 = get_stable_root_Tp(model, T, p, x1, opt);
+        if (!r0.found() || !r1.found()){
+            break;
+        }
+        root0 = r0; root1 = r1;
+        Eigen::ArrayXd Knew = exp(root0.lnphi - root1.lnphi);
+        double change = (log(Knew) - log(K)).abs().maxCoeff();
+        K = Knew;
+        if (change < 1e-8){
+            break;
+        }
+    }
+    if ((x0 - x1).abs().maxCoeff() < 1e-6 && std::abs(root0.rho/root1.rho - 1) < 1e-6){
+        return single; // Collapsed onto the trivial solution
+    }
+    return UnpackedVariables(T, {(root0.rho*x0).eval(), (root1.rho*x1).eval()}, (Eigen::ArrayXd(2) << 1-beta, beta).finished());
+}
+
+/// Newton iterations of the generalized phase equilibrium, with the steps limited to keep the temperature and the molar concentrations positive
+inline auto newton(GeneralizedPhaseEquilibrium& gpe, Eigen::ArrayXd& x, const FlashOptions& opt){
+    FlashAttempt attempt;
+    attempt.Nphases = gpe.Nphases;
+    const auto Nrho = gpe.Ncomponents*gpe.Nphases;
+    for (auto iter = 0; iter < opt.max_iter; ++iter){
+        gpe.call(x);
+        attempt.num_iter++;
+        attempt.max_abs_r = gpe.res.r.cwiseAbs().maxCoeff();
+        if (!gpe.res.r.allFinite()){
+            break;
+        }
+        Eigen::ArrayXd dx = gpe.res.J.colPivHouseholderQr().solve(-gpe.res.r).array();
+        if (!dx.allFinite()){
+            break;
+        }
+        double lambda = 1.0;
+        if (x[0] + dx[0] < 0.5*x[0]){
+            lambda = std::min(lambda, -0.5*x[0]/dx[0]);
+        }
+        for (auto i = 1; i < 1 + Nrho; ++i){
+            if (x[i] + dx[i] < 0.1*x[i]){
+                lambda = std::min(lambda, -0.9*x[i]/dx[i]);
+            }
+        }
+        x += lambda*dx;
+        if (lambda == 1.0 && (dx.abs() <= opt.xtol*(1 + x.abs())).all()){
+            attempt.converged = true;
+            break;
+        }
+    }
+    return attempt;
+}
+
+/**
+ \brief The driver of the energy-specified flashes
+ 
+ Starting from the split at the initial temperature and pressure, the equilibrium with the specifications is solved for with Newton
+ iterations on all the variables together. A phase whose molar fraction ends up negative (or the least abundant one if the iterations
+ fail) is removed, and a phase is added from the stationary point of the stability test of a converged state that is unstable, until a
+ converged and stable state is reached
+ */
+inline FlashResult energy_flash(const AbstractModel& model, const std::shared_ptr<const AbstractModel>& idealgas, const Eigen::ArrayXd& z, const std::vector<std::shared_ptr<AbstractSpecification>>& specs, const std::function<double(double)>& get_p_init, const std::optional<FlashOptions>& options){
+    using UnpackedVariables = GeneralizedPhaseEquilibrium::UnpackedVariables;
+    auto opt = options.value_or(FlashOptions{});
+    if (!idealgas){
+        throw teqp::InvalidArgument("The ideal-gas model is required for the energy-specified flashes");
+    }
+    if (z.size() == 0 || (z <= 0).any() || std::abs(z.sum() - 1) > 1e-10){
+        throw teqp::InvalidArgument("The feed mole fractions must be positive and sum to one");
+    }
+    if (opt.max_phases < 1){
+        throw teqp::InvalidArgument("max_phases must be at least 1");
+    }
+    FlashResult result;
+    double T0 = opt.T_guess.value_or(model.get_reducing_temperature(z));
+    auto init = initial_Tp_state(model, T0, get_p_init(T0), z, opt, result);
+    // The starting point of the current number of phases
+    double T = init.T;
+    std::vector<Eigen::ArrayXd> rhovecs = init.rhovecs;
+    Eigen::ArrayXd betas = init.betas;
+    
+    for (auto ichange = 0; ; ++ichange){
+        GeneralizedPhaseEquilibrium gpe(model, z, UnpackedVariables(T, rhovecs, betas), specs);
+        gpe.attach_ideal_gas(idealgas);
+        Eigen::ArrayXd x = UnpackedVariables(T, rhovecs, betas).pack();
+        auto attempt = newton(gpe, x, opt);
+        result.attempts.push_back(attempt);
+        result.num_iter += attempt.num_iter;
+        
+        const auto Nphases = gpe.Nphases, Ncomp = gpe.Ncomponents;
+        if (attempt.converged){
+            T = x[0];
+            for (auto iphase = 0; iphase < Nphases; ++iphase){
+                rhovecs[iphase] = x.segment(1 + iphase*Ncomp, Ncomp);
+            }
+            betas = x.tail(Nphases);
+        }
+        // Otherwise restart from the previous starting point, which is still physical
+        
+        auto remove_phase = [&](Eigen::Index iremove){
+            rhovecs.erase(rhovecs.begin() + iremove);
+            Eigen::ArrayXd betas_(Nphases-1);
+            for (auto iphase = 0, j = 0; iphase < Nphases; ++iphase){
+                if (iphase != iremove){
+                    betas_[j++] = std::max(betas[iphase], 0.0);
+                }
+            }
+            betas = (betas_.sum() > 0) ? (betas_/betas_.sum()).eval() : Eigen::ArrayXd::Constant(Nphases-1, 1.0/(Nphases-1)).eval();
+            result.num_phase_changes++;
+        };
+        
+        if (ichange >= opt.max_phase_changes){
+            result.message = "Maximum number of phase changes reached";
+            break;
+        }
+        Eigen::Index imin;
+        betas.minCoeff(&imin);
+        if (!attempt.converged){
+            if (Nphases > 1){
+                remove_phase(imin); // Try again without the least abundant phase
+                continue;
+            }
+            result.message = "Newton iterations did not converge";
+            break;
+        }
+        if (Nphases > 1 && betas[imin] < 0){
+            remove_phase(imin);
+            continue;
+        }
+        
+        // Converged; the phases are in equilibrium with each other, so the stability of the first one is that of all of them
+        double rho0 = rhovecs[0].sum();
+        Eigen::ArrayXd x0 = rhovecs[0]/rho0;
+        double p = rho0*model.get_R(x0)*T*(1 + model.get_Ar01(T, rho0, x0));
+        if (Nphases < opt.max_phases){
+            auto stab = stability_test(model, T, p, x0, make_root(model, T, rho0, x0), opt);
+            result.num_stability_tests++;
+            if (!stab.stable){
+                rhovecs.push_back((stab.rho*stab.x).eval());
+                Eigen::ArrayXd betas_ = Eigen::ArrayXd::Zero(Nphases+1);
+                betas_.head(Nphases) = betas;
+                betas = betas_;
+                result.num_phase_changes++;
+                continue;
+            }
+        }
+        result.success = true;
+        result.Nphases = Nphases;
+        result.T = T;
+        result.p = p;
+        result.rhovecs = rhovecs;
+        result.betas = betas;
+        break;
+    }
+    return result;
+}
+
+}
+
+/**
+ \brief Flash at given pressure and molar enthalpy
+ \param model The model for the residual portion of the Helmholtz energy
+ \param idealgas The model for the ideal-gas portion of the Helmholtz energy
+ \param z The mole fractions of the feed
+ \param p Pressure, in Pa
+ \param h Molar enthalpy, in J/mol
+ \param options The options of the flash
+ */
+inline auto flash_PH(const AbstractModel& model, const std::shared_ptr<const AbstractModel>& idealgas, const Eigen::ArrayXd& z, const double p, const double h, const std::optional<FlashOptions>& options = std::nullopt){
+    std::vector<std::shared_ptr<AbstractSpecification>> specs = {std::make_shared<PSpecification>(p), std::make_shared<MolarEnthalpySpecification>(h)};
+    return detail::energy_flash(model, idealgas, z, specs, [p](double){ return p; }, options);
+}
+
+/**
+ \brief Flash at given pressure and molar entropy
+ \param model The model for the residual portion of the Helmholtz energy
+ \param idealgas The model for the ideal-gas portion of the Helmholtz energy
+ \param z The mole fractions of the feed
+ \param p Pressure, in Pa
+ \param s Molar entropy, in J/mol/K
+ \param options The options of the flash
+ */
+inline auto flash_PS(const AbstractModel& model, const std::shared_ptr<const AbstractModel>& idealgas, const Eigen::ArrayXd& z, const double p, const double s, const std::optional<FlashOptions>& options = std::nullopt){
+    std::vector<std::shared_ptr<AbstractSpecification>> specs = {std::make_shared<PSpecification>(p), std::make_shared<MolarEntropySpecification>(s)};
+    return detail::energy_flash(model, idealgas, z, specs, [p](double){ return p; }, options);
+}
+
+/**
+ \brief Flash at given molar internal energy and molar volume
+ \param model The model for the residual portion of the Helmholtz energy
+ \param idealgas The model for the ideal-gas portion of the Helmholtz energy
+ \param z The mole fractions of the feed
+ \param u Molar internal energy, in J/mol
+ \param v Molar volume, in m^3/mol
+ \param options The options of the flash
+ 
+ The initial split is made at the pressure of the homogeneous feed at the specified volume and the initial temperature
+ */
+inline auto flash_UV(const AbstractModel& model, const std::shared_ptr<const AbstractModel>& idealgas, const Eigen::ArrayXd& z, const double u, const double v, const std::optional<FlashOptions>& options = std::nullopt){
+    std::vector<std::shared_ptr<AbstractSpecification>> specs = {std::make_shared<MolarInternalEnergySpecification>(u), std::make_shared<MolarVolumeSpecification>(v)};
+    auto get_p_init = [&model, &z, v](double T){
+        double p = 1/v*model.get_R(z)*T*(1 + model.get_Ar01(T, 1/v, z));
+        // In the liquid-vapor dome the homogeneous pressure can be negative; use that of the ideal gas then
+        return (std::isfinite(p) && p > 0) ? p : 1/v*model.get_R(z)*T;
+    };
+    return detail::energy_flash(model, idealgas, z, specs, get_p_init, options);
+}
+
 }
@@ -7,6 +7,7 @@
 #include "teqp/cpp/teqpcpp.hpp"
 #include "teqp/exceptions.hpp"
 #include "teqp/math/pow_templates.hpp"
+#include "teqp/algorithms/cancellation.hpp"
 
 #include <boost/asio/thread_pool.hpp>
 #include <boost/asio/post.hpp>
@@ -203,6 +204,8 @@ public:
     const nlohmann::json jbase;
     std::vector<std::vector<nlohmann::json::json_pointer>> pointers;
     std::vector<PureOptimizationContribution> contributions;
+    std::optional<CancellationToken> cancellation; ///< If set and cancelled, the evaluation of the cost function stops with an IterationFailure
+    std::optional<Deadline> deadline; ///< If set and expired, the evaluation of the cost function stops with an IterationFailure
     
     PureParameterOptimizer(const nlohmann::json jbase, const std::vector<std::variant<std::string, std::vector<std::string>>>& pointerstrs) : jbase(jbase), pointers(make_pointers(pointerstrs)){}
     
@@ -238,13 +241,22 @@ public:
         return std::make_tuple(std::move(model), helpers);
     }
     
+    /// Throw if the optimization has been cancelled or its deadline has expired, so that the optimizer driving the cost function stops
+    void throw_if_interrupted() const {
+        if (auto reason = check_interruption(cancellation, deadline); reason != diagnostics::TerminationReason::none){
+            throw teqp::IterationFailure(std::string("Evaluation of the cost function was interrupted: ") + diagnostics::get_name(reason));
+        }
+    }
+    
     template<typename T>
     auto cost_function(const T& x) const{
+        throw_if_interrupted();
         const auto [_model, _helpers] = prepare(x);
         const auto& model = _model;
         const auto& helpers = _helpers;
         double cost = 0.0;
         for (const auto& contrib : contributions){
+            throw_if_interrupted();
             cost += std::visit([&model](const auto& c){ return c.calculate_contribution(model); }, contrib);
         }
         if (!std::isfinite(cost)){
@@ -255,6 +267,7 @@ public:
     
     template<typename T>
     auto cost_function_threaded(const T& x, std::size_t Nthreads) {
+        throw_if_interrupted();
         boost::asio::thread_pool pool{Nthreads}; // Nthreads in the pool
         const auto [_model, _helpers] = prepare(x);
         const auto& model = _model;
@@ -263,7 +276,9 @@ public:
         std::size_t i = 0;
         for (const auto& contrib : contributions){
             auto& dest = buffer[i];
-            auto payload = [&model, &dest, contrib] (){
+            auto payload = [this, &model, &dest, contrib] (){
+                // Contributions that have not started when the optimization is interrupted are skipped
+                if (check_interruption(cancellation, deadline) != diagnostics::TerminationReason::none){ return; }
                 dest = std::visit([&model](const auto& c){ return c.calculate_contribution(model); }, contrib);
                 if (!std::isfinite(dest)){ dest = 1e30; }
             };
@@ -271,6 +286,7 @@ public:
             i++;
         }
         pool.join();
+        throw_if_interrupted();
         double summer = 0.0;
         for (auto i = 0; i < contributions.size(); ++i){
 //            std::cout << buffer[i] << std::endl;
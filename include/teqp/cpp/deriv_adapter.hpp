@@ -1,6 +1,9 @@
 #pragma once
 
 #include "teqp/derivs.hpp"
+#include "teqp/ensemble.hpp"
+#include "teqp/screening.hpp"
+#include "teqp/virial_fastpath.hpp"
 #include "teqp/cpp/teqpcpp.hpp"
 #include "teqp/exceptions.hpp"
 
@@ -107,6 +110,8 @@ template<typename ModelPack>
 class DerivativeAdapter : public teqp::cppinterface::AbstractModel{
 private:
     ModelPack mp;
+    using FastPath = VirialFastPath<std::decay_t<decltype(std::declval<const ModelPack&>().get_cref())>>;
+    std::optional<FastPath> virial_fastpath;
 public:
     auto& get_ModelPack_ref(){ return mp; }
     const auto& get_ModelPack_cref() const { return mp; }
@@ -128,24 +133,38 @@ public:
         return mp.get_cref().R(molefrac);
     };
     
+    virtual void enable_virial_fastpath(const double Tmin, const double Tmax, const EArrayd& molefrac, const std::optional<VirialFastPathOptions>& opt) override {
+        virial_fastpath.reset();
+        virial_fastpath.emplace(mp.get_cref(), molefrac, Tmin, Tmax, opt.value_or(VirialFastPathOptions{}));
+    }
+    virtual void disable_virial_fastpath() override {
+        virial_fastpath.reset();
+    }
+    
     virtual double get_Arxy(const int NT, const int ND, const double T, const double rhomolar, const EArrayd& molefrac) const override{
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
+        if (virial_fastpath && molefrac.size() == virial_fastpath->molefrac.size() && (molefrac == virial_fastpath->molefrac).all()){
+            // Falls back to the model itself when the state point is not in the range of the series
+            return virial_fastpath->get_Arxy(NT, ND, T, rhomolar).value;
+        }
         return TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_Ar(NT, ND, mp.get_cref(), T, rhomolar, molefrac);
     };
     
     // Here X-Macros are used to create functions like get_Ar00, get_Ar01, ....
-#define X(i,j) virtual double get_Ar ## i ## j(const double T, const double rho, const REArrayd& molefrac) const  override { return TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::template get_Arxy<i,j>(mp.get_cref(), T, rho, molefrac); };
+#define X(i,j) virtual double get_Ar ## i ## j(const double T, const double rho, const REArrayd& molefrac) const  override { TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass); return TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::template get_Arxy<i,j>(mp.get_cref(), T, rho, molefrac); };
     ARXY_args
 #undef X
     // And like get_Ar01n, get_Ar02n, ....
-#define X(i) virtual EArrayd get_Ar0 ## i ## n(const double T, const double rho, const REArrayd& molefrac) const  override { auto vals = TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::template get_Ar0n<i>(mp.get_cref(), T, rho, molefrac); return Eigen::Map<Eigen::ArrayXd>(&(vals[0]), vals.size()); };
+#define X(i) virtual EArrayd get_Ar0 ## i ## n(const double T, const double rho, const REArrayd& molefrac) const  override { TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass); auto vals = TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::template get_Ar0n<i>(mp.get_cref(), T, rho, molefrac); return Eigen::Map<Eigen::ArrayXd>(&(vals[0]), vals.size()); };
     AR0N_args
 #undef X
     // And like get_Ar10n, get_Ar20n, ....
-#define X(i) virtual EArrayd get_Ar ## i ## 0n(const double T, const double rho, const REArrayd& molefrac) const  override { auto vals = TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::template get_Arn0<i>(mp.get_cref(), T, rho, molefrac); return Eigen::Map<Eigen::ArrayXd>(&(vals[0]), vals.size()); };
+#define X(i) virtual EArrayd get_Ar ## i ## 0n(const double T, const double rho, const REArrayd& molefrac) const  override { TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass); auto vals = TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::template get_Arn0<i>(mp.get_cref(), T, rho, molefrac); return Eigen::Map<Eigen::ArrayXd>(&(vals[0]), vals.size()); };
     ARN0_args
 #undef X
     
     virtual double get_Ar01ep(const double T, const double rho, const EArrayd& molefrac) const  override {
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
         using namespace boost::multiprecision;
         using my_float_t = number<cpp_bin_float<100U>>;
         auto f = [&](const auto& rhoep){
@@ -154,6 +173,7 @@ public:
         return rho*static_cast<double>(centered_diff<1,4>(f, static_cast<my_float_t>(rho), 1e-16*static_cast<my_float_t>(rho)));
     }
     virtual double get_Ar02ep(const double T, const double rho, const EArrayd& molefrac) const  override {
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
         using namespace boost::multiprecision;
         using my_float_t = number<cpp_bin_float<100U>>;
         auto f = [&](const auto& rhoep){
@@ -162,6 +182,7 @@ public:
         return rho*rho*static_cast<double>(centered_diff<2,4>(f, static_cast<my_float_t>(rho), 1e-16*static_cast<my_float_t>(rho)));
     }
     virtual double get_Ar03ep(const double T, const double rho, const EArrayd& molefrac) const  override {
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
         using namespace boost::multiprecision;
         using my_float_t = number<cpp_bin_float<100U>>;
         auto f = [&](const auto& rhoep){
@@ -191,60 +212,128 @@ public:
     
     // Virial derivatives
     virtual double get_B2vir(const double T, const EArrayd& z) const override {
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
         return VirialDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_B2vir(mp.get_cref(), T, z);
     };
     virtual std::map<int, double> get_Bnvir(const int Nderiv, const double T, const EArrayd& z) const override {
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
         return VirialDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_Bnvir_runtime(Nderiv, mp.get_cref(), T, z);
     };
     virtual double get_B12vir(const double T, const EArrayd& z) const override {
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
         return VirialDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_B12vir(mp.get_cref(), T, z);
     };
     virtual double get_dmBnvirdTm(const int Nderiv, const int NTderiv, const double T, const EArrayd& molefrac) const override {
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
         return VirialDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_dmBnvirdTm_runtime(Nderiv, NTderiv, mp.get_cref(), T, molefrac);
     };
     
     // Composition derivatives with temperature and density as the working variables
     virtual double get_ATrhoXi(const double T, const int NT, const double rhomolar, const int ND, const EArrayd& molefrac, const int i, const int NXi) const override {
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
         return TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_ATrhoXi_runtime(mp.get_cref(), T, NT, rhomolar, ND, molefrac, i, NXi);
     };
     virtual double get_ATrhoXiXj(const double T, const int NT, const double rhomolar, const int ND, const EArrayd& molefrac, const int i, const int NXi, const int j, const int NXj) const override {
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
         return TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_ATrhoXiXj_runtime(mp.get_cref(), T, NT, rhomolar, ND, molefrac, i, NXi, j, NXj);
     };
     virtual double get_ATrhoXiXjXk(const double T, const int NT, const double rhomolar, const int ND, const EArrayd& molefrac, const int i, const int NXi, const int j, const int NXj, const int k, const int NXk) const override {
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
         return TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_ATrhoXiXjXk_runtime(mp.get_cref(), T, NT, rhomolar, ND, molefrac, i, NXi, j, NXj, k, NXk);
     };
     
     // Composition derivatives with tau and delta as the working variables
     virtual double get_AtaudeltaXi(const double tau, const int NT, const double delta, const int ND, const EArrayd& molefrac, const int i, const int NXi) const override {
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
         return TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_AtaudeltaXi_runtime(mp.get_cref(), tau, NT, delta, ND, molefrac, i, NXi);
     };
     virtual double get_AtaudeltaXiXj(const double tau, const int NT, const double delta, const int ND, const EArrayd& molefrac, const int i, const int NXi, const int j, const int NXj) const override {
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
         return TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_AtaudeltaXiXj_runtime(mp.get_cref(), tau, NT, delta, ND, molefrac, i, NXi, j, NXj);
     };
     virtual double get_AtaudeltaXiXjXk(const double tau, const int NT, const double delta, const int ND, const EArrayd& molefrac, const int i, const int NXi, const int j, const int NXj, const int k, const int NXk) const override {
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
         return TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_AtaudeltaXiXjXk_runtime(mp.get_cref(), tau, NT, delta, ND, molefrac, i, NXi, j, NXj, k, NXk);
     };
     
     // Derivatives from isochoric thermodynamics (all have the same signature within each block), and they differ by their output argument
-#define X(f) virtual double f(const double T, const EArrayd& rhovec) const override { return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::f(mp.get_cref(), T, rhovec); };
+#define X(f) virtual double f(const double T, const EArrayd& rhovec) const override { TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass); return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::f(mp.get_cref(), T, rhovec); };
     ISOCHORIC_double_args
 #undef X
-#define X(f) virtual EArrayd f(const double T, const EArrayd& rhovec) const override { return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::f(mp.get_cref(), T, rhovec); };
+#define X(f) virtual EArrayd f(const double T, const EArrayd& rhovec) const override { TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass); return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::f(mp.get_cref(), T, rhovec); };
     ISOCHORIC_array_args
 #undef X
-#define X(f) virtual EMatrixd f(const double T, const EArrayd& rhovec) const override { return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::f(mp.get_cref(), T, rhovec); };
+#define X(f) virtual EMatrixd f(const double T, const EArrayd& rhovec) const override { TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass); return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::f(mp.get_cref(), T, rhovec); };
     ISOCHORIC_matrix_args
 #undef X
-#define X(f) virtual std::tuple<double, Eigen::ArrayXd, Eigen::MatrixXd> f(const double T, const EArrayd& rhovec) const override { return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::f(mp.get_cref(), T, rhovec); };
+#define X(f) virtual std::tuple<double, Eigen::ArrayXd, Eigen::MatrixXd> f(const double T, const EArrayd& rhovec) const override { TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass); return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::f(mp.get_cref(), T, rhovec); };
     ISOCHORIC_multimatrix_args
 #undef X
+    virtual IsochoricDerivativeBundle build_Psir_derivative_bundle_autodiff(const double T, const EArrayd& rhovec) const override{
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
+        return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::build_Psir_derivative_bundle_autodiff(mp.get_cref(), T, rhovec);
+    };
     virtual Eigen::ArrayXd get_Psir_sigma_derivs(const double T, const EArrayd& rhovec, const EArrayd& v) const override{
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
         return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_Psir_sigma_derivs(mp.get_cref(), T, rhovec, v);
     };
+    virtual double get_Psir_vector_Hessian_vector_product_autodiff(const double T, const EArrayd& rhovec, const EArrayd& u, const EArrayd& v) const override{
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
+        return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_Psir_vector_Hessian_vector_product_autodiff(mp.get_cref(), T, rhovec, u, v);
+    };
+    virtual Eigen::ArrayXd build_Psir_Hessian_vector_product_autodiff(const double T, const EArrayd& rhovec, const EArrayd& v) const override{
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
+        return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::build_Psir_Hessian_vector_product_autodiff(mp.get_cref(), T, rhovec, v);
+    };
     
     virtual EArray33d get_deriv_mat2(const double T, double rho, const EArrayd& z ) const override {
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
         return DerivativeHolderSquare<2>(mp.get_cref(), T, rho, z).derivs;
     };
+    
+    // Ensemble evaluations over many sets of parameters
+    virtual EArrayd get_ensemble_parameters() const override {
+        using Model = std::decay_t<decltype(mp.get_cref())>;
+        if constexpr(EnsembleCapable<Model>){
+            return mp.get_cref().get_ensemble_parameters();
+        }
+        else{
+            throw teqp::NotImplementedError("Cannot call get_ensemble_parameters of a class that doesn't support ensemble evaluation");
+        }
+    }
+    virtual EArrayd get_Arxy_ensemble(const int NT, const int ND, const double T, const double rho, const REArrayd& molefrac, const Eigen::Ref<const Eigen::MatrixXd>& parameters) const override {
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
+        using Model = std::decay_t<decltype(mp.get_cref())>;
+        if constexpr(EnsembleCapable<Model>){
+            return EnsembleDerivatives<Model, double, EArrayd>::get_Arxy(NT, ND, mp.get_cref(), T, rho, molefrac, parameters);
+        }
+        else{
+            throw teqp::NotImplementedError("Cannot call get_Arxy_ensemble of a class that doesn't support ensemble evaluation");
+        }
+    }
+    
+    // Batched evaluations over many state points
+    virtual EArrayd get_Arxy_batch(const int NT, const int ND, const REArrayd& T, const REArrayd& rho, const REMatrixd& molefracs, const bool screening) const override {
+        TEQP_INSTRUMENT_SCOPE(m_stats, derivative_pass);
+        using Model = std::decay_t<decltype(mp.get_cref())>;
+        const auto N = T.size();
+        if (rho.size() != N || molefracs.rows() != N) {
+            throw teqp::InvalidArgument("T, rho, and the rows of molefracs must all be the same length");
+        }
+        EArrayd o(N);
+        Eigen::ArrayXd z(molefracs.cols());
+        for (auto i = 0; i < N; ++i) {
+            z = molefracs.row(i).transpose();
+            if constexpr (SinglePrecisionScreeningCapable<Model>) {
+                if (screening) {
+                    o[i] = ScreeningDerivatives<Model>::get_Arxy(NT, ND, mp.get_cref(), T[i], rho[i], z);
+                    continue;
+                }
+            }
+            o[i] = TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_Ar(NT, ND, mp.get_cref(), T[i], rho[i], z);
+        }
+        return o;
+    }
 };
 
 template<typename TemplatedModel> auto view(const TemplatedModel& tp){
@@ -261,6 +350,17 @@ template<typename TemplatedModel> auto make_owned(const TemplatedModel& tmodel){
     return std::unique_ptr<AbstractModel>(own(std::move(tmodel)));
 };
 
+/**
+ \brief Make an owning adapter around a copy of the model in which the model remains mutable, so that get_model_ref can be used
+ 
+ \note Models modified through get_model_ref must not be evaluated concurrently in other threads while they are being modified
+ */
+template<typename TemplatedModel> auto make_mutable_owned(const TemplatedModel& tmodel){
+    using namespace teqp::cppinterface;
+    Owner<TemplatedModel> o(TemplatedModel{tmodel});
+    return std::unique_ptr<AbstractModel>(new DerivativeAdapter<decltype(o)>(internal::tag<decltype(o)>{}, std::move(o)));
+};
+
 template<typename TemplatedModel> auto make_cview(const TemplatedModel& tmodel){
     using namespace teqp::cppinterface;
     return std::unique_ptr<AbstractModel>(view(tmodel));
@@ -279,12 +379,16 @@ const ModelType& get_model_cref(const AbstractModel *am)
     }
     const auto* mptr = dynamic_cast<const DerivativeAdapter<ConstViewer<const ModelType>>*>(am);
     const auto* mptr2 = dynamic_cast<const DerivativeAdapter<Owner<const ModelType>>*>(am);
+    const auto* mptr3 = dynamic_cast<const DerivativeAdapter<Owner<ModelType>>*>(am);
     if (mptr != nullptr){
         return mptr->get_ModelPack_cref().get_cref();
     }
     else if (mptr2 != nullptr){
         return mptr2->get_ModelPack_cref().get_cref();
     }
+    else if (mptr3 != nullptr){
+        return mptr3->get_ModelPack_cref().get_cref();
+    }
     else{
         throw teqp::InvalidArgument("Unable to cast model to desired type");
     }
@@ -11,6 +11,9 @@
 #include "teqp/algorithms/critical_tracing_types.hpp"
 #include "teqp/algorithms/VLE_types.hpp"
 #include "teqp/algorithms/VLLE_types.hpp"
+#include "teqp/algorithms/density_roots_types.hpp"
+#include "teqp/derivs_types.hpp"
+#include "teqp/instrumentation.hpp"
 
 using EArray2 = Eigen::Array<double, 2, 1>;
 using EArrayd = Eigen::ArrayX<double>;
@@ -92,6 +95,9 @@ namespace teqp {
          
         */
         class AbstractModel {
+        protected:
+            /// The evaluation counters and timing histograms, see instrumentation.hpp
+            instrumentation::EvaluationStats m_stats;
         public:
             
             virtual ~AbstractModel() = default;
@@ -154,16 +160,39 @@ namespace teqp {
             #define X(f) virtual std::tuple<double, Eigen::ArrayXd, Eigen::MatrixXd> f(const double T, const EArrayd& rhovec) const = 0;
                 ISOCHORIC_multimatrix_args
             #undef X
+            /// \f$\Psi^{\rm r}\f$ and all its first and second derivatives w.r.t. the molar concentrations and temperature, from one Hessian evaluation
+            virtual IsochoricDerivativeBundle build_Psir_derivative_bundle_autodiff(const double T, const EArrayd& rhovec) const = 0;
             virtual Eigen::ArrayXd get_Psir_sigma_derivs(const double T, const EArrayd& rhovec, const EArrayd& v) const = 0;
+            /// \f$u^T H v\f$ for the Hessian of \f$\Psi^{\rm r}\f$ w.r.t. the molar concentrations, in one pass
+            virtual double get_Psir_vector_Hessian_vector_product_autodiff(const double T, const EArrayd& rhovec, const EArrayd& u, const EArrayd& v) const = 0;
+            /// \f$H v\f$ for the Hessian of \f$\Psi^{\rm r}\f$ w.r.t. the molar concentrations, without building the Hessian
+            virtual Eigen::ArrayXd build_Psir_Hessian_vector_product_autodiff(const double T, const EArrayd& rhovec, const EArrayd& v) const = 0;
+            
+            /// Opt-in fast path of get_Arxy from the virial series at low density, for the composition molefrac only; see virial_fastpath.hpp
+            virtual void enable_virial_fastpath(const double Tmin, const double Tmax, const EArrayd& molefrac, const std::optional<VirialFastPathOptions>& = std::nullopt) = 0;
+            virtual void disable_virial_fastpath() = 0;
             
             double get_neff(const double, const double, const EArrayd&) const;
             
             virtual EArray33d get_deriv_mat2(const double T, double rho, const EArrayd& z ) const = 0;
             
+            // Ensemble evaluations of models that are linear in some of their parameters, for many sets of those parameters at once
+            virtual EArrayd get_ensemble_parameters() const = 0;
+            virtual EArrayd get_Arxy_ensemble(const int NT, const int ND, const double T, const double rho, const REArrayd& molefrac, const Eigen::Ref<const Eigen::MatrixXd>& parameters) const = 0;
+            
+            // Batched evaluations over many state points, one point per row of molefracs; with screening, models that support it are evaluated in single precision (see screening.hpp)
+            virtual EArrayd get_Arxy_batch(const int NT, const int ND, const REArrayd& T, const REArrayd& rho, const REMatrixd& molefracs, const bool screening = false) const = 0;
+            EArrayd polish_Arxy_batch(const int NT, const int ND, const REArrayd& T, const REArrayd& rho, const REMatrixd& molefracs, const REArrayd& screened, const Eigen::ArrayXi& indices) const;
+            
             std::tuple<double, double> solve_pure_critical(const double T, const double rho, const std::optional<nlohmann::json>& = std::nullopt) const ;
             EArray2 extrapolate_from_critical(const double Tc, const double rhoc, const double Tgiven, const std::optional<Eigen::ArrayXd>& molefracs = std::nullopt) const;
             std::tuple<EArrayd, EMatrixd> get_pure_critical_conditions_Jacobian(const double T, const double rho, const std::optional<std::size_t>& alternative_pure_index, const std::optional<std::size_t>& alternative_length) const;
             
+            /// All the density roots and spinodals at the given temperature, pressure and composition, see density_roots.hpp
+            DensityRootsResult find_density_roots(const double T, const double p, const REArrayd& molefrac, const std::optional<DensityRootsOptions>& options = std::nullopt) const;
+            /// All the density roots and spinodals of many state points, one per row of molefracs
+            std::vector<DensityRootsResult> find_density_roots_batch(const REArrayd& T, const REArrayd& p, const REMatrixd& molefracs, const std::optional<DensityRootsOptions>& options = std::nullopt) const;
+            
             EArray2 pure_VLE_T(const double T, const double rhoL, const double rhoV, int maxiter, const std::optional<Eigen::ArrayXd>& molefracs = std::nullopt) const;
             double dpsatdT_pure(const double T, const double rhoL, const double rhoV) const;
             
@@ -172,14 +201,20 @@ namespace teqp {
             virtual double get_dpsat_dTsat_isopleth(const double T, const REArrayd& rhovecL, const REArrayd& rhovecV) const;
             virtual nlohmann::json trace_VLE_isotherm_binary(const double T0, const EArrayd& rhovec0, const EArrayd& rhovecV0, const std::optional<TVLEOptions> & = std::nullopt) const;
             virtual nlohmann::json trace_VLE_isobar_binary(const double p, const double T0, const EArrayd& rhovecL0, const EArrayd& rhovecV0, const std::optional<PVLEOptions> & = std::nullopt) const;
-            virtual std::tuple<VLE_return_code,EArrayd,EArrayd> mix_VLE_Tx(const double T, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const REArrayd& xspec, const double atol, const double reltol, const double axtol, const double relxtol, const int maxiter) const;
+            virtual std::tuple<VLE_return_code,EArrayd,EArrayd> mix_VLE_Tx(const double T, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const REArrayd& xspec, const double atol, const double reltol, const double axtol, const double relxtol, const int maxiter, const std::optional<MixVLETxFlags>& flags = std::nullopt) const;
             virtual MixVLEReturn mix_VLE_Tp(const double T, const double pgiven, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const std::optional<MixVLETpFlags> &flags = std::nullopt) const;
             virtual std::tuple<VLE_return_code,double,EArrayd,EArrayd> mixture_VLE_px(const double p_spec, const REArrayd& xmolar_spec, const double T0, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const std::optional<MixVLEpxFlags>& flags = std::nullopt) const;
+            /// Bubble or dew points at many compositions (one per row) and the same pressure, see bubble_dew_batch in VLE.hpp
+            BubbleDewBatchResult bubble_dew_batch_p(const double p, const REMatrixd& compositions, const double T0, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const std::optional<BubbleDewOptions>& options = std::nullopt) const;
+            /// Bubble or dew points at many compositions (one per row) and the same temperature, for binary mixtures, see bubble_dew_batch in VLE.hpp
+            BubbleDewBatchResult bubble_dew_batch_T(const double T, const REMatrixd& compositions, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const std::optional<BubbleDewOptions>& options = std::nullopt) const;
             
             std::tuple<VLLE::VLLE_return_code,EArrayd,EArrayd,EArrayd> mix_VLLE_T(const double T, const REArrayd& rhovecVinit, const REArrayd& rhovecL1init, const REArrayd& rhovecL2init, const double atol, const double reltol, const double axtol, const double relxtol, const int maxiter) const;
+            std::tuple<VLLE::VLLE_return_code,EArrayd,EArrayd,EArrayd> mix_VLLE_Tp(const double T, const double p, const REArrayd& rhovecVinit, const REArrayd& rhovecL1init, const REArrayd& rhovecL2init, const double atol, const double reltol, const double axtol, const double relxtol, const int maxiter) const;
             std::vector<nlohmann::json> find_VLLE_T_binary(const std::vector<nlohmann::json>& traces, const std::optional<VLLE::VLLEFinderOptions> options = std::nullopt) const;
             std::vector<nlohmann::json> find_VLLE_p_binary(const std::vector<nlohmann::json>& traces, const std::optional<VLLE::VLLEFinderOptions> options = std::nullopt) const;
             nlohmann::json trace_VLLE_binary(const double T, const REArrayd& rhovecV, const REArrayd& rhovecL1, const REArrayd& rhovecL2, const std::optional<VLLE::VLLETracerOptions> options) const;
+            nlohmann::json trace_VLLE(const double T, const REArrayd& rhovecV, const REArrayd& rhovecL1, const REArrayd& rhovecL2, const std::optional<VLLE::VLLETracerOptions> options) const;
             
             virtual nlohmann::json trace_critical_arclength_binary(const double T0, const EArrayd& rhovec0, const std::optional<std::string>& = std::nullopt, const std::optional<TCABOptions> & = std::nullopt) const;
             virtual EArrayd get_drhovec_dT_crit(const double T, const REArrayd& rhovec) const;
@@ -188,6 +223,10 @@ namespace teqp {
             virtual EigenData eigen_problem(const double T, const REArrayd& rhovec, const std::optional<REArrayd>& = std::nullopt) const;
             virtual double get_minimum_eigenvalue_Psi_Hessian(const double T, const REArrayd& rhovec) const;
             
+            /// The evaluation counters and timing histograms, summed over all the threads; all zero unless built with TEQP_INSTRUMENTATION
+            nlohmann::json get_stats() const { return m_stats.to_json(); }
+            /// Zero the evaluation counters and timing histograms
+            void reset_stats() { m_stats.reset(); }
         };
         
         // Generic JSON-based interface where the model description is encoded as JSON
@@ -10,9 +10,11 @@
 
 #include "teqp/types.hpp"
 #include "teqp/exceptions.hpp"
+#include "teqp/derivs_types.hpp"
 
 #if defined(TEQP_MULTICOMPLEX_ENABLED)
 #include "MultiComplex/MultiComplex.hpp"
+#include "teqp/math/fixed_multicomplex.hpp"
 #endif
 
 // autodiff include
@@ -42,10 +44,9 @@ typename ContainerType::value_type derivT(const FuncType& f, TType T, const Cont
 */
 template <typename TType, typename ContainerType, typename FuncType>
 typename ContainerType::value_type derivTmcx(const FuncType& f, TType T, const ContainerType& rho) {
-    using fcn_t = std::function<mcx::MultiComplex<double>(const mcx::MultiComplex<double>&)>;
-    fcn_t wrapper = [&rho, &f](const auto& T_) {return f(T_, rho); };
-    auto ders = diff_mcx1(wrapper, T, 1);
-    return ders[0];
+    auto wrapper = [&rho, &f](const auto& T_) {return f(T_, rho); };
+    auto ders = diff_fixed_mcx1<1>(wrapper, T);
+    return ders[1];
 }
 #endif
 
@@ -169,9 +170,9 @@ struct TDXDerivatives {
 #endif
 #if defined(TEQP_MULTICOMPLEX_ENABLED)
             else if constexpr (be == ADBackends::multicomplex) {
-                using fcn_t = std::function<mcx::MultiComplex<Scalar>(const mcx::MultiComplex<Scalar>&)>;
-                fcn_t f = [&](const auto& rhomcx) { return AlphaCaller(w, T, rhomcx, molefrac); };
-                auto ders = diff_mcx1(f, rho, iD, true /* and_val */);
+                // The order is known at compile-time, so the multicomplex type with fixed-size storage is used
+                auto f = [&](const auto& rhomcx) { return AlphaCaller(w, T, rhomcx, molefrac); };
+                auto ders = diff_fixed_mcx1<iD>(f, rho);
                 return powi(rho, iD)*ders[iD];
             }
 #endif
@@ -196,9 +197,8 @@ struct TDXDerivatives {
 #endif
 #if defined(TEQP_MULTICOMPLEX_ENABLED)
             else if constexpr (be == ADBackends::multicomplex) {
-                using fcn_t = std::function<mcx::MultiComplex<Scalar>(const mcx::MultiComplex<Scalar>&)>;
-                fcn_t f = [&](const auto& Trecipmcx) { return AlphaCaller(w, 1.0/Trecipmcx, rho, molefrac); };
-                auto ders = diff_mcx1(f, Trecip, iT, true /* and_val */);
+                auto f = [&](const auto& Trecipmcx) { return AlphaCaller(w, 1.0/Trecipmcx, rho, molefrac); };
+                auto ders = diff_fixed_mcx1<iT>(f, Trecip);
                 return powi(Trecip, iT)*ders[iT];
             }
 #endif
@@ -219,14 +219,10 @@ struct TDXDerivatives {
             }
 #if defined(TEQP_MULTICOMPLEX_ENABLED)
             else if constexpr (be == ADBackends::multicomplex) {
-                using fcn_t = std::function< mcx::MultiComplex<double>(const std::valarray<mcx::MultiComplex<double>>&)>;
-                const fcn_t func = [&w, &molefrac](const auto& zs) {
-                    auto Trecip = zs[0], rhomolar = zs[1];
+                auto func = [&w, &molefrac](const auto& Trecip, const auto& rhomolar) {
                     return AlphaCaller(w, 1.0 / Trecip, rhomolar, molefrac);
                 };
-                std::vector<double> xs = { 1.0 / T, rho};
-                std::vector<int> order = { iT, iD };
-                auto der = mcx::diff_mcxN(func, xs, order);
+                auto der = diff_fixed_mcx2<iT, iD>(func, static_cast<Scalar>(1.0 / T), rho);
                 return powi(1.0 / T, iT)*powi(rho, iD)*der;
             }
 #endif
@@ -555,10 +551,8 @@ struct TDXDerivatives {
         }
 #if defined(TEQP_MULTICOMPLEX_ENABLED)
         else {
-            using fcn_t = std::function<mcx::MultiComplex<Scalar>(const mcx::MultiComplex<Scalar>&)>;
-            bool and_val = true;
-            fcn_t f = [&w, &T, &molefrac](const auto& rhomcx) { return AlphaCaller(w, T, rhomcx, molefrac); };
-            auto ders = diff_mcx1(f, rho, Nderiv, and_val);
+            auto f = [&w, &T, &molefrac](const auto& rhomcx) { return AlphaCaller(w, T, rhomcx, molefrac); };
+            auto ders = diff_fixed_mcx1<Nderiv>(f, rho);
             for (auto n = 0; n <= Nderiv; ++n) {
                 o[n] = powi(rho, n) * ders[n];
             }
@@ -583,9 +577,8 @@ struct TDXDerivatives {
         }
 #if defined(TEQP_MULTICOMPLEX_ENABLED)
         else if constexpr (be == ADBackends::multicomplex) {
-            using fcn_t = std::function<mcx::MultiComplex<Scalar>(const mcx::MultiComplex<Scalar>&)>;
-            fcn_t f = [&](const auto& Trecipmcx) { return AlphaCaller(w, 1.0/Trecipmcx, rho, molefrac); };
-            auto ders = diff_mcx1(f, Trecip, Nderiv+1, true /* and_val */);
+            auto f = [&](const auto& Trecipmcx) { return AlphaCaller(w, 1.0/Trecipmcx, rho, molefrac); };
+            auto ders = diff_fixed_mcx1<Nderiv>(f, Trecip);
             for (auto n = 0; n <= Nderiv; ++n) {
                 o[n] = powi(Trecip, n) * ders[n];
             }
@@ -725,10 +718,8 @@ struct VirialDerivatives {
         }
 #if defined(TEQP_MULTICOMPLEX_ENABLED)
         else if constexpr(be == ADBackends::multicomplex){
-            using namespace mcx;
-            using fcn_t = std::function<MultiComplex<double>(const MultiComplex<double>&)>;
-            fcn_t f = [&model, &T, &molefrac](const auto& rho_) { return model.alphar(T, rho_, molefrac); };
-            auto derivs = diff_mcx1(f, 0.0, Nderiv, true /* and_val */);
+            auto f = [&model, &T, &molefrac](const auto& rho_) { return model.alphar(T, rho_, molefrac); };
+            auto derivs = diff_fixed_mcx1<Nderiv-1>(f, 0.0);
             for (auto n = 1; n < Nderiv; ++n){
                 dnalphardrhon[n] = derivs[n];
             }
@@ -794,14 +785,10 @@ struct VirialDerivatives {
         }
 #if defined(TEQP_MULTICOMPLEX_ENABLED)
         else if constexpr (be == ADBackends::multicomplex) {
-            using namespace mcx;
-            using fcn_t = std::function<MultiComplex<double>(const std::valarray<MultiComplex<double>>&)>;
-            fcn_t f = [&model, &molefrac](const auto& zs) {
-                auto T_ = zs[0], rho_ = zs[1];
+            auto f = [&model, &molefrac](const auto& T_, const auto& rho_) {
                 return model.alphar(T_, rho_, molefrac);
             };
-            std::valarray<double> at = { T, 0.0 };
-            auto deriv = diff_mcxN(f, at, { NTderiv, Nderiv-1});
+            auto deriv = diff_fixed_mcx2<NTderiv, Nderiv-1>(f, T, static_cast<Scalar>(0.0));
             return deriv / factorial(Nderiv - 2);
         }
 #endif
@@ -1068,6 +1055,40 @@ struct IsochoricDerivatives{
         return std::make_tuple(f, gg, H);
     }
 
+    /**
+    * \brief Calculate \f$\Psi^r = a^r\rho\f$ and all its first and second derivatives w.r.t. the molar concentrations and temperature
+    *
+    * The Hessian is taken in the variables \f$(\rho_0, \ldots, \rho_{N-1}, T)\f$, so the derivatives returned separately by
+    * build_Psir_fgradHessian_autodiff, get_dPsirdT_constrhovec and build_d2PsirdTdrhoi_autodiff are obtained in one call with
+    * \f$(N+1)(N+2)/2\f$ passes through the model rather than \f$N(N+1)/2+2N+1\f$
+    */
+    static auto build_Psir_derivative_bundle_autodiff(const Model& model, const Scalar& T, const VectorType& rho) {
+        const auto N = rho.size();
+        dual2nd u; // the output scalar u = f(x), evaluated together with Hessian below
+        ArrayXdual g;
+        ArrayXdual2nd vars(N + 1); for (auto i = 0; i < N; ++i) { vars[i] = rho[i]; } vars[N] = T;
+        auto hfunc = [&model, N](const ArrayXdual2nd& v) {
+            const dual2nd& T_ = v[N];
+            auto rhotot_ = v.head(N).sum();
+            auto molefrac = (v.head(N) / rhotot_).eval();
+            return forceeval(model.alphar(T_, rhotot_, molefrac) * model.R(molefrac) * T_ * rhotot_);
+        };
+        Eigen::MatrixXd H = autodiff::hessian(hfunc, wrt(vars), at(vars), u, g);
+        auto gg = g.cast<double>().eval();
+        
+        IsochoricDerivativeBundle b;
+        b.T = T;
+        b.R = model.R((rho / rho.sum()).eval());
+        b.rhovec = rho;
+        b.Psir = getbaseval(u);
+        b.gradient = gg.head(N);
+        b.Hessian = H.topLeftCorner(N, N);
+        b.dPsirdT = gg[N];
+        b.d2PsirdTdrhoi = H.col(N).head(N).array();
+        b.d2PsirdT2 = H(N, N);
+        return b;
+    }
+
     /**
     * \brief Calculate the Hessian of \f$\Psi = a \rho\f$ w.r.t. the molar concentrations
     *
@@ -1507,6 +1528,40 @@ struct IsochoricDerivatives{
         for (auto i = 0; i < ret.size(); ++i){ ret[i] = der[i];}
         return ret;
     }
+    
+    /**
+    * \brief Calculate the product \f$u^T H v\f$ of the Hessian of \f$\Psi^r = a^r\rho\f$ w.r.t. the molar concentrations with two vectors
+    *
+    * Forward-over-forward differentiation of \f$\Psi^r(\vec\rho + s\vec u + t\vec v)\f$ w.r.t. \f$s\f$ and \f$t\f$: one pass through the model, whatever the number of components
+    */
+    static double get_Psir_vector_Hessian_vector_product_autodiff(const Model& model, const Scalar& T, const VectorType& rho, const VectorType& u, const VectorType& v) {
+        auto psirfunc = [&model, &T, &rho, &u, &v](const dual2nd& s, const dual2nd& t) {
+            ArrayXdual2nd rhovecc(rho.size()); for (auto j = 0; j < rho.size(); ++j) { rhovecc[j] = rho[j] + s*u[j] + t*v[j]; }
+            auto rhotot_ = rhovecc.sum();
+            auto molefrac = (rhovecc / rhotot_).eval();
+            return forceeval(model.alphar(T, rhotot_, molefrac) * model.R(molefrac) * T * rhotot_);
+        };
+        dual2nd s = 0.0, t = 0.0;
+        auto [u00, u10, u11] = derivatives(psirfunc, wrt(s, t), at(s, t));
+        return u11;
+    }
+    
+    /**
+    * \brief Calculate the product \f$H v\f$ of the Hessian of \f$\Psi^r = a^r\rho\f$ w.r.t. the molar concentrations with a vector, without building the Hessian
+    *
+    * Each entry is a forward-over-forward directional derivative along \f$\vec v\f$ and the i-th concentration, so \f$N\f$ passes
+    * through the model are needed rather than the \f$N(N+1)/2\f$ of build_Psir_Hessian_autodiff
+    */
+    static Eigen::ArrayXd build_Psir_Hessian_vector_product_autodiff(const Model& model, const Scalar& T, const VectorType& rho, const VectorType& v) {
+        Eigen::ArrayXd Hv(rho.size());
+        VectorType e = VectorType::Zero(rho.size());
+        for (auto i = 0; i < rho.size(); ++i) {
+            e[i] = 1.0;
+            Hv[i] = get_Psir_vector_Hessian_vector_product_autodiff(model, T, rho, e, v);
+            e[i] = 0.0;
+        }
+        return Hv;
+    }
 };
 
 template<int Nderivsmax>
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cmath>
+#include <Eigen/Dense>
+
+namespace teqp {
+
+/**
+ \brief The residual Helmholtz energy density \f$\Psi^{\rm r}=a^{\rm r}\rho\f$ and all its first and second derivatives with respect to
+ the molar concentrations and the temperature, as obtained together from one Hessian evaluation in the variables \f$(\vec\rho, T)\f$
+
+ These are the derivatives needed to build the residuals and the right-hand sides of the isochoric phase equilibrium
+ routines; the ideal-gas contributions are added by the convenience methods
+ */
+struct IsochoricDerivativeBundle {
+    double T = 0; ///< Temperature, in K
+    double R = 0; ///< The molar gas constant of the mixture, in J/mol/K
+    Eigen::ArrayXd rhovec; ///< The molar concentrations, in mol/m^3
+    double Psir = 0; ///< \f$\Psi^{\rm r}\f$
+    Eigen::ArrayXd gradient; ///< \f$\partial\Psi^{\rm r}/\partial\rho_i\f$, the residual chemical potentials
+    Eigen::MatrixXd Hessian; ///< \f$\partial^2\Psi^{\rm r}/\partial\rho_i\partial\rho_j\f$
+    double dPsirdT = 0; ///< \f$\partial\Psi^{\rm r}/\partial T\f$ at constant molar concentrations
+    Eigen::ArrayXd d2PsirdTdrhoi; ///< \f$\partial^2\Psi^{\rm r}/\partial T\partial\rho_i\f$
+    double d2PsirdT2 = 0; ///< \f$\partial^2\Psi^{\rm r}/\partial T^2\f$ at constant molar concentrations
+
+    /// Pressure, in Pa
+    double p() const { return rhovec.sum()*R*T - Psir + (rhovec*gradient).sum(); }
+    /// \f$(\partial p/\partial\rho_i)_{T,\rho_{j\neq i}}\f$, as in IsochoricDerivatives::get_dpdrhovec_constT
+    Eigen::ArrayXd dpdrhovec() const { return (R*T + (Hessian*rhovec.matrix()).array()).eval(); }
+    /// \f$(\partial p/\partial T)_{\vec\rho}\f$, as in IsochoricDerivatives::get_dpdT_constrhovec
+    double dpdT() const { return rhovec.sum()*R - dPsirdT + (rhovec*d2PsirdTdrhoi).sum(); }
+    /// The Hessian of \f$\Psi\f$ including the ideal-gas part, as in IsochoricDerivatives::build_Psi_Hessian_autodiff
+    Eigen::MatrixXd Psi_Hessian() const {
+        Eigen::MatrixXd H = Hessian;
+        for (auto i = 0; i < rhovec.size(); ++i) {
+            H(i, i) += R*T/rhovec[i];
+        }
+        return H;
+    }
+    /// The temperature derivatives of the chemical potentials, as in IsochoricDerivatives::get_dchempotdT_autodiff
+    Eigen::ArrayXd dchempotdT() const { return (d2PsirdTdrhoi + R*(1.0 + log(rhovec))).eval(); }
+};
+
+/// The options of VirialFastPath
+struct VirialFastPathOptions {
+    int Nvir = 4; ///< The last virial coefficient retained in the series; 2 to 4
+    int degree = 24; ///< The degree of the Chebyshev expansions in temperature
+    double rhoB_tolerance = 1e-2; ///< The series is used when \f$|\rho B_2|\f$ is below this value
+};
+
+/// The value returned by VirialFastPath::get_Arxy
+struct VirialFastPathResult {
+    double value; ///< The value of \f$\Lambda^{\rm r}_{xy}\f$
+    double error_estimate; ///< The estimated error of the series (the first omitted term plus the error of the interpolation in temperature); zero for the fallback
+    bool used_series; ///< True if the value comes from the virial series, false if from the full model
+};
+
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+/**
+ Lockstep evaluation of one model over an ensemble of parameter sets, as for uncertainty propagation or Monte Carlo sampling
+ of the parameters of an EOS.
+
+ The models that support ensembles are those in which \f$\alpha^{\rm r}\f$ is an affine function of some of their parameters.
+ These models define:
+
+ * get_ensemble_parameters(), returning their own values of the \f$N_p\f$ parameters
+ * alphar_ensemble_basis(T, rho, molefrac), returning an array \f$\phi\f$ of length \f$N_p+1\f$ such that \f$\alpha^{\rm r} = \phi_0 + \sum_{k=1}^{N_p} p_k\phi_k\f$
+
+ The basis (and its derivatives) is evaluated once at the state point and is shared by all the members of the ensemble, so that
+ the evaluation for all the members reduces to a matrix-vector product.
+ */
+
+#include <Eigen/Dense>
+
+#include "teqp/types.hpp"
+#include "teqp/exceptions.hpp"
+
+// autodiff include
+#include <autodiff/forward/dual.hpp>
+#include <autodiff/forward/real.hpp>
+
+namespace teqp {
+
+template<typename Model>
+concept EnsembleCapable = requires(const Model& m, double T, double rho, Eigen::ArrayXd z) {
+    { m.get_ensemble_parameters() };
+    { m.alphar_ensemble_basis(T, rho, z) };
+};
+
+template<typename Model, typename Scalar = double, typename VectorType = Eigen::ArrayXd>
+struct EnsembleDerivatives {
+
+    /**
+     * \brief The derivatives \f$\Lambda_{xy}\f$ of each entry of the basis, with the same scaling as TDXDerivatives::get_Arxy
+     *
+     * The pure derivatives are obtained from a single pass with autodiff::Real, and the mixed derivative with iT = iD = 1 from a single pass with a second-order dual number
+     */
+    template<int iT, int iD>
+    static Eigen::ArrayXd get_basis_derivs(const Model& model, const Scalar& T, const Scalar& rho, const VectorType& molefrac) {
+        if constexpr (iT == 0 && iD == 0) {
+            return model.alphar_ensemble_basis(T, rho, molefrac);
+        }
+        else if constexpr (iT == 0) {
+            autodiff::Real<iD, Scalar> rho_ = rho;
+            rho_[1] = 1.0;
+            auto basis = model.alphar_ensemble_basis(T, rho_, molefrac);
+            Eigen::ArrayXd o(basis.size());
+            for (auto k = 0; k < o.size(); ++k) {
+                o[k] = powi(rho, iD)*basis[k][iD];
+            }
+            return o;
+        }
+        else if constexpr (iD == 0) {
+            Scalar Trecip = 1.0 / T;
+            autodiff::Real<iT, Scalar> Trecip_ = Trecip;
+            Trecip_[1] = 1.0;
+            autodiff::Real<iT, Scalar> T_ = 1.0/Trecip_;
+            auto basis = model.alphar_ensemble_basis(T_, rho, molefrac);
+            Eigen::ArrayXd o(basis.size());
+            for (auto k = 0; k < o.size(); ++k) {
+                o[k] = powi(Trecip, iT)*basis[k][iT];
+            }
+            return o;
+        }
+        else if constexpr (iT == 1 && iD == 1) {
+            // Seed 1/T along the outer direction and rho along the inner one, the mixed derivative is then in grad.grad
+            using adtype = autodiff::HigherOrderDual<2, Scalar>;
+            adtype Trecip_ = 1.0 / T, rho_ = rho;
+            Trecip_.grad.val = 1.0;
+            rho_.val.grad = 1.0;
+            adtype T_ = 1.0/Trecip_;
+            auto basis = model.alphar_ensemble_basis(T_, rho_, molefrac);
+            Eigen::ArrayXd o(basis.size());
+            for (auto k = 0; k < o.size(); ++k) {
+                o[k] = (1.0/T)*rho*basis[k].grad.grad;
+            }
+            return o;
+        }
+        else {
+            static_assert(iT == 0 || iD == 0, "Only pure derivatives and the mixed derivative with iT = iD = 1 are supported");
+        }
+    }
+
+    /// Runtime dispatch of get_basis_derivs, for orders of the pure derivatives up to 3
+    static Eigen::ArrayXd get_basis_derivs(const int iT, const int iD, const Model& model, const Scalar& T, const Scalar& rho, const VectorType& molefrac) {
+        if (iT == 0) {
+            switch (iD) {
+            case 0: return get_basis_derivs<0, 0>(model, T, rho, molefrac);
+            case 1: return get_basis_derivs<0, 1>(model, T, rho, molefrac);
+            case 2: return get_basis_derivs<0, 2>(model, T, rho, molefrac);
+            case 3: return get_basis_derivs<0, 3>(model, T, rho, molefrac);
+            default: break;
+            }
+        }
+        else if (iD == 0) {
+            switch (iT) {
+            case 1: return get_basis_derivs<1, 0>(model, T, rho, molefrac);
+            case 2: return get_basis_derivs<2, 0>(model, T, rho, molefrac);
+            case 3: return get_basis_derivs<3, 0>(model, T, rho, molefrac);
+            default: break;
+            }
+        }
+        else if (iT == 1 && iD == 1) {
+            return get_basis_derivs<1, 1>(model, T, rho, molefrac);
+        }
+        throw teqp::InvalidArgument("Ensemble derivatives are not available for iT=" + std::to_string(iT) + " and iD=" + std::to_string(iD));
+    }
+
+    /**
+     * \brief The derivative \f$\Lambda^{\rm r}_{xy}\f$ for each member of the ensemble
+     * \param parameters The matrix of parameters, of size (Nparams x Nmembers), one member per column
+     * \returns The array of length Nmembers
+     */
+    static Eigen::ArrayXd get_Arxy(const int iT, const int iD, const Model& model, const Scalar& T, const Scalar& rho, const VectorType& molefrac, const Eigen::Ref<const Eigen::MatrixXd>& parameters) {
+        auto D = get_basis_derivs(iT, iD, model, T, rho, molefrac);
+        const auto Np = D.size() - 1;
+        if (parameters.rows() != Np) {
+            throw teqp::InvalidArgument("The parameter matrix has " + std::to_string(parameters.rows()) + " rows but the model has " + std::to_string(Np) + " ensemble parameters");
+        }
+        return D[0] + (parameters.transpose()*D.tail(Np).matrix()).array();
+    }
+};
+
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+/**
+ Instrumentation of the evaluations of a model: counters of the inner iterations (association, COSMO-SAC, polarizable
+ multipoles, solvers) and timing histograms of the derivative passes and the calls to solvers that go through AbstractModel.
+
+ The counting is compiled in when TEQP_INSTRUMENTATION_ENABLED is defined (the CMake option TEQP_INSTRUMENTATION), otherwise
+ the macros TEQP_COUNT and TEQP_INSTRUMENT_SCOPE expand to nothing and the statistics remain zero.
+
+ Each thread increments its own block of counters, so there is no contention between threads evaluating the same model, and
+ the blocks of all the threads are summed when the statistics are read. The inner iterations of a model do not know which
+ AbstractModel they are being evaluated for, so the counts are attributed to the statistics of the innermost active scope
+ on the calling thread; iterations that run outside of any scope (for instance when a model is used directly rather than
+ through AbstractModel) are not counted.
+ */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+namespace teqp {
+namespace instrumentation {
+
+enum class Counter : std::size_t { association_iterations, COSMOSAC_iterations, polar_iterations, solver_iterations, trace_steps, N };
+inline const char* get_name(Counter c) {
+    static const char* names[] = { "association_iterations", "COSMOSAC_iterations", "polar_iterations", "solver_iterations", "trace_steps" };
+    return names[static_cast<std::size_t>(c)];
+}
+
+enum class Timer : std::size_t { derivative_pass, solver_call, N };
+inline const char* get_name(Timer t) {
+    static const char* names[] = { "derivative_pass", "solver_call" };
+    return names[static_cast<std::size_t>(t)];
+}
+
+/// The number of buckets of the timing histograms; bucket k holds the durations in [2^k, 2^(k+1)) ns, and the last one all the longer ones
+constexpr std::size_t N_buckets = 40;
+
+/// The counters of one thread
+struct Block {
+    std::thread::id owner; ///< The thread that increments this block
+    std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(Counter::N)> counts{};
+    std::array<std::array<std::atomic<std::uint64_t>, N_buckets>, static_cast<std::size_t>(Timer::N)> histograms{};
+    std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(Timer::N)> total_ns{};
+};
+
+class EvaluationStats {
+private:
+    static std::uint64_t next_id() {
+        static std::atomic<std::uint64_t> n{ 1 };
+        return n.fetch_add(1);
+    }
+    /// A unique identifier, never reused, so that the caches of the threads cannot confuse a dead instance with a live one
+    const std::uint64_t id = next_id();
+    mutable std::mutex mtx;
+    mutable std::vector<std::unique_ptr<Block>> blocks;
+
+    /// The number of instances whose blocks are cached on each thread
+    static constexpr std::size_t N_cached = 8;
+
+    /**
+     The block of the calling thread, created on first use
+     
+     Each thread caches the blocks of the few instances it used most recently. An evicted instance finds its block again
+     by the identifier of the thread, so neither the cache nor the blocks grow with the number of instances a thread has
+     used, and entries of dead instances are simply evicted in turn
+     */
+    Block& local() const {
+        struct Entry {
+            std::uint64_t id = 0;
+            Block* block = nullptr;
+        };
+        struct Cache {
+            std::array<Entry, N_cached> entries{};
+            std::size_t next = 0;
+        };
+        thread_local Cache cache;
+        for (const auto& e : cache.entries) {
+            if (e.id == id) {
+                return *e.block;
+            }
+        }
+        Block* b = nullptr;
+        const auto me = std::this_thread::get_id();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (auto& owned : blocks) {
+                if (owned->owner == me) {
+                    b = owned.get();
+                    break;
+                }
+            }
+            if (b == nullptr) {
+                blocks.push_back(std::make_unique<Block>());
+                b = blocks.back().get();
+                b->owner = me;
+            }
+        }
+        cache.entries[cache.next] = { id, b };
+        cache.next = (cache.next + 1) % N_cached;
+        return *b;
+    }
+
+public:
+    EvaluationStats() = default;
+    /// A copy starts again from zero
+    EvaluationStats(const EvaluationStats&) : EvaluationStats() {}
+    EvaluationStats& operator=(const EvaluationStats&) { return *this; }
+
+    void count(Counter c, std::uint64_t n = 1) const {
+        local().counts[static_cast<std::size_t>(c)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void record(Timer t, std::uint64_t ns) const {
+        std::size_t bucket = 0;
+        while (bucket + 1 < N_buckets && (ns >> (bucket + 1)) > 0) { ++bucket; }
+        auto& b = local();
+        b.histograms[static_cast<std::size_t>(t)][bucket].fetch_add(1, std::memory_order_relaxed);
+        b.total_ns[static_cast<std::size_t>(t)].fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    /// Zero the counters of all the threads
+    void reset() {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (auto& b : blocks) {
+            for (auto& c : b->counts) { c.store(0, std::memory_order_relaxed); }
+            for (auto& h : b->histograms) { for (auto& c : h) { c.store(0, std::memory_order_relaxed); } }
+            for (auto& c : b->total_ns) { c.store(0, std::memory_order_relaxed); }
+        }
+    }
+
+    /// The statistics summed over all the threads
+    nlohmann::json to_json() const {
+        std::array<std::uint64_t, static_cast<std::size_t>(Counter::N)> counts{};
+        std::array<std::array<std::uint64_t, N_buckets>, static_cast<std::size_t>(Timer::N)> histograms{};
+        std::array<std::uint64_t, static_cast<std::size_t>(Timer::N)> total_ns{};
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (const auto& b : blocks) {
+                for (auto i = 0U; i < counts.size(); ++i) { counts[i] += b->counts[i].load(std::memory_order_relaxed); }
+                for (auto i = 0U; i < histograms.size(); ++i) {
+                    for (auto k = 0U; k < N_buckets; ++k) { histograms[i][k] += b->histograms[i][k].load(std::memory_order_relaxed); }
+                    total_ns[i] += b->total_ns[i].load(std::memory_order_relaxed);
+                }
+            }
+        }
+        nlohmann::json jcounters = nlohmann::json::object(), jtimers = nlohmann::json::object();
+        for (auto i = 0U; i < counts.size(); ++i) {
+            jcounters[get_name(static_cast<Counter>(i))] = counts[i];
+        }
+        for (auto i = 0U; i < histograms.size(); ++i) {
+            std::uint64_t n = 0;
+            for (auto c : histograms[i]) { n += c; }
+            // The histogram is trimmed after the last occupied bucket
+            std::size_t last = 0;
+            for (auto k = 0U; k < N_buckets; ++k) { if (histograms[i][k] > 0) { last = k + 1; } }
+            jtimers[get_name(static_cast<Timer>(i))] = {
+                {"count", n},
+                {"total / s", total_ns[i]*1e-9},
+                {"histogram lower bound / ns", std::vector<std::uint64_t>{}},
+                {"histogram counts", std::vector<std::uint64_t>(histograms[i].begin(), histograms[i].begin() + last)}
+            };
+            auto& lower = jtimers[get_name(static_cast<Timer>(i))]["histogram lower bound / ns"];
+            for (auto k = 0U; k < last; ++k) { lower.push_back(k == 0 ? 0 : (std::uint64_t(1) << k)); }
+        }
+        return {
+#if defined(TEQP_INSTRUMENTATION_ENABLED)
+            {"enabled", true},
+#else
+            {"enabled", false},
+#endif
+            {"counters", jcounters},
+            {"timers", jtimers}
+        };
+    }
+};
+
+/// The statistics of the innermost active scope on this thread, or nullptr
+inline const EvaluationStats*& current() {
+    thread_local const EvaluationStats* stats = nullptr;
+    return stats;
+}
+
+/// Count into the statistics of the innermost active scope, if any
+inline void count(Counter c, std::uint64_t n = 1) {
+    if (auto s = current()) { s->count(c, n); }
+}
+
+/// Make the statistics active on this thread for the lifetime of the scope, and record its duration
+class TimedScope {
+private:
+    const EvaluationStats& stats;
+    const EvaluationStats* previous;
+    const Timer timer;
+    const std::chrono::steady_clock::time_point tic;
+public:
+    TimedScope(const EvaluationStats& stats, Timer timer) : stats(stats), previous(current()), timer(timer), tic(std::chrono::steady_clock::now()) {
+        current() = &stats;
+    }
+    ~TimedScope() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tic).count();
+        stats.record(timer, static_cast<std::uint64_t>(ns));
+        current() = previous;
+    }
+    TimedScope(const TimedScope&) = delete;
+    TimedScope& operator=(const TimedScope&) = delete;
+};
+
+}
+}
+
+#if defined(TEQP_INSTRUMENTATION_ENABLED)
+#define TEQP_COUNT(counter, n) ::teqp::instrumentation::count(::teqp::instrumentation::Counter::counter, n)
+#define TEQP_INSTRUMENT_SCOPE(stats, timer) const ::teqp::instrumentation::TimedScope teqp_instrumentation_scope_(stats, ::teqp::instrumentation::Timer::timer)
+#else
+#define TEQP_COUNT(counter, n) ((void)0)
+#define TEQP_INSTRUMENT_SCOPE(stats, timer) ((void)0)
+#endif
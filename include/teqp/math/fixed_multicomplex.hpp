@@ -0,0 +1,353 @@
+#pragma once
+
+/**
+ A multicomplex number of an order that is fixed at compile-time, for the multicomplex derivative backend
+
+ The runtime-order mcx::MultiComplex stores its \f$2^N\f$ coefficients in a std::valarray, so every arithmetic operation allocates,
+ and the function to be differentiated must be wrapped in a std::function. When the order of the derivative is a template
+ parameter, as it is in TDXDerivatives and VirialDerivatives, the coefficients can instead be held in a std::array and all the
+ loops of the arithmetic are unrolled by the compiler.
+
+ The number \f$z = a + b\,i_N\f$, with \f$a\f$ and \f$b\f$ of order \f$N-1\f$, is stored with the coefficients of \f$a\f$ first and
+ then those of \f$b\f$, the same layout as in mcx::MultiComplex, so that the coefficient of \f$i_1i_2\cdots i_n\f$ is at index \f$2^n-1\f$.
+
+ The elementary functions are evaluated from the Taylor series around the real part, truncated after the \f$N\f$-th power of
+ the imaginary part \f$\epsilon = z-\Re(z)\f$. In the derivative engine, all the imaginary parts are of the order of the step
+ \f$h\f$, so the truncation only affects the coefficients at relative order \f$h^2\f$, as does the step itself.
+ */
+
+#include <array>
+#include <cmath>
+#include <type_traits>
+
+#include "teqp/types.hpp"
+
+namespace teqp {
+
+// The type and its functions live in their own namespace, so that they are found by argument-dependent lookup without
+// hiding the functions of the standard library for the unqualified calls with doubles elsewhere in namespace teqp
+namespace fixedmcx {
+
+template<typename T, int N>
+class FixedMultiComplex {
+    static_assert(N >= 0, "The order must be non-negative");
+public:
+    static constexpr std::size_t ncoef = std::size_t(1) << N;
+    std::array<T, ncoef> coef;
+
+    FixedMultiComplex() { coef.fill(T(0)); }
+    template<typename U> requires std::is_convertible_v<U, T>
+    FixedMultiComplex(const U& x) { coef.fill(T(0)); coef[0] = static_cast<T>(x); }
+
+    const T& real() const { return coef[0]; }
+    const T& operator[](std::size_t i) const { return coef[i]; }
+    T& operator[](std::size_t i) { return coef[i]; }
+
+    FixedMultiComplex operator-() const { FixedMultiComplex o; for (auto k = 0U; k < ncoef; ++k) { o.coef[k] = -coef[k]; } return o; }
+    FixedMultiComplex& operator+=(const FixedMultiComplex& w) { for (auto k = 0U; k < ncoef; ++k) { coef[k] += w.coef[k]; } return *this; }
+    FixedMultiComplex& operator-=(const FixedMultiComplex& w) { for (auto k = 0U; k < ncoef; ++k) { coef[k] -= w.coef[k]; } return *this; }
+    FixedMultiComplex& operator*=(const FixedMultiComplex& w) { *this = *this*w; return *this; }
+    FixedMultiComplex& operator/=(const FixedMultiComplex& w) { *this = *this/w; return *this; }
+};
+
+namespace detail {
+
+    /// The product of two numbers of order L, from (a + b i)(c + d i) = (ac - bd) + (ad + bc) i; o must not alias a or b
+    template<int L, typename T>
+    inline void mul(const T* a, const T* b, T* o) {
+        if constexpr (L == 0) {
+            o[0] = a[0]*b[0];
+        }
+        else {
+            // The four products are kept separate; the three-product variant would subtract terms that differ by orders of h
+            constexpr std::size_t h = std::size_t(1) << (L - 1);
+            std::array<T, h> bd, bc;
+            mul<L-1>(a, b, o);
+            mul<L-1>(a + h, b + h, bd.data());
+            mul<L-1>(a, b + h, o + h);
+            mul<L-1>(a + h, b, bc.data());
+            for (std::size_t k = 0; k < h; ++k) {
+                o[k] -= bd[k];
+                o[h + k] += bc[k];
+            }
+        }
+    }
+
+    /// Evaluate \f$\sum_k c_k\epsilon^k\f$ for \f$\epsilon = z-\Re(z)\f$, given the Taylor coefficients \f$c_k = f^{(k)}(\Re(z))/k!\f$
+    template<typename T, int N>
+    inline FixedMultiComplex<T, N> taylor(const FixedMultiComplex<T, N>& z, const std::array<T, N + 1>& c) {
+        FixedMultiComplex<T, N> eps = z;
+        eps.coef[0] = T(0);
+        FixedMultiComplex<T, N> o = c[N];
+        for (int k = N - 1; k >= 0; --k) {
+            o = o*eps;
+            o.coef[0] += c[k];
+        }
+        return o;
+    }
+
+    /// The Taylor coefficients of \f$x^e\f$ around \f$x_0\f$, starting from \f$c_0 = x_0^e\f$
+    template<typename T, int N>
+    inline std::array<T, N + 1> power_coefficients(const T& x0, const T& c0, double e) {
+        std::array<T, N + 1> c;
+        c[0] = c0;
+        for (int k = 1; k <= N; ++k) {
+            c[k] = c[k-1]*(e - (k - 1))/(k*x0);
+        }
+        return c;
+    }
+}
+
+template<typename T, int N>
+FixedMultiComplex<T, N> operator+(const FixedMultiComplex<T, N>& z, const FixedMultiComplex<T, N>& w) { auto o = z; o += w; return o; }
+template<typename T, int N>
+FixedMultiComplex<T, N> operator-(const FixedMultiComplex<T, N>& z, const FixedMultiComplex<T, N>& w) { auto o = z; o -= w; return o; }
+template<typename T, int N>
+FixedMultiComplex<T, N> operator*(const FixedMultiComplex<T, N>& z, const FixedMultiComplex<T, N>& w) {
+    FixedMultiComplex<T, N> o;
+    detail::mul<N>(z.coef.data(), w.coef.data(), o.coef.data());
+    return o;
+}
+template<typename T, int N>
+FixedMultiComplex<T, N> operator/(const FixedMultiComplex<T, N>& z, const FixedMultiComplex<T, N>& w) {
+    // Reciprocal from the Taylor series of 1/x, c_k = (-1)^k/x0^(k+1)
+    std::array<T, N + 1> c;
+    c[0] = T(1)/w.real();
+    for (int k = 1; k <= N; ++k) { c[k] = -c[k-1]/w.real(); }
+    return z*detail::taylor(w, c);
+}
+
+// Mixed operations with scalars, which only touch the real part (addition) or scale all the coefficients (multiplication)
+template<typename T, int N, typename U> requires std::is_convertible_v<U, T>
+FixedMultiComplex<T, N> operator+(const FixedMultiComplex<T, N>& z, const U& x) { auto o = z; o.coef[0] += static_cast<T>(x); return o; }
+template<typename T, int N, typename U> requires std::is_convertible_v<U, T>
+FixedMultiComplex<T, N> operator+(const U& x, const FixedMultiComplex<T, N>& z) { return z + x; }
+template<typename T, int N, typename U> requires std::is_convertible_v<U, T>
+FixedMultiComplex<T, N> operator-(const FixedMultiComplex<T, N>& z, const U& x) { auto o = z; o.coef[0] -= static_cast<T>(x); return o; }
+template<typename T, int N, typename U> requires std::is_convertible_v<U, T>
+FixedMultiComplex<T, N> operator-(const U& x, const FixedMultiComplex<T, N>& z) { auto o = -z; o.coef[0] += static_cast<T>(x); return o; }
+template<typename T, int N, typename U> requires std::is_convertible_v<U, T>
+FixedMultiComplex<T, N> operator*(const FixedMultiComplex<T, N>& z, const U& x) { auto o = z; for (auto& c : o.coef) { c *= static_cast<T>(x); } return o; }
+template<typename T, int N, typename U> requires std::is_convertible_v<U, T>
+FixedMultiComplex<T, N> operator*(const U& x, const FixedMultiComplex<T, N>& z) { return z*x; }
+template<typename T, int N, typename U> requires std::is_convertible_v<U, T>
+FixedMultiComplex<T, N> operator/(const FixedMultiComplex<T, N>& z, const U& x) { auto o = z; for (auto& c : o.coef) { c /= static_cast<T>(x); } return o; }
+template<typename T, int N, typename U> requires std::is_convertible_v<U, T>
+FixedMultiComplex<T, N> operator/(const U& x, const FixedMultiComplex<T, N>& z) { return FixedMultiComplex<T, N>(x)/z; }
+
+template<typename T, int N>
+FixedMultiComplex<T, N> exp(const FixedMultiComplex<T, N>& z) {
+    using std::exp;
+    std::array<T, N + 1> c;
+    c[0] = exp(z.real());
+    for (int k = 1; k <= N; ++k) { c[k] = c[k-1]/k; }
+    return detail::taylor(z, c);
+}
+
+template<typename T, int N>
+FixedMultiComplex<T, N> expm1(const FixedMultiComplex<T, N>& z) {
+    using std::exp; using std::expm1;
+    std::array<T, N + 1> c;
+    c[0] = expm1(z.real());
+    T ck = exp(z.real());
+    for (int k = 1; k <= N; ++k) { ck /= k; c[k] = ck; }
+    return detail::taylor(z, c);
+}
+
+template<typename T, int N>
+FixedMultiComplex<T, N> log(const FixedMultiComplex<T, N>& z) {
+    using std::log;
+    std::array<T, N + 1> c;
+    c[0] = log(z.real());
+    T xk = T(1);
+    for (int k = 1; k <= N; ++k) { xk *= z.real(); c[k] = ((k % 2 == 1) ? 1.0 : -1.0)/(k*xk); }
+    return detail::taylor(z, c);
+}
+
+template<typename T, int N>
+FixedMultiComplex<T, N> log1p(const FixedMultiComplex<T, N>& z) {
+    using std::log1p;
+    std::array<T, N + 1> c;
+    c[0] = log1p(z.real());
+    T xk = T(1);
+    for (int k = 1; k <= N; ++k) { xk *= 1.0 + z.real(); c[k] = ((k % 2 == 1) ? 1.0 : -1.0)/(k*xk); }
+    return detail::taylor(z, c);
+}
+
+template<typename T, int N>
+FixedMultiComplex<T, N> pow(const FixedMultiComplex<T, N>& z, int e) {
+    return powi(z, e);
+}
+
+template<typename T, int N>
+FixedMultiComplex<T, N> pow(const FixedMultiComplex<T, N>& z, double e) {
+    using std::pow;
+    // Integer exponents by multiplication, which also works when the real part is zero, as for virial coefficients
+    if (e == static_cast<int>(e) && std::abs(e) <= 16) {
+        return powi(z, static_cast<int>(e));
+    }
+    return detail::taylor(z, detail::power_coefficients<T, N>(z.real(), pow(z.real(), e), e));
+}
+
+template<typename T, int N>
+FixedMultiComplex<T, N> pow(const FixedMultiComplex<T, N>& z, const FixedMultiComplex<T, N>& e) {
+    return exp(e*log(z));
+}
+
+template<typename T, int N>
+FixedMultiComplex<T, N> pow(double x, const FixedMultiComplex<T, N>& e) {
+    using std::log;
+    return exp(e*log(x));
+}
+
+template<typename T, int N>
+FixedMultiComplex<T, N> sqrt(const FixedMultiComplex<T, N>& z) {
+    using std::sqrt;
+    return detail::taylor(z, detail::power_coefficients<T, N>(z.real(), sqrt(z.real()), 0.5));
+}
+
+template<typename T, int N>
+FixedMultiComplex<T, N> cbrt(const FixedMultiComplex<T, N>& z) {
+    using std::cbrt;
+    return detail::taylor(z, detail::power_coefficients<T, N>(z.real(), cbrt(z.real()), 1.0/3.0));
+}
+
+template<typename T, int N>
+FixedMultiComplex<T, N> sin(const FixedMultiComplex<T, N>& z) {
+    using std::sin; using std::cos;
+    // The derivatives cycle through sin, cos, -sin, -cos
+    const T d[4] = { sin(z.real()), cos(z.real()), -sin(z.real()), -cos(z.real()) };
+    std::array<T, N + 1> c;
+    T fact = T(1);
+    for (int k = 0; k <= N; ++k) { if (k > 0) { fact *= k; } c[k] = d[k % 4]/fact; }
+    return detail::taylor(z, c);
+}
+
+template<typename T, int N>
+FixedMultiComplex<T, N> cos(const FixedMultiComplex<T, N>& z) {
+    using std::sin; using std::cos;
+    const T d[4] = { cos(z.real()), -sin(z.real()), -cos(z.real()), sin(z.real()) };
+    std::array<T, N + 1> c;
+    T fact = T(1);
+    for (int k = 0; k <= N; ++k) { if (k > 0) { fact *= k; } c[k] = d[k % 4]/fact; }
+    return detail::taylor(z, c);
+}
+
+template<typename T, int N>
+FixedMultiComplex<T, N> sinh(const FixedMultiComplex<T, N>& z) {
+    using std::sinh; using std::cosh;
+    const T d[2] = { sinh(z.real()), cosh(z.real()) };
+    std::array<T, N + 1> c;
+    T fact = T(1);
+    for (int k = 0; k <= N; ++k) { if (k > 0) { fact *= k; } c[k] = d[k % 2]/fact; }
+    return detail::taylor(z, c);
+}
+
+template<typename T, int N>
+FixedMultiComplex<T, N> cosh(const FixedMultiComplex<T, N>& z) {
+    using std::sinh; using std::cosh;
+    const T d[2] = { cosh(z.real()), sinh(z.real()) };
+    std::array<T, N + 1> c;
+    T fact = T(1);
+    for (int k = 0; k <= N; ++k) { if (k > 0) { fact *= k; } c[k] = d[k % 2]/fact; }
+    return detail::taylor(z, c);
+}
+
+template<typename T, int N>
+FixedMultiComplex<T, N> tanh(const FixedMultiComplex<T, N>& z) {
+    return sinh(z)/cosh(z);
+}
+
+template<typename T, int N>
+auto pow(const FixedMultiComplex<T, N>& x, const Eigen::ArrayXd& e) {
+    Eigen::Array<FixedMultiComplex<T, N>, Eigen::Dynamic, 1> o(e.size());
+    for (auto i = 0; i < e.size(); ++i) {
+        o[i] = pow(x, e[i]);
+    }
+    return o;
+}
+
+template<typename T, int N>
+auto pow(const Eigen::ArrayX<FixedMultiComplex<T, N>>& x, const int& e) {
+    auto y = x;
+    for (auto i = 0; i < x.size(); ++i) {
+        y[i] = powi(x[i], e);
+    }
+    return y;
+}
+
+/// The step of the imaginary parts, chosen such that \f$h^N\f$ is still a normal double
+template<int N>
+constexpr double fixed_mcx_step() {
+    double h = 1.0;
+    const int e = (N <= 3) ? 100 : 300/N;
+    for (int k = 0; k < e; ++k) { h /= 10.0; }
+    return h;
+}
+
+/**
+ * \brief The derivatives of a function of one variable up to order N, along with the value
+ * \returns An array whose n-th entry is \f$f^{(n)}(x)\f$
+ *
+ * The function is called once with a FixedMultiComplex<T,N> argument, and may be a generic lambda
+ */
+template<int N, typename T, typename Function>
+std::array<T, N + 1> diff_fixed_mcx1(const Function& f, const T& x) {
+    const T h = fixed_mcx_step<N>();
+    FixedMultiComplex<T, N> z = x;
+    for (int k = 0; k < N; ++k) { z.coef[std::size_t(1) << k] = h; }
+    const auto r = f(z);
+    std::array<T, N + 1> o;
+    o[0] = r.real();
+    T hn = T(1);
+    for (int n = 1; n <= N; ++n) {
+        hn *= h;
+        o[n] = r.coef[(std::size_t(1) << n) - 1]/hn;
+    }
+    return o;
+}
+
+/**
+ * \brief The mixed derivative \f$\partial^{N_1+N_2}f/\partial x_1^{N_1}\partial x_2^{N_2}\f$ of a function of two variables
+ *
+ * The first N1 imaginary units are given to the first variable and the remaining N2 to the second
+ */
+template<int N1, int N2, typename T, typename Function>
+T diff_fixed_mcx2(const Function& f, const T& x1, const T& x2) {
+    constexpr int N = N1 + N2;
+    const T h = fixed_mcx_step<N>();
+    FixedMultiComplex<T, N> z1 = x1, z2 = x2;
+    for (int k = 0; k < N1; ++k) { z1.coef[std::size_t(1) << k] = h; }
+    for (int k = N1; k < N; ++k) { z2.coef[std::size_t(1) << k] = h; }
+    const auto r = f(z1, z2);
+    T hn = T(1);
+    for (int n = 0; n < N; ++n) { hn *= h; }
+    return r.coef.back()/hn;
+}
+
+} // namespace fixedmcx
+
+using fixedmcx::FixedMultiComplex;
+using fixedmcx::fixed_mcx_step;
+using fixedmcx::diff_fixed_mcx1;
+using fixedmcx::diff_fixed_mcx2;
+
+template<typename T, int N> struct is_mcx_t<FixedMultiComplex<T, N>> : public std::true_type {};
+
+}
+
+// See https://eigen.tuxfamily.org/dox/TopicCustomizing_CustomScalar.html
+namespace Eigen {
+    template<typename T, int N> struct NumTraits<teqp::fixedmcx::FixedMultiComplex<T, N>> : NumTraits<double>
+    {
+        enum {
+            IsComplex = 1,
+            IsInteger = 0,
+            IsSigned = 1,
+            RequireInitialization = 1,
+            ReadCost = 1,
+            AddCost = 3,
+            MulCost = 3
+        };
+    };
+}
@@ -0,0 +1,114 @@
+/**
+
+ Matrix-free iterative solution of linear systems, for systems whose matrix is only available through its product with vectors
+ (for instance Hessians of the Helmholtz energy density obtained as Hessian-vector products)
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <Eigen/Dense>
+
+namespace teqp{
+
+struct KrylovOptions {
+    int max_iter = 200; ///< The maximum number of products with the matrix
+    int restart = 30; ///< The dimension of the Krylov subspace before restarting
+    double rtol = 1e-12; ///< The tolerance on the norm of the residual, relative to that of the right-hand side
+    double atol = 0.0; ///< The absolute tolerance on the norm of the residual
+};
+
+struct KrylovResult {
+    Eigen::VectorXd x; ///< The solution
+    int num_iter = 0; ///< The number of products with the matrix
+    double residual_norm = 0.0; ///< The norm of the residual of the linear system
+    bool converged = false;
+};
+
+/**
+ Restarted GMRES for \f$Ax = b\f$, where the operator \f$A\f$ is a callable returning the product \f$Av\f$ for a vector \f$v\f$
+
+ The subspace dimension is limited to the size of the system, so without restarting the exact solution is obtained after at most that many products
+*/
+template<typename Operator>
+inline KrylovResult gmres(const Operator& A, const Eigen::VectorXd& b, const KrylovOptions& opt = {}){
+    const auto N = b.size();
+    KrylovResult res;
+    res.x = Eigen::VectorXd::Zero(N);
+    const double bnorm = b.norm();
+    if (bnorm == 0){
+        res.converged = true;
+        return res;
+    }
+    const double tol = std::max(opt.rtol*bnorm, opt.atol);
+    const int m = static_cast<int>(std::min<Eigen::Index>(opt.restart, N));
+
+    Eigen::MatrixXd V(N, m+1), H(m+1, m);
+    Eigen::VectorXd cs(m), sn(m), g(m+1);
+    while (res.num_iter < opt.max_iter){
+        Eigen::VectorXd r = b - Eigen::VectorXd(A(res.x));
+        double beta = r.norm();
+        res.residual_norm = beta;
+        if (beta <= tol){
+            res.converged = true;
+            break;
+        }
+        V.col(0) = r/beta;
+        H.setZero();
+        g.setZero(); g(0) = beta;
+        int k = 0;
+        bool breakdown = false;
+        while (k < m && res.num_iter < opt.max_iter){
+            Eigen::VectorXd w = A(Eigen::VectorXd(V.col(k)));
+            res.num_iter++;
+            // Anything smaller than this after orthogonalization is round-off
+            const double eps = 1e3*std::numeric_limits<double>::epsilon()*w.norm();
+            // Modified Gram-Schmidt orthogonalization against the basis
+            for (auto j = 0; j <= k; ++j){
+                H(j, k) = w.dot(V.col(j));
+                w -= H(j, k)*V.col(j);
+            }
+            double hnext = w.norm();
+            if (hnext <= eps){
+                hnext = 0;
+            }
+            // Apply the previous Givens rotations to the new column, then eliminate the subdiagonal entry
+            for (auto j = 0; j < k; ++j){
+                double tmp = cs(j)*H(j, k) + sn(j)*H(j+1, k);
+                H(j+1, k) = -sn(j)*H(j, k) + cs(j)*H(j+1, k);
+                H(j, k) = tmp;
+            }
+            double denom = std::hypot(H(k, k), hnext);
+            if (denom <= eps){
+                breakdown = true; // Singular system
+                break;
+            }
+            cs(k) = H(k, k)/denom; sn(k) = hnext/denom;
+            H(k, k) = denom;
+            g(k+1) = -sn(k)*g(k); g(k) = cs(k)*g(k);
+            res.residual_norm = std::abs(g(k+1));
+            ++k;
+            if (hnext == 0 || res.residual_norm <= tol){
+                break; // The subspace is invariant, or the tolerance is met
+            }
+            V.col(k) = w/hnext;
+        }
+        if (k > 0){
+            Eigen::VectorXd y = H.topLeftCorner(k, k).triangularView<Eigen::Upper>().solve(g.head(k));
+            res.x += V.leftCols(k)*y;
+        }
+        if (breakdown){
+            break;
+        }
+        if (res.residual_norm <= tol){
+            res.converged = true;
+            break;
+        }
+    }
+    return res;
+}
+
+}
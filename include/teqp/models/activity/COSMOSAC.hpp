@@ -6,6 +6,8 @@
  DOI: 10.1021/acs.jctc.9b01016
  */
 
+#include "teqp/instrumentation.hpp"
+
 namespace teqp::activity::activity_models::COSMOSAC{
 
 /**
@@ -226,6 +228,7 @@ public:
             
             auto AA = (Eigen::exp(-DELTAW / (R*T)).template cast<TXType>().rowwise()*psigmas.template cast<TXType>().transpose()).eval();
             for (auto counter = 0; counter <= max_iter; ++counter) {
+                TEQP_COUNT(COSMOSAC_iterations, 1);
                 Gammanew = 1 / (AA.rowwise()*Gamma.transpose()).rowwise().sum();
                 Gamma = (Gamma + Gammanew) / 2;
                 double maxdiff = getbaseval(((Gamma - Gammanew) / Gamma).cwiseAbs().real().maxCoeff());
@@ -261,6 +264,7 @@ public:
             //auto midTime2 = std::chrono::high_resolution_clock::now();
             
             for (auto counter = 0; counter <= max_iter; ++counter) {
+                TEQP_COUNT(COSMOSAC_iterations, 1);
                 for (Eigen::Index offset : {51*0, 51*1, 51*2}){
                     Gammanew.segment(offset + ileft, w) = 1 / (
                                                                AA.matrix().block(offset+ileft,51*0+ileft,w,w).array().rowwise()*Gamma.segment(51*0+ileft, w).transpose()
@@ -29,14 +29,56 @@ namespace teqp{
         template<typename MoleFracType>
         auto R(const MoleFracType&) const { return 8.314471; }
 
+        const double gamma = 0.5248379;
+
+        /**
+         \brief The quantities that depend only on composition
+         
+         These can be obtained once from \ref prepare_composition and reused for repeated evaluations at the same composition
+         */
+        template<typename MoleFracType>
+        struct CompositionState {
+            MoleFracType xNH3;
+            MoleFracType Tred; ///< Reducing temperature
+            MoleFracType rhored; ///< Reducing density
+            MoleFracType depfactor; ///< The factor xNH3*(1-xNH3^gamma) of the departure function
+        };
+
+        /// Evaluate the composition-dependent quantities of the model for a given composition
+        template<typename MoleFracs>
+        auto prepare_composition(const MoleFracs& molefrac) const {
+            using x_t = std::decay_t<decltype(molefrac[0])>;
+            if (molefrac.size() != 2) {
+                throw teqp::InvalidArgument("Wrong size of molefrac, should be 2");
+            }
+            x_t xNH3 = molefrac[0];
+            if (getbaseval(xNH3) == 0) {
+                throw teqp::InvalidArgument("Tillner-Roth model cannot accept mole fraction of zero");
+            }
+            CompositionState<x_t> state;
+            state.xNH3 = xNH3;
+            state.Tred = forceeval(TcNH3*xNH3*xNH3 + TcH2O*(1-xNH3)*(1-xNH3) + 2.0*xNH3*(1.0-pow(xNH3, alpha))*k_T/2.0*(TcNH3 + TcH2O));
+            auto vred = forceeval(vcNH3*xNH3*xNH3 + vcH2O*(1-xNH3)*(1-xNH3) + 2.0*xNH3*(1.0-pow(xNH3, beta))*k_V/2.0*(vcNH3 + vcH2O));
+            state.rhored = forceeval(1/vred);
+            state.depfactor = forceeval(xNH3 * (1 - pow(xNH3, gamma)));
+            return state;
+        }
+
+        /// The departure function, without the factor of xNH3*(1-xNH3^gamma)
         template<typename TType, typename RhoType, typename MoleFracType>
-        auto alphar_departure(const TType& tau, const RhoType& delta, const MoleFracType& xNH3) const
+        auto alphar_departure_sum(const TType& tau, const RhoType& delta, const MoleFracType& xNH3) const
         {
             std::common_type_t<TType, RhoType, MoleFracType> summer = a[1]*pow(tau, t[1])*pow(delta, d[1]);
             for (auto i=2; i <= 6; ++i){ summer = summer + a[i]*pow(tau, t[i])*pow(delta, d[i])*exp(-pow(delta,e[i]));}
             for (auto i=7; i <= 13; ++i){ summer = summer + xNH3*a[i]*pow(tau, t[i])*pow(delta, d[i])*exp(-pow(delta,e[i]));}
             for (auto i=14; i <= 14; ++i) { summer = summer + xNH3*xNH3 * a[i] * pow(tau, t[i]) * pow(delta, d[i]) * exp(-pow(delta, e[i])); }
-            double gamma = 0.5248379;
+            return summer;
+        }
+
+        template<typename TType, typename RhoType, typename MoleFracType>
+        auto alphar_departure(const TType& tau, const RhoType& delta, const MoleFracType& xNH3) const
+        {
+            auto summer = alphar_departure_sum(tau, delta, xNH3);
             // xNH3^gamma is not differentiable at xNH3=0, but limit when multiplied by zero is still zero
             if (getbaseval(xNH3) == 0) {
                 return static_cast<decltype(summer)>(0.0);
@@ -46,16 +88,7 @@ namespace teqp{
         
         template<typename MoleFracType>
         auto get_Treducing(const MoleFracType& molefrac) const {
-            if (molefrac.size() != 2) {
-                throw teqp::InvalidArgument("Wrong size of molefrac, should be 2");
-            }
-            auto xNH3 = molefrac[0];
-            if (getbaseval(xNH3) == 0) {
-                throw teqp::InvalidArgument("Tillner-Roth model cannot accept mole fraction of zero");
-                return static_cast<decltype(xNH3)>(TcH2O);
-            }
-            auto Tred = forceeval(TcNH3*xNH3*xNH3 + TcH2O*(1-xNH3)*(1-xNH3) + 2.0*xNH3*(1.0-pow(xNH3, alpha))*k_T/2.0*(TcNH3 + TcH2O));
-            return Tred;
+            return prepare_composition(molefrac).Tred;
         }
         template<typename MoleFracType>
         auto get_reducing_temperature(const MoleFracType& molefrac) const {
@@ -64,16 +97,7 @@ namespace teqp{
         
         template<typename MoleFracType>
         auto get_rhoreducing(const MoleFracType& molefrac) const {
-            if (molefrac.size() != 2) {
-                throw teqp::InvalidArgument("Wrong size of molefrac, should be 2");
-            }
-            auto xNH3 = molefrac[0];
-            if (getbaseval(xNH3) == 0) {
-                throw teqp::InvalidArgument("Tillner-Roth model cannot accept mole fraction of zero");
-                return static_cast<decltype(xNH3)>(forceeval(1/vcH2O));
-            }
-            auto vred = forceeval(vcNH3*xNH3*xNH3 + vcH2O*(1-xNH3)*(1-xNH3) + 2.0*xNH3*(1.0-pow(xNH3, beta))*k_V/2.0*(vcNH3 + vcH2O));
-            return forceeval(1/vred);
+            return prepare_composition(molefrac).rhored;
         }
         template<typename MoleFracType>
         auto get_reducing_density(const MoleFracType& molefrac) const {
@@ -85,18 +109,61 @@ namespace teqp{
             const RhoType& rho,
             const MoleFracType& molefrac) const
         {
-            if (molefrac.size() != 2) {
-                throw teqp::InvalidArgument("Wrong size of molefrac, should be 2");
-            }
-            auto xNH3 = molefrac[0];
-            auto Tred = get_Treducing(molefrac);
-            auto rhored = get_rhoreducing(molefrac);
-            auto delta = forceeval(rho / rhored);
-            auto tau = forceeval(Tred / T);
+            return alphar_prepared(T, rho, prepare_composition(molefrac));
+        }
+
+        /// Evaluate alphar with the composition-dependent quantities obtained from \ref prepare_composition
+        template<typename TType, typename RhoType, typename MoleFracType>
+        auto alphar_prepared(const TType& T,
+            const RhoType& rho,
+            const CompositionState<MoleFracType>& state) const
+        {
+            const auto& xNH3 = state.xNH3;
+            auto delta = forceeval(rho / state.rhored);
+            auto tau = forceeval(state.Tred / T);
             auto val_CS = pures[0].alphar(tau, delta)*xNH3 + pures[1].alphar(tau, delta)*(1-xNH3);
-            auto val_dep = alphar_departure(tau, delta, xNH3);
+            auto val_dep = state.depfactor*alphar_departure_sum(tau, delta, xNH3);
             return forceeval(val_CS + val_dep);
         }
+
+        /**
+         \brief Evaluate alphar for many densities along an isotherm at fixed composition
+         
+         The composition-dependent quantities are evaluated once, and the factors of each term of the departure function
+         that depend only on tau are evaluated once for the isotherm. The density array may contain autodiff types, in
+         which case density derivatives are obtained for all the densities. The mole fractions must be of double type.
+         
+         \param T Temperature, in K
+         \param rhos The molar densities, in mol/m^3
+         \param molefrac The mole fractions
+         */
+        template<typename RhoArray, typename MoleFracs>
+        auto alphar_isotherm(const double T, const RhoArray& rhos, const MoleFracs& molefrac) const
+        {
+            using rho_t = std::decay_t<decltype(rhos[0])>;
+            const auto state = prepare_composition(molefrac);
+            const double xNH3 = state.xNH3, tau = state.Tred / T;
+            
+            // Coefficients of the departure function that are constant along the isotherm, with the composition factors folded in
+            Eigen::ArrayXd A(a.size());
+            for (auto i = 1; i < a.size(); ++i) {
+                double xfactor = (i <= 6) ? 1.0 : ((i <= 13) ? xNH3 : xNH3*xNH3);
+                A[i] = state.depfactor*xfactor*a[i]*pow(tau, t[i]);
+            }
+            
+            Eigen::Array<rho_t, Eigen::Dynamic, 1> o(rhos.size());
+            for (auto k = 0; k < rhos.size(); ++k) {
+                rho_t delta = rhos[k] / state.rhored;
+                // The exponential factors exp(-delta^e), shared by all the terms with the same exponent e
+                rho_t expdelta1 = exp(-delta), expdelta2 = exp(-delta*delta);
+                rho_t dep = A[1]*powi(delta, static_cast<int>(d[1]));
+                for (auto i = 2; i < a.size(); ++i) {
+                    dep += A[i]*powi(delta, static_cast<int>(d[i]))*((e[i] == 1) ? expdelta1 : expdelta2);
+                }
+                o[k] = pures[0].alphar(tau, delta)*xNH3 + pures[1].alphar(tau, delta)*(1-xNH3) + dep;
+            }
+            return o;
+        }
     };
 
 } /* */
\ No newline at end of file
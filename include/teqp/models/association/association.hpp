@@ -16,6 +16,7 @@ The implementation follows the approach of Langenbach for the index compression,
 #include "teqp/constants.hpp"
 #include "teqp/types.hpp"
 #include "teqp/exceptions.hpp"
+#include "teqp/instrumentation.hpp"
 
 #include <Eigen/Dense>
 #include "teqp/math/pow_templates.hpp"
@@ -417,6 +418,7 @@ public:
         }
         
         for (auto counter = 0; counter < options.max_iters; ++counter){
+            TEQP_COUNT(association_iterations, 1);
             // calculate the new array of non-bonded site fractions X
             Xnew = options.alpha*X + (1.0-options.alpha)/(1.0+(rDDX*X.matrix()).array());
             // These unaryExpr extract the numerical value from an Eigen array of generic type, allowing for comparison.
@@ -79,6 +79,9 @@ protected:
     
     nlohmann::json meta;
     
+    GroupedAlphaFunctions sqrt_a_over_b; ///< For evaluation of \f$\sqrt{a_i(T)/b_i}\f$
+    Eigen::ArrayXXd bmat; ///< The matrix of \f$b_{ij}\f$ for the quadratic mixing rule, symmetrized
+    
     template<typename TType, typename IndexType>
     auto get_ai(TType& T, IndexType i) const {
         auto alphai = std::visit([&](auto& t) { return t(T); }, alphas[i]);
@@ -112,6 +115,16 @@ public:
             bi[i] = OmegaB * R_JmolK * Tc_K[i] / pc_Pa[i];
         }
         check_lmat(ai.size());
+        std::valarray<NumType> a_over_b = ai/bi;
+        sqrt_a_over_b = GroupedAlphaFunctions(this->alphas, a_over_b);
+        const auto N = static_cast<Eigen::Index>(ai.size());
+        auto oneminusl = symmetrized_one_minus(this->lmat);
+        bmat.resize(N, N);
+        for (auto i = 0; i < N; ++i) {
+            for (auto j = 0; j < N; ++j) {
+                bmat(i, j) = oneminusl(i, j) * pow((pow(bi[i], 1.0/s) + pow(bi[j], 1.0/s))/2.0, s);
+            }
+        }
     };
     
     void set_meta(const nlohmann::json& j) { meta = j; }
@@ -169,8 +182,9 @@ public:
     auto get_am_over_bm(TType T, const CompType& molefracs) const {
         auto aEresRT = std::visit([&](auto& aresRTfunc) { return aresRTfunc(T, molefracs); }, ares); // aEres/RT, so a non-dimensional quantity
         std::common_type_t<TType, decltype(molefracs[0])> summer = aEresRT*R_JmolK*T/CEoS;
+        const auto sqrtaoverb = sqrt_a_over_b.get_sqrt_aalpha(T);
         for (auto i = 0U; i < molefracs.size(); ++i) {
-            summer += molefracs[i]*get_ai(T,i)/get_bi(T,i);
+            summer += molefracs[i]*POW2(sqrtaoverb[i]);
         }
         return forceeval(summer);
     }
@@ -181,15 +195,8 @@ public:
         
         switch (brule){
             case AdvancedPRaEMixingRules::kQuadratic:
-                for (auto i = 0U; i < molefracs.size(); ++i) {
-                    auto bi_ = get_bi(T, i);
-                    for (auto j = 0U; j < molefracs.size(); ++j) {
-                        auto bj_ = get_bi(T, j);
-                        
-                        auto bij = (1 - lmat(i,j)) * pow((pow(bi_, 1.0/s) + pow(bj_, 1.0/s))/2.0, s);
-                        b_ += molefracs[i] * molefracs[j] * bij;
-                    }
-                }
+                // The b_ij are independent of temperature, and were assembled at construction
+                b_ = symmetric_quadratic_form(bmat, molefracs);
                 break;
             case AdvancedPRaEMixingRules::kLinear:
                 for (auto i = 0U; i < molefracs.size(); ++i) {
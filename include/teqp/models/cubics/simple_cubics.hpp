@@ -32,6 +32,8 @@ private:
     mi;  ///< The "m" parameter
 public:
     BasicAlphaFunction(NumType Tci, NumType mi) : Tci(Tci), mi(mi) {};
+    auto get_Tci() const { return Tci; }
+    auto get_mi() const { return mi; }
     
     template<typename TType>
     auto operator () (const TType& T) const {
@@ -56,6 +58,8 @@ public:
             throw teqp::InvalidArgument("coefficients c for Twu alpha function must have length 3");
         }
     };
+    auto get_Tci() const { return Tci; }
+    const auto& get_c() const { return c; }
     template<typename TType>
     auto operator () (const TType& T) const {
         return forceeval(pow(T/Tci,c[2]*(c[1]-1))*exp(c[0]*(1.0-pow(T/Tci, c[1]*c[2]))));
@@ -84,6 +88,8 @@ public:
             throw teqp::InvalidArgument("coefficients c for Mathias-Copeman alpha function must have length 3");
         }
     };
+    auto get_Tci() const { return Tci; }
+    const auto& get_c() const { return c; }
     template<typename TType>
     auto operator () (const TType& T) const {
         auto x = 1.0 - sqrt(T/Tci);
@@ -94,6 +100,139 @@ public:
 
 using AlphaFunctionOptions = std::variant<BasicAlphaFunction<double>, TwuAlphaFunction<double>, MathiasCopemanAlphaFunction<double>>;
 
+/**
+ * \brief The alpha functions of all the components of a mixture, grouped by kind
+ *
+ * Each group is evaluated as one array expression over its components to yield \f$\sqrt{a_i\alpha_i(T)}\f$, with
+ * all the temperature-independent constants folded at construction:
+ *
+ * - Basic: \f$\sqrt{a_i\alpha_i} = A_{0,i} + A_{1,i}\sqrt{T}\f$
+ * - Twu: \f$\sqrt{a_i\alpha_i} = \sqrt{a_i}\exp\left(\frac{c_{2}(c_{1}-1)}{2}\ln T_{r} + \frac{c_0}{2}(1-\exp(c_1c_2\ln T_r))\right)\f$
+ * - Mathias-Copeman: \f$\sqrt{a_i\alpha_i} = \sqrt{a_i}(1+c_0x + c_1x^2 + c_2x^3)\f$ with \f$x=1-\sqrt{T}/\sqrt{T_{ci}}\f$
+ *
+ * The magnitudes of the Basic and Mathias-Copeman expressions are returned, as \f$\alpha_i\f$ is their square
+ */
+class GroupedAlphaFunctions {
+private:
+    struct BasicGroup { std::vector<Eigen::Index> idx; Eigen::ArrayXd A0, A1; };
+    struct TwuGroup { std::vector<Eigen::Index> idx; Eigen::ArrayXd sqrta, lnTc, he1, hc0, e2; };
+    struct MathiasCopemanGroup { std::vector<Eigen::Index> idx; Eigen::ArrayXd sqrta, invsqrtTc, c0, c1, c2; };
+    BasicGroup basic;
+    TwuGroup twu;
+    MathiasCopemanGroup mc;
+    Eigen::Index N = 0;
+    
+    template<typename Group>
+    static void resize_group(Group& g, std::initializer_list<Eigen::ArrayXd*> arrays) {
+        for (auto a : arrays) { a->resize(static_cast<Eigen::Index>(g.idx.size())); }
+    }
+    
+    template<typename TType, typename Values>
+    static void scatter(const std::vector<Eigen::Index>& idx, const Values& v, Eigen::ArrayX<TType>& o) {
+        for (auto k = 0U; k < idx.size(); ++k) { o[idx[k]] = v[k]; }
+    }
+    
+    /// Scatter the magnitudes; the polynomial brackets change sign far above Tc, where \f$\sqrt{a_i\alpha_ia_j\alpha_j}\f$ is still positive
+    template<typename TType, typename Values>
+    static void scatter_abs(const std::vector<Eigen::Index>& idx, const Values& v, Eigen::ArrayX<TType>& o) {
+        for (auto k = 0U; k < idx.size(); ++k) { o[idx[k]] = (getbaseval(v[k]) < 0) ? TType(-v[k]) : TType(v[k]); }
+    }
+    
+public:
+    GroupedAlphaFunctions() = default;
+    template<typename AlphaFunctions>
+    GroupedAlphaFunctions(const AlphaFunctions& alphas, const std::valarray<double>& ai) : N(static_cast<Eigen::Index>(alphas.size())) {
+        if (ai.size() != alphas.size()) {
+            throw teqp::InvalidArgument("alphas and ai must be the same length");
+        }
+        for (auto i = 0U; i < alphas.size(); ++i) {
+            if (std::holds_alternative<BasicAlphaFunction<double>>(alphas[i])) { basic.idx.push_back(i); }
+            else if (std::holds_alternative<TwuAlphaFunction<double>>(alphas[i])) { twu.idx.push_back(i); }
+            else { mc.idx.push_back(i); }
+        }
+        resize_group(basic, {&basic.A0, &basic.A1});
+        for (auto k = 0U; k < basic.idx.size(); ++k) {
+            auto i = basic.idx[k];
+            const auto& f = std::get<BasicAlphaFunction<double>>(alphas[i]);
+            auto sqrta = sqrt(ai[i]), m = f.get_mi();
+            basic.A0[k] = sqrta*(1.0 + m);
+            basic.A1[k] = -sqrta*m/sqrt(f.get_Tci());
+        }
+        resize_group(twu, {&twu.sqrta, &twu.lnTc, &twu.he1, &twu.hc0, &twu.e2});
+        for (auto k = 0U; k < twu.idx.size(); ++k) {
+            auto i = twu.idx[k];
+            const auto& f = std::get<TwuAlphaFunction<double>>(alphas[i]);
+            const auto& c = f.get_c();
+            twu.sqrta[k] = sqrt(ai[i]);
+            twu.lnTc[k] = log(f.get_Tci());
+            twu.he1[k] = 0.5*c[2]*(c[1]-1);
+            twu.hc0[k] = 0.5*c[0];
+            twu.e2[k] = c[1]*c[2];
+        }
+        resize_group(mc, {&mc.sqrta, &mc.invsqrtTc, &mc.c0, &mc.c1, &mc.c2});
+        for (auto k = 0U; k < mc.idx.size(); ++k) {
+            auto i = mc.idx[k];
+            const auto& f = std::get<MathiasCopemanAlphaFunction<double>>(alphas[i]);
+            const auto& c = f.get_c();
+            mc.sqrta[k] = sqrt(ai[i]);
+            mc.invsqrtTc[k] = 1.0/sqrt(f.get_Tci());
+            mc.c0[k] = c[0]; mc.c1[k] = c[1]; mc.c2[k] = c[2];
+        }
+    }
+    
+    /// Return \f$\sqrt{a_i\alpha_i(T)}\f$ for all the components
+    template<typename TType>
+    auto get_sqrt_aalpha(const TType& T) const {
+        using R = std::decay_t<TType>;
+        Eigen::ArrayX<R> o(N);
+        if (!basic.idx.empty() || !mc.idx.empty()) {
+            R sqrtT = sqrt(T);
+            if (!basic.idx.empty()) {
+                Eigen::ArrayX<R> v = basic.A0.template cast<R>() + basic.A1.template cast<R>()*sqrtT;
+                scatter_abs(basic.idx, v, o);
+            }
+            if (!mc.idx.empty()) {
+                Eigen::ArrayX<R> x = mc.invsqrtTc.template cast<R>()*(-sqrtT) + R(1.0);
+                Eigen::ArrayX<R> paren = ((mc.c2.template cast<R>()*x + mc.c1.template cast<R>())*x + mc.c0.template cast<R>())*x + R(1.0);
+                scatter_abs(mc.idx, (mc.sqrta.template cast<R>()*paren).eval(), o);
+            }
+        }
+        if (!twu.idx.empty()) {
+            R lnT = log(T);
+            Eigen::ArrayX<R> lnTr = (-twu.lnTc).template cast<R>() + lnT;
+            Eigen::ArrayX<R> hc0 = twu.hc0.template cast<R>();
+            Eigen::ArrayX<R> v = twu.sqrta.template cast<R>()*(twu.he1.template cast<R>()*lnTr + hc0 - hc0*(twu.e2.template cast<R>()*lnTr).exp()).exp();
+            scatter(twu.idx, v, o);
+        }
+        return o;
+    }
+};
+
+/**
+ * \brief Evaluate the quadratic form \f$\sum_i\sum_j y_iy_jM_{ij}\f$ for a symmetric matrix \f$M\f$
+ *
+ * Only the diagonal and upper triangle of \f$M\f$ are visited, the off-diagonal terms being doubled
+ */
+template<typename YType>
+auto symmetric_quadratic_form(const Eigen::ArrayXXd& M, const YType& y){
+    using result = std::decay_t<decltype(y[0])>;
+    const auto N = static_cast<Eigen::Index>(y.size());
+    result sum = 0.0;
+    for (auto i = 0; i < N; ++i) {
+        result offdiag = 0.0;
+        for (auto j = i+1; j < N; ++j) {
+            offdiag += M(i,j)*y[j];
+        }
+        sum += y[i]*(M(i,i)*y[i] + 2.0*offdiag);
+    }
+    return sum;
+}
+
+/// Symmetrize a matrix of pairwise corrections \f$k_{ij}\f$ into \f$1-(k_{ij}+k_{ji})/2\f$, which yields the same double sums
+inline Eigen::ArrayXXd symmetrized_one_minus(const Eigen::ArrayXXd& kmat){
+    return 1.0 - (kmat + kmat.transpose())/2.0;
+}
+
 template<typename TC>
 auto build_alpha_functions(const TC& Tc_K, const nlohmann::json& jalphas){
     std::vector<AlphaFunctionOptions> alphas;
@@ -144,6 +283,9 @@ protected:
     nlohmann::json meta;
     const double m_R_JmolK;
     
+    GroupedAlphaFunctions grouped_alphas; ///< The alpha functions, grouped by kind for evaluation
+    Eigen::ArrayXXd oneminusk; ///< The matrix of \f$1-(k_{ij}+k_{ji})/2\f$
+    
     template<typename TType, typename IndexType>
     auto get_ai(TType /*T*/, IndexType i) const { return ai[i]; }
     
@@ -164,6 +306,9 @@ protected:
     }
     
 public:
+    /// alphar is generic in the types of its arguments, including autodiff types built on float, see screening.hpp
+    static constexpr bool single_precision_screening = true;
+
     GenericCubic(NumType Delta1, NumType Delta2, NumType OmegaA, NumType OmegaB, int superanc_index, const std::valarray<NumType>& Tc_K, const std::valarray<NumType>& pc_Pa, const AlphaFunctions& alphas, const Eigen::ArrayXXd& kmat, const double R_JmolK)
     : Delta1(Delta1), Delta2(Delta2), OmegaA(OmegaA), OmegaB(OmegaB), superanc_index(superanc_index), alphas(alphas), kmat(kmat), m_R_JmolK(R_JmolK)
     {
@@ -174,6 +319,8 @@ public:
             bi[i] = OmegaB * m_R_JmolK * Tc_K[i] / pc_Pa[i];
         }
         check_kmat(ai.size());
+        grouped_alphas = GroupedAlphaFunctions(this->alphas, ai);
+        oneminusk = symmetrized_one_minus(this->kmat);
     };
     
     void set_meta(const nlohmann::json& j) { meta = j; }
@@ -214,20 +361,21 @@ public:
         return m_R_JmolK;
     }
     
+    /**
+     \brief The mixture attraction parameter \f$a=\sum_i\sum_j x_ix_j(1-k_{ij})\sqrt{a_i\alpha_ia_j\alpha_j}\f$
+     
+     Evaluated as the quadratic form \f$y^{\rm T}(1-K)y\f$ with \f$y_i=x_i\sqrt{a_i\alpha_i}\f$, using only the upper triangle of the symmetric matrix
+     */
     template<typename TType, typename CompType>
     auto get_a(TType T, const CompType& molefracs) const {
-        std::common_type_t<TType, decltype(molefracs[0])> a_ = 0.0;
-        for (auto i = 0U; i < molefracs.size(); ++i) {
-            auto alphai = forceeval(std::visit([&](auto& t) { return t(T); }, alphas[i]));
-            auto ai_ = forceeval(this->ai[i] * alphai);
-            for (auto j = 0U; j < molefracs.size(); ++j) {
-                auto alphaj = forceeval(std::visit([&](auto& t) { return t(T); }, alphas[j]));
-                auto aj_ = this->ai[j] * alphaj;
-                auto aij = forceeval((1 - kmat(i,j)) * sqrt(ai_ * aj_));
-                a_ = a_ + molefracs[i] * molefracs[j] * aij;
-            }
+        using result = std::common_type_t<TType, decltype(molefracs[0])>;
+        const auto sqrtaalpha = grouped_alphas.get_sqrt_aalpha(T);
+        const auto N = static_cast<Eigen::Index>(molefracs.size());
+        Eigen::ArrayX<result> y(N);
+        for (auto i = 0; i < N; ++i) {
+            y[i] = molefracs[i]*sqrtaalpha[i];
         }
-        return forceeval(a_);
+        return forceeval(symmetric_quadratic_form(oneminusk, y));
     }
     
     template<typename TType, typename CompType>
@@ -253,6 +401,60 @@ public:
         auto val = Psiminus - get_a(T, molefrac) / (m_R_JmolK * T) * Psiplus;
         return forceeval(val);
     }
+    
+    /// The parameters of ensemble evaluations: the symmetrized \f$k_{ij}\f$ for \f$i<j\f$, ordered as (0,1), (0,2), ..., (1,2), ...
+    Eigen::ArrayXd get_ensemble_parameters() const {
+        const auto N = oneminusk.rows();
+        Eigen::ArrayXd k(N*(N-1)/2);
+        Eigen::Index p = 0;
+        for (auto i = 0; i < N; ++i) {
+            for (auto j = i+1; j < N; ++j) {
+                k[p++] = 1.0 - oneminusk(i, j);
+            }
+        }
+        return k;
+    }
+    
+    /**
+     \brief The basis of ensemble evaluations over the parameters returned by get_ensemble_parameters
+     
+     \f$\alpha^{\rm r}\f$ is linear in \f$a\f$ and thus in each \f$k_{ij}\f$. The first entry is \f$\alpha^{\rm r}\f$ with all the \f$k_{ij}\f$ (\f$i\neq j\f$) set to zero
+     and the entry for the pair \f$(i,j)\f$ is \f$2y_iy_j\Psi^{(+)}/(RT)\f$ with \f$y_i=x_i\sqrt{a_i\alpha_i}\f$
+     */
+    template<typename TType, typename RhoType, typename MoleFracType>
+    auto alphar_ensemble_basis(const TType& T,
+                const RhoType& rho,
+                const MoleFracType& molefrac) const
+    {
+        if (static_cast<std::size_t>(molefrac.size()) != alphas.size()) {
+            throw std::invalid_argument("Sizes do not match");
+        }
+        using result = std::common_type_t<TType, RhoType, std::decay_t<decltype(molefrac[0])>>;
+        const auto N = static_cast<Eigen::Index>(molefrac.size());
+        const auto sqrtaalpha = grouped_alphas.get_sqrt_aalpha(T);
+        Eigen::ArrayX<result> y(N);
+        for (auto i = 0; i < N; ++i) {
+            y[i] = molefrac[i]*sqrtaalpha[i];
+        }
+        auto b = get_b(T, molefrac);
+        auto Psiminus = -log(1.0 - b * rho);
+        auto Psiplus = log((Delta1 * b * rho + 1.0) / (Delta2 * b * rho + 1.0)) / (b * (Delta1 - Delta2));
+        result C = forceeval(Psiplus / (m_R_JmolK * T));
+        
+        Eigen::ArrayX<result> o(1 + N*(N-1)/2);
+        result a0 = 0.0;
+        Eigen::Index p = 1;
+        for (auto i = 0; i < N; ++i) {
+            result offdiag = 0.0;
+            for (auto j = i+1; j < N; ++j) {
+                offdiag += y[j];
+                o[p++] = forceeval(2.0*y[i]*y[j]*C);
+            }
+            a0 += y[i]*(oneminusk(i,i)*y[i] + 2.0*offdiag);
+        }
+        o[0] = forceeval(Psiminus - a0*C);
+        return o;
+    }
 };
 
 template <typename TCType, typename PCType, typename AcentricType>
@@ -453,6 +655,11 @@ private:
     const Eigen::ArrayXXd kmat, lmat;
     const double Ru;
     
+    // Precomputed temperature-independent quantities
+    Eigen::ArrayXd b_scale; ///< The prefactors of the quantum corrections: \f$b_{c,i}/(1+A_i/(T_{c,i}+B_i))^3\f$
+    GroupedAlphaFunctions sqrt_a; ///< For evaluation of \f$\sqrt{a_i(T)}\f$
+    Eigen::ArrayXXd oneminusk, oneminusl; ///< The symmetrized pair factors \f$1-k_{ij}\f$ and \f$1-l_{ij}\f$
+    
     auto build_alphas(const nlohmann::json& j){
         std::vector<AlphaFunctionOptions> alphas_;
         std::vector<double> L = j.at("Ls"), M = j.at("Ms"), N = j.at("Ns");
@@ -469,7 +676,23 @@ private:
     std::vector<double> get_(const nlohmann::json &j, const std::string& k) const { return j.at(k).get<std::vector<double>>(); }
 public:
     
-    QuantumCorrectedPR(const nlohmann::json &j) : Tc_K(get_(j, "Tcrit / K")), pc_Pa(get_(j, "pcrit / Pa")), alphas(build_alphas(j)), As(get_(j, "As")), Bs(get_(j, "Bs")), cs_m3mol(get_(j, "cs / m^3/mol")), kmat(build_square_matrix(j.at("kmat"))), lmat(build_square_matrix(j.at("lmat"))), Ru(j.value("R / J/mol/K", constants::R_CODATA2017)) {}
+    QuantumCorrectedPR(const nlohmann::json &j) : Tc_K(get_(j, "Tcrit / K")), pc_Pa(get_(j, "pcrit / Pa")), alphas(build_alphas(j)), As(get_(j, "As")), Bs(get_(j, "Bs")), cs_m3mol(get_(j, "cs / m^3/mol")), kmat(build_square_matrix(j.at("kmat"))), lmat(build_square_matrix(j.at("lmat"))), Ru(j.value("R / J/mol/K", constants::R_CODATA2017)) {
+        std::size_t N = alphas.size();
+        if (kmat.rows() != static_cast<Eigen::Index>(N) || lmat.rows() != static_cast<Eigen::Index>(N)){
+            throw teqp::InvalidArgument("kmat and lmat must be square matrices the same size as the number of components [" + std::to_string(N) + "]");
+        }
+        b_scale.resize(N);
+        std::valarray<double> ai(N);
+        for (auto i = 0U; i < N; ++i){
+            // See https://doi.org/10.1021/acs.iecr.1c00847 for the exact value: OmegaB = 0.077796073903888455972;
+            b_scale[i] = 0.07780*Tc_K[i]*Ru/pc_Pa[i]/POW3(1.0+As[i]/(Tc_K[i]+Bs[i]));
+            // See https://doi.org/10.1021/acs.iecr.1c00847
+            ai[i] = 0.45723552892138218938*POW2(Tc_K[i]*Ru)/pc_Pa[i];
+        }
+        sqrt_a = GroupedAlphaFunctions(alphas, ai);
+        oneminusk = symmetrized_one_minus(kmat);
+        oneminusl = symmetrized_one_minus(lmat);
+    }
     
     
     
@@ -484,10 +707,7 @@ public:
     
     template<typename TType>
     auto get_bi(std::size_t i, const TType& T) const {
-        auto beta = POW3(1.0 + As[i]/(T+Bs[i]))/POW3(1.0+As[i]/(Tc_K[i]+Bs[i]));
-        // See https://doi.org/10.1021/acs.iecr.1c00847 for the exact value: OmegaB = 0.077796073903888455972;
-        auto b = 0.07780*Tc_K[i]*Ru/pc_Pa[i];
-        return forceeval(b*beta);
+        return forceeval(b_scale[i]*POW3(1.0 + As[i]/(T+Bs[i])));
     }
     
     template<typename TType>
@@ -499,21 +719,27 @@ public:
         return forceeval(a*alphai);
     }
     
+    /// Return the mixture parameters \f$a=\sum_i\sum_jz_iz_j\sqrt{a_ia_j}(1-k_{ij})\f$ and \f$b=\sum_i\sum_jz_iz_j(b_i+b_j)(1-l_{ij})/2\f$ as a tuple
     template<typename TType, typename FractionsType>
     auto get_ab(const TType& T, const FractionsType& z) const{
         using numtype = std::common_type_t<TType, decltype(z[0])>;
+        const auto N = static_cast<Eigen::Index>(alphas.size());
+        // The temperature-dependent pure-component quantities, once per call
+        const auto sqrtai = sqrt_a.get_sqrt_aalpha(T);
+        Eigen::ArrayX<numtype> y(N), zb(N);
+        for (auto i = 0; i < N; ++i){
+            y[i] = z[i]*sqrtai[i];
+            zb[i] = z[i]*get_bi(i, T);
+        }
+        numtype a = symmetric_quadratic_form(oneminusk, y);
+        // The terms in b from the pair (i,j) and (j,i) are summed together
         numtype b = 0.0;
-        numtype a = 0.0;
-        std::size_t N = alphas.size();
-        for (auto i = 0U; i < N; ++i){
-            auto bi = get_bi(i, T);
-            auto ai = get_ai(i, T);
-            for (auto j = 0U; j < N; ++j){
-                auto bj = get_bi(j, T);
-                auto aj = get_ai(j, T);
-                b += z[i]*z[j]*(bi + bj)/2.0*(1.0 - lmat(i,j));
-                a += z[i]*z[j]*sqrt(ai*aj)*(1.0 - kmat(i,j));
+        for (auto i = 0; i < N; ++i){
+            numtype offdiag = 0.0;
+            for (auto j = i+1; j < N; ++j){
+                offdiag += oneminusl(i,j)*(zb[i]*z[j] + zb[j]*z[i]);
             }
+            b += oneminusl(i,i)*zb[i]*z[i] + offdiag;
         }
         return std::make_tuple(a, b);
     }
@@ -597,6 +823,13 @@ private:
     const double Ru; ///< Universal gas constant, in J/mol/K
     const std::vector<double> a_c, b_c;
     
+    // Precomputed temperature-independent quantities
+    Eigen::ArrayXd sqrt_a_c, ///< \f$\sqrt{a_{c,i}}\f$
+    half_k, ///< \f$k_i/2\f$
+    inv_Tc; ///< \f$1/T_{c,i}\f$
+    Eigen::ArrayXXd oneminusk, ///< The symmetrized pair factors \f$1-k_{ij}\f$
+    bmat; ///< The matrix of \f$(b_i+b_j)(1-l_{ij})/2\f$, symmetrized
+    
     /// A convenience function to save some typing
     std::vector<double> get_(const nlohmann::json &j, const std::string& key) const { return j.at(key).get<std::vector<double>>(); }
     
@@ -625,7 +858,26 @@ private:
     }
 public:
     
-    RKPRCismondi2005(const nlohmann::json &j) : delta_1(get_(j, "delta_1")), Tc_K(get_(j, "Tcrit / K")), pc_Pa(get_(j, "pcrit / Pa")), k(get_(j, "k")), kmat(build_square_matrix(j.at("kmat"))), lmat(build_square_matrix(j.at("lmat"))), Ru(j.value("R / J/mol/K", constants::R_CODATA2017)), a_c(build_ac()), b_c(build_bc()) {}
+    RKPRCismondi2005(const nlohmann::json &j) : delta_1(get_(j, "delta_1")), Tc_K(get_(j, "Tcrit / K")), pc_Pa(get_(j, "pcrit / Pa")), k(get_(j, "k")), kmat(build_square_matrix(j.at("kmat"))), lmat(build_square_matrix(j.at("lmat"))), Ru(j.value("R / J/mol/K", constants::R_CODATA2017)), a_c(build_ac()), b_c(build_bc()) {
+        const auto N = static_cast<Eigen::Index>(delta_1.size());
+        if (kmat.rows() != N || lmat.rows() != N){
+            throw teqp::InvalidArgument("kmat and lmat must be square matrices the same size as the number of components [" + std::to_string(N) + "]");
+        }
+        sqrt_a_c.resize(N); half_k.resize(N); inv_Tc.resize(N);
+        for (auto i = 0; i < N; ++i){
+            sqrt_a_c[i] = sqrt(a_c[i]);
+            half_k[i] = k[i]/2.0;
+            inv_Tc[i] = 1.0/Tc_K[i];
+        }
+        oneminusk = symmetrized_one_minus(kmat);
+        bmat.resize(N, N);
+        auto oneminusl = symmetrized_one_minus(lmat);
+        for (auto i = 0; i < N; ++i){
+            for (auto jj = 0; jj < N; ++jj){
+                bmat(i, jj) = (b_c[i] + b_c[jj])/2.0*oneminusl(i, jj);
+            }
+        }
+    }
     
     template<class VecType>
     auto R(const VecType& /*molefrac*/) const {
@@ -648,24 +900,21 @@ public:
         return forceeval(a_c[i]*pow(3.0/(2.0+T/Tc_K[i]), k[i]));
     }
     
+    /// Return the mixture parameters \f$a=\sum_i\sum_jz_iz_j\sqrt{a_ia_j}(1-k_{ij})\f$ and \f$b=\sum_i\sum_jz_iz_j(b_i+b_j)(1-l_{ij})/2\f$ as a tuple
     template<typename TType, typename FractionsType>
     auto get_ab(const TType& T, const FractionsType& z) const{
         using numtype = std::common_type_t<TType, decltype(z[0])>;
-        numtype b = 0.0;
-        numtype a = 0.0;
-        std::size_t N = delta_1.size();
-        for (auto i = 0U; i < N; ++i){
-            auto bi = get_bi(i, T);
-            auto ai = get_ai(i, T);
-            for (auto j = 0U; j < N; ++j){
-                auto aj = get_ai(j, T);
-                auto bj = get_bi(j, T);
-                
-                a += z[i]*z[j]*sqrt(ai*aj)*(1.0 - kmat(i,j));
-                b += z[i]*z[j]*(bi + bj)/2.0*(1.0 - lmat(i,j));
-                
-            }
+        using zt = std::decay_t<decltype(z[0])>;
+        const auto N = static_cast<Eigen::Index>(delta_1.size());
+        // The square roots of the pure-component a_i(T), once per call
+        Eigen::ArrayX<numtype> y(N);
+        Eigen::ArrayX<zt> zz(N);
+        for (auto i = 0; i < N; ++i){
+            y[i] = z[i]*sqrt_a_c[i]*pow(3.0/(2.0+T*inv_Tc[i]), half_k[i]);
+            zz[i] = z[i];
         }
+        numtype a = symmetric_quadratic_form(oneminusk, y);
+        numtype b = symmetric_quadratic_form(bmat, zz);
         return std::make_tuple(a, b);
     }
     
@@ -43,6 +43,7 @@ namespace teqp {
     using CPA_t = decltype(CPA::CPAfactory(nlohmann::json{}));
     using multifluid_t = decltype(multifluidfactory(nlohmann::json{}));
     using multifluidmutant_t = decltype(build_multifluid_mutant(multifluidfactory(nlohmann::json{}), nlohmann::json{}));
+    using multifluidparametermutant_t = decltype(build_multifluid_parameter_mutant(multifluidfactory(nlohmann::json{}), nlohmann::json{}));
     using ammonia_water_TillnerRoth_t = AmmoniaWaterTillnerRoth;
     using SW_EspindolaHeredia2009_t = squarewell::EspindolaHeredia2009;
     using EXP6_Kataoka1992_t = exp6::Kataoka1992;
@@ -3,6 +3,9 @@
 #include "teqp/types.hpp"
 #include "teqp/exceptions.hpp"
 #include <map>
+#include <set>
+#include <algorithm>
+#include <vector>
 
 namespace teqp {
 
@@ -247,6 +250,66 @@ namespace teqp {
             }
         };
 
+        /// Powers x^e for all the integers e in [emin, emax], built by successive multiplication
+        template<typename T>
+        auto power_ladder(const T& x, int emin, int emax) {
+            std::vector<T> o(std::max(emax - emin + 1, 1));
+            o[0] = powi(x, emin);
+            for (auto j = 1U; j < o.size(); ++j) {
+                o[j] = o[j - 1] * x;
+            }
+            return o;
+        }
+
+        /// Convert an exponent that must be a multiple of 1/2 into the integer exponent of the square root
+        inline int to_half_integer(double e, const std::string& what) {
+            auto twoe = static_cast<int>(std::round(2.0 * e));
+            if (std::abs(2.0 * e - twoe) > 1e-14) {
+                throw teqp::InvalidArgument("The exponent " + std::to_string(e) + " of " + what + " is not a multiple of 1/2");
+            }
+            return twoe;
+        }
+
+        /**
+         The terms of the attractive contribution once the elongation-dependent factor \f$\alpha^{o_i}\f$ has been folded
+         into the coefficients. Terms are grouped by the exponential factor \f$\exp(p\delta^q)\f$ that they share, and
+         within a group the terms with the same exponents of \f$\tau\f$ and \f$\delta\f$ are merged
+         */
+        class FoldedAttractiveContribution {
+        public:
+            struct ExpGroup {
+                double p = 0;
+                int q = 0;
+                std::vector<double> c; ///< The folded coefficients
+                std::vector<int> itau; ///< Index into the ladder of powers of sqrt(tau)
+                std::vector<int> idelta; ///< Index into the ladder of integer powers of delta
+            };
+            std::vector<ExpGroup> groups;
+            int tau_emin = 0, tau_emax = 0; ///< Range of the exponents of sqrt(tau)
+            int delta_nmax = 0; ///< Largest exponent of delta
+
+            template<typename TauType, typename DeltaType>
+            auto alphar(const TauType& tau, const DeltaType& delta) const {
+                using result = std::common_type_t<TauType, DeltaType>;
+                auto taupow = power_ladder(forceeval(sqrt(tau)), tau_emin, tau_emax);
+                auto deltapow = power_ladder(delta, 0, delta_nmax);
+                result r = 0.0;
+                for (const auto& g : groups) {
+                    result summer = 0.0;
+                    for (auto i = 0U; i < g.c.size(); ++i) {
+                        summer += g.c[i] * taupow[g.itau[i]] * deltapow[g.idelta[i]];
+                    }
+                    if (g.p == 0) {
+                        r += summer;
+                    }
+                    else {
+                        r += summer * exp(g.p * deltapow[g.q]);
+                    }
+                }
+                return forceeval(r);
+            }
+        };
+
         class AttractiveContribution {
         public:
             std::valarray<double> c, m, n, o, p, q;
@@ -262,6 +325,37 @@ namespace teqp {
                 }
                 return forceeval(r);
             }
+
+            /// Fold the constant factor \f$\alpha^{o_i}\f$ into the coefficients, for a given value of alpha
+            auto fold(const double alpha) const {
+                FoldedAttractiveContribution f;
+                // Keyed by (p, q), then by (exponent of sqrt(tau), exponent of delta)
+                std::map<std::pair<double, int>, std::map<std::pair<int, int>, double>> terms;
+                std::set<int> tau_exponents = {0};
+                for (auto i = 0U; i < c.size(); ++i) {
+                    auto etau = to_half_integer(m[i], "tau");
+                    auto ndelta = static_cast<int>(n[i]), qdelta = static_cast<int>(q[i]);
+                    if (ndelta != n[i] || qdelta != q[i] || ndelta < 0 || qdelta < 0) {
+                        throw teqp::InvalidArgument("The exponents of delta must be non-negative integers");
+                    }
+                    tau_exponents.insert(etau);
+                    f.delta_nmax = std::max({f.delta_nmax, ndelta, qdelta});
+                    terms[std::make_pair(p[i], qdelta)][std::make_pair(etau, ndelta)] += c[i] * pow(alpha, o[i]);
+                }
+                f.tau_emin = *tau_exponents.begin();
+                f.tau_emax = *tau_exponents.rbegin();
+                for (const auto& [pq, groupterms] : terms) {
+                    FoldedAttractiveContribution::ExpGroup g;
+                    std::tie(g.p, g.q) = pq;
+                    for (const auto& [exponents, coeff] : groupterms) {
+                        g.c.push_back(coeff);
+                        g.itau.push_back(exponents.first - f.tau_emin);
+                        g.idelta.push_back(exponents.second);
+                    }
+                    f.groups.push_back(g);
+                }
+                return f;
+            }
         };
 
 
@@ -280,6 +374,84 @@ namespace teqp {
             }
         };
 
+        /**
+         The terms of the polar (dipolar or quadrupolar) contribution once the constant factor \f$(\mu^2)^{k_i/4}\f$
+         has been folded into the coefficients. Terms are grouped by the exponential factor \f$\exp(-o\delta^2)\f$
+         that they share, and within a group the terms with the same exponents of \f$\tau\f$ and \f$\delta\f$ are merged
+         */
+        class FoldedPolarContribution {
+        public:
+            struct ExpGroup {
+                double o = 0;
+                std::vector<double> c; ///< The folded coefficients
+                std::vector<int> itau; ///< Index into the ladder of powers of sqrt(tau)
+                std::vector<int> idelta; ///< Index into the table of distinct powers of delta
+            };
+            std::vector<ExpGroup> groups;
+            int tau_emin = 0, tau_emax = 0; ///< Range of the exponents of sqrt(tau)
+            std::vector<int> delta_exponents; ///< The distinct exponents of sqrt(delta)
+
+            template<typename TauType, typename DeltaType>
+            auto alphar(const TauType& tau, const DeltaType& delta) const {
+                using result = std::common_type_t<TauType, DeltaType>;
+                auto taupow = power_ladder(forceeval(sqrt(tau)), tau_emin, tau_emax);
+                // Even exponents are integer powers of delta; the odd ones are kept as pow(delta, m/2)
+                // so that they remain well-behaved in the limit of zero density
+                std::vector<DeltaType> deltapow(delta_exponents.size());
+                for (auto j = 0U; j < delta_exponents.size(); ++j) {
+                    auto e = delta_exponents[j];
+                    deltapow[j] = (e % 2 == 0) ? powi(delta, e / 2) : DeltaType(pow(delta, e / 2.0));
+                }
+                DeltaType delta2 = delta * delta;
+                result r = 0.0;
+                for (const auto& g : groups) {
+                    result summer = 0.0;
+                    for (auto i = 0U; i < g.c.size(); ++i) {
+                        summer += g.c[i] * taupow[g.itau[i]] * deltapow[g.idelta[i]];
+                    }
+                    if (g.o == 0) {
+                        r += summer;
+                    }
+                    else {
+                        r += summer * exp(-g.o * delta2);
+                    }
+                }
+                return forceeval(r);
+            }
+        };
+
+        /// Fold the constant factor \f$(\mu^2)^{k_i/4}\f$ of a polar contribution into its coefficients
+        inline auto fold_polar(const std::valarray<double>& c, const std::valarray<double>& m, const std::valarray<double>& n, const std::valarray<double>& k, const std::valarray<double>& o, const double mu_sq) {
+            FoldedPolarContribution f;
+            // Keyed by o, then by (exponent of sqrt(tau), exponent of sqrt(delta))
+            std::map<double, std::map<std::pair<int, int>, double>> terms;
+            std::set<int> tau_exponents = {0}, delta_exponents;
+            for (auto i = 0U; i < c.size(); ++i) {
+                auto etau = static_cast<int>(n[i]), edelta = static_cast<int>(m[i]);
+                if (etau != n[i] || edelta != m[i]) {
+                    throw teqp::InvalidArgument("The exponents n and m of the polar contribution must be integers");
+                }
+                tau_exponents.insert(etau);
+                delta_exponents.insert(edelta);
+                terms[o[i]][std::make_pair(etau, edelta)] += c[i] * pow(mu_sq, k[i] / 4.0);
+            }
+            f.tau_emin = *tau_exponents.begin();
+            f.tau_emax = *tau_exponents.rbegin();
+            f.delta_exponents.assign(delta_exponents.begin(), delta_exponents.end());
+            for (const auto& [o_, groupterms] : terms) {
+                FoldedPolarContribution::ExpGroup g;
+                g.o = o_;
+                for (const auto& [exponents, coeff] : groupterms) {
+                    g.c.push_back(coeff);
+                    g.itau.push_back(exponents.first - f.tau_emin);
+                    auto it = std::find(f.delta_exponents.begin(), f.delta_exponents.end(), exponents.second);
+                    g.idelta.push_back(static_cast<int>(it - f.delta_exponents.begin()));
+                }
+                f.groups.push_back(g);
+            }
+            return f;
+        }
+
         class DipolarContribution {
         public:
             std::valarray<double> c, m, n, k, o;
@@ -294,6 +466,11 @@ namespace teqp {
                 }
                 return forceeval(r);
             }
+
+            /// Fold the constant factor \f$(\mu^2)^{k_i/4}\f$ into the coefficients, for a given value of mu_sq
+            auto fold(const double mu_sq) const {
+                return fold_polar(c, m, n, k, o, mu_sq);
+            }
         };
 
         class QuadrupolarContribution {
@@ -309,6 +486,11 @@ namespace teqp {
                 }
                 return forceeval(r);
             }
+
+            /// Fold the constant factor \f$(\mu^2)^{k_i/4}\f$ into the coefficients, for a given value of mu_sq
+            auto fold(const double mu_sq) const {
+                return fold_polar(c, m, n, k, o, mu_sq);
+            }
         };
         template<typename TypePolarContribution>
         class Twocenterljf {
@@ -320,26 +502,30 @@ namespace teqp {
             const TypePolarContribution Pole;
             const double L;
             const double mu_sq;
+        private:
+            // Constants that depend only on L and mu_sq, evaluated at construction
+            const double Tred, Rred, eta_red, alpha;
+            const FoldedAttractiveContribution AttrFolded;
+            const FoldedPolarContribution PoleFolded;
+        public:
 
-            Twocenterljf(ReducingDensity&& redD, ReducingTemperature&& redT, HardSphereContribution&& Hard, const AttractiveContribution&& Attr, const TypePolarContribution&& Pole, const double L, const double& mu_sq) : redD(redD), redT(redT), Hard(Hard), Attr(Attr), Pole(Pole), L(L), mu_sq(mu_sq) {};
+            Twocenterljf(ReducingDensity&& redD, ReducingTemperature&& redT, HardSphereContribution&& Hard, const AttractiveContribution&& Attr, const TypePolarContribution&& Pole, const double L, const double& mu_sq) : redD(redD), redT(redT), Hard(Hard), Attr(Attr), Pole(Pole), L(L), mu_sq(mu_sq),
+                Tred(forceeval(redT.get_T_red(L))), Rred(forceeval(redD.get_rho_red(L))), eta_red(forceeval(redD.get_eta_over_rho(L))), alpha(forceeval(redD.get_alpha_star(L))),
+                AttrFolded(Attr.fold(alpha)), PoleFolded(Pole.fold(mu_sq)) {};
 
             template<typename TType, typename RhoType, typename MoleFracType>
             auto alphar(const TType& T_star,
                 const RhoType& rho_dimer_star,
                 const MoleFracType& /*molefrac*/) const
             {
-                auto Tred = forceeval(redT.get_T_red(L));
-                auto Rred = forceeval(redD.get_rho_red(L));
-                auto eta_red = forceeval(redD.get_eta_over_rho(L));
-                auto alpha = forceeval(redD.get_alpha_star(L));
                 auto delta = forceeval(rho_dimer_star / Rred);
                 auto tau = forceeval(T_star / Tred);
                 auto delta_eta = forceeval(rho_dimer_star * eta_red);
                 auto alphar_1 = Hard.alphar(tau, delta_eta, alpha);
-                auto alphar_2 = Attr.alphar(tau, delta, alpha);
+                auto alphar_2 = AttrFolded.alphar(tau, delta);
                 auto val = forceeval(alphar_1 + alphar_2);
                 if (mu_sq != 0.0){
-                    val += Pole.alphar(tau, delta, mu_sq);
+                    val += PoleFolded.alphar(tau, delta);
                 }
                 return forceeval(val);
             }
@@ -15,6 +15,11 @@ Equation of State of the Fluid Defined by the Modified Buckingham (exp-6)
 Potential Derived by Molecular Dynamics Simulations
 Bulletin of the Chemical Society of Japan, 1992; 65, 2093-2103
 https://doi.org/10.1246/bcsj.65.2093
+ 
+ The terms are of the form \f$A_{pqr}\rho^{*p}T^{*-q}\alpha^{*r}\f$. Since \f$\alpha^*\f$ is fixed for a
+ given model, the factors \f$A_{pqr}\alpha^{*r}\f$ are summed into one coefficient for each (p,q) pair
+ at construction. The remaining bivariate polynomial is evaluated with Horner's method in \f$\rho^*\f$ and
+ \f$1/T^*\f$, along with the \f$T^{*-1/4}\f$ terms.
  */
 class Kataoka1992{
 private:
@@ -98,10 +103,31 @@ private:
     };
     const double alphastar;
     
+    /// Exponents of \f$\rho^*\f$ run from 1 to pmax
+    static constexpr int pmax = 5;
+    /// Columns 0..3 are the coefficients of \f$T^{*-q}\f$ for q=0,1,2,3 and column 4 is for q=1/4
+    using FoldedCoeffs = Eigen::Array<double, pmax, 5>;
+    const FoldedCoeffs B;
+    
+    /// Sum the \f$A_{pqr}\alpha^{*r}\f$ into one coefficient for each (p,q) pair
+    FoldedCoeffs fold_coefficients() const{
+        FoldedCoeffs o = FoldedCoeffs::Zero();
+        for (const auto& el : c){
+            int p = static_cast<int>(el[0]);
+            auto q = el[1], r = el[2], Apqr = el[3];
+            auto col = (q == 0.25) ? 4 : static_cast<int>(q);
+            if (p < 1 || p > pmax || (col != 4 && (static_cast<double>(col) != q || col > 3))){
+                throw teqp::InvalidArgument("Term with p=" + std::to_string(p) + ", q=" + std::to_string(q) + " cannot be folded");
+            }
+            o(p-1, col) += Apqr*pow(alphastar, r);
+        }
+        return o;
+    }
+    
 public:
     /// Constructor
     /// \param alpha
-    Kataoka1992(double alpha) : alphastar((alpha-8)/10){};
+    Kataoka1992(double alpha) : alphastar((alpha-8)/10), B(fold_coefficients()){};
     
     // We are in "simulation units", so R is 1.0, and T and rho are T^* and rho^*
     template<typename MoleFracType>
@@ -122,11 +148,15 @@ public:
         const RhoType& rhostar,
         const MoleFracType& /*molefrac*/) const
     {
+        TType oneoverT = 1.0/Tstar;
+        TType oneoverTquarter = sqrt(sqrt(oneoverT));
+        
+        // Horner's method in rho^*, with the coefficient of each power of rho^* being itself
+        // a polynomial in 1/T^* (plus the T^{*-1/4} term)
         std::common_type_t<TType, RhoType> o = 0.0;
-        for (auto el : c){
-            int p = static_cast<int>(el[0]);
-            auto q = el[1], r = el[2], Apqr = el[3];
-            o = o + Apqr * powi(rhostar, p) * pow(Tstar, -q) * pow(alphastar, r);
+        for (auto i = pmax-1; i >= 0; --i){
+            TType coeff = B(i,0) + oneoverT*(B(i,1) + oneoverT*(B(i,2) + oneoverT*B(i,3))) + B(i,4)*oneoverTquarter;
+            o = (o + coeff)*rhostar;
         }
         return forceeval(o);
     }
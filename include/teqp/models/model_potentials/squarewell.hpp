@@ -3,6 +3,8 @@
 
 #include <valarray>
 #include <map>
+#include <array>
+#include <tuple>
 
 namespace teqp{
 namespace squarewell{
@@ -24,8 +26,9 @@ namespace squarewell{
          \end{array}\right.
 \f]
  
- Note: if needed, all the terms that don't depend on T or rho could be pre-calculated at model
- initialization for a small speed boost
+ All the terms that depend only on lambda are evaluated once at construction and stored in
+ a flat table of coefficients, so that alphar only needs to evaluate a few polynomials in
+ \f$\rho^*\f$ and \f$1/T^*\f$ with Horner's method
 
  */
 class EspindolaHeredia2009{
@@ -120,24 +123,38 @@ private:
     double xi3(double lambda_) const{ return a33(lambda_)/a2i(3, lambda_); }
     double xi4(double lambda_) const{ return a34(lambda_)/a2i(4, lambda_); }
     
-    template<typename RhoType>
-    auto Ki(int i, const RhoType & rhostar, double lambda_) const{
+    /// The coefficients that depend only on lambda, evaluated once at construction
+    struct BakedCoefficients{
+        std::array<double, 6> a1; ///< a1 = rho*(a1[0] + a1[1]*rho + ... + a1[5]*rho^5)
+        double a22, xi2, phi1, phi2; ///< a2 = a22*rho*(1-rho^2/1.5129)*exp(rho*(xi2 + rho^2*(phi1 + phi2*rho)))
+        double a23, xi3, K3num, K3den; ///< a3 = a23*rho*exp(xi3*rho + K3num*rho^2/(1 + K3den*rho))
+        double a24, xi4, K4num, K4den; ///< a4 = a24*rho*exp(xi4*rho + K4num*rho^2/(1 + K4den*rho))
+    };
+    
+    /// The numerator and denominator sums of the K_i function, which depend only on lambda
+    auto Ki_sums(int i, double lambda_) const{
         const auto & thetai = thetavals.at(i);
-        RhoType num = 0.0;
+        double num = 0.0;
         for (auto n = 1; n < 5; ++n){
             num += thetai[n]*pow(lambda_, n);
         }
-        num *= powi(rhostar, 2);
-        RhoType den = 0;
+        double den = 0.0;
         for (auto n = 5; n < 8; ++n){
             den += thetai[n]*pow(lambda_, n-4);
         }
-        den = 1.0 + rhostar*den;
-        return forceeval(num/den);
+        return std::make_tuple(num, den);
     }
     
-    template<typename RhoType>
-    auto Chi(const RhoType & rhostar, double lambda_) const { return forceeval(a2i(2, lambda_)*rhostar*(1.0-powi(rhostar,2)/1.5129)); }
+    BakedCoefficients bake(double lambda_) const{
+        BakedCoefficients c;
+        c.a1 = {a2i(1, lambda_), a31(lambda_), gamman(1, lambda_), gamman(2, lambda_), gamman(3, lambda_), gamman(4, lambda_)};
+        c.a22 = a2i(2, lambda_); c.xi2 = xi2(lambda_); c.phi1 = phii(1, lambda_); c.phi2 = phii(2, lambda_);
+        c.a23 = a2i(3, lambda_); c.xi3 = xi3(lambda_); std::tie(c.K3num, c.K3den) = Ki_sums(3, lambda_);
+        c.a24 = a2i(4, lambda_); c.xi4 = xi4(lambda_); std::tie(c.K4num, c.K4den) = Ki_sums(4, lambda_);
+        return c;
+    }
+    
+    const BakedCoefficients coeffs;
     
     template<typename RhoType>
     auto aHS(const RhoType & rhostar) const{
@@ -145,31 +162,32 @@ private:
     }
     
     template<typename RhoType>
-    auto get_a1(const RhoType & rhostar, double lambda_) const{
-        RhoType o = a2i(1, lambda_)*powi(rhostar, 2-1) + a31(lambda_)*powi(rhostar, 3-1);
-        for (auto i = 1; i < 5; ++i){
-            o = o + gamman(i, lambda_)*powi(rhostar, i+2);
-        }
-        return forceeval(o);
+    auto get_a1(const RhoType & rhostar) const{
+        const auto& c = coeffs.a1;
+        return forceeval(rhostar*(c[0] + rhostar*(c[1] + rhostar*(c[2] + rhostar*(c[3] + rhostar*(c[4] + rhostar*c[5]))))));
     }
     
     template<typename RhoType>
-    auto get_a2(const RhoType & rhostar, double lambda_) const{
-        return forceeval(Chi(rhostar, lambda_)*exp(xi2(lambda_)*rhostar + phii(1, lambda_)*powi(rhostar,3) + phii(2,lambda_)*powi(rhostar,4)));
+    auto get_a2(const RhoType & rhostar) const{
+        const auto& c = coeffs;
+        RhoType rhostar2 = rhostar*rhostar;
+        return forceeval(c.a22*rhostar*(1.0-rhostar2/1.5129)*exp(rhostar*(c.xi2 + rhostar2*(c.phi1 + c.phi2*rhostar))));
     }
     
     template<typename RhoType>
-    auto get_a3(const RhoType & rhostar, double lambda_) const {
-        return forceeval(a2i(3, lambda_)*rhostar*exp(xi3(lambda_)*rhostar + Ki(3, rhostar, lambda_)));
+    auto get_a3(const RhoType & rhostar) const {
+        const auto& c = coeffs;
+        return forceeval(c.a23*rhostar*exp(c.xi3*rhostar + c.K3num*rhostar*rhostar/(1.0 + c.K3den*rhostar)));
     }
     
     template<typename RhoType>
-    auto get_a4(const RhoType & rhostar, double lambda_) const {
-        return forceeval(a2i(4, lambda_)*rhostar*exp(xi4(lambda_)*rhostar + Ki(4, rhostar, lambda_)));
+    auto get_a4(const RhoType & rhostar) const {
+        const auto& c = coeffs;
+        return forceeval(c.a24*rhostar*exp(c.xi4*rhostar + c.K4num*rhostar*rhostar/(1.0 + c.K4den*rhostar)));
     }
     
 public:
-    EspindolaHeredia2009(double lambda) : lambda(lambda){};
+    EspindolaHeredia2009(double lambda) : lambda(lambda), coeffs(bake(lambda)){};
     
     // We are in "simulation units", so R is 1.0, and T and rho are T^* and rho^*
     template<typename MoleFracType>
@@ -190,16 +208,14 @@ public:
         const RhoType& rhostar,
         const MoleFracType& /*molefrac*/) const
     {
-        auto a1 = get_a1(rhostar, lambda);
-        auto a2 = get_a2(rhostar, lambda);
-        auto a3 = get_a3(rhostar, lambda);
-        auto a4 = get_a4(rhostar, lambda);
+        auto a1 = get_a1(rhostar);
+        auto a2 = get_a2(rhostar);
+        auto a3 = get_a3(rhostar);
+        auto a4 = get_a4(rhostar);
         
-        return forceeval(aHS(rhostar)
-            + a1/Tstar
-            + a2/pow(Tstar, 2)
-            + a3/pow(Tstar, 3)
-            + a4/pow(Tstar, 4));
+        // Horner's method in 1/T^*
+        auto oneoverT = forceeval(1.0/Tstar);
+        return forceeval(aHS(rhostar) + oneoverT*(a1 + oneoverT*(a2 + oneoverT*(a3 + oneoverT*a4))));
     }
 };
 
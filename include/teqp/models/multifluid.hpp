@@ -23,6 +23,7 @@
 #include "multifluid_eosterms.hpp"
 #include "multifluid_reducing.hpp"
 #include "multifluid_gas_constant.hpp"
+#include "multifluid_rpinterop.hpp"
 
 #include <boost/algorithm/string/join.hpp>
 
@@ -75,6 +76,45 @@ public:
     auto get_EOS(std::size_t i) const{
         return EOSs[i];
     }
+
+    /// The coefficients of the pure fluids that are exposed to ensemble evaluations, concatenated in the order of the components
+    Eigen::ArrayXd get_coefficients() const {
+        std::vector<Eigen::ArrayXd> blocks;
+        Eigen::Index N = 0;
+        for (const auto& EOS : EOSs) {
+            blocks.emplace_back(EOS.get_coefficients());
+            N += blocks.back().size();
+        }
+        Eigen::ArrayXd c(N);
+        Eigen::Index offset = 0;
+        for (const auto& block : blocks) {
+            c.segment(offset, block.size()) = block;
+            offset += block.size();
+        }
+        return c;
+    }
+
+    /// Split alphar into a fixed part and the basis of the coefficients returned by get_coefficients, see EOSTermContainer::alphar_basis
+    template<typename TauType, typename DeltaType, typename MoleFractions>
+    auto alphar_basis(const TauType& tau, const DeltaType& delta, const MoleFractions& molefracs) const {
+        using resulttype = std::decay_t<std::common_type_t<decltype(tau), decltype(molefracs[0]), decltype(delta)>>;
+        resulttype fixed = 0.0;
+        std::vector<Eigen::ArrayX<resulttype>> blocks;
+        Eigen::Index N = 0;
+        for (auto i = 0U; i < static_cast<std::size_t>(molefracs.size()); ++i) {
+            auto [fixedi, basisi] = EOSs[i].alphar_basis(tau, delta);
+            fixed += molefracs[i]*fixedi;
+            blocks.emplace_back(molefracs[i]*basisi.template cast<resulttype>());
+            N += blocks.back().size();
+        }
+        Eigen::ArrayX<resulttype> basis(N);
+        Eigen::Index offset = 0;
+        for (const auto& block : blocks) {
+            basis.segment(offset, block.size()) = block;
+            offset += block.size();
+        }
+        return std::make_tuple(fixed, basis);
+    }
 };
 
 template<typename FCollection, typename DepartureFunctionCollection>
@@ -176,6 +216,33 @@ public:
         return forceeval(corr.alphar(tau, delta, molefrac) + dep.alphar(tau, delta, molefrac));
     }
     
+    /// The parameters of ensemble evaluations: the coefficients of the pure-fluid terms that are linear in them, see CorrespondingStatesContribution::get_coefficients
+    Eigen::ArrayXd get_ensemble_parameters() const {
+        return corr.get_coefficients();
+    }
+
+    /**
+     \brief The basis of ensemble evaluations, in which the first entry is the contribution of all the terms whose coefficients are held fixed
+     (including the departure function) and the others multiply the parameters returned by get_ensemble_parameters
+     */
+    template<typename TType, typename RhoType, typename MoleFracType>
+    auto alphar_ensemble_basis(const TType &T,
+        const RhoType &rho,
+        const MoleFracType& molefrac) const
+    {
+        if (static_cast<std::size_t>(molefrac.size()) != corr.size()){
+            throw teqp::InvalidArgument("Wrong size of mole fractions; "+std::to_string(corr.size()) + " are loaded but "+std::to_string(molefrac.size()) + " were provided");
+        }
+        auto delta = forceeval(rho / redfunc.get_rhor(molefrac));
+        auto tau = forceeval(redfunc.get_Tr(molefrac) / T);
+        auto [fixed, basis] = corr.alphar_basis(tau, delta, molefrac);
+        using result = std::decay_t<decltype(fixed)>;
+        Eigen::ArrayX<result> o(basis.size() + 1);
+        o[0] = (molefrac.size() == 1) ? fixed : forceeval(fixed + dep.alphar(tau, delta, molefrac));
+        o.tail(basis.size()) = basis;
+        return o;
+    }
+    
     template<typename TType, typename RhoType, typename MoleFracType>
     auto alphar_taudelta(const TType &tau,
         const RhoType &delta,
@@ -373,6 +440,7 @@ inline auto build_departure_function(const nlohmann::json& j) {
         eos.taumax = term.at("taumax");
         eos.deltamin = term.at("deltamin");
         eos.deltamax = term.at("deltamax");
+        eos.strict_domain = term.value("strict_domain", false);
         dep.add_term(eos);
     };
     //auto build_gaussian = [&](auto& term) {
@@ -1007,10 +1075,10 @@ inline auto make_pure_components_JSON(const nlohmann::json& components, const st
                 pureJSON.push_back(load_a_JSON_file(contents.substr(6)));
             }
             else if (contents.find("FLDPATH::") == 0){
-                pureJSON.push_back(RPinterop::FLDfile(contents.substr(9)).make_json(""));
+                pureJSON.push_back(RPinteropcache::get_cache().get_FLD_from_path(contents.substr(9)));
             }
             else if (contents.find("FLD::") == 0){
-                pureJSON.push_back(RPinterop::FLDfile(contents.substr(5)).make_json(""));
+                pureJSON.push_back(RPinteropcache::get_cache().get_FLD_from_contents(contents.substr(5)));
             }
             else{
                 pureJSON.push_back(get_or_aliasmap());
@@ -1051,11 +1119,15 @@ inline auto multifluidfactory(const nlohmann::json& spec) {
     
     // We are in the interop logical branch in which we will be invoking the REFPROP-interop code
     if (spec.contains("HMX.BNC")){
+        // The conversions are cached by the contents of the files, and only the binary pairs
+        // relevant to these components are passed on
+        auto& cache = RPinteropcache::get_cache();
         std::vector<nlohmann::json> componentJSON;
         for (auto comp : spec.at("components")){
-            componentJSON.push_back(RPinterop::FLDfile(comp).make_json(""));
+            componentJSON.push_back(cache.get_FLD_from_path(comp));
         }
-        auto [BIPcollection, depcollection] = RPinterop::HMXBNCfile(spec.at("HMX.BNC")).make_jsons();
+        auto HMX = cache.get_HMXBNC(spec.at("HMX.BNC"));
+        auto [BIPcollection, depcollection] = HMX->select(collect_identifiers(componentJSON));
         return _build_multifluid_model(componentJSON, BIPcollection, depcollection, flags);
     }
     else{
@@ -1,5 +1,7 @@
 #pragma once
 #include <Eigen/Dense>
+#include <array>
+#include <algorithm>
 #include "teqp/exceptions.hpp"
 
 
@@ -7,28 +9,77 @@ namespace teqp {
 
     /*!
             Implementation of the polynomial extended corresponding states (pECS) mixture model \n
-            The mixture model depends on coefficients for a temperature and density polynomial. \n
-            Only valid for binary mixtures. \n
+            The mixture model depends on coefficients for a temperature and density polynomial for each binary pair. \n
             The pECS reducing function follow the mathematical operations: \n
             \f$F(\bar x, Y, T, \rho ) = \sum_{i=1}^{N} x_{i}^{2} Y_{\mathrm{c},i} + \sum_{i=1}^{N-1}\sum_{j=i+1}^{N} 2 x_{i} x_{j}  Y_{ij} f_{Y}(T,\rho).\f$ \n
             \f$f_{T,v} = \sum_{i}^{n} \sum_{j}^{m-i} c_{ij,T,v} \tau_{\mathrm{ECS}}^{i} \delta_{\mathrm{ECS}}^{j}\f$ \n
             \f$\tau_{\mathrm{ECS}} = \frac{Y_{T,ij}}{T}\f$ \n
             \f$\delta_{\mathrm{ECS}} = \rho Y_{v,ij}\f$ \n
             \f$Y_{T,ij} =  \sqrt{T_{\mathrm{c},i} T_{\mathrm{c},j}}\f$ \n
-            \f$Y_{v,ij} =  \left( \frac{1}{\rho_{\mathrm{c},i}^{1/3}} + \frac{1}{\rho_{\mathrm{c},j}^{1/3}}\right)^{3}\f$ \n
-            \f$c_{ij,T,v} = a_{ij,1} + a_{ij,2} x_{i} + a_{ij,3} x_{i}^{2}\f$. 
+            \f$Y_{v,ij} =  \left( \frac{v_{\mathrm{c},i}^{1/3} + v_{\mathrm{c},j}^{1/3}}{2}\right)^{3}\f$ \n
+            \f$c_{ij,T,v} = a_{ij,1} + a_{ij,2} x_{i} + a_{ij,3} x_{i}^{2}\f$. \n
+            
+            The coefficients are provided in JSON, either as the fields "tr_coeffs" and "dr_coeffs" (only for a binary mixture),
+            or as an array "pairs" of objects with fields "i", "j", "tr_coeffs" and "dr_coeffs", where i and j are the 0-based
+            indices of the components, and \f$x_i\f$ in \f$c_{ij,T,v}\f$ is the mole fraction of component i. Pairs that are not provided
+            have \f$f_{T}=f_{v}=1\f$. The pair scales \f$Y_{T,ij}\f$ and \f$Y_{v,ij}\f$ are evaluated at construction.
     */
     class Reducing_ECS {
-
+    public:
+        /// The coefficients of one row (p00, p10, p01, p20, p11, p02) are polynomials in mole fraction of order 2
+        using PairCoeffs = Eigen::Matrix<double, 6, 3>;
+        
+        /// The precomputed information for one binary pair
+        struct PairData {
+            Eigen::Index i, j;
+            double Tc_scale; ///< \f$Y_{T,ij}\f$
+            double vc_scale; ///< \f$Y_{v,ij}\f$
+            PairCoeffs tr_coeffs; ///< Matrix containing the coefficients for the temperature polynomial: \f$a_{ij,T}\f$
+            PairCoeffs dr_coeffs; ///< Matrix containing the coefficients for the volume polynomial: \f$a_{ij,v}\f$
+        };
+        
     private:
-        /*!
-          Matrix containing the coefficients for the temperature polynominal: \f$a_{ij,T}\f$
-        */
-        Eigen::MatrixXd  tr_coeffs;
-        /*!
-                  Matrix containing the coefficients for the volume polynominal: \f$a_{ij,v}\f$
-        */
-        Eigen::MatrixXd dr_coeffs;
+        std::vector<PairData> pairs;
+        
+        static PairCoeffs get_coeffs(const nlohmann::json& j, const std::string& key) {
+            if (!j.contains(key)) {
+                throw teqp::InvalidArgument(key + " not in provided json");
+            }
+            const auto& jc = j.at(key);
+            PairCoeffs c;
+            if (jc.size() != static_cast<std::size_t>(c.rows())) {
+                throw teqp::InvalidArgument(key + " must have " + std::to_string(c.rows()) + " rows");
+            }
+            for (auto i = 0; i < c.rows(); ++i) {
+                if (jc[i].size() != static_cast<std::size_t>(c.cols())) {
+                    throw teqp::InvalidArgument("Each row of " + key + " must have " + std::to_string(c.cols()) + " entries");
+                }
+                for (auto j = 0; j < c.cols(); ++j) {
+                    c(i, j) = jc[i][j];
+                }
+            }
+            return c;
+        }
+        
+        auto build_pair(Eigen::Index i, Eigen::Index j, const nlohmann::json& jpair) const {
+            if (i < 0 || j < 0 || i >= Tc.size() || j >= Tc.size() || i == j) {
+                throw teqp::InvalidArgument("Invalid component indices in ECS pair: " + std::to_string(i) + "," + std::to_string(j));
+            }
+            PairData pair;
+            pair.i = i; pair.j = j;
+            pair.Tc_scale = sqrt(Tc[i] * Tc[j]);
+            pair.vc_scale = 0.125 * pow(pow(vc[i], 1.0 / 3.0) + pow(vc[j], 1.0 / 3.0), 3.0);
+            if (jpair.is_null()) {
+                // f_T = f_v = 1
+                pair.tr_coeffs = PairCoeffs::Zero(); pair.tr_coeffs(0, 0) = 1.0;
+                pair.dr_coeffs = pair.tr_coeffs;
+            }
+            else {
+                pair.tr_coeffs = get_coeffs(jpair, "tr_coeffs");
+                pair.dr_coeffs = get_coeffs(jpair, "dr_coeffs");
+            }
+            return pair;
+        }
 
     public:
         /*!
@@ -41,39 +92,67 @@ namespace teqp {
         Eigen::ArrayXd vc;
         template<typename ArrayLike>
         Reducing_ECS(const ArrayLike& Tc, const ArrayLike& vc, const nlohmann::json& jj) : Tc(Tc), vc(vc) {
-
-            if (not jj.contains("tr_coeffs")) {
-                throw teqp::InvalidArgument("tr_coeffs not in provided json");
+            if (jj.contains("pairs")) {
+                for (const auto& jpair : jj.at("pairs")) {
+                    auto i = jpair.at("i").get<Eigen::Index>(), j = jpair.at("j").get<Eigen::Index>();
+                    if (has_pair(i, j)) {
+                        throw teqp::InvalidArgument("Duplicated ECS pair: " + std::to_string(i) + "," + std::to_string(j));
+                    }
+                    pairs.push_back(build_pair(i, j, jpair));
+                }
             }
-
-            if (not jj.contains("dr_coeffs")) {
-                throw teqp::InvalidArgument("dr_coeffs not in provided json");
+            else {
+                if (this->Tc.size() != 2) {
+                    throw teqp::InvalidArgument("tr_coeffs and dr_coeffs at the top level are only valid for a binary mixture; use pairs instead");
+                }
+                pairs.push_back(build_pair(0, 1, jj));
             }
-
-            auto json_tr_coeffs = jj.at("tr_coeffs");
-            auto json_dr_coeffs = jj.at("dr_coeffs");
-
-            auto rows_tr = json_tr_coeffs.size();
-            auto cols_tr = json_tr_coeffs[0].size();
-            tr_coeffs.resize(rows_tr, cols_tr);
-
-            auto rows_dr = json_dr_coeffs.size();
-            auto cols_dr = json_dr_coeffs[0].size();
-            dr_coeffs.resize(rows_dr, cols_dr);
-
-
-            for (auto i = 0; i < rows_tr; ++i) {
-                for (auto j = 0; j < cols_tr; ++j) {
-                    tr_coeffs(i, j) = json_tr_coeffs[i][j];
+            // Pairs that are not provided have f_T = f_v = 1
+            for (auto i = 0; i < this->Tc.size(); ++i) {
+                for (auto j = i + 1; j < this->Tc.size(); ++j) {
+                    if (!has_pair(i, j)) {
+                        pairs.push_back(build_pair(i, j, nullptr));
+                    }
                 }
             }
+        }
+        
+        /// True if the pair i,j (in either order) has been provided
+        bool has_pair(Eigen::Index i, Eigen::Index j) const {
+            return std::any_of(pairs.begin(), pairs.end(), [i, j](const auto& p) { return (p.i == i && p.j == j) || (p.i == j && p.j == i); });
+        }
+        
+        /// Get the precomputed data for the binary pairs
+        const auto& get_pairs() const { return pairs; }
 
-            for (auto i = 0; i < rows_dr; ++i) {
-                for (auto j = 0; j < cols_dr; ++j) {
-                    dr_coeffs(i, j) = json_dr_coeffs[i][j];
+        /*!
+            Reducing temperature and density, evaluated in one pass so that the (tau, delta) monomials of each pair are shared
+        */
+        template <typename TTYPE, typename RHOTYPE, typename MoleFractions>
+        auto get_tr_dr(const TTYPE& temperature, const RHOTYPE& density, const MoleFractions& molefraction) const {
+            using result = std::common_type_t<TTYPE, RHOTYPE, std::decay_t<decltype(molefraction[0])>>;
+            result tc_func = 0.0, vc_func = 0.0;
+            for (auto i = 0; i < Tc.size(); ++i) {
+                tc_func += molefraction[i] * molefraction[i] * Tc[i];
+                vc_func += molefraction[i] * molefraction[i] * vc[i];
+            }
+            for (const auto& pair : pairs) {
+                const auto& xi = molefraction[pair.i];
+                const auto& xj = molefraction[pair.j];
+                auto tau = forceeval(pair.Tc_scale / temperature);
+                auto delta = forceeval(density * pair.vc_scale);
+                // Monomials in the order of the rows of the coefficient matrices
+                std::array<result, 6> monomials = {1.0, delta, tau, delta * delta, delta * tau, tau * tau};
+                result fT = 0.0, fv = 0.0;
+                for (auto k = 0; k < 6; ++k) {
+                    fT += (pair.tr_coeffs(k, 0) + xi * (pair.tr_coeffs(k, 1) + xi * pair.tr_coeffs(k, 2))) * monomials[k];
+                    fv += (pair.dr_coeffs(k, 0) + xi * (pair.dr_coeffs(k, 1) + xi * pair.dr_coeffs(k, 2))) * monomials[k];
                 }
+                auto twoxixj = forceeval(2.0 * xi * xj);
+                tc_func += twoxixj * fT * pair.Tc_scale;
+                vc_func += twoxixj * fv * pair.vc_scale;
             }
-
+            return std::make_tuple(forceeval(tc_func), forceeval(1.0 / vc_func));
         }
 
         /*!
@@ -81,46 +160,15 @@ namespace teqp {
         */
         template <typename TTYPE, typename RHOTYPE, typename MoleFractions>
         auto get_tr(const TTYPE& temperature, const RHOTYPE& density, const MoleFractions& molefraction) const {
-            
-            auto p00 = tr_coeffs(0, 0) + molefraction[0] * tr_coeffs(0, 1) + molefraction[0] * molefraction[0] * tr_coeffs(0, 2);
-            auto p10 = tr_coeffs(1, 0) + molefraction[0] * tr_coeffs(1, 1) + molefraction[0] * molefraction[0] * tr_coeffs(1, 2);
-            auto p01 = tr_coeffs(2, 0) + molefraction[0] * tr_coeffs(2, 1) + molefraction[0] * molefraction[0] * tr_coeffs(2, 2);
-            auto p20 = tr_coeffs(3, 0) + molefraction[0] * tr_coeffs(3, 1) + molefraction[0] * molefraction[0] * tr_coeffs(3, 2);
-            auto p11 = tr_coeffs(4, 0) + molefraction[0] * tr_coeffs(4, 1) + molefraction[0] * molefraction[0] * tr_coeffs(4, 2);
-            auto p02 = tr_coeffs(5, 0) + molefraction[0] * tr_coeffs(5, 1) + molefraction[0] * molefraction[0] * tr_coeffs(5, 2);
-            auto dc_scale = 1.0/(0.125* pow( pow(vc[0],1.0/3.0)  + pow(vc[1],1.0/3.0),3.0));
-            auto tc_scale = sqrt(Tc[0] * Tc[1]);
-            auto tau = tc_scale / temperature;
-            auto delta = density / dc_scale;
-
-            auto tc_func = pow(molefraction[0], 2.0) * Tc[0] + pow(molefraction[1], 2.0) * Tc[1] + 2.0 * molefraction[0] * molefraction[1] * \
-                (p00 + p10 * delta + p01 * tau + p20 * delta * delta + p02 * tau * tau + p11 * delta * tau) * tc_scale;
-            return forceeval(tc_func);
+            return std::get<0>(get_tr_dr(temperature, density, molefraction));
         }
 
-
         /*!
             Reducing function for density
         */
         template <typename TTYPE, typename RHOTYPE, typename MoleFractions>
         auto get_dr(const TTYPE& temperature, const RHOTYPE& density, const MoleFractions& molefraction) const {
-
-            auto p00 = dr_coeffs(0, 0) + molefraction[0] * dr_coeffs(0, 1) + molefraction[0] * molefraction[0] * dr_coeffs(0, 2);
-            auto p10 = dr_coeffs(1, 0) + molefraction[0] * dr_coeffs(1, 1) + molefraction[0] * molefraction[0] * dr_coeffs(1, 2);
-            auto p01 = dr_coeffs(2, 0) + molefraction[0] * dr_coeffs(2, 1) + molefraction[0] * molefraction[0] * dr_coeffs(2, 2);
-            auto p20 = dr_coeffs(3, 0) + molefraction[0] * dr_coeffs(3, 1) + molefraction[0] * molefraction[0] * dr_coeffs(3, 2);
-            auto p11 = dr_coeffs(4, 0) + molefraction[0] * dr_coeffs(4, 1) + molefraction[0] * molefraction[0] * dr_coeffs(4, 2);
-            auto p02 = dr_coeffs(5, 0) + molefraction[0] * dr_coeffs(5, 1) + molefraction[0] * molefraction[0] * dr_coeffs(5, 2);
-            auto dc_scale = 1.0/(0.125* pow( pow(vc[0],1.0/3.0)  + pow(vc[1],1.0/3.0),3.0));
-            auto vc_scale = 1.0/dc_scale;
-            auto tc_scale = sqrt(Tc[0] * Tc[1]);
-            auto tau = tc_scale / temperature;
-            auto delta = density / dc_scale;
-
-            auto vc_ = pow(molefraction[0], 2.0) * vc[0] + pow(molefraction[1], 2.0) * vc[1] + 2.0 * molefraction[0] * molefraction[1] * \
-                (p00 + p10 * delta + p01 * tau + p20 * delta * delta + p02 * tau * tau + p11 * delta * tau) * vc_scale;
-            auto dc_func = (1.0 / vc_);
-            return forceeval(dc_func);
+            return std::get<1>(get_tr_dr(temperature, density, molefraction));
         }
 
     };
@@ -151,11 +199,10 @@ namespace teqp {
             const RhoType& rho,
             const MoleFracType& molefrac) const
         {
-            if (static_cast<std::size_t>(molefrac.size()) != 2){
-                 throw teqp::InvalidArgument("Wrong size of mole fractions - ECS mutant is only valid for a binary mixture");
+            if (static_cast<Eigen::Index>(molefrac.size()) != redfunc.Tc.size()){
+                 throw teqp::InvalidArgument("Wrong size of mole fractions; should be " + std::to_string(redfunc.Tc.size()));
             }
-            auto Tred = forceeval(redfunc.get_tr(T, rho, molefrac));
-            auto rhored = forceeval(redfunc.get_dr(T, rho, molefrac));
+            auto [Tred, rhored] = redfunc.get_tr_dr(T, rho, molefrac);
             auto delta = forceeval(rho / rhored);
             auto tau = forceeval(Tred / T);
             auto val = base.corr.alphar(tau, delta, molefrac);
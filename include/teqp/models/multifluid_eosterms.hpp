@@ -33,6 +33,29 @@ public:
         }
         return forceeval(r);
     }
+
+    /// The coefficients of the terms, in the order of alphar_basis
+    const Eigen::ArrayXd& get_coefficients() const { return n; }
+
+    /// The terms without their coefficients, such that \f$\alpha^{\rm r}=\sum_i n_i\phi_i\f$
+    template<typename TauType, typename DeltaType>
+    auto alphar_basis(const TauType& tau, const DeltaType& delta) const {
+        using result = std::common_type_t<TauType, DeltaType>;
+        Eigen::ArrayX<result> o(n.size());
+        TauType lntau = log(tau);
+        if (getbaseval(delta) == 0) {
+            for (auto i = 0; i < o.size(); ++i) {
+                o[i] = exp(t[i] * lntau)*powi(delta, static_cast<int>(d[i]));
+            }
+        }
+        else {
+            DeltaType lndelta = log(delta);
+            for (auto i = 0; i < o.size(); ++i) {
+                o[i] = exp(t[i] * lntau + d[i] * lndelta);
+            }
+        }
+        return o;
+    }
 };
 
 /**
@@ -73,6 +96,29 @@ public:
         }
         return r;
     }
+
+    /// The coefficients of the terms, in the order of alphar_basis
+    const Eigen::ArrayXd& get_coefficients() const { return coeffs.n; }
+
+    /// The terms without their coefficients, such that \f$\alpha^{\rm r}=\sum_i n_i\phi_i\f$
+    template<typename TauType, typename DeltaType>
+    auto alphar_basis(const TauType& tau, const DeltaType& delta) const {
+        using result = std::common_type_t<TauType, DeltaType>;
+        Eigen::ArrayX<result> o(coeffs.n.size());
+        TauType lntau = log(tau);
+        if (getbaseval(delta) == 0) {
+            for (auto i = 0; i < o.size(); ++i) {
+                o[i] = exp(coeffs.t[i] * lntau - coeffs.c[i] * powi(delta, coeffs.l_i[i])) * powi(delta, static_cast<int>(coeffs.d[i]));
+            }
+        }
+        else {
+            DeltaType lndelta = log(delta);
+            for (auto i = 0; i < o.size(); ++i) {
+                o[i] = exp(coeffs.t[i] * lntau + coeffs.d[i] * lndelta - coeffs.c[i] * powi(delta, coeffs.l_i[i]));
+            }
+        }
+        return o;
+    }
 };
 
 /**
@@ -100,6 +146,29 @@ public:
         }
         return forceeval(r);
     }
+
+    /// The coefficients of the terms, in the order of alphar_basis
+    const Eigen::ArrayXd& get_coefficients() const { return n; }
+
+    /// The terms without their coefficients, such that \f$\alpha^{\rm r}=\sum_i n_i\phi_i\f$
+    template<typename TauType, typename DeltaType>
+    auto alphar_basis(const TauType& tau, const DeltaType& delta) const {
+        using result = std::common_type_t<TauType, DeltaType>;
+        Eigen::ArrayX<result> o(n.size());
+        TauType lntau = log(tau);
+        if (getbaseval(delta) == 0) {
+            for (auto i = 0; i < o.size(); ++i) {
+                o[i] = exp(t[i] * lntau - g[i] * powi(delta, l_i[i]))*powi(delta, static_cast<int>(d[i]));
+            }
+        }
+        else {
+            DeltaType lndelta = log(delta);
+            for (auto i = 0; i < o.size(); ++i) {
+                o[i] = exp(t[i] * lntau + d[i] * lndelta - g[i] * powi(delta, l_i[i]));
+            }
+        }
+        return o;
+    }
 };
 
 /**
@@ -163,6 +232,30 @@ public:
         }
         return forceeval(r);
     }
+
+    /// The coefficients of the terms, in the order of alphar_basis
+    const Eigen::ArrayXd& get_coefficients() const { return n; }
+
+    /// The terms without their coefficients, such that \f$\alpha^{\rm r}=\sum_i n_i\phi_i\f$
+    template<typename TauType, typename DeltaType>
+    auto alphar_basis(const TauType& tau, const DeltaType& delta) const {
+        using result = std::common_type_t<TauType, DeltaType>;
+        Eigen::ArrayX<result> o(n.size());
+        TauType lntau = log(tau);
+        auto square = [](auto x) { return x * x; };
+        if (getbaseval(delta) == 0) {
+            for (auto i = 0; i < o.size(); ++i) {
+                o[i] = exp(t[i] * lntau - eta[i] * square(delta - epsilon[i]) - beta[i] * square(tau - gamma[i]))*powi(delta, static_cast<int>(d[i]));
+            }
+        }
+        else {
+            DeltaType lndelta = log(delta);
+            for (auto i = 0; i < o.size(); ++i) {
+                o[i] = exp(t[i] * lntau + d[i] * lndelta - eta[i] * square(delta - epsilon[i]) - beta[i] * square(tau - gamma[i]));
+            }
+        }
+        return o;
+    }
 };
 
 /**
@@ -250,11 +343,21 @@ public:
 
 /**
 The contribution is a Chebyshev expansion in two dimensions
+
+\f[
+\alpha^r = \sum_{k=0}^{N_\delta}\sum_{l=0}^{N_\tau}{}^{'} a_{kl}T_k(y)T_l(x)
+\f]
+where the primes indicate that the terms with \f$k=0\f$ or \f$l=0\f$ are halved, and \f$x\f$ and \f$y\f$ are
+\f$\tau\f$ and \f$\delta\f$ mapped linearly onto [-1,1].
+
+The expansion is evaluated with nested Clenshaw recurrences that are carried out on the fly, so no scratch storage is needed
+and the evaluation is reentrant.
 */
 class Chebyshev2DEOSTerm {
 public:
     Eigen::ArrayXXd a;
     double taumin = -1, taumax = -1, deltamin = -1, deltamax = -1;
+    bool strict_domain = false; ///< If true, throw if \f$x\f$ or \f$y\f$ are outside [-1,1] rather than extrapolating
 
     /// Clenshaw evaluation of a Chebyshev expansion in 1D
     template<typename vectype, typename XType>
@@ -271,50 +374,110 @@ public:
         }
         return (u_k - u_kp2)/2.0;
     }
-
-    /// Clenshaw evaluation of one dimensional flattening of the Chebyshev expansion
-    template<typename MatType, typename XType>
-    static auto Clenshaw1DByRow(const MatType& c, const XType &ind) {
-        int N = static_cast<int>(c.rows()) - 1;
-        constexpr int Cols = MatType::ColsAtCompileTime;
-        using NumType = std::common_type_t<typename MatType::Scalar, XType>;
-        static Eigen::Array<NumType, 1, Cols> u_k, u_kp1, u_kp2;
-        // Not statically sized, need to resize
-        if constexpr (Cols == Eigen::Dynamic) {
-            int M = static_cast<int>(c.rows());
-            u_k.resize(M); 
-            u_kp1.resize(M);
-            u_kp2.resize(M);
-        }
-        u_k.setZero(); u_kp1.setZero(); u_kp2.setZero();
-        
-        for (int k = N; k >= 0; --k) {
-            // Do the recurrent calculation
-            u_k = 2.0 * ind * u_kp1 - u_kp2 + c.row(k).template cast<XType>();
-            if (k > 0) {
-                // Update the values
-                u_kp2 = u_kp1; u_kp1 = u_k;
-            }
+    
+    /// Clenshaw evaluation of the derivative of a Chebyshev expansion in 1D, with \f$T'_k(x)=kU_{k-1}(x)\f$
+    template<typename vectype>
+    static double Clenshaw1DDerivative(const vectype &c, double ind){
+        int N = static_cast<int>(c.size()) - 1;
+        double v_j = 0, v_jp1 = 0, v_jp2 = 0;
+        for (int j = N-1; j >= 0; --j){
+            v_j = 2.0*ind*v_jp1 - v_jp2 + (j+1)*c[j+1];
+            v_jp2 = v_jp1; v_jp1 = v_j;
         }
-        return (u_k - u_kp2) / 2.0;
+        return v_j;
     }
 
     /** Clenshaw evaluation of the complete expansion
      * \param a Matrix
      * \param x The first argument, in [-1,1]
      * \param y The second argument, in [-1,1]
+     *
+     * The outer recurrence in \f$x\f$ consumes the columns from the last to the first, so the inner
+     * recurrence in \f$y\f$ for each column is evaluated at the point it is needed
      */
     template<typename MatType, typename XType, typename YType>
     static auto Clenshaw2DEigen(const MatType& a, const XType &x, const YType &y) {
-        auto b = Clenshaw1DByRow(a, y);
-        return Clenshaw1D(b.matrix(), x);
+        using NumType = std::common_type_t<typename MatType::Scalar, XType, YType>;
+        NumType u_l = 0.0, u_lp1 = 0.0, u_lp2 = 0.0;
+        for (auto l = static_cast<int>(a.cols()) - 1; l >= 0; --l){
+            u_l = 2.0*x*u_lp1 - u_lp2 + Clenshaw1D(a.col(l), y);
+            if (l > 0){
+                u_lp2 = u_lp1; u_lp1 = u_l;
+            }
+        }
+        return forceeval((u_l - u_lp2)/2.0);
     }
-
+    
+    /// Map \f$\tau\f$ and \f$\delta\f$ onto [-1,1], and check the domain if requested
     template<typename TauType, typename DeltaType>
-    auto alphar(const TauType& tau, const DeltaType& delta) const {
+    auto get_xy(const TauType& tau, const DeltaType& delta) const {
         TauType x = (2.0*tau - (taumax + taumin)) / (taumax - taumin);
         DeltaType y = (2.0*delta - (deltamax + deltamin)) / (deltamax - deltamin);
-        return forceeval(Clenshaw2DEigen(a, x, y));
+        if (strict_domain){
+            auto xb = getbaseval(x), yb = getbaseval(y);
+            if (xb < -1 || xb > 1 || yb < -1 || yb > 1){
+                throw teqp::InvalidArgument("Chebyshev2D term evaluated outside its domain; tau: " + std::to_string(getbaseval(tau)) + " (x: " + std::to_string(xb) + "), delta: " + std::to_string(getbaseval(delta)) + " (y: " + std::to_string(yb) + ")");
+            }
+        }
+        return std::make_tuple(x, y);
+    }
+    
+    /// Return true if \f$\tau\f$ and \f$\delta\f$ are within the domain of the expansion
+    bool in_domain(double tau, double delta) const {
+        return tau >= taumin && tau <= taumax && delta >= deltamin && delta <= deltamax;
+    }
+
+    /**
+     * For the first-derivative autodiff types (from get_Ar01, get_Ar10, and the isochoric gradients) the value and 
+     * first derivatives are obtained from alphar_derivs and the derivatives of the arguments applied by the chain rule,
+     * rather than carrying the autodiff types through the recurrences. All other types go through the generic recurrences.
+     */
+    template<typename TauType, typename DeltaType>
+    auto alphar(const TauType& tau, const DeltaType& delta) const {
+        using NumType = std::common_type_t<TauType, DeltaType>;
+        if constexpr (std::is_same_v<NumType, autodiff::Real<1, double>> || std::is_same_v<NumType, autodiff::dual>) {
+            NumType tau_ = tau, delta_ = delta;
+            auto [f, dfdtau, dfddelta] = alphar_derivs(getbaseval(tau_), getbaseval(delta_));
+            NumType o = f;
+            if constexpr (std::is_same_v<NumType, autodiff::dual>) {
+                o.grad = dfdtau*tau_.grad + dfddelta*delta_.grad;
+            }
+            else {
+                o[1] = dfdtau*tau_[1] + dfddelta*delta_[1];
+            }
+            return o;
+        }
+        else {
+            auto [x, y] = get_xy(tau, delta);
+            return forceeval(Clenshaw2DEigen(a, x, y));
+        }
+    }
+    
+    /**
+     * \brief Return \f$\alpha^r\f$ and its first derivatives with respect to \f$\tau\f$ and \f$\delta\f$ as a tuple
+     *
+     * The derivatives of the Chebyshev polynomials are obtained analytically from \f$T'_k(x)=kU_{k-1}(x)\f$,
+     * with the recurrences for the value and both derivatives carried out in the same pass over the coefficients
+     */
+    auto alphar_derivs(double tau, double delta) const {
+        auto [x, y] = get_xy(tau, delta);
+        double dxdtau = 2.0/(taumax - taumin), dydelta = 2.0/(deltamax - deltamin);
+        // u: value, v: derivative in x (a series in U), w: derivative in y
+        double u_l = 0, u_lp1 = 0, u_lp2 = 0, v_l = 0, v_lp1 = 0, v_lp2 = 0, w_l = 0, w_lp1 = 0, w_lp2 = 0;
+        for (auto l = static_cast<int>(a.cols()) - 1; l >= 0; --l){
+            auto b = Clenshaw1D(a.col(l), y);
+            u_l = 2.0*x*u_lp1 - u_lp2 + b;
+            w_l = 2.0*x*w_lp1 - w_lp2 + Clenshaw1DDerivative(a.col(l), y);
+            if (l > 0){
+                v_l = 2.0*x*v_lp1 - v_lp2 + l*b;
+                v_lp2 = v_lp1; v_lp1 = v_l;
+                u_lp2 = u_lp1; u_lp1 = u_l;
+                w_lp2 = w_lp1; w_lp1 = w_l;
+            }
+        }
+        // The sum over U_{l-1} ends at l=1, so its value is the last v_l
+        double dfdx = (a.cols() > 1) ? v_l : 0.0;
+        return std::make_tuple((u_l - u_lp2)/2.0, dfdx*dxdtau, (w_l - w_lp2)/2.0*dydelta);
     }
 };
 
@@ -359,6 +522,30 @@ public:
             return static_cast<decltype(outval)>(0.0);
         }
     }
+
+    /// The coefficients of the terms, in the order of alphar_basis
+    const Eigen::ArrayXd& get_coefficients() const { return n; }
+
+    /// The terms without their coefficients, such that \f$\alpha^{\rm r}=\sum_i n_i\phi_i\f$; as in alphar, undefined terms at the critical point are zero
+    template<typename TauType, typename DeltaType>
+    auto alphar_basis(const TauType& tau, const DeltaType& delta) const {
+        auto square = [](auto x) { return x * x; };
+        auto delta_min1_sq = square(delta - 1.0);
+
+        using result = std::common_type_t<TauType, DeltaType>;
+        Eigen::ArrayX<result> o(n.size());
+        for (auto i = 0; i < n.size(); ++i) {
+            auto Psi = exp(-C[i]*delta_min1_sq - D[i]*square(tau - 1.0));
+            auto k = 1.0 / (2.0 * beta[i]);
+            auto theta = (1.0 - tau) + A[i] * pow(delta_min1_sq, k);
+            auto Delta = square(theta) + B[i]*pow(delta_min1_sq, a[i]);
+            o[i] = pow(Delta, b[i])*delta*Psi;
+            if (!std::isfinite(static_cast<double>(getbaseval(o[i])))) {
+                o[i] = 0.0;
+            }
+        }
+        return o;
+    }
 };
 
 /**
@@ -454,6 +641,50 @@ public:
         }
         return ar;
     }
+
+    /// The coefficients of all the terms that are linear in their coefficients and define alphar_basis, in order
+    Eigen::ArrayXd get_coefficients() const {
+        std::vector<double> c;
+        for (const auto& term : coll) {
+            std::visit([&](auto& t) {
+                if constexpr (requires { t.get_coefficients(); }) {
+                    const auto& n = t.get_coefficients();
+                    c.insert(c.end(), n.begin(), n.end());
+                }
+            }, term);
+        }
+        return Eigen::Map<const Eigen::ArrayXd>(c.data(), c.size());
+    }
+
+    /**
+     \brief Split alphar into the terms whose coefficients are held fixed and the basis of the coefficients returned by get_coefficients
+     \returns The tuple of the fixed part and the basis, such that alphar = fixed + sum(coefficients*basis)
+     */
+    template <class Tau, class Delta>
+    auto alphar_basis(const Tau& tau, const Delta& delta) const {
+        using result = std::common_type_t<Tau, Delta>;
+        result fixed = 0.0;
+        std::vector<Eigen::ArrayX<result>> blocks;
+        Eigen::Index N = 0;
+        for (const auto& term : coll) {
+            std::visit([&](auto& t) {
+                if constexpr (requires { t.alphar_basis(tau, delta); }) {
+                    blocks.emplace_back(t.alphar_basis(tau, delta));
+                    N += blocks.back().size();
+                }
+                else {
+                    fixed += t.alphar(tau, delta);
+                }
+            }, term);
+        }
+        Eigen::ArrayX<result> basis(N);
+        Eigen::Index offset = 0;
+        for (const auto& block : blocks) {
+            basis.segment(offset, block.size()) = block;
+            offset += block.size();
+        }
+        return std::make_tuple(fixed, basis);
+    }
 };
 
 using EOSTerms = EOSTermContainer<JustPowerEOSTerm, PowerEOSTerm, GaussianEOSTerm, NonAnalyticEOSTerm, Lemmon2005EOSTerm, GaoBEOSTerm, ExponentialEOSTerm, DoubleExponentialEOSTerm, GenericCubicTerm, PCSAFTGrossSadowski2001Term>;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <span>
 
 namespace teqp {
 
@@ -62,18 +63,16 @@ namespace teqp {
         }
     };
 
-    template<class Model>
-    auto build_multifluid_mutant(const Model& model, const nlohmann::json& jj) {
-
-        auto N = model.redfunc.Tc.size();
+    /// Build the matrix of F factors and the matrix of departure functions of a mutant from its JSON specification
+    inline auto build_mutant_departure_functions(const std::size_t N, const nlohmann::json& jj) {
 
         // Allocate the matrices of default models and F factors
         Eigen::MatrixXd F(N, N); F.setZero();
         std::vector<std::vector<DepartureTerms>> funcs(N);
-        for (auto i = 0; i < N; ++i) { funcs[i].resize(N); }
+        for (auto i = 0U; i < N; ++i) { funcs[i].resize(N); }
 
         // Build the F and departure function matrix
-        for (auto i = 0; i < N; ++i) {
+        for (auto i = 0U; i < N; ++i) {
             for (auto j = i; j < N; ++j) {
                 if (i == j) {
                     funcs[i][i].add_term(NullEOSTerm());
@@ -92,6 +91,14 @@ namespace teqp {
                 }
             }
         }
+        return std::make_tuple(F, funcs);
+    }
+
+    template<class Model>
+    auto build_multifluid_mutant(const Model& model, const nlohmann::json& jj) {
+
+        auto N = model.redfunc.Tc.size();
+        auto [F, funcs] = build_mutant_departure_functions(N, jj);
 
         // Determine what sort of reducing function is to be used
         auto get_reducing = [&](const auto& deptype) {
@@ -152,4 +159,192 @@ namespace teqp {
         return mfa;
     }
 
+    /**
+    A mutant in which the binary interaction parameters are held in a flat vector of parameters that can be
+    updated in place with set_parameters, without rebuilding the reducing or departure functions. This is intended
+    for the fitting of binary interaction parameters, where the model is evaluated for many sets of parameters.
+
+    For each binary pair (i,j) with i < j, in the order (0,1), (0,2), ..., (1,2), ..., there are five parameters:
+    betaT, gammaT, betaV, gammaV, Fij for the standard reducing function, or phiT, lambdaT, phiV, lambdaV, Fij for
+    the invariant reducing function (selected with "type": "invariant" in the BIP, as in build_multifluid_mutant).
+    The structure of the departure functions is fixed at construction.
+
+    \note set_parameters modifies the model, so it must not be called while the model is being evaluated in another thread
+    */
+    template<typename BaseClass>
+    class MultiFluidParameterMutant {
+    public:
+        static constexpr std::size_t params_per_pair = 5;
+        const BaseClass& base;
+        const Eigen::ArrayXd Tc, vc;
+    private:
+        std::string meta = "";
+        const bool invariant;
+        const std::size_t N;
+        std::vector<double> parameters;
+        std::vector<std::vector<DepartureTerms>> funcs;
+        // The geometric factors of the reducing function that depend only on the pure fluids
+        Eigen::MatrixXd YTfac, Yvfac;
+        // The matrices of the reducing function, and of F, updated in place by set_parameters
+        Eigen::MatrixXd mat0, mat1, mat2, mat3, YT, Yv, F;
+
+        /// Copy the parameters for each pair into the matrices of the reducing function and F
+        void update_matrices() {
+            std::size_t k = 0;
+            for (auto i = 0U; i < N; ++i) {
+                for (auto j = i + 1; j < N; ++j) {
+                    const double* p = &(parameters[k]);
+                    if (invariant) {
+                        // phiT, lambdaT, phiV, lambdaV
+                        mat0(i, j) = p[0]; mat0(j, i) = p[0];
+                        mat1(i, j) = p[1]; mat1(j, i) = -p[1];
+                        mat2(i, j) = p[2]; mat2(j, i) = p[2];
+                        mat3(i, j) = p[3]; mat3(j, i) = -p[3];
+                    }
+                    else {
+                        // betaT, gammaT, betaV, gammaV; only betaT and betaV are needed in Y in addition to YT and Yv
+                        mat0(i, j) = p[0]; mat0(j, i) = 1.0 / p[0];
+                        mat1(i, j) = p[1]; mat1(j, i) = p[1];
+                        mat2(i, j) = p[2]; mat2(j, i) = 1.0 / p[2];
+                        mat3(i, j) = p[3]; mat3(j, i) = p[3];
+                        YT(i, j) = mat0(i, j) * mat1(i, j) * YTfac(i, j);
+                        YT(j, i) = mat0(j, i) * mat1(j, i) * YTfac(i, j);
+                        Yv(i, j) = mat2(i, j) * mat3(i, j) * Yvfac(i, j);
+                        Yv(j, i) = mat2(j, i) * mat3(j, i) * Yvfac(i, j);
+                    }
+                    F(i, j) = p[4]; F(j, i) = p[4];
+                    k += params_per_pair;
+                }
+            }
+        }
+
+    public:
+        MultiFluidParameterMutant(const BaseClass& base, const nlohmann::json& jj)
+            : base(base), Tc(base.redfunc.Tc), vc(base.redfunc.vc),
+              invariant(jj.at("0").at("1").at("BIP").value("type", "") == "invariant"), N(static_cast<std::size_t>(Tc.size()))
+        {
+            std::tie(F, funcs) = build_mutant_departure_functions(N, jj);
+            std::vector<std::string> keys = get_parameter_keys();
+            for (auto i = 0U; i < N; ++i) {
+                for (auto j = i + 1; j < N; ++j) {
+                    auto BIP = jj.at(std::to_string(i)).at(std::to_string(j)).at("BIP");
+                    for (const auto& key : keys) {
+                        parameters.push_back(BIP.at(key));
+                    }
+                }
+            }
+            mat0 = Eigen::MatrixXd::Zero(N, N); mat1 = mat0; mat2 = mat0; mat3 = mat0;
+            YTfac = mat0; Yvfac = mat0; YT = mat0; Yv = mat0;
+            for (auto i = 0U; i < N; ++i) {
+                for (auto j = 0U; j < N; ++j) {
+                    if (invariant) {
+                        // As in MultiFluidInvariantReducingFunction, these do not depend on the parameters
+                        YT(i, j) = sqrt(Tc[i] * Tc[j]);
+                        Yv(i, j) = 1.0 / 8.0 * pow3(cbrt(vc[i]) + cbrt(vc[j]));
+                    }
+                    else if (i != j) {
+                        YTfac(i, j) = 2.0 * sqrt(Tc[i] * Tc[j]);
+                        Yvfac(i, j) = 2.0 * 1.0 / 8.0 * pow3(cbrt(vc[i]) + cbrt(vc[j]));
+                    }
+                }
+            }
+            update_matrices();
+        }
+
+        template<class VecType>
+        auto R(const VecType& molefrac) const { return base.R(molefrac); }
+
+        /// Store some sort of metadata in string form (perhaps a JSON representation of the model?)
+        void set_meta(const std::string& m) { meta = m; }
+        /// Get the metadata stored in string form
+        auto get_meta() const { return meta; }
+
+        /// Return the keys of the parameters of each binary pair
+        std::vector<std::string> get_parameter_keys() const {
+            if (invariant) {
+                return { "phiT", "lambdaT", "phiV", "lambdaV", "Fij" };
+            }
+            return { "betaT", "gammaT", "betaV", "gammaV", "Fij" };
+        }
+        /// Return the current values of all the parameters
+        const std::vector<double>& get_parameters() const { return parameters; }
+
+        /**
+         \brief Set all the parameters, in the same order as returned by get_parameters
+         \param p The values; must be the same length as the parameter vector
+
+         No memory is allocated and the departure functions are untouched
+         */
+        void set_parameters(std::span<const double> p) {
+            if (p.size() != parameters.size()) {
+                throw teqp::InvalidArgument("Length of parameters of " + std::to_string(p.size()) + " does not equal the required length of " + std::to_string(parameters.size()));
+            }
+            std::copy(p.begin(), p.end(), parameters.begin());
+            update_matrices();
+        }
+
+        /// Return a binary interaction parameter
+        double get_BIP(const std::size_t& i, const std::size_t& j, const std::string& key) const {
+            if (i >= N || j >= N) {
+                throw teqp::InvalidArgument("Indices are out of bounds");
+            }
+            if (key == "F" || key == "Fij") { return F(i, j); }
+            auto keys = get_parameter_keys();
+            const Eigen::MatrixXd* mats[] = { &mat0, &mat1, &mat2, &mat3 };
+            for (auto k = 0U; k < 4; ++k) {
+                if (key == keys[k]) { return (*mats[k])(i, j); }
+            }
+            throw teqp::InvalidArgument("variable is not understood: " + key);
+        }
+
+        template<typename MoleFractions> auto get_Tr(const MoleFractions& molefracs) const {
+            if (invariant) {
+                return forceeval(MultiFluidInvariantReducingFunction::Y(molefracs, mat0, mat1, YT));
+            }
+            return forceeval(MultiFluidReducingFunction::Y(molefracs, Tc, mat0, YT));
+        }
+        template<typename MoleFractions> auto get_rhor(const MoleFractions& molefracs) const {
+            if (invariant) {
+                return forceeval(1.0 / MultiFluidInvariantReducingFunction::Y(molefracs, mat2, mat3, Yv));
+            }
+            return forceeval(1.0 / MultiFluidReducingFunction::Y(molefracs, vc, mat2, Yv));
+        }
+
+        template<typename TauType, typename DeltaType, typename MoleFractions>
+        auto alphar_departure(const TauType& tau, const DeltaType& delta, const MoleFractions& molefracs) const {
+            using resulttype = std::decay_t<std::common_type_t<decltype(tau), decltype(molefracs[0]), decltype(delta)>>;
+            resulttype alphar = 0.0;
+            for (auto i = 0U; i < N; ++i) {
+                for (auto j = i + 1; j < N; ++j) {
+                    alphar += molefracs[i] * molefracs[j] * F(i, j) * funcs[i][j].alphar(tau, delta);
+                }
+            }
+            return alphar;
+        }
+
+        template<typename TType, typename RhoType, typename MoleFracType>
+        auto alphar(const TType& T,
+            const RhoType& rho,
+            const MoleFracType& molefrac) const
+        {
+            if (static_cast<std::size_t>(molefrac.size()) != N) {
+                throw teqp::InvalidArgument("Length of fractions of " + std::to_string(molefrac.size()) + " does not equal # of components of " + std::to_string(N));
+            }
+            auto Tred = get_Tr(molefrac);
+            auto rhored = get_rhor(molefrac);
+            auto delta = forceeval(rho / rhored);
+            auto tau = forceeval(Tred / T);
+            auto val = base.corr.alphar(tau, delta, molefrac) + alphar_departure(tau, delta, molefrac);
+            return forceeval(val);
+        }
+    };
+
+    /// Build a mutant whose binary interaction parameters can be updated in place, see MultiFluidParameterMutant
+    template<class Model>
+    auto build_multifluid_parameter_mutant(const Model& model, const nlohmann::json& jj) {
+        auto mutant = MultiFluidParameterMutant<Model>(model, jj);
+        mutant.set_meta(jj.dump());
+        return mutant;
+    }
+
 }
@@ -201,7 +201,7 @@ namespace teqp {
         }
 
         template <typename MoleFractions>
-        auto Y(const MoleFractions& z, const Eigen::ArrayXd& Yc, const Eigen::MatrixXd& beta, const Eigen::MatrixXd& Yij) const {
+        static auto Y(const MoleFractions& z, const Eigen::ArrayXd& Yc, const Eigen::MatrixXd& beta, const Eigen::MatrixXd& Yij) {
             
             auto N = z.size();
             if (N != Yc.size()){
@@ -294,7 +294,7 @@ namespace teqp {
         }
         /// As implemented in Table 7.18 from GERG-2004
         template <typename MoleFractions>
-        auto Y(const MoleFractions& z, const Eigen::MatrixXd& phi, const Eigen::MatrixXd& lambda, const Eigen::MatrixXd& Yij) const {
+        static auto Y(const MoleFractions& z, const Eigen::MatrixXd& phi, const Eigen::MatrixXd& lambda, const Eigen::MatrixXd& Yij) {
             auto N = z.size();
             typename MoleFractions::value_type sum = 0.0;
             for (auto i = 0U; i < N; ++i) {
@@ -0,0 +1,201 @@
+#pragma once
+
+/**
+ Caching and indexing of the conversion of REFPROP-format inputs (FLD files and HMX.BNC) into the JSON
+ structures that are used to build multifluid models. The conversion itself is carried out by REFPROP-interop
+*/
+
+#include "nlohmann/json.hpp"
+
+#include <string>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <functional>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <unordered_map>
+
+#include "teqp/exceptions.hpp"
+
+#include "RPinterop/interop.hpp"
+
+namespace teqp {
+namespace RPinteropcache {
+
+/// Read the complete contents of a file into a string
+inline std::string read_file_contents(const std::string& path) {
+    if (!std::filesystem::is_regular_file(path)) {
+        throw teqp::InvalidArgument("Path to be loaded does not exist: " + path);
+    }
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        throw teqp::InvalidArgument("File stream cannot be opened from: " + path);
+    }
+    std::stringstream buffer;
+    buffer << stream.rdbuf();
+    return buffer.str();
+}
+
+/// The key used in the caches, a hash of the contents along with their length
+inline std::string content_key(const std::string& contents) {
+    return std::to_string(std::hash<std::string>{}(contents)) + ":" + std::to_string(contents.size());
+}
+
+/**
+ * \brief The binary interaction parameters and departure functions of an HMX.BNC file, indexed by binary pair
+ *
+ * The index reproduces the matching of reducing::get_BIPdep (hashes first, then names, then CAS numbers, in either
+ * order of the components, with the first match in the collection winning), so that only the entries needed for a given
+ * set of components can be handed on to the model construction rather than the complete collection
+ */
+class HMXBNCIndex {
+public:
+    const nlohmann::json BIPcollection, depcollection;
+private:
+    /// For the passes over hashes, names and CAS numbers, map from "id1/id2" to the index of the first entry with that pair
+    std::array<std::unordered_map<std::string, std::size_t>, 3> pair_index;
+
+    static std::string toupper(const std::string& s) {
+        auto data = s; std::for_each(data.begin(), data.end(), [](char& c) { c = static_cast<char>(::toupper(c)); }); return data;
+    }
+
+    void build_index() {
+        std::size_t i = 0;
+        for (const auto& el : BIPcollection) {
+            auto add = [&](std::size_t pass, const std::string& k1, const std::string& k2) {
+                if (el.contains(k1) && el.contains(k2)) {
+                    std::string id1 = el.at(k1), id2 = el.at(k2);
+                    if (pass < 2) { id1 = toupper(id1); id2 = toupper(id2); }
+                    pair_index[pass].emplace(id1 + "/" + id2, i); // emplace keeps the first entry
+                }
+            };
+            add(0, "hash1", "hash2");
+            add(1, "Name1", "Name2");
+            add(2, "CAS1", "CAS2");
+            i++;
+        }
+    }
+
+public:
+    HMXBNCIndex(const nlohmann::json& BIPcollection, const nlohmann::json& depcollection) : BIPcollection(BIPcollection), depcollection(depcollection) {
+        build_index();
+    }
+
+    /// Find the index of the entry in the BIP collection for the pair of identifiers, if there is one
+    std::optional<std::size_t> find_pair(const std::string& id1, const std::string& id2) const {
+        for (auto pass = 0U; pass < pair_index.size(); ++pass) {
+            std::string a = (pass < 2) ? toupper(id1) : id1, b = (pass < 2) ? toupper(id2) : id2;
+            std::optional<std::size_t> found;
+            for (const auto& key : { a + "/" + b, b + "/" + a }) {
+                auto it = pair_index[pass].find(key);
+                if (it != pair_index[pass].end() && (!found || it->second < found.value())) {
+                    found = it->second;
+                }
+            }
+            if (found) { return found; }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * \brief Select the entries that could be needed for the components, given all their sets of identifiers
+     * \param identifierset Map from kind of identifier to the identifiers of the components, as returned by collect_identifiers
+     *
+     * The entries are returned in their original order, along with the departure functions that they refer to
+     */
+    template<typename mapvecstring>
+    auto select(const mapvecstring& identifierset) const {
+        std::set<std::size_t> indices;
+        for (const auto& [key, identifiers] : identifierset) {
+            for (auto i = 0U; i < identifiers.size(); ++i) {
+                for (auto j = i + 1; j < identifiers.size(); ++j) {
+                    auto found = find_pair(identifiers[i], identifiers[j]);
+                    if (found) { indices.insert(found.value()); }
+                }
+            }
+        }
+        nlohmann::json BIP = nlohmann::json::array(), DEP = nlohmann::json::array();
+        std::set<std::string> funcnames;
+        for (auto i : indices) {
+            const auto& el = BIPcollection[i];
+            BIP.push_back(el);
+            if (el.contains("function") && el.at("function").is_string()) {
+                funcnames.insert(el.at("function").template get<std::string>());
+            }
+        }
+        for (const auto& el : depcollection) {
+            if (el.contains("Name") && funcnames.count(el.at("Name").template get<std::string>()) > 0) {
+                DEP.push_back(el);
+            }
+        }
+        return std::make_tuple(BIP, DEP);
+    }
+};
+
+/**
+ * \brief A thread-safe cache of the conversions of FLD files and HMX.BNC files with REFPROP-interop
+ *
+ * The entries are keyed by a hash of the contents, so the same contents at different paths share an entry,
+ * and a modified file at the same path is converted again
+ */
+class REFPROPInteropCache {
+private:
+    mutable std::mutex mtx;
+    std::unordered_map<std::string, nlohmann::json> FLD;
+    std::unordered_map<std::string, std::shared_ptr<const HMXBNCIndex>> HMX;
+
+    template<typename Map, typename Factory>
+    auto get_or_make(Map& map, const std::string& key, const Factory& factory) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = map.find(key);
+            if (it != map.end()) { return it->second; }
+        }
+        // The conversion is done without holding the lock; if two threads race, the first insertion wins
+        auto value = factory();
+        std::lock_guard<std::mutex> lock(mtx);
+        return map.emplace(key, std::move(value)).first->second;
+    }
+
+public:
+    /// Get the JSON representation of the fluid in the FLD file at the given path
+    nlohmann::json get_FLD_from_path(const std::string& path) {
+        return get_or_make(FLD, content_key(read_file_contents(path)), [&]() { return RPinterop::FLDfile(path).make_json(""); });
+    }
+    /// Get the JSON representation of the fluid given the contents of an FLD file
+    nlohmann::json get_FLD_from_contents(const std::string& contents) {
+        return get_or_make(FLD, content_key(contents), [&]() { return RPinterop::FLDfile(contents).make_json(""); });
+    }
+    /// Get the indexed contents of the HMX.BNC file at the given path
+    std::shared_ptr<const HMXBNCIndex> get_HMXBNC(const std::string& path) {
+        return get_or_make(HMX, content_key(read_file_contents(path)), [&]() {
+            auto [BIP, DEP] = RPinterop::HMXBNCfile(path).make_jsons();
+            return std::make_shared<const HMXBNCIndex>(BIP, DEP);
+        });
+    }
+    /// The number of cached FLD and HMX.BNC conversions
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return FLD.size() + HMX.size();
+    }
+    /// Remove all the cached conversions
+    void clear() {
+        std::lock_guard<std::mutex> lock(mtx);
+        FLD.clear(); HMX.clear();
+    }
+};
+
+/// Get the process-wide cache of REFPROP-interop conversions
+inline REFPROPInteropCache& get_cache() {
+    static REFPROPInteropCache cache;
+    return cache;
+}
+
+}
+}
@@ -10,6 +10,7 @@
 #include "teqp/types.hpp"
 #include "teqp/constants.hpp"
 #include "teqp/exceptions.hpp"
+#include "teqp/instrumentation.hpp"
 #include "correlation_integrals.hpp"
 #include <optional>
 #include <Eigen/Dense>  
@@ -636,6 +637,7 @@ public:
         using otype = std::common_type_t<TTYPE, RhoType, RhoStarType, decltype(mole_fractions[0]), decltype(mu[0])>;
         Eigen::ArrayX<otype> muprime = mu.template cast<otype>();
         for (auto counter = 0; counter < max_steps; ++counter){
+            TEQP_COUNT(polar_iterations, 1);
             auto Eprime = get_Eprime(T, rhoN, rhostar, mole_fractions, muprime); // units of J /(C m)
             // alpha*Eprime has units of J m^3/(C m), divide by k_e (has units of J m / C^2) to get C m
             muprime = mu.template cast<otype>() + polarizable.value().alpha_symm_C2m2J.template cast<otype>()*Eprime.template cast<otype>(); // Units of C m
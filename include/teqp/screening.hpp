@@ -0,0 +1,111 @@
+#pragma once
+
+/**
+ A single-precision screening mode for the evaluation of the residual Helmholtz energy and its derivatives, as for coarse
+ screening of phase envelopes or the evaluation of large populations in fitting, where a relative error of the order of
+ \f$10^{-6}\f$ can be tolerated.
+
+ The derivatives are obtained with float as the underlying type of the algorithmic differentiation (autodiff::Real<N,float>
+ for the pure derivatives and autodiff::HigherOrderDual<2,float> for the mixed one), and the temperature, density, and mole
+ fractions are passed to the model in single precision. The parameters of the models are held in double precision, so the
+ arithmetic that only involves the parameters is still carried out in double precision.
+
+ Accuracy envelope: with the unit roundoff of float of \f$6\times 10^{-8}\f$, the relative error of \f$\alpha^{\rm r}\f$ and of its
+ derivatives is typically below \f$10^{-6}\f$, but is larger where the derivative is the small difference of large terms, for instance
+ close to a zero of the derivative, in the vicinity of the critical point, or as \f$\rho\to 0\f$ for the derivatives with respect to \f$1/T\f$.
+ Values that drive a decision should therefore be polished by a re-evaluation in double precision, see AbstractModel::polish_Arxy_batch.
+
+ The models that support the screening mode declare
+ \code
+ static constexpr bool single_precision_screening = true;
+ \endcode
+ which is a promise that their alphar function is generic in the types of the temperature, density, and mole fractions,
+ including autodiff types built on float. Other models are evaluated in double precision when screening is requested.
+ */
+
+#include <Eigen/Dense>
+
+#include "teqp/types.hpp"
+#include "teqp/exceptions.hpp"
+
+// autodiff include
+#include <autodiff/forward/dual.hpp>
+#include <autodiff/forward/real.hpp>
+
+namespace teqp {
+
+template<typename Model>
+concept SinglePrecisionScreeningCapable = requires {
+    requires Model::single_precision_screening;
+};
+
+template<typename Model>
+struct ScreeningDerivatives {
+
+    /**
+     * \brief The derivative \f$\Lambda^{\rm r}_{xy}\f$, with the same scaling as TDXDerivatives::get_Arxy, evaluated in single precision
+     *
+     * The pure derivatives are obtained from a single pass with autodiff::Real, and the mixed derivative with iT = iD = 1 from a single pass with a second-order dual number
+     */
+    template<int iT, int iD>
+    static double get_Arxy(const Model& model, const double T, const double rho, const Eigen::ArrayXd& molefrac) {
+        const Eigen::ArrayXf z = molefrac.template cast<float>();
+        const float Tf = static_cast<float>(T), rhof = static_cast<float>(rho), Trecipf = static_cast<float>(1.0/T);
+        if constexpr (iT == 0 && iD == 0) {
+            return static_cast<double>(model.alphar(Tf, rhof, z));
+        }
+        else if constexpr (iT == 0) {
+            autodiff::Real<iD, float> rho_ = rhof;
+            rho_[1] = 1.0f;
+            auto val = model.alphar(Tf, rho_, z);
+            return powi(rho, iD)*static_cast<double>(val[iD]);
+        }
+        else if constexpr (iD == 0) {
+            autodiff::Real<iT, float> Trecip_ = Trecipf;
+            Trecip_[1] = 1.0f;
+            autodiff::Real<iT, float> T_ = 1.0f/Trecip_;
+            auto val = model.alphar(T_, rhof, z);
+            return powi(1.0/T, iT)*static_cast<double>(val[iT]);
+        }
+        else if constexpr (iT == 1 && iD == 1) {
+            // Seed 1/T along the outer direction and rho along the inner one, the mixed derivative is then in grad.grad
+            using adtype = autodiff::HigherOrderDual<2, float>;
+            adtype Trecip_ = Trecipf, rho_ = rhof;
+            Trecip_.grad.val = 1.0f;
+            rho_.val.grad = 1.0f;
+            adtype T_ = 1.0f/Trecip_;
+            auto val = model.alphar(T_, rho_, z);
+            return (1.0/T)*rho*static_cast<double>(val.grad.grad);
+        }
+        else {
+            static_assert(iT == 0 || iD == 0, "Only pure derivatives and the mixed derivative with iT = iD = 1 are supported");
+        }
+    }
+
+    /// Runtime dispatch of get_Arxy, for orders of the pure derivatives up to 3
+    static double get_Arxy(const int iT, const int iD, const Model& model, const double T, const double rho, const Eigen::ArrayXd& molefrac) {
+        if (iT == 0) {
+            switch (iD) {
+            case 0: return get_Arxy<0, 0>(model, T, rho, molefrac);
+            case 1: return get_Arxy<0, 1>(model, T, rho, molefrac);
+            case 2: return get_Arxy<0, 2>(model, T, rho, molefrac);
+            case 3: return get_Arxy<0, 3>(model, T, rho, molefrac);
+            default: break;
+            }
+        }
+        else if (iD == 0) {
+            switch (iT) {
+            case 1: return get_Arxy<1, 0>(model, T, rho, molefrac);
+            case 2: return get_Arxy<2, 0>(model, T, rho, molefrac);
+            case 3: return get_Arxy<3, 0>(model, T, rho, molefrac);
+            default: break;
+            }
+        }
+        else if (iT == 1 && iD == 1) {
+            return get_Arxy<1, 1>(model, T, rho, molefrac);
+        }
+        throw teqp::InvalidArgument("Screening derivatives are not available for iT=" + std::to_string(iT) + " and iD=" + std::to_string(iD));
+    }
+};
+
+}
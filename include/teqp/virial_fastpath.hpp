@@ -0,0 +1,190 @@
+#pragma once
+
+/**
+ A fast path for the residual properties in the gas phase at low density, where the virial expansion truncated after a few terms is accurate.
+
+ For a given model and composition, the virial coefficients \f$B_n\f$ and their temperature derivatives (from VirialDerivatives) are
+ sampled once over a range of temperature and stored as Chebyshev expansions in temperature. Thereafter, when \f$|\rho B_2|\f$ is small enough,
+ the derivatives \f$\Lambda^{\rm r}_{xy}\f$ are obtained from the truncated series
+ \f[
+ \alpha^{\rm r} = \sum_{n=2}^{N} \frac{B_n\rho^{n-1}}{n-1}
+ \f]
+ without any evaluation of the model. Outside of that regime, the evaluation falls back to TDXDerivatives.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "teqp/derivs.hpp"
+#include "teqp/derivs_types.hpp"
+#include "teqp/exceptions.hpp"
+
+namespace teqp {
+
+template<typename Model>
+class VirialFastPath {
+public:
+    const Model& model;
+    const Eigen::ArrayXd molefrac;
+    const double Tmin, Tmax;
+    const VirialFastPathOptions opt;
+private:
+    // Chebyshev coefficients of T^m d^mB_n/dT^m, indexed as [m][n-2], for m = 0, 1, 2 and n = 2, ..., Nvir
+    std::vector<std::vector<Eigen::ArrayXd>> coeffs;
+    // Maximum absolute error of the expansions at the midpoints between the nodes, indexed as coeffs
+    std::vector<std::vector<double>> fit_error;
+    // Chebyshev coefficients of B_{Nvir+1}, for the estimate of the truncation error
+    Eigen::ArrayXd coeffs_next;
+
+    double to_x(double T) const { return (2.0*T - (Tmax + Tmin))/(Tmax - Tmin); }
+    double to_T(double x) const { return ((Tmax - Tmin)*x + (Tmax + Tmin))/2.0; }
+
+    /// Chebyshev coefficients from the values at the Chebyshev-Lobatto nodes \f$x_k=\cos(\pi k/M)\f$
+    static Eigen::ArrayXd fit(const Eigen::ArrayXd& f) {
+        const auto M = f.size() - 1;
+        Eigen::ArrayXd c(M + 1);
+        for (auto j = 0; j <= M; ++j) {
+            double s = 0;
+            for (auto k = 0; k <= M; ++k) {
+                double w = (k == 0 || k == M) ? 0.5 : 1.0;
+                s += w*f[k]*cos(EIGEN_PI*j*k/M);
+            }
+            c[j] = 2.0/M*s*((j == 0 || j == M) ? 0.5 : 1.0);
+        }
+        return c;
+    }
+
+    /// Evaluate \f$\sum_j c_jT_j(x)\f$ with the Clenshaw recurrence
+    static double clenshaw(const Eigen::ArrayXd& c, double x) {
+        double b1 = 0, b2 = 0;
+        for (auto j = c.size() - 1; j > 0; --j) {
+            double b0 = 2.0*x*b1 - b2 + c[j];
+            b2 = b1; b1 = b0;
+        }
+        return x*b1 - b2 + c[0];
+    }
+
+    /// The values of T^m d^mB_n/dT^m at one temperature, indexed as [m][n-2], and B_{Nvir+1}
+    auto sample(double T) const {
+        using vd = VirialDerivatives<Model, double, Eigen::ArrayXd>;
+        std::vector<std::vector<double>> vals(3, std::vector<double>(opt.Nvir - 1));
+        auto Bn = vd::get_Bnvir_runtime(opt.Nvir + 1, model, T, molefrac);
+        for (auto n = 2; n <= opt.Nvir; ++n) {
+            vals[0][n-2] = Bn[n];
+            for (auto m = 1; m <= 2; ++m) {
+                vals[m][n-2] = pow(T, m)*vd::get_dmBnvirdTm_runtime(n, m, model, T, molefrac);
+            }
+        }
+        return std::make_tuple(vals, Bn[opt.Nvir + 1]);
+    }
+
+    /// The factor \f$(n-1)_y/(n-1)\f$ from \f$\rho^y\partial^y(\rho^{n-1})/\partial\rho^y\f$, divided by \f$(n-1)\f$ from the series
+    static double density_factor(int n, int iD) {
+        double f = 1.0/(n - 1);
+        for (auto k = 0; k < iD; ++k) {
+            f *= (n - 1 - k);
+        }
+        return f;
+    }
+
+public:
+    /**
+     \brief Build the expansions of the virial coefficients for one composition over a range of temperature
+     \param model The model, which must outlive this object
+     \param molefrac The mole fractions
+     \param Tmin The minimum temperature of the expansions
+     \param Tmax The maximum temperature of the expansions
+     \param opt The options
+     */
+    VirialFastPath(const Model& model, const Eigen::ArrayXd& molefrac, double Tmin, double Tmax, const VirialFastPathOptions& opt = {})
+        : model(model), molefrac(molefrac), Tmin(Tmin), Tmax(Tmax), opt(opt)
+    {
+        if (opt.Nvir < 2 || opt.Nvir > 4) {
+            throw teqp::InvalidArgument("Nvir must be in [2, 4]");
+        }
+        if (opt.degree < 2) {
+            throw teqp::InvalidArgument("degree must be at least 2");
+        }
+        if (!(Tmin > 0 && Tmax > Tmin)) {
+            throw teqp::InvalidArgument("Temperature range is invalid");
+        }
+        const auto M = opt.degree;
+        std::vector<std::vector<Eigen::ArrayXd>> nodevals(3, std::vector<Eigen::ArrayXd>(opt.Nvir - 1, Eigen::ArrayXd(M + 1)));
+        Eigen::ArrayXd nextvals(M + 1);
+        for (auto k = 0; k <= M; ++k) {
+            auto [vals, Bnext] = sample(to_T(cos(EIGEN_PI*k/M)));
+            for (auto m = 0; m < 3; ++m) {
+                for (auto i = 0; i < opt.Nvir - 1; ++i) {
+                    nodevals[m][i][k] = vals[m][i];
+                }
+            }
+            nextvals[k] = Bnext;
+        }
+        coeffs.resize(3);
+        fit_error.resize(3);
+        for (auto m = 0; m < 3; ++m) {
+            for (auto i = 0; i < opt.Nvir - 1; ++i) {
+                coeffs[m].push_back(fit(nodevals[m][i]));
+            }
+            fit_error[m].resize(opt.Nvir - 1, 0.0);
+        }
+        coeffs_next = fit(nextvals);
+
+        // Check the expansions between the nodes
+        for (auto k = 0; k < M; ++k) {
+            double x = cos(EIGEN_PI*(k + 0.5)/M);
+            auto [vals, Bnext] = sample(to_T(x));
+            for (auto m = 0; m < 3; ++m) {
+                for (auto i = 0; i < opt.Nvir - 1; ++i) {
+                    fit_error[m][i] = std::max(fit_error[m][i], std::abs(vals[m][i] - clenshaw(coeffs[m][i], x)));
+                }
+            }
+        }
+    }
+
+    /// The virial coefficient \f$B_n\f$ from the expansions
+    double get_Bn(int n, double T) const {
+        if (n < 2 || n > opt.Nvir) {
+            throw teqp::InvalidArgument("n must be in [2, Nvir]");
+        }
+        return clenshaw(coeffs[0][n-2], to_x(T));
+    }
+
+    /// True if the series is used for this state point
+    bool in_range(double T, double rho) const {
+        return T >= Tmin && T <= Tmax && std::abs(rho*clenshaw(coeffs[0][0], to_x(T))) < opt.rhoB_tolerance;
+    }
+
+    /**
+     \brief The derivative \f$\Lambda^{\rm r}_{xy}\f$, from the virial series at low density and from the model otherwise
+     \param iT The number of derivatives with respect to \f$1/T\f$; the series supports up to 2
+     \param iD The number of derivatives with respect to \f$\rho\f$
+     \param T Temperature
+     \param rho Molar density
+     */
+    VirialFastPathResult get_Arxy(int iT, int iD, double T, double rho) const {
+        if (iT > 2 || !in_range(T, rho)) {
+            return { TDXDerivatives<Model, double, Eigen::ArrayXd>::get_Ar(iT, iD, model, T, rho, molefrac), 0.0, false };
+        }
+        const double x = to_x(T);
+        // The contribution of T^m d^mB/dT^m to the derivatives with respect to 1/T, see the Faa di Bruno formula for 1/T
+        auto temperature_part = [&](const auto& get) {
+            if (iT == 0) { return get(0); }
+            if (iT == 1) { return -get(1); }
+            return 2.0*get(1) + get(2);
+        };
+        double value = 0, error = 0, rhon = rho;
+        for (auto n = 2; n <= opt.Nvir; ++n) {
+            const double f = density_factor(n, iD)*rhon;
+            value += f*temperature_part([&](int m) { return clenshaw(coeffs[m][n-2], x); });
+            error += std::abs(f*temperature_part([&](int m) { return fit_error[m][n-2]; }));
+            rhon *= rho;
+        }
+        error += std::abs(density_factor(opt.Nvir + 1, iD)*rhon*clenshaw(coeffs_next, x));
+        return { value, error, true };
+    }
+};
+
+}
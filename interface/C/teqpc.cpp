@@ -6,9 +6,11 @@
 #include <unordered_map>
 #include <variant>
 #include <atomic>
+#include <mutex>
 
 #include "teqp/cpp/teqpcpp.hpp"
 #include "teqp/exceptions.hpp"
+#include "teqp/algorithms/cancellation.hpp"
 
 // Define empty macros so that no exporting happens
 #if defined(TEQPC_CATCH)
@@ -42,6 +44,10 @@ std::atomic<long long int> next_index{ 0 };
 
 std::unordered_map<unsigned long long int, std::shared_ptr<teqp::cppinterface::AbstractModel>> library;
 
+// The cancellation tokens are cancelled from other threads than the ones running the algorithms, so their map is guarded
+std::mutex tokens_mutex;
+std::unordered_map<long long int, teqp::CancellationToken> tokens;
+
 void exception_handler(int& errcode, char* message_buffer, const int buffer_length)
 {
     auto write_error = [&](const std::string& msg){
@@ -215,15 +221,146 @@ EXPORT_CODE int CONVENTION get_dmBnvirdTm(const long long int uuid, const int Nv
     return errcode;
 }
 
+EXPORT_CODE int CONVENTION build_cancellation_token(long long int* uuid, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        long long int uid = next_index++;
+        std::lock_guard<std::mutex> lock(tokens_mutex);
+        tokens.emplace(uid, CancellationToken());
+        *uuid = uid;
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+EXPORT_CODE int CONVENTION cancel_token(const long long int uuid, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        std::lock_guard<std::mutex> lock(tokens_mutex);
+        tokens.at(uuid).cancel();
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+EXPORT_CODE int CONVENTION free_cancellation_token(const long long int uuid, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        std::lock_guard<std::mutex> lock(tokens_mutex);
+        tokens.erase(uuid);
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+/**
+ Trace an isotherm of a binary mixture. The options are given as a JSON object whose keys are the names of the fields of TVLEOptions,
+ the token is not used if token_uuid is negative, and no deadline applies if timeout_s is not positive. The output is the JSON
+ document of the trace, with the data in the "data" field and the termination reason in the "meta" field
+ */
+EXPORT_CODE int CONVENTION trace_VLE_isotherm_binary(const long long int uuid, const double T, const double* rhovecL0, const double* rhovecV0, const int Ncomp, const char* options, const long long int token_uuid, const double timeout_s, char* output, int output_length, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        nlohmann::json jopt = (options != nullptr && std::string(options).size() > 0) ? nlohmann::json::parse(options) : nlohmann::json::object();
+        TVLEOptions opt;
+        opt.init_dt = jopt.value("init_dt", opt.init_dt);
+        opt.abs_err = jopt.value("abs_err", opt.abs_err);
+        opt.rel_err = jopt.value("rel_err", opt.rel_err);
+        opt.max_dt = jopt.value("max_dt", opt.max_dt);
+        opt.init_c = jopt.value("init_c", opt.init_c);
+        opt.p_termination = jopt.value("p_termination", opt.p_termination);
+        opt.crit_termination = jopt.value("crit_termination", opt.crit_termination);
+        opt.max_steps = jopt.value("max_steps", opt.max_steps);
+        opt.integration_order = jopt.value("integration_order", opt.integration_order);
+        opt.polish = jopt.value("polish", opt.polish);
+        opt.polish_reltol_rho = jopt.value("polish_reltol_rho", opt.polish_reltol_rho);
+        opt.calc_criticality = jopt.value("calc_criticality", opt.calc_criticality);
+        opt.verbosity = jopt.value("verbosity", opt.verbosity);
+        opt.polish_exception_on_fail = jopt.value("polish_exception_on_fail", opt.polish_exception_on_fail);
+        opt.terminate_unstable = jopt.value("terminate_unstable", opt.terminate_unstable);
+        opt.revision = 2;
+        if (token_uuid >= 0) {
+            std::lock_guard<std::mutex> lock(tokens_mutex);
+            opt.cancellation = tokens.at(token_uuid);
+        }
+        if (timeout_s > 0) {
+            opt.deadline = Deadline::in_seconds(timeout_s);
+        }
+        Eigen::Map<const Eigen::ArrayXd> rhovecL0_(rhovecL0, Ncomp), rhovecV0_(rhovecV0, Ncomp);
+        std::string out = library.at(uuid)->trace_VLE_isotherm_binary(T, rhovecL0_, rhovecV0_, opt).dump();
+        if (out.size() >= static_cast<std::size_t>(output_length)) {
+            throw teqpcException(40, "Output buffer of length " + std::to_string(output_length) + " is too short; " + std::to_string(out.size() + 1) + " are needed");
+        }
+        strcpy(output, out.c_str());
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
 #if defined(TEQPC_CATCH)
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/benchmark/catch_benchmark_all.hpp>
 
 #include "teqp/json_tools.hpp"
+#include "teqp/models/cubics/simple_cubics.hpp"
 
 const std::string FLUIDDATAPATH = "../teqp/fluiddata"; // normally defined in src/test/test_common.in
 
+TEST_CASE("Cancellation and timeout of the isotherm tracer of the C interface","[teqpc]") {
+    constexpr int errmsg_length = 3000;
+    char errmsg[errmsg_length] = "";
+    long long int uuid, token;
+    std::string j = R"({"kind": "PR", "model": {"Tcrit / K": [190.564, 154.581], "pcrit / Pa": [4599200, 5042800], "acentric": [0.011, 0.022]}})";
+    REQUIRE(build_model(j.c_str(), &uuid, errmsg, errmsg_length) == 0);
+    
+    // Start from the saturated pure first component
+    double T = 120;
+    std::valarray<double> Tc = {190.564}, pc = {4599200}, acentric = {0.011};
+    auto [rhoL, rhoV] = teqp::canonical_PR(Tc, pc, acentric).superanc_rhoLV(T);
+    std::vector<double> rhovecL0 = {rhoL, 0}, rhovecV0 = {rhoV, 0};
+    
+    const int output_length = 1000000;
+    std::string output(output_length, '\0');
+    auto trace = [&](const std::string& options, long long int token_uuid, double timeout_s){
+        int e = trace_VLE_isotherm_binary(uuid, T, &(rhovecL0[0]), &(rhovecV0[0]), 2, options.c_str(), token_uuid, timeout_s, &(output[0]), output_length, errmsg, errmsg_length);
+        CAPTURE(errmsg);
+        REQUIRE(e == 0);
+        return nlohmann::json::parse(output.c_str());
+    };
+    
+    // The flags that control the output and the stopping of the trace are parsed too; a complete trace is neither cancelled nor expired
+    auto full = trace(R"({"verbosity": 0, "polish_exception_on_fail": false, "terminate_unstable": true})", -1, -1);
+    CHECK(full["data"].size() > 5);
+    CHECK(full["meta"]["termination_reason"] != "cancelled");
+    CHECK(full["meta"]["termination_reason"] != "deadline_expired");
+    
+    REQUIRE(build_cancellation_token(&token, errmsg, errmsg_length) == 0);
+    REQUIRE(cancel_token(token, errmsg, errmsg_length) == 0);
+    auto cancelled = trace("", token, -1);
+    CHECK(cancelled["meta"]["termination_reason"] == "cancelled");
+    CHECK(cancelled["data"].size() == 0);
+    REQUIRE(free_cancellation_token(token, errmsg, errmsg_length) == 0);
+    // A freed token cannot be used any more
+    CHECK(trace_VLE_isotherm_binary(uuid, T, &(rhovecL0[0]), &(rhovecV0[0]), 2, "", token, -1, &(output[0]), output_length, errmsg, errmsg_length) != 0);
+    
+    auto expired = trace("", -1, 1e-12);
+    CHECK(expired["meta"]["termination_reason"] == "deadline_expired");
+    CHECK(expired["data"].size() == 0);
+    
+    // A buffer that is too small is an error
+    CHECK(trace_VLE_isotherm_binary(uuid, T, &(rhovecL0[0]), &(rhovecV0[0]), 2, "", -1, -1, &(output[0]), 10, errmsg, errmsg_length) != 0);
+    free_model(uuid, errmsg, errmsg_length);
+}
+
 TEST_CASE("Use of C interface","[teqpc]") {
 
     constexpr int errmsg_length = 3000;
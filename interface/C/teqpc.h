@@ -18,3 +18,11 @@ EXPORT_CODE int CONVENTION get_AtaudeltaXiXj(const long long int uuid, const dou
 EXPORT_CODE int CONVENTION get_AtaudeltaXiXjXk(const long long int uuid, const double tau, const int Ntau, const double delta, const int Ndelta, const double* molefrac, const int Ncomp, const int i, const int NXi, const int j, const int NXj, const int k, const int NXk, double *val, char* errmsg, int errmsg_length) ;
 
 EXPORT_CODE int CONVENTION get_dmBnvirdTm(const long long int uuid, const int Nvir, const int NT, const double T, const double* molefrac, const int Ncomp, double* val, char* errmsg, int errmsg_length) ;
+
+EXPORT_CODE int CONVENTION build_cancellation_token(long long int* uuid, char* errmsg, int errmsg_length);
+
+EXPORT_CODE int CONVENTION cancel_token(const long long int uuid, char* errmsg, int errmsg_length);
+
+EXPORT_CODE int CONVENTION free_cancellation_token(const long long int uuid, char* errmsg, int errmsg_length);
+
+EXPORT_CODE int CONVENTION trace_VLE_isotherm_binary(const long long int uuid, const double T, const double* rhovecL0, const double* rhovecV0, const int Ncomp, const char* options, const long long int token_uuid, const double timeout_s, char* output, int output_length, char* errmsg, int errmsg_length);
@@ -3,6 +3,7 @@
 #include "teqp/algorithms/VLE_pure.hpp"
 #include "teqp/algorithms/VLE.hpp"
 #include "teqp/algorithms/VLLE.hpp"
+#include "teqp/algorithms/density_roots.hpp"
 
 namespace teqp{
     namespace cppinterface{
@@ -11,7 +12,24 @@ namespace teqp{
             return -3.0*(this->get_Ar01(T, rho, molefracs) - this->get_Ar11(T, rho, molefracs) )/this->get_Ar20(T,rho,molefracs);
         };
 
+        EArrayd AbstractModel::polish_Arxy_batch(const int NT, const int ND, const REArrayd& T, const REArrayd& rho, const REMatrixd& molefracs, const REArrayd& screened, const Eigen::ArrayXi& indices) const {
+            if (screened.size() != T.size() || rho.size() != T.size() || molefracs.rows() != T.size()) {
+                throw teqp::InvalidArgument("T, rho, screened, and the rows of molefracs must all be the same length");
+            }
+            // Re-evaluate the selected points in double precision, the others keep their screened values
+            EArrayd o = screened;
+            for (auto k = 0; k < indices.size(); ++k) {
+                const auto i = indices[k];
+                if (i < 0 || i >= T.size()) {
+                    throw teqp::InvalidArgument("Index " + std::to_string(i) + " is out of range");
+                }
+                o[i] = get_Arxy(NT, ND, T[i], rho[i], molefracs.row(i).transpose());
+            }
+            return o;
+        }
+
         std::tuple<double, double> AbstractModel::solve_pure_critical(const double T, const double rho, const std::optional<nlohmann::json>& flags) const  {
+            TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
             return teqp::solve_pure_critical(*this, T, rho, flags.value_or(nlohmann::json{}));
         }
         std::tuple<EArrayd, EMatrixd> AbstractModel::get_pure_critical_conditions_Jacobian(const double T, const double rho, const std::optional<std::size_t>& alternative_pure_index, const std::optional<std::size_t>& alternative_length) const {
@@ -21,7 +39,17 @@ namespace teqp{
             return teqp::extrapolate_from_critical(*this, Tc, rhoc, Tnew, molefracs);
         }
 
+        DensityRootsResult AbstractModel::find_density_roots(const double T, const double p, const REArrayd& molefrac, const std::optional<DensityRootsOptions>& options) const {
+            TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
+            return teqp::find_density_roots(*this, T, p, molefrac, options);
+        }
+        std::vector<DensityRootsResult> AbstractModel::find_density_roots_batch(const REArrayd& T, const REArrayd& p, const REMatrixd& molefracs, const std::optional<DensityRootsOptions>& options) const {
+            TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
+            return teqp::find_density_roots_batch(*this, T, p, molefracs, options);
+        }
+
         EArray2 AbstractModel::pure_VLE_T(const double T, const double rhoL, const double rhoV, int maxiter, const std::optional<Eigen::ArrayXd>& molefracs) const {
+            TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
             return teqp::pure_VLE_T(*this, T, rhoL, rhoV, maxiter, molefracs);
         }
 
@@ -30,31 +58,53 @@ namespace teqp{
         }
     
         std::tuple<VLLE::VLLE_return_code,EArrayd,EArrayd,EArrayd> AbstractModel::mix_VLLE_T(const double T, const REArrayd& rhovecVinit, const REArrayd& rhovecL1init, const REArrayd& rhovecL2init, const double atol, const double reltol, const double axtol, const double relxtol, const int maxiter) const{
-            
+            TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
             return VLLE::mix_VLLE_T(*this, T, rhovecVinit, rhovecL1init, rhovecL2init, atol, reltol, axtol, relxtol, maxiter);
         }
+        std::tuple<VLLE::VLLE_return_code,EArrayd,EArrayd,EArrayd> AbstractModel::mix_VLLE_Tp(const double T, const double p, const REArrayd& rhovecVinit, const REArrayd& rhovecL1init, const REArrayd& rhovecL2init, const double atol, const double reltol, const double axtol, const double relxtol, const int maxiter) const{
+            TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
+            return VLLE::mix_VLLE_Tp(*this, T, p, rhovecVinit, rhovecL1init, rhovecL2init, atol, reltol, axtol, relxtol, maxiter);
+        }
 
         std::vector<nlohmann::json> AbstractModel::find_VLLE_T_binary(const std::vector<nlohmann::json>& traces, const std::optional<VLLE::VLLEFinderOptions> options) const{
+            TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
             return VLLE::find_VLLE_T_binary(*this, traces, options);
         }
         std::vector<nlohmann::json> AbstractModel::find_VLLE_p_binary(const std::vector<nlohmann::json>& traces, const std::optional<VLLE::VLLEFinderOptions> options) const{
+            TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
             return VLLE::find_VLLE_p_binary(*this, traces, options);
         }
     
         nlohmann::json AbstractModel::trace_VLLE_binary(const double T, const REArrayd& rhovecV, const REArrayd& rhovecL1, const REArrayd& rhovecL2, const std::optional<VLLE::VLLETracerOptions> options) const{
+            TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
             return VLLE::trace_VLLE_binary(*this, T, rhovecV, rhovecL1, rhovecL2, options);
         }
+        nlohmann::json AbstractModel::trace_VLLE(const double T, const REArrayd& rhovecV, const REArrayd& rhovecL1, const REArrayd& rhovecL2, const std::optional<VLLE::VLLETracerOptions> options) const{
+            TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
+            return VLLE::trace_VLLE(*this, T, rhovecV, rhovecL1, rhovecL2, options);
+        }
     
-    std::tuple<VLE_return_code,EArrayd,EArrayd> AbstractModel::mix_VLE_Tx(const double T, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const REArrayd& xspec, const double atol, const double reltol, const double axtol, const double relxtol, const int maxiter) const{
-        return teqp::mix_VLE_Tx(*this, T, rhovecL0, rhovecV0, xspec, atol, reltol, axtol, relxtol, maxiter);
+    std::tuple<VLE_return_code,EArrayd,EArrayd> AbstractModel::mix_VLE_Tx(const double T, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const REArrayd& xspec, const double atol, const double reltol, const double axtol, const double relxtol, const int maxiter, const std::optional<MixVLETxFlags>& flags) const{
+        TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
+        return teqp::mix_VLE_Tx(*this, T, rhovecL0, rhovecV0, xspec, atol, reltol, axtol, relxtol, maxiter, flags);
     
     }
     MixVLEReturn AbstractModel::mix_VLE_Tp(const double T, const double pgiven, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const std::optional<MixVLETpFlags> &flags) const{
+        TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
         return teqp::mix_VLE_Tp(*this, T, pgiven, rhovecL0, rhovecV0, flags);
     }
     std::tuple<VLE_return_code,double,EArrayd,EArrayd> AbstractModel::mixture_VLE_px(const double p_spec, const REArrayd& xmolar_spec, const double T0, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const std::optional<MixVLEpxFlags>& flags) const{
+        TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
         return teqp::mixture_VLE_px(*this, p_spec, xmolar_spec, T0, rhovecL0, rhovecV0, flags);
     }
+    BubbleDewBatchResult AbstractModel::bubble_dew_batch_p(const double p, const REMatrixd& compositions, const double T0, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const std::optional<BubbleDewOptions>& options) const{
+        TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
+        return teqp::bubble_dew_batch_p(*this, p, compositions, T0, rhovecL0, rhovecV0, options);
+    }
+    BubbleDewBatchResult AbstractModel::bubble_dew_batch_T(const double T, const REMatrixd& compositions, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const std::optional<BubbleDewOptions>& options) const{
+        TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
+        return teqp::bubble_dew_batch_T(*this, T, compositions, rhovecL0, rhovecV0, options);
+    }
     
     std::tuple<EArrayd, EArrayd> AbstractModel::get_drhovecdp_Tsat(const double T, const REArrayd& rhovecL, const REArrayd& rhovecV) const {
         return teqp::get_drhovecdp_Tsat(*this, T, rhovecL, rhovecV);
@@ -66,13 +116,16 @@ namespace teqp{
         return teqp::get_dpsat_dTsat_isopleth(*this, T, rhovecL, rhovecV);
     }
     nlohmann::json AbstractModel::trace_VLE_isotherm_binary(const double T0, const EArrayd& rhovecL0, const EArrayd& rhovecV0, const std::optional<TVLEOptions> &options) const{
+        TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
         return teqp::trace_VLE_isotherm_binary(*this, T0, rhovecL0, rhovecV0, options);
     }
     nlohmann::json AbstractModel::trace_VLE_isobar_binary(const double p, const double T0, const EArrayd& rhovecL0, const EArrayd& rhovecV0, const std::optional<PVLEOptions> &options) const{
+        TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
         return teqp::trace_VLE_isobar_binary(*this, p, T0, rhovecL0, rhovecV0, options);
     }
     
     nlohmann::json AbstractModel::trace_critical_arclength_binary(const double T0, const EArrayd& rhovec0, const std::optional<std::string>& filename, const std::optional<TCABOptions> &options) const {
+        TEQP_INSTRUMENT_SCOPE(m_stats, solver_call);
         using crit = teqp::CriticalTracing<decltype(*this), double, std::decay_t<decltype(rhovec0)>>;
         return crit::trace_critical_arclength_binary(*this, T0, rhovec0, filename , options);
     }
@@ -37,6 +37,7 @@ void add_multifluid(py::module& m){
         .def_readonly("T_r", &VLEAncillary::T_r)
         .def_readonly("Tmax", &VLEAncillary::Tmax)
         .def_readonly("Tmin", &VLEAncillary::Tmin)
+        .def_readonly("description", &VLEAncillary::description)
         ;
 
     // The collection of VLE ancillary curves
@@ -88,6 +89,13 @@ void add_multifluid_mutant(py::module& m) {
         auto mutant{build_multifluid_mutant(model, j)};
         return teqp::cppinterface::adapter::make_owned(mutant);
     });
+
+    // Wrap the function for generating a multifluid mutant with parameters that can be updated in place
+    m.def("_build_multifluid_parameter_mutant", [](const py::object& o, const nlohmann::json &j){
+        const MultiFluid& model = get_typed<MultiFluid>(o);
+        auto mutant{build_multifluid_parameter_mutant(model, j)};
+        return teqp::cppinterface::adapter::make_mutable_owned(mutant);
+    });
 }
 
 void add_multifluid_ecs_mutant(py::module& m) {
@@ -119,6 +127,19 @@ void attach_multifluid_methods(py::object&obj){
     setattr("get_BIP", MethodType(py::cpp_function([](py::object& o, const std::size_t& i, const std::size_t& j, const std::string& key){ return get_typed<TYPE>(o).get_BIP(i,j,key); }, "self"_a, "i"_a, "j"_a, "key"_a), obj));
 }
 template<typename TYPE>
+void attach_multifluid_parameter_mutant_methods(py::object&obj){
+    auto setattr = py::getattr(obj, "__setattr__");
+    auto MethodType = py::module_::import("types").attr("MethodType");
+    setattr("get_Tr", MethodType(py::cpp_function([](py::object& o, REArrayd& molefrac){ return get_typed<TYPE>(o).get_Tr(molefrac); }, "self"_a, "molefrac"_a.noconvert()), obj));
+    setattr("get_rhor", MethodType(py::cpp_function([](py::object& o, REArrayd& molefrac){ return get_typed<TYPE>(o).get_rhor(molefrac); }, "self"_a, "molefrac"_a.noconvert()), obj));
+    setattr("get_meta", MethodType(py::cpp_function([](py::object& o){ return get_typed<TYPE>(o).get_meta(); }), obj));
+    setattr("set_meta", MethodType(py::cpp_function([](py::object& o, const std::string& s){ return get_mutable_typed<TYPE>(o).set_meta(s); }, "self"_a, "s"_a), obj));
+    setattr("get_BIP", MethodType(py::cpp_function([](py::object& o, const std::size_t& i, const std::size_t& j, const std::string& key){ return get_typed<TYPE>(o).get_BIP(i,j,key); }, "self"_a, "i"_a, "j"_a, "key"_a), obj));
+    setattr("get_parameter_keys", MethodType(py::cpp_function([](py::object& o){ return get_typed<TYPE>(o).get_parameter_keys(); }), obj));
+    setattr("get_parameters", MethodType(py::cpp_function([](py::object& o){ return get_typed<TYPE>(o).get_parameters(); }), obj));
+    setattr("set_parameters", MethodType(py::cpp_function([](py::object& o, const std::vector<double>& p){ get_mutable_typed<TYPE>(o).set_parameters(p); }, "self"_a, "p"_a), obj));
+}
+template<typename TYPE>
 void attach_GERG_methods(py::object&obj){
     auto setattr = py::getattr(obj, "__setattr__");
     auto MethodType = py::module_::import("types").attr("MethodType");
@@ -140,6 +161,7 @@ const std::type_index AmmoniaWaterTillnerRoth_i{std::type_index(typeid(AmmoniaWa
 const std::type_index idealgas_i{std::type_index(typeid(idealgas_t))};
 const std::type_index multifluid_i{std::type_index(typeid(multifluid_t))};
 const std::type_index multifluidmutant_i{std::type_index(typeid(multifluidmutant_t))};
+const std::type_index multifluidparametermutant_i{std::type_index(typeid(multifluidparametermutant_t))};
 const std::type_index SW_EspindolaHeredia2009_i{std::type_index(typeid(SW_EspindolaHeredia2009_t))};
 const std::type_index EXP6_Kataoka1992_i{std::type_index(typeid(EXP6_Kataoka1992_t))};
 const std::type_index twocenterLJF_i{std::type_index(typeid(twocenterLJF_t))};
@@ -257,6 +279,7 @@ void attach_model_specific_methods(py::object& obj){
             std::complex<double> delta_(delta, h);
             return m.alphar_departure(tau, delta_, xNH3).imag()/h;
         }, "self"_a, "tau"_a, "delta"_a, "xNH3"_a), obj));
+        setattr("alphar_isotherm", MethodType(py::cpp_function([](py::object& o, const double T, const Eigen::ArrayXd& rhos, REArrayd& molefrac){ return get_typed<AmmoniaWaterTillnerRoth>(o).alphar_isotherm(T, rhos, molefrac); }, "self"_a, "T"_a, "rhos"_a, "molefrac"_a), obj));
     }
     else if (index == multifluid_i){
         attach_multifluid_methods<multifluid_t>(obj);
@@ -292,6 +315,9 @@ void attach_model_specific_methods(py::object& obj){
     else if (index == multifluidmutant_i){
         attach_multifluid_methods<multifluidmutant_t>(obj);
     }
+    else if (index == multifluidparametermutant_i){
+        attach_multifluid_parameter_mutant_methods<multifluidparametermutant_t>(obj);
+    }
     else if (index == SW_EspindolaHeredia2009_i){
         // Have to use a method because lambda is a reserved word in Python
         setattr("get_lambda", MethodType(py::cpp_function([](py::object& o){ return get_typed<SW_EspindolaHeredia2009_t>(o).get_lambda(); }, "self"_a), obj));
@@ -336,6 +362,31 @@ void attach_model_specific_methods(py::object& obj){
 /// Instantiate "instances" of models (really wrapped Python versions of the models), and then attach all derivative methods
 void init_teqp(py::module& m) {
     
+    // Cooperative cancellation and deadlines of the long-running algorithms
+    py::class_<CancellationToken>(m, "CancellationToken")
+        .def(py::init<>())
+        .def("cancel", &CancellationToken::cancel)
+        .def("is_cancelled", &CancellationToken::is_cancelled)
+    ;
+    py::class_<Deadline>(m, "Deadline")
+        .def_static("in_seconds", &Deadline::in_seconds, "seconds"_a)
+        .def("expired", &Deadline::expired)
+        .def("remaining_seconds", &Deadline::remaining_seconds)
+    ;
+    
+    // The sinks of the structured diagnostics of the tracers
+    py::class_<diagnostics::EventSink, std::shared_ptr<diagnostics::EventSink>>(m, "EventSink");
+    py::class_<diagnostics::RingBufferSink, diagnostics::EventSink, std::shared_ptr<diagnostics::RingBufferSink>>(m, "RingBufferSink")
+        .def(py::init<std::size_t>(), "capacity"_a = 1024)
+        .def("capacity", &diagnostics::RingBufferSink::capacity)
+        .def("dropped", &diagnostics::RingBufferSink::dropped)
+        .def("drain", [](diagnostics::RingBufferSink& sink){
+            auto j = nlohmann::json::array();
+            for (const auto& e : sink.drain()){ j.push_back(diagnostics::to_json(e)); }
+            return j;
+        })
+    ;
+    
     // The options class for critical tracer, not tied to a particular model
     py::class_<TCABOptions>(m, "TCABOptions")
         .def(py::init<>())
@@ -357,6 +408,10 @@ void init_teqp(py::module& m) {
         .def_readwrite("polish_reltol_T", &TCABOptions::polish_reltol_T)
         .def_readwrite("pure_endpoint_polish", &TCABOptions::pure_endpoint_polish)
         .def_readwrite("polish_exception_on_fail", &TCABOptions::polish_exception_on_fail)
+        .def_readwrite("sink", &TCABOptions::sink)
+        .def_readwrite("revision", &TCABOptions::revision)
+        .def_readwrite("cancellation", &TCABOptions::cancellation)
+        .def_readwrite("deadline", &TCABOptions::deadline)
     ;
     
     // The options class for isotherm tracer, not tied to a particular model
@@ -377,6 +432,10 @@ void init_teqp(py::module& m) {
         .def_readwrite("verbosity", &TVLEOptions::verbosity)
         .def_readwrite("calc_criticality", &TVLEOptions::calc_criticality)
         .def_readwrite("terminate_unstable", &TVLEOptions::terminate_unstable)
+        .def_readwrite("revision", &TVLEOptions::revision)
+        .def_readwrite("sink", &TVLEOptions::sink)
+        .def_readwrite("cancellation", &TVLEOptions::cancellation)
+        .def_readwrite("deadline", &TVLEOptions::deadline)
     ;
     
     // The options class for isobar tracer, not tied to a particular model
@@ -396,6 +455,26 @@ void init_teqp(py::module& m) {
         .def_readwrite("verbosity", &PVLEOptions::verbosity)
         .def_readwrite("calc_criticality", &PVLEOptions::calc_criticality)
         .def_readwrite("terminate_unstable", &PVLEOptions::terminate_unstable)
+        .def_readwrite("sink", &PVLEOptions::sink)
+        .def_readwrite("revision", &PVLEOptions::revision)
+        .def_readwrite("cancellation", &PVLEOptions::cancellation)
+        .def_readwrite("deadline", &PVLEOptions::deadline)
+    ;
+    
+    // All the isochoric derivatives of a phase from one evaluation
+    py::class_<IsochoricDerivativeBundle>(m, "IsochoricDerivativeBundle")
+        .def_readonly("T", &IsochoricDerivativeBundle::T)
+        .def_readonly("R", &IsochoricDerivativeBundle::R)
+        .def_readonly("rhovec", &IsochoricDerivativeBundle::rhovec)
+        .def_readonly("Psir", &IsochoricDerivativeBundle::Psir)
+        .def_readonly("gradient", &IsochoricDerivativeBundle::gradient)
+        .def_readonly("Hessian", &IsochoricDerivativeBundle::Hessian)
+        .def_readonly("dPsirdT", &IsochoricDerivativeBundle::dPsirdT)
+        .def_readonly("d2PsirdTdrhoi", &IsochoricDerivativeBundle::d2PsirdTdrhoi)
+        .def_readonly("d2PsirdT2", &IsochoricDerivativeBundle::d2PsirdT2)
+        .def("p", &IsochoricDerivativeBundle::p)
+        .def("dpdT", &IsochoricDerivativeBundle::dpdT)
+        .def("dpdrhovec", &IsochoricDerivativeBundle::dpdrhovec)
     ;
     
     // The options class for the finder of VLLE solutions from VLE tracing, not tied to a particular model
@@ -403,6 +482,10 @@ void init_teqp(py::module& m) {
         .def(py::init<>())
         .def_readwrite("max_steps", &VLLE::VLLEFinderOptions::max_steps)
         .def_readwrite("rho_trivial_threshold", &VLLE::VLLEFinderOptions::rho_trivial_threshold)
+        .def_readwrite("atol", &VLLE::VLLEFinderOptions::atol)
+        .def_readwrite("reltol", &VLLE::VLLEFinderOptions::reltol)
+        .def_readwrite("axtol", &VLLE::VLLEFinderOptions::axtol)
+        .def_readwrite("relxtol", &VLLE::VLLEFinderOptions::relxtol)
     ;
     
     // The options class for the finder of VLLE solutions from VLE tracing, not tied to a particular model
@@ -416,12 +499,22 @@ void init_teqp(py::module& m) {
         .def_readwrite("max_dT", &VLLE::VLLETracerOptions::max_dT)
         .def_readwrite("polish", &VLLE::VLLETracerOptions::polish)
         .def_readwrite("max_polish_steps", &VLLE::VLLETracerOptions::max_polish_steps)
+        .def_readwrite("polish_atol", &VLLE::VLLETracerOptions::polish_atol)
+        .def_readwrite("polish_reltol", &VLLE::VLLETracerOptions::polish_reltol)
+        .def_readwrite("polish_axtol", &VLLE::VLLETracerOptions::polish_axtol)
+        .def_readwrite("polish_relxtol", &VLLE::VLLETracerOptions::polish_relxtol)
         .def_readwrite("terminate_composition", &VLLE::VLLETracerOptions::terminate_composition)
         .def_readwrite("terminate_composition_tol", &VLLE::VLLETracerOptions::terminate_composition_tol)
         .def_readwrite("T_limit", &VLLE::VLLETracerOptions::T_limit)
         .def_readwrite("max_step_retries", &VLLE::VLLETracerOptions::max_step_retries)
     ;
     
+    py::class_<MixVLETxFlags>(m, "MixVLETxFlags")
+        .def(py::init<>())
+        .def_readwrite("cancellation", &MixVLETxFlags::cancellation)
+        .def_readwrite("deadline", &MixVLETxFlags::deadline)
+    ;
+    
     py::class_<MixVLETpFlags>(m, "MixVLETpFlags")
         .def(py::init<>())
         .def_readwrite("atol", &MixVLETpFlags::atol)
@@ -429,6 +522,8 @@ void init_teqp(py::module& m) {
         .def_readwrite("axtol", &MixVLETpFlags::axtol)
         .def_readwrite("relxtol", &MixVLETpFlags::relxtol)
         .def_readwrite("maxiter", &MixVLETpFlags::maxiter)
+        .def_readwrite("cancellation", &MixVLETpFlags::cancellation)
+        .def_readwrite("deadline", &MixVLETpFlags::deadline)
     ;
     
     py::class_<MixVLEpxFlags>(m, "MixVLEpxFlags")
@@ -438,6 +533,35 @@ void init_teqp(py::module& m) {
         .def_readwrite("axtol", &MixVLEpxFlags::axtol)
         .def_readwrite("relxtol", &MixVLEpxFlags::relxtol)
         .def_readwrite("maxiter", &MixVLEpxFlags::maxiter)
+        .def_readwrite("cancellation", &MixVLEpxFlags::cancellation)
+        .def_readwrite("deadline", &MixVLEpxFlags::deadline)
+    ;
+
+    py::class_<BubbleDewOptions>(m, "BubbleDewOptions")
+        .def(py::init<>())
+        .def_readwrite("dew", &BubbleDewOptions::dew)
+        .def_readwrite("reorder", &BubbleDewOptions::reorder)
+        .def_readwrite("predictor", &BubbleDewOptions::predictor)
+        .def_readwrite("trivial_tol", &BubbleDewOptions::trivial_tol)
+        .def_readwrite("flags", &BubbleDewOptions::flags)
+    ;
+
+    py::class_<BubbleDewPoint>(m, "BubbleDewPoint")
+        .def(py::init<>())
+        .def_readonly("success", &BubbleDewPoint::success)
+        .def_readonly("return_code", &BubbleDewPoint::return_code)
+        .def_readonly("message", &BubbleDewPoint::message)
+        .def_readonly("T", &BubbleDewPoint::T)
+        .def_readonly("p", &BubbleDewPoint::p)
+        .def_readonly("rhovecL", &BubbleDewPoint::rhovecL)
+        .def_readonly("rhovecV", &BubbleDewPoint::rhovecV)
+    ;
+
+    py::class_<BubbleDewBatchResult>(m, "BubbleDewBatchResult")
+        .def(py::init<>())
+        .def_readonly("points", &BubbleDewBatchResult::points)
+        .def_readonly("order", &BubbleDewBatchResult::order)
+        .def_readonly("num_failed", &BubbleDewBatchResult::num_failed)
     ;
     
     using namespace teqp::cppinterface;
@@ -456,6 +580,8 @@ void init_teqp(py::module& m) {
         .value("maxiter_met", VLE_return_code::maxiter_met)
         .value("maxfev_met", VLE_return_code::maxfev_met)
         .value("notfinite_step", VLE_return_code::notfinite_step)
+        .value("cancelled", VLE_return_code::cancelled)
+        .value("deadline_expired", VLE_return_code::deadline_expired)
     ;
     
     py::class_<MixVLEReturn>(m, "MixVLEReturn")
@@ -472,6 +598,55 @@ void init_teqp(py::module& m) {
         .def_readonly("initial_r", &MixVLEReturn::initial_r)
     ;
     
+    py::enum_<DensityRootStability>(m, "DensityRootStability")
+        .value("stable", DensityRootStability::stable)
+        .value("metastable", DensityRootStability::metastable)
+        .value("unstable", DensityRootStability::unstable)
+    ;
+    
+    py::class_<VirialFastPathOptions>(m, "VirialFastPathOptions")
+        .def(py::init<>())
+        .def_readwrite("Nvir", &VirialFastPathOptions::Nvir)
+        .def_readwrite("degree", &VirialFastPathOptions::degree)
+        .def_readwrite("rhoB_tolerance", &VirialFastPathOptions::rhoB_tolerance)
+    ;
+    
+    py::class_<DensityRootsOptions>(m, "DensityRootsOptions")
+        .def(py::init<>())
+        .def_readwrite("rho_max", &DensityRootsOptions::rho_max)
+        .def_readwrite("degree", &DensityRootsOptions::degree)
+        .def_readwrite("initial_intervals", &DensityRootsOptions::initial_intervals)
+        .def_readwrite("max_depth", &DensityRootsOptions::max_depth)
+        .def_readwrite("coeff_tol", &DensityRootsOptions::coeff_tol)
+        .def_readwrite("max_newton", &DensityRootsOptions::max_newton)
+    ;
+    
+    py::class_<DensityRoot>(m, "DensityRoot")
+        .def(py::init<>())
+        .def_readonly("rho", &DensityRoot::rho)
+        .def_readonly("dpdrho", &DensityRoot::dpdrho)
+        .def_readonly("g_RT", &DensityRoot::g_RT)
+        .def_readonly("stability", &DensityRoot::stability)
+    ;
+    
+    py::class_<DensitySpinodal>(m, "DensitySpinodal")
+        .def(py::init<>())
+        .def_readonly("rho", &DensitySpinodal::rho)
+        .def_readonly("p", &DensitySpinodal::p)
+        .def_readonly("d2pdrho2", &DensitySpinodal::d2pdrho2)
+    ;
+    
+    py::class_<DensityRootsResult>(m, "DensityRootsResult")
+        .def(py::init<>())
+        .def_readonly("roots", &DensityRootsResult::roots)
+        .def_readonly("spinodals", &DensityRootsResult::spinodals)
+        .def_readonly("num_intervals", &DensityRootsResult::num_intervals)
+        .def_readonly("num_evaluations", &DensityRootsResult::num_evaluations)
+        .def("stable_root", &DensityRootsResult::stable_root)
+        .def("vapor_root", &DensityRootsResult::vapor_root)
+        .def("liquid_root", &DensityRootsResult::liquid_root)
+    ;
+    
     using namespace teqp::PCSAFT;
     py::class_<SAFTCoeffs>(m, "SAFTCoeffs")
         .def(py::init<>())
@@ -527,6 +702,22 @@ void init_teqp(py::module& m) {
 #undef X
         .def("get_neff", &am::get_neff, "T"_a, "rho"_a, "molefrac"_a.noconvert())
     
+    // Low-density fast path of get_Arxy from the virial series
+        .def("enable_virial_fastpath", &am::enable_virial_fastpath, "Tmin"_a, "Tmax"_a, "molefrac"_a, py::arg_v("options", std::nullopt, "None"))
+        .def("disable_virial_fastpath", &am::disable_virial_fastpath)
+    
+    // Ensemble evaluations over many sets of parameters
+        .def("get_ensemble_parameters", &am::get_ensemble_parameters)
+        .def("get_Arxy_ensemble", &am::get_Arxy_ensemble, "NT"_a, "ND"_a, "T"_a, "rho"_a, "molefrac"_a.noconvert(), "parameters"_a)
+    
+    // Batched evaluations over many state points, optionally screened in single precision
+        .def("get_Arxy_batch", &am::get_Arxy_batch, "NT"_a, "ND"_a, "T"_a, "rho"_a, "molefracs"_a, "screening"_a = false)
+        .def("polish_Arxy_batch", &am::polish_Arxy_batch, "NT"_a, "ND"_a, "T"_a, "rho"_a, "molefracs"_a, "screened"_a, "indices"_a)
+    
+    // Evaluation counters and timing histograms (populated if built with TEQP_INSTRUMENTATION)
+        .def("get_stats", &am::get_stats)
+        .def("reset_stats", &am::reset_stats)
+    
     // Methods that come from the isochoric derivatives formalism
         .def("get_pr", &am::get_pr, "T"_a, "rhovec"_a.noconvert())
         .def("get_splus", &am::get_splus, "T"_a, "rhovec"_a.noconvert())
@@ -534,6 +725,9 @@ void init_teqp(py::module& m) {
         .def("build_Psi_Hessian_autodiff", &am::build_Psi_Hessian_autodiff, "T"_a, "rhovec"_a.noconvert())
         .def("build_Psir_gradient_autodiff", &am::build_Psir_gradient_autodiff, "T"_a, "rhovec"_a.noconvert())
         .def("build_d2PsirdTdrhoi_autodiff", &am::build_d2PsirdTdrhoi_autodiff, "T"_a, "rhovec"_a.noconvert())
+        .def("build_Psir_derivative_bundle_autodiff", &am::build_Psir_derivative_bundle_autodiff, "T"_a, "rhovec"_a.noconvert())
+        .def("build_Psir_Hessian_vector_product_autodiff", &am::build_Psir_Hessian_vector_product_autodiff, "T"_a, "rhovec"_a.noconvert(), "v"_a.noconvert())
+        .def("get_Psir_vector_Hessian_vector_product_autodiff", &am::get_Psir_vector_Hessian_vector_product_autodiff, "T"_a, "rhovec"_a.noconvert(), "u"_a.noconvert(), "v"_a.noconvert())
         .def("get_chempotVLE_autodiff", &am::get_chempotVLE_autodiff, "T"_a, "rhovec"_a.noconvert())
         .def("get_dchempotdT_autodiff", &am::get_dchempotdT_autodiff, "T"_a, "rhovec"_a.noconvert())
         .def("get_fugacity_coefficients", &am::get_fugacity_coefficients, "T"_a, "rhovec"_a.noconvert())
@@ -556,6 +750,8 @@ void init_teqp(py::module& m) {
     
         .def("pure_VLE_T", &am::pure_VLE_T, "T"_a, "rhoL"_a, "rhoV"_a, "max_iter"_a, py::arg_v("molefrac", std::nullopt, "None"))
         .def("dpsatdT_pure", &am::dpsatdT_pure, "T"_a, "rhoL"_a, "rhoV"_a)
+        .def("find_density_roots", &am::find_density_roots, "T"_a, "p"_a, "molefrac"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
+        .def("find_density_roots_batch", &am::find_density_roots_batch, "T"_a, "p"_a, "molefracs"_a, py::arg_v("options", std::nullopt, "None"))
     
         .def("get_drhovecdp_Tsat", &am::get_drhovecdp_Tsat, "T"_a, "rhovecL"_a.noconvert(), "rhovecV"_a.noconvert())
         .def("get_drhovecdT_psat", &am::get_drhovecdT_psat, "T"_a, "rhovecL"_a.noconvert(), "rhovecV"_a.noconvert())
@@ -563,19 +759,23 @@ void init_teqp(py::module& m) {
     
         .def("trace_VLE_isotherm_binary", &am::trace_VLE_isotherm_binary, "T"_a, "rhovecL0"_a.noconvert(), "rhovecV0"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
         .def("trace_VLE_isobar_binary", &am::trace_VLE_isobar_binary, "p"_a, "T0"_a, "rhovecL0"_a.noconvert(), "rhovecV0"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
-        .def("mix_VLE_Tx", &am::mix_VLE_Tx, "T"_a, "rhovecL0"_a.noconvert(), "rhovecV0"_a.noconvert(), "xspec"_a.noconvert(), "atol"_a, "reltol"_a, "axtol"_a, "relxtol"_a, "maxiter"_a)
+        .def("mix_VLE_Tx", &am::mix_VLE_Tx, "T"_a, "rhovecL0"_a.noconvert(), "rhovecV0"_a.noconvert(), "xspec"_a.noconvert(), "atol"_a, "reltol"_a, "axtol"_a, "relxtol"_a, "maxiter"_a, py::arg_v("flags", std::nullopt, "None"))
         .def("mix_VLE_Tp", &am::mix_VLE_Tp, "T"_a, "p_given"_a, "rhovecL0"_a.noconvert(), "rhovecV0"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
         .def("mixture_VLE_px", &am::mixture_VLE_px, "p_spec"_a, "xmolar_spec"_a.noconvert(), "T0"_a, "rhovecL0"_a.noconvert(), "rhovecV0"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
+        .def("bubble_dew_batch_p", &am::bubble_dew_batch_p, "p"_a, "compositions"_a, "T0"_a, "rhovecL0"_a.noconvert(), "rhovecV0"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
+        .def("bubble_dew_batch_T", &am::bubble_dew_batch_T, "T"_a, "compositions"_a, "rhovecL0"_a.noconvert(), "rhovecV0"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
     
         .def("mix_VLLE_T", &am::mix_VLLE_T, "T"_a, "rhovecVinit"_a.noconvert(), "rhovecL1init"_a.noconvert(), "rhovecL2init"_a.noconvert(), "atol"_a, "reltol"_a, "axtol"_a, "relxtol"_a, "maxiter"_a)
+        .def("mix_VLLE_Tp", &am::mix_VLLE_Tp, "T"_a, "p"_a, "rhovecVinit"_a.noconvert(), "rhovecL1init"_a.noconvert(), "rhovecL2init"_a.noconvert(), "atol"_a, "reltol"_a, "axtol"_a, "relxtol"_a, "maxiter"_a)
         .def("find_VLLE_T_binary", &am::find_VLLE_T_binary, "traces"_a, py::arg_v("options", std::nullopt, "None"))
         .def("find_VLLE_p_binary", &am::find_VLLE_p_binary, "traces"_a, py::arg_v("options", std::nullopt, "None"))
         .def("trace_VLLE_binary", &am::trace_VLLE_binary, "T"_a, "rhovecV"_a.noconvert(), "rhovecL1"_a.noconvert(), "rhovecL2"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
+        .def("trace_VLLE", &am::trace_VLLE, "T"_a, "rhovecV"_a.noconvert(), "rhovecL1"_a.noconvert(), "rhovecL2"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
     ;
     
     m.def("_make_model", &teqp::cppinterface::make_model, "json_data"_a, py::arg_v("validate", true));
     m.def("attach_model_specific_methods", &attach_model_specific_methods);
-    m.def("build_ancillaries", &teqp::ancillaries::build_ancillaries, "model"_a, "Tc"_a, "rhoc"_a, "Tmin"_a, py::arg_v("flags", std::nullopt, "None"));
+    m.def("build_ancillaries", &teqp::ancillaries::build_ancillaries, "model"_a, "Tc"_a, "rhoc"_a, "Tmin"_a, py::arg_v("flags", std::nullopt, "None"), py::arg_v("cancellation", std::nullopt, "None"), py::arg_v("deadline", std::nullopt, "None"));
     m.def("convert_FLD", [](const std::string& component, const std::string& name){ return RPinterop::FLDfile(component).make_json(name); },
           "component"_a, "name"_a);
     m.def("convert_HMXBNC", [](const std::string& path){ return RPinterop::HMXBNCfile(path).make_jsons(); }, "path"_a);
@@ -615,6 +815,42 @@ void init_teqp(py::module& m) {
             .def("num_Jacobian", &GeneralizedPhaseEquilibrium::num_Jacobian, "A testing function to build the Jacobian with centered differences")
             .def_readonly("res", &GeneralizedPhaseEquilibrium::res, "The data structure containing r and J")
         ;
+        
+        py::class_<FlashOptions>(m_phaseequil, "FlashOptions")
+            .def(py::init<>())
+            .def_readwrite("T_guess", &FlashOptions::T_guess)
+            .def_readwrite("rho_liquid_guess", &FlashOptions::rho_liquid_guess)
+            .def_readwrite("max_phases", &FlashOptions::max_phases)
+            .def_readwrite("max_iter", &FlashOptions::max_iter)
+            .def_readwrite("xtol", &FlashOptions::xtol)
+            .def_readwrite("max_phase_changes", &FlashOptions::max_phase_changes)
+            .def_readwrite("max_SS_iter", &FlashOptions::max_SS_iter)
+            .def_readwrite("stability_tol", &FlashOptions::stability_tol)
+        ;
+        py::class_<FlashAttempt>(m_phaseequil, "FlashAttempt")
+            .def_readonly("Nphases", &FlashAttempt::Nphases)
+            .def_readonly("num_iter", &FlashAttempt::num_iter)
+            .def_readonly("converged", &FlashAttempt::converged)
+            .def_readonly("max_abs_r", &FlashAttempt::max_abs_r)
+        ;
+        py::class_<FlashResult>(m_phaseequil, "FlashResult")
+            .def_readonly("success", &FlashResult::success)
+            .def_readonly("message", &FlashResult::message)
+            .def_readonly("Nphases", &FlashResult::Nphases)
+            .def_readonly("T", &FlashResult::T)
+            .def_readonly("p", &FlashResult::p)
+            .def_readonly("rhovecs", &FlashResult::rhovecs)
+            .def_readonly("betas", &FlashResult::betas)
+            .def_readonly("num_iter", &FlashResult::num_iter)
+            .def_readonly("num_stability_tests", &FlashResult::num_stability_tests)
+            .def_readonly("num_phase_changes", &FlashResult::num_phase_changes)
+            .def_readonly("attempts", &FlashResult::attempts)
+        ;
+        // The models are owned by Python, so the ideal-gas model is not owned by the pointer handed to the flash
+        auto borrow = [](const AbstractModel& model){ return std::shared_ptr<const AbstractModel>(&model, [](const AbstractModel*){}); };
+        m_phaseequil.def("flash_PH", [borrow](const AbstractModel& model, const AbstractModel& idealgas, const Eigen::ArrayXd& z, double p, double h, const std::optional<FlashOptions>& options){ return flash_PH(model, borrow(idealgas), z, p, h, options); }, "model"_a, "idealgas"_a, "z"_a, "p"_a, "h"_a, "options"_a = py::none());
+        m_phaseequil.def("flash_PS", [borrow](const AbstractModel& model, const AbstractModel& idealgas, const Eigen::ArrayXd& z, double p, double s, const std::optional<FlashOptions>& options){ return flash_PS(model, borrow(idealgas), z, p, s, options); }, "model"_a, "idealgas"_a, "z"_a, "p"_a, "s"_a, "options"_a = py::none());
+        m_phaseequil.def("flash_UV", [borrow](const AbstractModel& model, const AbstractModel& idealgas, const Eigen::ArrayXd& z, double u, double v, const std::optional<FlashOptions>& options){ return flash_UV(model, borrow(idealgas), z, u, v, options); }, "model"_a, "idealgas"_a, "z"_a, "u"_a, "v"_a, "options"_a = py::none());
     }
     
     using namespace teqp::iteration;
@@ -691,6 +927,8 @@ void init_teqp(py::module& m) {
             .def("cost_function_threaded", &PureParameterOptimizer::cost_function_threaded<Eigen::ArrayXd>)
             .def("build_JSON", &PureParameterOptimizer::build_JSON<Eigen::ArrayXd>)
             .def("add_one_contribution", &PureParameterOptimizer::add_one_contribution)
+            .def_readwrite("cancellation", &PureParameterOptimizer::cancellation)
+            .def_readwrite("deadline", &PureParameterOptimizer::deadline)
         ;
     };
     auto m_paramopt = m.def_submodule("paramopt", "Tools for doing parameter optimization");
@@ -0,0 +1,38 @@
+#include <fstream>
+#include <iostream>
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/json_tools.hpp"
+#include "teqp/algorithms/binary_classification.hpp"
+
+using namespace teqp::algorithms::binary_classification;
+
+/// Classify all the pairs of the binary interaction parameters of the multifluid models and write the columns as JSON
+int main(int argc, char* argv[]){
+    if (argc < 2){
+        std::cout << "Usage: classify_binary_pairs FLUIDDATAPATH [output.json] [Nthreads]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string root = argv[1];
+    std::string outpath = (argc > 2) ? argv[2] : "binary_pairs_classification.json";
+
+    BinaryClassificationOptions opt;
+    if (argc > 3){
+        opt.Nthreads = std::stoi(argv[3]);
+    }
+
+    auto pairs = get_binary_pairs(teqp::load_a_JSON_file(root + "/dev/mixtures/mixture_binary_pairs.json"));
+    BinaryModelFactory factory = [&root](const std::vector<std::string>& names){
+        return teqp::cppinterface::make_multifluid_model(names, root);
+    };
+
+    auto tic = std::chrono::steady_clock::now();
+    auto columns = classify_binary_pairs(pairs, factory, opt);
+    auto toc = std::chrono::steady_clock::now();
+
+    std::size_t Nfailed = std::count_if(columns.error.begin(), columns.error.end(), [](const auto& e){ return !e.empty(); });
+    std::size_t Nunclassified = std::count_if(columns.unclassified.begin(), columns.unclassified.end(), [](const auto& e){ return !e.empty(); });
+    std::cout << columns.size() << " pairs classified in " << std::chrono::duration<double>(toc - tic).count() << " s on " << opt.Nthreads << " threads; " << Nfailed << " failed, " << Nunclassified << " unclassified" << std::endl;
+    std::ofstream(outpath) << columns.to_json().dump();
+    return EXIT_SUCCESS;
+}
@@ -219,6 +219,17 @@ TEST_CASE("VLE pure tracing", "[SAFTVRMieVLE]"){
     };
     auto o = pure_trace_VLE(model, 300, spec);
     CHECK(o[0] == Approx(o1[0]));
+    
+    SECTION("adaptive and fixed integration agree"){
+        auto specfixed = spec1; specfixed["integration"] = "fixed";
+        auto ofixed = pure_trace_VLE(pure, 250, specfixed);
+        auto specadaptive = spec1; specadaptive["rtol"] = 1e-3;
+        auto oadaptive = pure_trace_VLE(pure, 250, specadaptive);
+        CHECK(oadaptive[0] == Approx(ofixed[0]));
+        CHECK(oadaptive[1] == Approx(ofixed[1]));
+        auto specbad = spec1; specbad["integration"] = "RK45";
+        CHECK_THROWS(pure_trace_VLE(pure, 250, specbad));
+    }
 }
 
 TEST_CASE("VLE isotherm tracing", "[SAFTVRMieVLE]"){
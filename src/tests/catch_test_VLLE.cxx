@@ -4,6 +4,7 @@
 using Catch::Approx;
 
 #include "teqp/algorithms/VLLE.hpp"
+#include "teqp/algorithms/binary_classification.hpp"
 #include "teqp/cpp/teqpcpp.hpp"
 #include "teqp/models/multifluid.hpp"
 #include "teqp/models/multifluid_ancillaries.hpp"
@@ -204,4 +205,149 @@ TEST_CASE("Test VLLE tracing", "[VLLE]")
          rhovecL2 = get_array(VLLEsoln[0].at("polished")[2]);
     auto trace = trace_VLLE_binary(*model, 118.0, rhovecV, rhovecL1, rhovecL2, flags);
 //    std::cout << trace.dump(1) << std::endl;
+    
+    {
+        // The derivatives along the curve from the per-phase derivatives agree with finite differences of polished solutions
+        double dT = 1e-3;
+        auto polish = [&](double T_){
+            auto [code, rhovecVnew, rhovecL1new, rhovecL2new] = VLLE::mix_VLLE_T(*model, T_, rhovecV, rhovecL1, rhovecL2, 1e-10, 1e-10, 1e-10, 1e-10, 20);
+            return (Eigen::ArrayXd(6) << rhovecVnew, rhovecL1new, rhovecL2new).finished();
+        };
+        auto [drhovecV, drhovecL1, drhovecL2] = VLLE::get_drhovecdT_VLLE_binary(*model, 118.0, rhovecV, rhovecL1, rhovecL2);
+        Eigen::ArrayXd fd = (polish(118.0 + dT) - polish(118.0 - dT))/(2*dT);
+        CHECK(drhovecV[0] == Approx(fd[0]).epsilon(1e-4));
+        CHECK(drhovecL1[0] == Approx(fd[2]).epsilon(1e-4));
+        CHECK(drhovecL2[0] == Approx(fd[4]).epsilon(1e-4));
+        
+        // More components than can be traced in temperature alone
+        Eigen::ArrayXd four = Eigen::ArrayXd::Ones(4);
+        CHECK_THROWS(VLLE::trace_VLLE(*model, 118.0, four, four, four, flags));
+        // A binary mixture at given temperature and pressure is over-specified
+        CHECK_THROWS(VLLE::mix_VLLE_Tp(*model, 118.0, 1e5, rhovecV, rhovecL1, rhovecL2, 1e-10, 1e-10, 1e-10, 1e-10, 20));
+    }
+}
+
+TEST_CASE("Test VLLE tracing of a ternary mixture at constant pressure", "[VLLE]")
+{
+    // The nitrogen + ethane three-phase state, with some methane added
+    std::vector<std::string> names = {"Nitrogen", "Ethane"};
+    using namespace teqp::cppinterface;
+    auto model = make_multifluid_model(names, FLUIDDATAPATH);
+    auto ternary = make_multifluid_model({"Nitrogen", "Ethane", "Methane"}, FLUIDDATAPATH);
+
+    double T = 118.0;
+    std::vector<nlohmann::json> traces;
+    for (int ipure : {0, 1}){
+        auto pure = make_multifluid_model({names[ipure]}, FLUIDDATAPATH);
+        auto m0 = build_multifluid_model({names[ipure]}, FLUIDDATAPATH);
+        auto anc = teqp::MultiFluidVLEAncillaries(nlohmann::json::parse(m0.get_meta()).at("pures")[0].at("ANCILLARIES"));
+        auto rhoLpurerhoVpure = pure->pure_VLE_T(T, anc.rhoL(T), anc.rhoV(T), 10);
+        auto rhovecL = (Eigen::ArrayXd(2) << 0.0, 0.0).finished();
+        auto rhovecV = (Eigen::ArrayXd(2) << 0.0, 0.0).finished();
+        rhovecL[ipure] = rhoLpurerhoVpure[0];
+        rhovecV[ipure] = rhoLpurerhoVpure[1];
+        TVLEOptions opt; opt.p_termination = 1e8; opt.crit_termination=1e-4; opt.calc_criticality=true;
+        traces.push_back(model->trace_VLE_isotherm_binary(T, rhovecL, rhovecV, opt));
+    }
+    auto VLLEsoln = VLLE::find_VLLE_T_binary(*model, traces);
+    REQUIRE(VLLEsoln.size() == 1);
+    
+    auto get_array = [](const nlohmann::json& j){ Eigen::ArrayXd o(j.size()); for (auto i = 0; i < o.size(); ++i){ o[i] = j[i]; } return o; };
+    auto with_methane = [](const nlohmann::json& j){
+        Eigen::ArrayXd o(3);
+        o[0] = j[0]; o[1] = j[1]; o[2] = 0.02*(o[0] + o[1]);
+        return o;
+    };
+    Eigen::ArrayXd rhovecV = with_methane(VLLEsoln[0].at("polished")[0]),
+                   rhovecL1 = with_methane(VLLEsoln[0].at("polished")[1]),
+                   rhovecL2 = with_methane(VLLEsoln[0].at("polished")[2]);
+    
+    // Methane raises the three-phase pressure of the binary
+    double p = 1.02*VLLE::get_VLLE_phase_derivatives(*model, T, get_array(VLLEsoln[0].at("polished")[0]), false).p;
+    auto [code, rhovecVnew, rhovecL1new, rhovecL2new] = VLLE::mix_VLLE_Tp(*ternary, T, p, rhovecV, rhovecL1, rhovecL2, 1e-10, 1e-10, 1e-10, 1e-10, 50);
+    REQUIRE((code == VLLE::VLLE_return_code::xtol_satisfied || code == VLLE::VLLE_return_code::functol_satisfied));
+    
+    auto check_equilibrium = [&](double T_, const Eigen::ArrayXd& rV, const Eigen::ArrayXd& rL1, const Eigen::ArrayXd& rL2){
+        auto V = VLLE::get_VLLE_phase_derivatives(*ternary, T_, rV, false),
+             L1 = VLLE::get_VLLE_phase_derivatives(*ternary, T_, rL1, false),
+             L2 = VLLE::get_VLLE_phase_derivatives(*ternary, T_, rL2, false);
+        double RT = V.R*T_;
+        CHECK((V.mu - L1.mu).cwiseAbs().maxCoeff() < 1e-8*RT);
+        CHECK((L1.mu - L2.mu).cwiseAbs().maxCoeff() < 1e-8*RT);
+        CHECK(V.p == Approx(p).epsilon(1e-8));
+        CHECK(L1.p == Approx(p).epsilon(1e-8));
+        CHECK(L2.p == Approx(p).epsilon(1e-8));
+        // And the phases are distinct
+        CHECK((rL1 - rL2).cwiseAbs().maxCoeff() > 100);
+    };
+    check_equilibrium(T, rhovecVnew, rhovecL1new, rhovecL2new);
+    
+    teqp::VLLE::VLLETracerOptions flags; flags.init_dT = 0.01; flags.max_dT = 0.5; flags.T_limit = T + 5;
+    auto trace = VLLE::trace_VLLE(*ternary, T, rhovecVnew, rhovecL1new, rhovecL2new, flags);
+    REQUIRE(trace.size() > 5);
+    CHECK(trace.back().at("T / K").get<double>() > T + 0.5);
+    for (const auto& pt : trace){
+        CHECK(pt.at("pV / Pa").get<double>() == Approx(p).epsilon(1e-8));
+        check_equilibrium(pt.at("T / K"), get_array(pt.at("rhoV / mol/m^3")), get_array(pt.at("rhoL1 / mol/m^3")), get_array(pt.at("rhoL2 / mol/m^3")));
+    }
+}
+
+TEST_CASE("Classify binary pairs in parallel", "[VLLE][classification]")
+{
+    using namespace teqp::algorithms::binary_classification;
+    std::vector<std::vector<std::string>> pairs = {{"Methane", "Ethane"}, {"Nitrogen", "Ethane"}, {"BADFLUID", "Ethane"}};
+    BinaryModelFactory factory = [](const std::vector<std::string>& names){
+        return teqp::cppinterface::make_multifluid_model(names, FLUIDDATAPATH);
+    };
+    BinaryClassificationOptions opt;
+    opt.Nthreads = 2;
+    auto columns = classify_binary_pairs(pairs, factory, opt);
+    REQUIRE(columns.size() == 3);
+    // The order of the pairs is retained
+    CHECK(columns.name0[1] == "Nitrogen");
+    
+    CHECK(columns.error[0].empty());
+    CHECK(columns.unclassified[0].empty());
+    CHECK(columns.continuous_critical_locus[0]);
+    CHECK(columns.type[0] == "I");
+    
+    // The critical locus from nitrogen ends at the upper critical endpoint, the one from ethane goes to high pressure
+    CHECK(columns.error[1].empty());
+    CHECK(columns.unclassified[1].empty());
+    CHECK(!columns.continuous_critical_locus[1]);
+    CHECK(columns.liquid_immiscibility[1]);
+    CHECK(columns.type[1] == "III");
+    
+    // A pair whose model cannot be built does not prevent the others from being classified
+    CHECK(!columns.error[2].empty());
+    CHECK(columns.type[2] == "unknown");
+    CHECK(columns.to_json().at("type").size() == 3);
+}
+
+TEST_CASE("Classification of a binary pair whose tracing is interrupted", "[VLLE][classification]")
+{
+    using namespace teqp::algorithms::binary_classification;
+    auto model = teqp::cppinterface::make_multifluid_model({"Methane", "Ethane"}, FLUIDDATAPATH);
+    BinaryClassificationOptions opt;
+    SECTION("cancelled"){
+        CancellationToken token; token.cancel();
+        opt.cancellation = token;
+        auto r = classify_binary_pair(*model, opt);
+        CHECK(r.type == VKSType::unknown);
+        CHECK(r.unclassified == "cancelled");
+        CHECK(r.error.empty());
+    }
+    SECTION("deadline expired"){
+        opt.deadline = Deadline::in_seconds(0);
+        auto r = classify_binary_pair(*model, opt);
+        CHECK(r.type == VKSType::unknown);
+        CHECK(r.unclassified == "deadline_expired");
+    }
+    SECTION("empty critical branch"){
+        opt.critical_options.max_step_count = 0;
+        opt.critical_options.pure_endpoint_polish = false;
+        auto r = classify_binary_pair(*model, opt);
+        CHECK(r.type == VKSType::unknown);
+        CHECK(!r.unclassified.empty());
+    }
 }
@@ -118,4 +118,22 @@ TEST_CASE("pure water derivatives ", "[NH3H2O]") {
     auto dersdu = derivatives(f, wrt(x__,x__,x__,x__), at(x__));
     //CHECK(dersdu[0] = 0); // Bug in autodiff
     //CHECK(dersdu[1] = 1);
-}
\ No newline at end of file
+}
+TEST_CASE("Batched isotherm evaluation w/ Tillner-Roth", "[NH3H2O]") {
+    auto model = AmmoniaWaterTillnerRoth();
+    auto z = (Eigen::ArrayXd(2) <<  0.3, 0.7).finished();
+    double T = 350;
+    Eigen::ArrayXd rhos = Eigen::ArrayXd::LinSpaced(10, 1.0, 40000.0);
+    auto alphars = model.alphar_isotherm(T, rhos, z);
+    
+    // Density derivatives come along for free with autodiff types in the densities
+    Eigen::ArrayX<autodiff::Real<1, double>> rhosad(rhos.size());
+    for (auto k = 0; k < rhosad.size(); ++k){ rhosad[k] = rhos[k]; rhosad[k][1] = 1.0; }
+    auto alpharsad = model.alphar_isotherm(T, rhosad, z);
+    
+    using tdx = teqp::TDXDerivatives<decltype(model)>;
+    for (auto k = 0; k < rhos.size(); ++k){
+        CHECK(alphars[k] == Approx(model.alphar(T, rhos[k], z)).epsilon(1e-14));
+        CHECK(alpharsad[k][1]*rhos[k] == Approx(tdx::get_Ar01(model, T, rhos[k], z)).epsilon(1e-12));
+    }
+}
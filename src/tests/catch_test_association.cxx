@@ -10,6 +10,8 @@ using Catch::Matchers::WithinRel;
 #include "teqp/models/CPA.hpp"
 #include "teqp/cpp/deriv_adapter.hpp"
 
+#include "test_common.in"
+
 using namespace teqp;
 
 TEST_CASE("Test making the indices and D like in Langenbach", "[association]"){
@@ -279,3 +281,97 @@ TEST_CASE("Check explicit solutions for association fractions from old and new c
         return anotexplicit.successive_substitution(T, rhomolar, molefrac, X_init);
     };
 }
+
+TEST_CASE("Evaluation statistics of an associating model", "[association][instrumentation]"){
+    // The new association code, for a mixture so that the fractions are obtained by successive substitution
+    nlohmann::json water = {
+        {"a0i / Pa m^6/mol^2", 0.12277}, {"bi / m^3/mol", 0.0000145}, {"c1", 0.6736}, {"Tc / K", 647.13},
+        {"epsABi / J/mol", 16655.0}, {"betaABi", 0.0692}, {"sites", {"e","e","H","H"}}
+    };
+    nlohmann::json ethanol = {
+        {"a0i / Pa m^6/mol^2", 0.85164}, {"bi / m^3/mol", 0.0491e-3}, {"c1", 0.7502}, {"Tc / K", 513.92},
+        {"epsABi / J/mol", 21500.0}, {"betaABi", 0.008}, {"sites", {"e","H"}}
+    };
+    nlohmann::json j = {
+        {"kind", "CPA"},
+        {"model", {{"cubic", "SRK"}, {"radial_dist", "CS"}, {"options", nlohmann::json::object()}, {"pures", {ethanol, water}}, {"R_gas / J/mol/K", 8.31446261815324}}}
+    };
+    auto model = teqp::cppinterface::make_model(j, false);
+    auto z = (Eigen::ArrayXd(2) << 0.3, 0.7).finished();
+    for (auto i = 0; i < 3; ++i){
+        model->get_Ar01(300.0, 30000.0, z);
+    }
+    auto stats = model->get_stats();
+    REQUIRE(stats.contains("counters"));
+    REQUIRE(stats.contains("timers"));
+    const bool enabled = stats["enabled"].get<bool>();
+    auto npass = stats["timers"]["derivative_pass"]["count"].get<int>();
+    auto nassoc = stats["counters"]["association_iterations"].get<int>();
+    if (enabled){
+        CHECK(npass == 3);
+        CHECK(nassoc >= 3);
+    }
+    else{
+        CHECK(npass == 0);
+        CHECK(nassoc == 0);
+    }
+    CHECK(stats["counters"]["COSMOSAC_iterations"].get<int>() == 0);
+    model->reset_stats();
+    CHECK(model->get_stats()["timers"]["derivative_pass"]["count"].get<int>() == 0);
+    CHECK(model->get_stats()["counters"]["association_iterations"].get<int>() == 0);
+    
+    // The counts are attributed to the model being evaluated
+    auto other = teqp::cppinterface::make_model(j, false);
+    other->get_Ar01(300.0, 30000.0, z);
+    CHECK(model->get_stats()["counters"]["association_iterations"].get<int>() == 0);
+    
+    SECTION("COSMO-SAC"){
+        // Synthetic sigma profiles on the 51-point grid, all in the non-hydrogen-bonding profile
+        auto profile = [](double A, double sigma0){
+            std::vector<double> sigma(51), pA(51), zero(51, 0.0);
+            double sum = 0;
+            for (auto k = 0; k < 51; ++k){
+                sigma[k] = -0.025 + 0.001*k;
+                pA[k] = exp(-pow((sigma[k] - sigma0)/0.004, 2));
+                sum += pA[k];
+            }
+            for (auto& p : pA){ p *= A/sum; }
+            nlohmann::json nhb = {{"sigma / e/A^2", sigma}, {"p(sigma)*A / A^2", pA}};
+            nlohmann::json empty = {{"sigma / e/A^2", sigma}, {"p(sigma)*A / A^2", zero}};
+            return nlohmann::json{{"nhb", nhb}, {"oh", empty}, {"ot", empty}};
+        };
+        nlohmann::json jCOSMO = {
+            {"kind", "multifluid-activity"},
+            {"model", {
+                {"multifluid", {
+                    {"components", {"Methane", "Ethane"}},
+                    {"root", FLUIDDATAPATH},
+                    {"BIP", FLUIDDATAPATH + "/dev/mixtures/mixture_binary_pairs.json"},
+                    {"departure", FLUIDDATAPATH + "/dev/mixtures/mixture_departure_functions.json"}
+                }},
+                {"activity", {
+                    {"aresmodel", {
+                        {"type", "COSMO-SAC-2010"},
+                        {"A_COSMOSAC / A^2", {70.0, 95.0}},
+                        {"V_COSMOSAC / A^3", {50.0, 75.0}},
+                        {"profiles", {profile(70.0, -0.002), profile(95.0, 0.004)}}
+                    }},
+                    {"options", {{"b", {2.68e-5, 4.05e-5}}, {"u", 1.17}}}
+                }}
+            }}
+        };
+        auto cosmo = teqp::cppinterface::make_model(jCOSMO, false);
+        auto zc = (Eigen::ArrayXd(2) << 0.4, 0.6).finished();
+        cosmo->get_Ar01(200.0, 300.0, zc);
+        auto n = cosmo->get_stats()["counters"]["COSMOSAC_iterations"].get<int>();
+        if (enabled){ CHECK(n > 0); } else { CHECK(n == 0); }
+    }
+    SECTION("Polarizable multipoles"){
+        auto jpolar = R"({"kind": "SAFT-VR-Mie", "model": {"polar_model": "GrayGubbins+GubbinsTwu", "polar_flags": {"polarizable": {"alpha_symm / m^3": [18e-32], "alpha_asymm / m^3": [0.0]}}, "coeffs": [{"name": "PolarizableStockmayer", "BibTeXKey": "me", "m": 1.0, "epsilon_over_k": 100, "sigma_m": 1e-10, "lambda_r": 12.0, "lambda_a": 6.0, "mu_Cm": 3.919412183483701e-31, "nmu": 1.0}]}} )"_json;
+        auto polar = teqp::cppinterface::make_model(jpolar);
+        auto z1 = (Eigen::ArrayXd(1) << 1.0).finished();
+        polar->get_Ar01(150.0, 0.3/1e-30/6.02214076e23, z1);
+        auto n = polar->get_stats()["counters"]["polar_iterations"].get<int>();
+        if (enabled){ CHECK(n > 0); } else { CHECK(n == 0); }
+    }
+}
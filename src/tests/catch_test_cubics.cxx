@@ -10,6 +10,7 @@ using Catch::Approx;
 #include "teqp/models/cubics/advancedmixing_cubics.hpp"
 #include "teqp/derivs.hpp"
 #include "teqp/algorithms/VLE.hpp"
+#include "teqp/algorithms/density_roots.hpp"
 #include "teqp/cpp/teqpcpp.hpp"
 
 #include <boost/numeric/odeint/stepper/euler.hpp>
@@ -137,6 +138,68 @@ TEST_CASE("Check orthobaric density derivatives for pure fluid", "[cubic][supera
     CHECK(drhosatdTL == Approx((rhoLp-rhoLm)/(2*dT)));
 }
 
+TEST_CASE("Check all density roots and spinodals of a subcritical isotherm", "[cubic][densityroots]")
+{
+    std::valarray<double> Tc_K = { 150.687 };
+    std::valarray<double> pc_Pa = { 4863000.0};
+    std::valarray<double> acentric = { 0.0};
+    double T = 130.0;
+    auto molefrac = (Eigen::ArrayXd(1) << 1.0).finished();
+    
+    auto PR = canonical_PR(Tc_K, pc_Pa, acentric);
+    auto [rhoL, rhoV] = PR.superanc_rhoLV(T);
+    const auto modelptr = teqp::cppinterface::adapter::make_owned(canonical_PR(Tc_K, pc_Pa, acentric));
+    const auto& model = *modelptr;
+    double R = model.get_R(molefrac);
+    double psat = rhoV*R*T*(1 + model.get_Ar01(T, rhoV, molefrac));
+    
+    // The close packing density of Peng-Robinson is 1/b
+    DensityRootsOptions opt;
+    opt.rho_max = 0.99*pc_Pa[0]/(0.07780*R*Tc_K[0]);
+    auto pressure = [&](double rho){ return rho*R*T*(1 + model.get_Ar01(T, rho, molefrac)); };
+    
+    SECTION("At saturation"){
+        auto res = model.find_density_roots(T, psat, molefrac, opt);
+        REQUIRE(res.roots.size() == 3);
+        CHECK(res.roots[0].rho == Approx(rhoV).epsilon(1e-8));
+        CHECK(res.roots[2].rho == Approx(rhoL).epsilon(1e-8));
+        CHECK(res.roots[1].stability == DensityRootStability::unstable);
+        // The two phases in equilibrium have the same Gibbs energy
+        CHECK(res.roots[0].g_RT == Approx(res.roots[2].g_RT).epsilon(1e-8));
+        for (const auto& root : res.roots){
+            CHECK(std::abs(pressure(root.rho) - psat) < 1e-8*psat);
+        }
+        REQUIRE(res.spinodals.size() == 2);
+        CHECK(res.spinodals[0].d2pdrho2 < 0);
+        CHECK(res.spinodals[1].d2pdrho2 > 0);
+        for (const auto& spinodal : res.spinodals){
+            auto A = model.get_Ar02n(T, spinodal.rho, molefrac);
+            CHECK(std::abs(R*T*(1 + 2*A[1] + A[2])) < 1e-9*R*T);
+            CHECK(spinodal.rho > rhoV);
+            CHECK(spinodal.rho < rhoL);
+        }
+    }
+    SECTION("Below and above saturation, batched"){
+        Eigen::ArrayXd Ts = Eigen::ArrayXd::Constant(2, T), ps(2);
+        ps << 0.5*psat, 1.5*psat;
+        Eigen::ArrayXXd molefracs = Eigen::ArrayXXd::Ones(2, 1);
+        auto results = model.find_density_roots_batch(Ts, ps, molefracs, opt);
+        REQUIRE(results.size() == 2);
+        CHECK(results[0].stable_root()->rho == results[0].vapor_root()->rho);
+        CHECK(results[1].stable_root()->rho == results[1].liquid_root()->rho);
+        for (auto i = 0; i < 2; ++i){
+            auto single = model.find_density_roots(T, ps[i], molefrac, opt);
+            REQUIRE(single.roots.size() == results[i].roots.size());
+            for (auto j = 0U; j < single.roots.size(); ++j){
+                CHECK(single.roots[j].rho == Approx(results[i].roots[j].rho));
+            }
+        }
+    }
+    SECTION("The default upper density requires a reducing density"){
+        CHECK_THROWS_AS(model.find_density_roots(T, psat, molefrac), teqp::InvalidArgument);
+    }
+}
+
 TEST_CASE("Check manual integration of subcritical VLE isotherm for binary mixture", "[cubic][isochoric][traceisotherm]")
 {
     using namespace boost::numeric::odeint;
@@ -249,6 +312,70 @@ TEST_CASE("Check manual integration of subcritical VLE isotherm for binary mixtu
         double pfinal = J.back().at("pL / Pa").back();
         CHECK(std::abs(pfinal / pfinal_goal-1) < 1e-5);
     }
+    SECTION("Structured diagnostics of the isotherm tracer") {
+        auto X = get_start(T, 0);
+        auto N = X.size() / 2;
+        Eigen::ArrayXd rhovecL0 = Eigen::Map<const Eigen::ArrayXd>(&(X[0]), N);
+        Eigen::ArrayXd rhovecV0 = Eigen::Map<const Eigen::ArrayXd>(&(X[0]) + N, N);
+        auto sink = std::make_shared<diagnostics::RingBufferSink>(4096);
+        TVLEOptions opt;
+        opt.revision = 2;
+        opt.sink = sink;
+        auto J = trace_VLE_isotherm_binary(model, T, rhovecL0, rhovecV0, opt);
+        auto events = sink->drain();
+        REQUIRE(sink->dropped() == 0);
+        auto Nsteps = std::count_if(events.begin(), events.end(), [](const auto& e){ return e.kind == diagnostics::EventKind::step; });
+        CHECK(static_cast<std::size_t>(Nsteps) == J["data"].size());
+        REQUIRE(!events.empty());
+        CHECK(events.back().kind == diagnostics::EventKind::termination);
+        CHECK(J["meta"]["termination_reason"] == diagnostics::get_name(events.back().reason));
+
+        // When the buffer is full, the events are dropped rather than blocking the tracer
+        diagnostics::RingBufferSink small(2);
+        for (auto i = 0; i < 3; ++i){ small.emit(events[i]); }
+        CHECK(small.dropped() == 1);
+        CHECK(small.drain().size() == 2);
+    }
+    SECTION("Cancellation and deadline of the isotherm tracer") {
+        auto X = get_start(T, 0);
+        auto N = X.size() / 2;
+        Eigen::ArrayXd rhovecL0 = Eigen::Map<const Eigen::ArrayXd>(&(X[0]), N);
+        Eigen::ArrayXd rhovecV0 = Eigen::Map<const Eigen::ArrayXd>(&(X[0]) + N, N);
+        TVLEOptions opt;
+        opt.revision = 2;
+        auto full = trace_VLE_isotherm_binary(model, T, rhovecL0, rhovecV0, opt);
+
+        // A token cancelled after a few steps, from the sink of the diagnostics
+        struct CancelAfter : public diagnostics::EventSink {
+            CancellationToken token; int Nsteps = 0;
+            void emit(const diagnostics::TraceEvent& e) override { if (e.kind == diagnostics::EventKind::step && ++Nsteps == 5){ token.cancel(); } }
+        };
+        auto canceller = std::make_shared<CancelAfter>();
+        opt.sink = canceller;
+        opt.cancellation = canceller->token;
+        auto partial = trace_VLE_isotherm_binary(model, T, rhovecL0, rhovecV0, opt);
+        CHECK(partial["meta"]["termination_reason"] == "cancelled");
+        CHECK(partial["data"].size() == 5);
+        CHECK(partial["data"].size() < full["data"].size());
+
+        // A deadline that has already expired
+        opt.sink = nullptr;
+        opt.cancellation = std::nullopt;
+        opt.deadline = Deadline::in_seconds(0.0);
+        auto expired = trace_VLE_isotherm_binary(model, T, rhovecL0, rhovecV0, opt);
+        CHECK(expired["meta"]["termination_reason"] == "deadline_expired");
+        CHECK(expired["data"].size() == 0);
+        
+        // mix_VLE_Tx checks the flags before each iteration, so it returns the guess unchanged
+        auto x0 = (rhovecL0/rhovecL0.sum()).eval();
+        CancellationToken token; token.cancel();
+        auto [code, rhovecL, rhovecV] = mix_VLE_Tx(model, T, rhovecL0, rhovecV0, x0, 1e-10, 1e-8, 1e-10, 1e-8, 10, MixVLETxFlags{token, std::nullopt});
+        CHECK(code == VLE_return_code::cancelled);
+        CHECK((rhovecL == rhovecL0).all());
+        auto [code2, rhovecL2, rhovecV2] = mix_VLE_Tx(model, T, rhovecL0, rhovecV0, x0, 1e-10, 1e-8, 1e-10, 1e-8, 10, MixVLETxFlags{std::nullopt, Deadline::in_seconds(0.0)});
+        CHECK(code2 == VLE_return_code::deadline_expired);
+        CHECK((rhovecV2 == rhovecV0).all());
+    }
 }
 
 TEST_CASE("Check infinite dilution of isoline VLE derivatives", "[cubic][isochoric][infdil]")
@@ -448,6 +575,119 @@ TEST_CASE("Check manual integration of subcritical VLE isobar for binary mixture
     }
 }
 
+TEST_CASE("Check batched bubble and dew points of a binary mixture", "[cubic][bubbledew]")
+{
+    std::valarray<double> Tc_K = { 190.564, 154.581 },
+        pc_Pa = { 4599200, 5042800 },
+        acentric = { 0.011, 0.022 };
+    const auto modelptr = teqp::cppinterface::adapter::make_owned(canonical_PR(Tc_K, pc_Pa, acentric));
+    const auto& model = *modelptr;
+    
+    // Start from pure methane at 120 K, with a trace of the second component
+    double T0 = 120;
+    std::valarray<double> Tc_(Tc_K[0], 1), pc_(pc_Pa[0], 1), acentric_(acentric[0], 1);
+    auto [rhoL, rhoV] = canonical_PR(Tc_, pc_, acentric_).superanc_rhoLV(T0);
+    Eigen::ArrayXd z0 = (Eigen::ArrayXd(2) << 1.0-1e-6, 1e-6).finished();
+    Eigen::ArrayXd rhovecL0 = rhoL*z0, rhovecV0 = rhoV*z0;
+    
+    auto get_p = [&](double T, const Eigen::ArrayXd& rhovec){
+        double rho = rhovec.sum();
+        Eigen::ArrayXd molefrac = rhovec/rho;
+        return rho*model.get_R(molefrac)*T*(1 + model.get_Ar01(T, rho, molefrac));
+    };
+    double p = get_p(T0, rhovecL0);
+    
+    // The compositions are deliberately not sorted
+    Eigen::ArrayXd x0 = (Eigen::ArrayXd(9) << 0.5, 0.9, 0.2, 0.7, 0.99, 0.3, 0.8, 0.6, 0.4).finished();
+    Eigen::ArrayXXd compositions(x0.size(), 2);
+    compositions.col(0) = x0;
+    compositions.col(1) = 1 - x0;
+    
+    auto check_points = [&](const BubbleDewBatchResult& res, bool dew){
+        REQUIRE(res.points.size() == static_cast<std::size_t>(x0.size()));
+        CHECK(res.num_failed == 0);
+        // Solved by distance from the composition of the guess
+        CHECK(res.order[0] == 4);
+        CHECK(res.order[1] == 1);
+        for (auto i = 0; i < x0.size(); ++i){
+            const auto& pt = res.points[i];
+            CAPTURE(i, pt.message, static_cast<int>(pt.return_code), pt.T);
+            REQUIRE(pt.success);
+            const auto& rhovec = (dew) ? pt.rhovecV : pt.rhovecL;
+            CHECK(rhovec[0]/rhovec.sum() == Approx(x0[i]).margin(1e-8));
+            CHECK(get_p(pt.T, pt.rhovecL) == Approx(pt.p).epsilon(1e-6));
+            CHECK(get_p(pt.T, pt.rhovecV) == Approx(pt.p).epsilon(1e-6));
+            CHECK(pt.rhovecL.sum() > pt.rhovecV.sum());
+        }
+    };
+    
+    SECTION("Bubble points at given pressure"){
+        auto res = model.bubble_dew_batch_p(p, compositions, T0, rhovecL0, rhovecV0);
+        check_points(res, false);
+        // Adding the lighter second component lowers the bubble temperature
+        CHECK(res.points[2].T < res.points[0].T);
+        CHECK(res.points[0].T < res.points[1].T);
+        
+        // The predictor only changes the starting guesses, not the solutions
+        BubbleDewOptions opt;
+        opt.predictor = false;
+        auto resnopred = model.bubble_dew_batch_p(p, compositions, T0, rhovecL0, rhovecV0, opt);
+        for (auto i = 0; i < x0.size(); ++i){
+            CHECK(resnopred.points[i].T == Approx(res.points[i].T).epsilon(1e-8));
+        }
+    }
+    SECTION("Dew points at given pressure"){
+        BubbleDewOptions opt;
+        opt.dew = true;
+        auto res = model.bubble_dew_batch_p(p, compositions, T0, rhovecL0, rhovecV0, opt);
+        check_points(res, true);
+        auto bubble = model.bubble_dew_batch_p(p, compositions, T0, rhovecL0, rhovecV0);
+        for (auto i = 0; i < x0.size(); ++i){
+            // The dew temperature lies above the bubble temperature at the same composition
+            CHECK(res.points[i].T > bubble.points[i].T);
+        }
+    }
+    SECTION("Bubble points at given temperature"){
+        auto res = model.bubble_dew_batch_T(T0, compositions, rhovecL0, rhovecV0);
+        check_points(res, false);
+        for (const auto& pt : res.points){
+            CHECK(pt.T == T0);
+        }
+        CHECK(res.points[2].p > res.points[0].p);
+    }
+    SECTION("Compositions without a solution"){
+        // Above the critical temperature of the second component, the mixtures rich in it have no bubble point
+        double T1 = 170;
+        auto [rhoL1, rhoV1] = canonical_PR(Tc_, pc_, acentric_).superanc_rhoLV(T1);
+        Eigen::ArrayXd x1 = (Eigen::ArrayXd(4) << 0.95, 0.9, 0.1, 0.85).finished();
+        Eigen::ArrayXXd compositions1(x1.size(), 2);
+        compositions1.col(0) = x1;
+        compositions1.col(1) = 1 - x1;
+        BubbleDewOptions opt;
+        opt.reorder = false;
+        auto res = model.bubble_dew_batch_T(T1, compositions1, (rhoL1*z0).eval(), (rhoV1*z0).eval(), opt);
+        REQUIRE(res.points.size() == 4);
+        CHECK(res.num_failed == 1);
+        CHECK(!res.points[2].success);
+        CHECK(!res.points[2].message.empty());
+        // The points before and after it are still solved, the latter from the last solution
+        for (auto i : {0, 1, 3}){
+            CAPTURE(i);
+            const auto& pt = res.points[i];
+            REQUIRE(pt.success);
+            CHECK(pt.rhovecL[0]/pt.rhovecL.sum() == Approx(x1[i]).margin(1e-8));
+            CHECK(get_p(T1, pt.rhovecL) == Approx(pt.p).epsilon(1e-6));
+            CHECK(get_p(T1, pt.rhovecV) == Approx(pt.p).epsilon(1e-6));
+            CHECK(pt.rhovecL.sum() > pt.rhovecV.sum());
+        }
+        CHECK(res.points[3].p > res.points[1].p);
+    }
+    SECTION("Bad inputs"){
+        Eigen::ArrayXd rhovec3 = Eigen::ArrayXd::Ones(3);
+        CHECK_THROWS_AS(model.bubble_dew_batch_p(p, compositions, T0, rhovec3, rhovec3), teqp::InvalidArgument);
+    }
+}
+
 TEST_CASE("Bad kmat options", "[PRkmat]"){
     SECTION("null; ok"){
         auto j = nlohmann::json::parse(R"({
@@ -613,6 +853,87 @@ TEST_CASE("Check generalized and alphas", "[PRalpha]"){
     }
 }
 
+TEST_CASE("Mixed alpha functions in a_mix", "[PRalpha]"){
+    auto j = R"(
+    {
+        "type": "PR",
+        "Tcrit / K": [190.6, 305.3, 369.8],
+        "pcrit / Pa": [4.6e6, 4.9e6, 4.25e6],
+        "acentric": [0.011, 0.099, 0.152],
+        "alpha": [
+            {"type": "PR78", "acentric": 0.011},
+            {"type": "Twu", "c": [0.3, 0.9, 1.8]},
+            {"type": "Mathias-Copeman", "c": [0.5, -0.2, 0.3]}
+        ],
+        "kmat": [[0, 0.01, 0.02], [0.05, 0, 0.04], [0.0, -0.01, 0]]
+    }
+    )"_json;
+    auto model = make_generalizedcubic(j);
+    std::valarray<double> Tc_K = j.at("Tcrit / K"), pc_Pa = j.at("pcrit / Pa");
+    auto alphas = build_alpha_functions(Tc_K, j.at("alpha"));
+    auto kmat = build_square_matrix(j.at("kmat"));
+    double OmegaA = 0.45723552892138218938, R = constants::R_CODATA2017;
+    auto z = (Eigen::ArrayXd(3) << 0.2, 0.3, 0.5).finished();
+    for (double T : {150.0, 300.0, 450.0}){
+        // Double sum over the pairs with the alpha functions evaluated one at a time
+        double a = 0.0;
+        for (auto i = 0; i < 3; ++i){
+            for (auto k = 0; k < 3; ++k){
+                auto aai = OmegaA*pow2(R*Tc_K[i])/pc_Pa[i]*std::visit([&](auto& f){ return f(T); }, alphas[i]);
+                auto aak = OmegaA*pow2(R*Tc_K[k])/pc_Pa[k]*std::visit([&](auto& f){ return f(T); }, alphas[k]);
+                a += z[i]*z[k]*(1-kmat(i,k))*sqrt(aai*aak);
+            }
+        }
+        CHECK(model.get_a(T, z) == Approx(a).epsilon(1e-13));
+    }
+}
+
+TEST_CASE("Mixed alpha functions in a_mix far above the critical temperatures", "[PRalpha]"){
+    auto j = R"(
+    {
+        "type": "PR",
+        "Tcrit / K": [190.6, 305.3, 369.8],
+        "pcrit / Pa": [4.6e6, 4.9e6, 4.25e6],
+        "acentric": [0.011, 0.099, 0.152],
+        "alpha": [
+            {"type": "PR78", "acentric": 0.011},
+            {"type": "PR78", "acentric": 0.099},
+            {"type": "Mathias-Copeman", "c": [0.5, -0.2, 0.3]}
+        ],
+        "kmat": [[0, 0.01, 0.02], [0.05, 0, 0.04], [0.0, -0.01, 0]]
+    }
+    )"_json;
+    auto model = make_generalizedcubic(j);
+    std::valarray<double> Tc_K = j.at("Tcrit / K"), pc_Pa = j.at("pcrit / Pa");
+    auto alphas = build_alpha_functions(Tc_K, j.at("alpha"));
+    auto kmat = build_square_matrix(j.at("kmat"));
+    double OmegaA = 0.45723552892138218938, R = constants::R_CODATA2017;
+    auto z = (Eigen::ArrayXd(3) << 0.2, 0.3, 0.5).finished();
+    // At 2000 K only the bracket of the third component is negative, at 6000 K all of them are
+    for (double T : {2000.0, 6000.0}){
+        CAPTURE(T);
+        double m0 = 0.37464 + 1.54226*0.011 - 0.26992*pow2(0.011), x2 = 1 - sqrt(T/Tc_K[2]);
+        CHECK((1 + x2*(0.5 + x2*(-0.2 + 0.3*x2))) < 0);
+        CHECK(((1 + m0*(1 - sqrt(T/Tc_K[0]))) < 0) == (T > 3000));
+        // The double sum of the baseline, with the products of the a_i*alpha_i under the square root
+        double a = 0.0;
+        for (auto i = 0; i < 3; ++i){
+            for (auto k = 0; k < 3; ++k){
+                auto aai = OmegaA*pow2(R*Tc_K[i])/pc_Pa[i]*std::visit([&](auto& f){ return f(T); }, alphas[i]);
+                auto aak = OmegaA*pow2(R*Tc_K[k])/pc_Pa[k]*std::visit([&](auto& f){ return f(T); }, alphas[k]);
+                a += z[i]*z[k]*(1-kmat(i,k))*sqrt(aai*aak);
+            }
+        }
+        CHECK(model.get_a(T, z) == Approx(a).epsilon(1e-13));
+        // The temperature derivatives go through the same magnitudes
+        double h = 1e-5*T;
+        auto aTfd = (model.get_a(T + h, z) - model.get_a(T - h, z))/(2*h);
+        autodiff::Real<1, double> Tad = T;
+        auto aTad = derivatives([&](const auto& T_){ return model.get_a(T_, z); }, along(1), at(Tad))[1];
+        CHECK(aTad == Approx(aTfd).epsilon(1e-6));
+    }
+}
+
 TEST_CASE("QCPR", "[QCPR]"){
     
     /// Naming convention of variables follows the paper, not teqp
@@ -777,3 +1098,33 @@ TEST_CASE("RK-PR EOS w/ make_model", "[RKPR]"){
         CHECK(model->get_R(z) == 8.4);
     }
 }
+
+TEST_CASE("Single-precision screening of a cubic in a batch", "[cubic][screening]"){
+    nlohmann::json j = {
+        {"kind", "PR"},
+        {"model", {
+            {"Tcrit / K", {190.6, 305.3}},
+            {"pcrit / Pa", {4.6e6, 4.9e6}},
+            {"acentric", {0.011, 0.099}}
+        }}
+    };
+    auto model = teqp::cppinterface::make_model(j);
+    Eigen::ArrayXd T = Eigen::ArrayXd::LinSpaced(5, 200, 400), rho = Eigen::ArrayXd::LinSpaced(5, 100, 10000);
+    Eigen::ArrayXXd molefracs(5, 2);
+    molefracs.col(0) = Eigen::ArrayXd::LinSpaced(5, 0.1, 0.9);
+    molefracs.col(1) = 1.0 - molefracs.col(0);
+
+    for (auto [NT, ND] : std::vector<std::tuple<int,int>>{{0,0}, {0,1}, {0,2}, {1,0}, {2,0}, {1,1}}){
+        auto exact = model->get_Arxy_batch(NT, ND, T, rho, molefracs);
+        auto screened = model->get_Arxy_batch(NT, ND, T, rho, molefracs, true);
+        CAPTURE(NT, ND);
+        for (auto i = 0; i < T.size(); ++i){
+            CHECK(exact[i] == Approx(model->get_Arxy(NT, ND, T[i], rho[i], molefracs.row(i).transpose())).epsilon(1e-14));
+            CHECK(screened[i] == Approx(exact[i]).epsilon(1e-5));
+        }
+        // Polishing of all the points recovers the double-precision values
+        auto polished = model->polish_Arxy_batch(NT, ND, T, rho, molefracs, screened, Eigen::ArrayXi::LinSpaced(5, 0, 4));
+        CHECK((polished - exact).abs().maxCoeff() == 0.0);
+    }
+    CHECK_THROWS(model->get_Arxy_batch(0, 0, T, rho.head(3), molefracs));
+}
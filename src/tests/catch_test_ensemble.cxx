@@ -0,0 +1,99 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/exceptions.hpp"
+#include "teqp/json_tools.hpp"
+
+using namespace teqp;
+
+#include "test_common.in"
+
+TEST_CASE("Ensemble evaluation of the kij of a cubic", "[ensemble]"){
+    auto make_json = [](double k01, double k02, double k12){
+        nlohmann::json kmat = {{0, k01, k02}, {k01, 0, k12}, {k02, k12, 0}};
+        return nlohmann::json{
+            {"kind", "PR"},
+            {"model", {
+                {"Tcrit / K", {190.6, 305.3, 369.8}},
+                {"pcrit / Pa", {4.6e6, 4.9e6, 4.25e6}},
+                {"acentric", {0.011, 0.099, 0.152}},
+                {"kmat", kmat}
+            }}
+        };
+    };
+    auto model = cppinterface::make_model(make_json(0.01, 0.02, -0.03));
+    auto p = model->get_ensemble_parameters();
+    REQUIRE(p.size() == 3);
+    CHECK(p[0] == 0.01);
+    CHECK(p[2] == -0.03);
+
+    // Each column is a member of the ensemble
+    Eigen::MatrixXd P(3, 4);
+    P << 0.01, 0.0, 0.05, -0.02,
+         0.02, 0.0, 0.01, 0.03,
+        -0.03, 0.0, 0.02, 0.10;
+
+    double T = 250, rho = 3000;
+    auto z = (Eigen::ArrayXd(3) << 0.2, 0.5, 0.3).finished();
+    for (auto [NT, ND] : std::vector<std::tuple<int,int>>{{0,0}, {0,1}, {0,2}, {1,0}, {2,0}, {1,1}}){
+        auto vals = model->get_Arxy_ensemble(NT, ND, T, rho, z, P);
+        REQUIRE(vals.size() == 4);
+        for (auto m = 0; m < P.cols(); ++m){
+            auto member = cppinterface::make_model(make_json(P(0, m), P(1, m), P(2, m)));
+            CAPTURE(NT, ND, m);
+            CHECK(vals[m] == Approx(member->get_Arxy(NT, ND, T, rho, z)).epsilon(1e-12));
+        }
+    }
+    CHECK_THROWS(model->get_Arxy_ensemble(2, 1, T, rho, z, P));
+    CHECK_THROWS(model->get_Arxy_ensemble(0, 0, T, rho, z, P.topRows(2)));
+}
+
+TEST_CASE("Ensemble evaluation of the coefficients of a multifluid model", "[ensemble]"){
+    nlohmann::json j = {
+        {"kind", "multifluid"},
+        {"model", {
+            {"components", {"Nitrogen", "Ethane"}},
+            {"root", FLUIDDATAPATH},
+            {"BIP", FLUIDDATAPATH + "/dev/mixtures/mixture_binary_pairs.json"},
+            {"departure", FLUIDDATAPATH + "/dev/mixtures/mixture_departure_functions.json"}
+        }}
+    };
+    auto model = cppinterface::make_model(j);
+    auto n = model->get_ensemble_parameters();
+    REQUIRE(n.size() > 0);
+
+    // The same mixture built from the pure-fluid JSON with all the coefficients n scaled; both fluids only have
+    // power and Gaussian terms, so these are exactly the coefficients exposed to the ensemble evaluation
+    auto scaled_components = nlohmann::json::array();
+    for (std::string name : {"Nitrogen", "Ethane"}){
+        auto jf = load_a_JSON_file(FLUIDDATAPATH + "/dev/fluids/" + name + ".json");
+        for (auto& term : jf["EOS"][0]["alphar"]){
+            for (auto& ni : term["n"]){ ni = 1.001*ni.get<double>(); }
+        }
+        scaled_components.push_back(jf);
+    }
+    auto jscaled = j;
+    jscaled["model"]["components"] = scaled_components;
+    auto scaled = cppinterface::make_model(jscaled);
+
+    // The model's own coefficients and the scaled copy
+    Eigen::MatrixXd P(n.size(), 2);
+    P.col(0) = n.matrix();
+    P.col(1) = 1.001*n.matrix();
+    double T = 250, rho = 3000;
+    auto z = (Eigen::ArrayXd(2) << 0.4, 0.6).finished();
+    for (auto [NT, ND] : std::vector<std::tuple<int,int>>{{0,0}, {0,1}, {0,3}, {1,0}, {1,1}}){
+        auto vals = model->get_Arxy_ensemble(NT, ND, T, rho, z, P);
+        CAPTURE(NT, ND);
+        CHECK(vals[0] == Approx(model->get_Arxy(NT, ND, T, rho, z)).epsilon(1e-12));
+        CHECK(vals[1] == Approx(scaled->get_Arxy(NT, ND, T, rho, z)).epsilon(1e-12));
+        CHECK(vals[1] != Approx(vals[0]));
+    }
+
+    // Models that do not support ensembles
+    auto vdW = cppinterface::make_model({{"kind", "vdW1"}, {"model", {{"a", 1.0}, {"b", 2.0}}}});
+    CHECK_THROWS_AS(vdW->get_ensemble_parameters(), teqp::NotImplementedError);
+}
@@ -197,4 +197,31 @@ TEST_CASE("Test throwing error when tr_coeffs are not in json", "[ecs mutant]")
     std::string s = R"({})";
     nlohmann::json j = nlohmann::json::parse(s);
     CHECK_THROWS(build_multifluid_ecs_mutant(model, j));
-}
\ No newline at end of file
+}
+TEST_CASE("Test ternary ecs mutant with pairs reduces to the binary", "[ecs mutant]")
+{
+    std::string coolprop_root = FLUIDDATAPATH;
+    auto BIPcollection = coolprop_root + "/dev/mixtures/mixture_binary_pairs.json";
+
+    auto model = build_multifluid_model({ "CarbonDioxide", "Methane" }, coolprop_root, BIPcollection);
+    auto model3 = build_multifluid_model({ "CarbonDioxide", "Methane", "Nitrogen" }, coolprop_root, BIPcollection);
+
+    auto tr_coeffs = nlohmann::json::parse("[[0.99193,-0.0882,0.03588],[0.01099,-0.01506,0.0333],[-0.0567,0.23606,-0.0787],[-2e-05,-0.0135,0.00412],[-0.021714,0.0172,-0.026087],[0.03455,-0.03398,0.0148]]");
+    auto dr_coeffs = nlohmann::json::parse("[[0.95832,0.09096,-0.0863],[0.008766,-0.048183,0.03912],[0.03169,-0.25547,0.19474],[-0.001782,0.01038,-0.00688],[0.008965,0.00876,-0.01381],[-0.032164,0.1144,-0.0818]]");
+    nlohmann::json j = {{"tr_coeffs", tr_coeffs}, {"dr_coeffs", dr_coeffs}};
+    nlohmann::json j3 = {{"pairs", {{{"i", 0}, {"j", 1}, {"tr_coeffs", tr_coeffs}, {"dr_coeffs", dr_coeffs}}}}};
+
+    auto mutant = build_multifluid_ecs_mutant(model, j);
+    auto mutant3 = build_multifluid_ecs_mutant(model3, j3);
+    CHECK(mutant3.redfunc.get_pairs().size() == 3);
+
+    double T = 300, rho = 300;
+    Eigen::ArrayXd molefrac(2); molefrac = 0.5;
+    Eigen::ArrayXd molefrac3(3); molefrac3 << 0.5, 0.5, 0.0;
+    auto Ar00 = teqp::TDXDerivatives<decltype(mutant)>::get_Ar00(mutant, T, rho, molefrac);
+    auto Ar00_3 = teqp::TDXDerivatives<decltype(mutant3)>::get_Ar00(mutant3, T, rho, molefrac3);
+    CHECK(Ar00_3 == Approx(Ar00));
+
+    // Top-level coefficients are only allowed for binary mixtures
+    CHECK_THROWS(build_multifluid_ecs_mutant(model3, j));
+}
@@ -389,6 +389,37 @@ TEST_CASE("dpsat/dTsat", "[dpdTsat]") {
     
     auto dpdT = get_dpsat_dTsat_isopleth(model, T, rhovecL, rhovecV);
     CHECK(dpdT == Approx(39348.33949198946).margin(0.01));
+    
+    SECTION("Hessian-vector products"){
+        auto H = id::build_Psir_Hessian_autodiff(model, T, rhovecL);
+        Eigen::ArrayXd v = (Eigen::ArrayXd(2) << 0.3, -1.7).finished();
+        Eigen::ArrayXd Hv = id::build_Psir_Hessian_vector_product_autodiff(model, T, rhovecL, v);
+        Eigen::ArrayXd Hvexact = (H.matrix()*v.matrix()).array();
+        CHECK((Hv - Hvexact).abs().maxCoeff() < 1e-10*Hvexact.abs().maxCoeff());
+        CHECK(id::get_Psir_vector_Hessian_vector_product_autodiff(model, T, rhovecL, rhovecV, v) == Approx(rhovecV.matrix().dot(Hvexact.matrix())));
+    }
+    SECTION("matrix-free"){
+        auto [drhovecdTLk, drhovecdTVk] = get_drhovecdT_xsat(model, T, rhovecL, rhovecV, KrylovOptions{});
+        CHECK((drhovecdTLk - drhovecdTL).cwiseAbs().maxCoeff() < 1e-8*drhovecdTL.cwiseAbs().maxCoeff());
+        CHECK((drhovecdTVk - drhovecdTV).cwiseAbs().maxCoeff() < 1e-8*drhovecdTV.cwiseAbs().maxCoeff());
+    }
+    SECTION("matrix-free, four components"){
+        // The Krylov subspace is larger than one; the formulas do not rely on the phases being in equilibrium
+        const auto model4 = build_multifluid_model({ "Methane", "Ethane", "Propane", "Nitrogen" }, root);
+        auto rhovecL4 = (Eigen::ArrayXd(4) << 4000.0, 9000.0, 3000.0, 200.0).finished();
+        auto rhovecV4 = (Eigen::ArrayXd(4) << 900.0, 150.0, 15.0, 300.0).finished();
+        auto [drhovecdTL4, drhovecdTV4] = get_drhovecdT_xsat(model4, T, rhovecL4, rhovecV4);
+        for (auto restart : {30, 2}){
+            KrylovOptions kopt; kopt.restart = restart;
+            CAPTURE(restart);
+            auto [drhovecdTLk, drhovecdTVk] = get_drhovecdT_xsat(model4, T, rhovecL4, rhovecV4, kopt);
+            CHECK((drhovecdTLk - drhovecdTL4).cwiseAbs().maxCoeff() < 1e-8*drhovecdTL4.cwiseAbs().maxCoeff());
+            CHECK((drhovecdTVk - drhovecdTV4).cwiseAbs().maxCoeff() < 1e-8*drhovecdTV4.cwiseAbs().maxCoeff());
+        }
+        // Too few products with the Hessian to converge
+        KrylovOptions kopt; kopt.max_iter = 1;
+        CHECK_THROWS_AS(get_drhovecdT_xsat(model4, T, rhovecL4, rhovecV4, kopt), IterationError);
+    }
 }
 
 TEST_CASE("Trace a VLE isotherm for CO2 + water", "[isothermCO2water]") {
@@ -4,6 +4,7 @@ using Catch::Approx;
 
 #include "teqp/cpp/teqpcpp.hpp"
 #include "RPinterop/interop.hpp"
+#include "teqp/models/multifluid.hpp"
 
 using namespace teqp;
 
@@ -21,6 +22,34 @@ TEST_CASE("Check RPinterop conversion", "[RPinterop]") {
     auto model_ = cppinterface::make_model(j);
 }
 
+TEST_CASE("Check RPinterop conversions are cached and only the needed pairs are used", "[RPinterop]") {
+    auto& cache = RPinteropcache::get_cache();
+    cache.clear();
+    nlohmann::json j = {
+        {"kind", "multifluid"},
+        {"model", {
+            {"components", {"../doc/source/models/R152A.FLD", "../doc/source/models/NEWR1234YF.FLD"}},
+            {"HMX.BNC", "../doc/source/models/HMX.BNC"}
+        }}
+    };
+    auto model0 = cppinterface::make_model(j);
+    CHECK(cache.size() == 3);
+    auto model1 = cppinterface::make_model(j);
+    CHECK(cache.size() == 3);
+    
+    auto z = (Eigen::ArrayXd(2) << 0.4, 0.6).finished();
+    CHECK(model0->get_Ar00(300, 3000, z) == model1->get_Ar00(300, 3000, z));
+    
+    // Only the R152A/R1234YF pair (and its departure function) is selected from the HMX.BNC
+    auto HMX = cache.get_HMXBNC("../doc/source/models/HMX.BNC");
+    auto c0 = cache.get_FLD_from_path("../doc/source/models/R152A.FLD");
+    auto c1 = cache.get_FLD_from_path("../doc/source/models/NEWR1234YF.FLD");
+    auto [BIP, DEP] = HMX->select(collect_identifiers({c0, c1}));
+    CHECK(BIP.size() == 1);
+    CHECK(DEP.size() == 1);
+    CHECK(HMX->BIPcollection.size() > BIP.size());
+}
+
 TEST_CASE("Check RPinterop conversion with passing JSON structures directly", "[RPinterop]") {
     auto [BIP, DEP] = RPinterop::HMXBNCfile("../doc/source/models/HMX.BNC").make_jsons();
     auto c0 = RPinterop::FLDfile("../doc/source/models/R152A.FLD").make_json("");
@@ -146,6 +146,41 @@ TEST_CASE("Test construction of mutant with invariant departure function", "[mut
     CHECK(Ar02base != Ar02mut);
 }
 
+TEST_CASE("Mutant with parameters updated in place", "[mutant]")
+{
+    std::string coolprop_root = FLUIDDATAPATH;
+    auto BIPcollection = coolprop_root + "/dev/mixtures/mixture_binary_pairs.json";
+    auto model = build_multifluid_model({ "Nitrogen", "Ethane", "Methane" }, coolprop_root, BIPcollection);
+
+    auto make_json = [](double betaT, double Fij){
+        nlohmann::json BIP = {{"betaT", betaT}, {"gammaT", 0.9}, {"betaV", 1.05}, {"gammaV", 1.3}, {"Fij", Fij}};
+        nlohmann::json dep = {{"type", "Exponential"}, {"n", {0.1, -0.2}}, {"t", {1.0, 2.0}}, {"d", {1, 2}}, {"l", {0, 1}}};
+        nlohmann::json entry = {{"BIP", BIP}, {"departure", dep}};
+        nlohmann::json j;
+        j["0"]["1"] = entry; j["0"]["2"] = entry; j["1"]["2"] = entry;
+        return j;
+    };
+    auto mutant = build_multifluid_parameter_mutant(model, make_json(1.1, 1.0));
+    REQUIRE(mutant.get_parameters().size() == 15);
+
+    double T = 250, rho = 3000;
+    Eigen::ArrayXd molefrac(3); molefrac << 0.2, 0.5, 0.3;
+    auto reference = build_multifluid_mutant(model, make_json(1.1, 1.0));
+    CHECK(mutant.alphar(T, rho, molefrac) == Approx(reference.alphar(T, rho, molefrac)).epsilon(1e-14));
+
+    // Update the parameters of all the pairs and compare with a freshly built mutant
+    auto p = mutant.get_parameters();
+    for (auto k = 0U; k < 3; ++k){ p[5*k] = 0.97; p[5*k+4] = 0.7; }
+    mutant.set_parameters(p);
+    auto updated = build_multifluid_mutant(model, make_json(0.97, 0.7));
+    CHECK(mutant.alphar(T, rho, molefrac) == Approx(updated.alphar(T, rho, molefrac)).epsilon(1e-14));
+    CHECK(TDXDerivatives<decltype(mutant)>::get_Ar11(mutant, T, rho, molefrac) == Approx(TDXDerivatives<decltype(updated)>::get_Ar11(updated, T, rho, molefrac)));
+    CHECK(mutant.get_BIP(1, 0, "betaT") == Approx(1/0.97));
+
+    p.pop_back();
+    CHECK_THROWS(mutant.set_parameters(p));
+}
+
 TEST_CASE("Test infinite dilution critical locus derivatives for multifluid mutant with both orders", "[crit],[multifluid],[xxx]")
 {
     std::string root = FLUIDDATAPATH;
@@ -205,6 +240,42 @@ TEST_CASE("Mutant with Chebyshev departure function", "[mutant]") {
     CHECK(tdx::get_Ar00(mutant0, T, rho, z) != tdx::get_Ar00(mutant1, T, rho, z));
 }
 
+TEST_CASE("Chebyshev departure term with unequal degrees", "[mutant]") {
+    Chebyshev2DEOSTerm term;
+    term.a = (Eigen::ArrayXd(15) << 1,2,3,4,5,6,7,8,9,10,11,12,13,14,15).finished().reshaped(3, 5).eval();
+    term.taumin = 0.5; term.taumax = 3; term.deltamin = 0; term.deltamax = 2;
+    double tau = 0.7, delta = 1.9;
+    
+    // Direct summation of the expansion, with the terms of degree zero halved
+    double x = (2*tau - 3.5)/2.5, y = (2*delta - 2)/2.0, expected = 0;
+    for (auto k = 0; k < 3; ++k){
+        for (auto l = 0; l < 5; ++l){
+            double f = cos(k*acos(y))*cos(l*acos(x))*(k == 0 ? 0.5 : 1.0)*(l == 0 ? 0.5 : 1.0);
+            expected += term.a(k, l)*f;
+        }
+    }
+    CHECK(term.alphar(tau, delta) == Approx(expected));
+    
+    // Analytic derivatives against complex step derivatives
+    double h = 1e-100;
+    auto [val, dtau, ddelta] = term.alphar_derivs(tau, delta);
+    CHECK(val == Approx(expected));
+    CHECK(dtau == Approx(term.alphar(std::complex<double>(tau, h), delta).imag()/h));
+    CHECK(ddelta == Approx(term.alphar(tau, std::complex<double>(delta, h)).imag()/h));
+    
+    // First-derivative autodiff types are routed through alphar_derivs; compare with the generic recurrences
+    autodiff::dual taud = tau; taud.grad = 1.0;
+    auto [xd, yd] = term.get_xy(taud, autodiff::dual(delta));
+    CHECK(term.alphar(taud, delta).grad == Approx(Chebyshev2DEOSTerm::Clenshaw2DEigen(term.a, xd, yd).grad));
+    autodiff::Real<1, double> deltar = delta; deltar[1] = 1.0;
+    CHECK(term.alphar(tau, deltar)[0] == Approx(expected));
+    CHECK(term.alphar(tau, deltar)[1] == Approx(ddelta));
+    
+    CHECK_NOTHROW(term.alphar(3.5, delta));
+    term.strict_domain = true;
+    CHECK_THROWS(term.alphar(3.5, delta));
+}
+
 TEST_CASE("Exponential terms in the wrong order","[mutant]"){
     std::vector<std::string> fluids = { "Methane", "Water" };
     std::string root = FLUIDDATAPATH;
@@ -7,6 +7,7 @@ using Catch::Approx;
 #include "teqp/models/multifluid.hpp"
 #include "teqp/models/multifluid_ancillaries.hpp"
 #include "teqp/algorithms/phase_equil.hpp"
+#include "teqp/algorithms/VLLE.hpp"
 #include "teqp/ideal_eosterms.hpp"
 
 using namespace teqp;
@@ -96,3 +97,214 @@ TEST_CASE("Test new VLE routines", "[VLEgen]")
         std::cout << "x:" << x << std::endl;
     }
 }
+
+TEST_CASE("Energy-specified flashes", "[flash]")
+{
+    std::vector<std::string> names = {"Nitrogen", "Ethane"};
+    using namespace teqp::cppinterface;
+    std::string root = FLUIDDATAPATH;
+    auto model = make_multifluid_model(names, root);
+    
+    nlohmann::json jaig = nlohmann::json::array();
+    for (auto name : names){
+        jaig.push_back(convert_CoolProp_idealgas(root+"/dev/fluids/"+name+".json", 0 /* index of EOS */));
+    }
+    std::shared_ptr<const AbstractModel> aig(make_model(nlohmann::json{{"kind", "IdealHelmholtz"}, {"model",jaig}}));
+    
+    // A two-phase state on the isotherm, with equal amounts of both phases
+    double T = 118.0;
+    auto m0 = build_multifluid_model({names[0]}, root);
+    auto anc = teqp::MultiFluidVLEAncillaries(nlohmann::json::parse(m0.get_meta()).at("pures")[0].at("ANCILLARIES"));
+    auto pure = make_multifluid_model({names[0]}, root);
+    auto rhoLrhoV = pure->pure_VLE_T(T, anc.rhoL(T), anc.rhoV(T), 10);
+    auto rhovecL = (Eigen::ArrayXd(2) << rhoLrhoV[0], 0.0).finished();
+    auto rhovecV = (Eigen::ArrayXd(2) << rhoLrhoV[1], 0.0).finished();
+    TVLEOptions opt; opt.p_termination = 1e8; opt.crit_termination=1e-4; opt.calc_criticality=true; opt.polish=true;
+    auto el = model->trace_VLE_isotherm_binary(T, rhovecL, rhovecV, opt)[30];
+    auto tolist = [](const nlohmann::json& j) -> Eigen::ArrayXd{ auto x = j.get<std::vector<double>>(); return Eigen::Map<Eigen::ArrayXd>(&(x[0]), x.size()); };
+    std::vector<Eigen::ArrayXd> rhovecs = {tolist(el.at("rhoL / mol/m^3")), tolist(el.at("rhoV / mol/m^3"))};
+    auto betas = (Eigen::ArrayXd(2) << 0.5, 0.5).finished();
+    Eigen::ArrayXd z = 0.5*rhovecs[0]/rhovecs[0].sum() + 0.5*rhovecs[1]/rhovecs[1].sum();
+    double p = el.at("pL / Pa").get<double>();
+    double v = 0.5/rhovecs[0].sum() + 0.5/rhovecs[1].sum();
+    
+    // The residual of a specification of a zero value is the value of the property
+    auto get_property_of = [&](double T_, const std::vector<Eigen::ArrayXd>& rhovecs_, const Eigen::ArrayXd& betas_, const Eigen::ArrayXd& z_, const std::shared_ptr<AbstractSpecification>& spec){
+        GeneralizedPhaseEquilibrium::UnpackedVariables init{T_, rhovecs_, betas_};
+        GeneralizedPhaseEquilibrium gpe(*model, z_, init, {std::make_shared<TSpecification>(T_), spec});
+        gpe.attach_ideal_gas(aig);
+        gpe.call(init.pack());
+        return gpe.res.r[gpe.res.r.size()-1];
+    };
+    auto get_property = [&](const std::shared_ptr<AbstractSpecification>& spec){
+        return get_property_of(T, rhovecs, betas, z, spec);
+    };
+    double h = get_property(std::make_shared<MolarEnthalpySpecification>(0));
+    double s = get_property(std::make_shared<MolarEntropySpecification>(0));
+    double u = get_property(std::make_shared<MolarInternalEnergySpecification>(0));
+    
+    // The record of the iterations is consistent with the result
+    auto check_record = [](const FlashResult& res){
+        REQUIRE(!res.attempts.empty());
+        int num_iter = 0;
+        for (const auto& attempt : res.attempts){
+            num_iter += attempt.num_iter;
+        }
+        CHECK(num_iter == res.num_iter);
+        CHECK(res.attempts.size() == static_cast<std::size_t>(res.num_phase_changes) + 1);
+        if (res.success){
+            CHECK(res.attempts.back().converged);
+            CHECK(res.attempts.back().Nphases == res.Nphases);
+            CHECK(res.attempts.back().max_abs_r < 1e-6);
+            CHECK(res.betas.size() == static_cast<Eigen::Index>(res.Nphases));
+            CHECK(res.rhovecs.size() == res.Nphases);
+            CHECK(res.betas.sum() == Approx(1.0).epsilon(1e-10));
+            CHECK(res.betas.minCoeff() >= 0);
+        }
+    };
+    
+    FlashOptions fopt; fopt.T_guess = 110;
+    auto check = [&](const FlashResult& res){
+        CAPTURE(res.message);
+        CHECK(res.success);
+        CHECK(res.Nphases == 2);
+        CHECK(res.T == Approx(T).epsilon(1e-6));
+        CHECK(res.p == Approx(p).epsilon(1e-5));
+        REQUIRE(res.betas.size() == 2);
+        CHECK(res.betas[0] == Approx(0.5).epsilon(1e-5));
+        CHECK(res.betas[1] == Approx(0.5).epsilon(1e-5));
+        check_record(res);
+    };
+    SECTION("PH"){ check(flash_PH(*model, aig, z, p, h, fopt)); }
+    SECTION("PS"){ check(flash_PS(*model, aig, z, p, s, fopt)); }
+    SECTION("UV"){ check(flash_UV(*model, aig, z, u, v, fopt)); }
+    
+    // A homogeneous vapor at the same pressure, well above the dew temperature
+    double Tvap = 150;
+    double rhovap = teqp::algorithms::phase_equil::detail::get_rho_Tp(*model, Tvap, p, z, p/(model->get_R(z)*Tvap), false);
+    REQUIRE(std::isfinite(rhovap));
+    std::vector<Eigen::ArrayXd> rhovecsvap = {(rhovap*z).eval()};
+    double hvap = get_property_of(Tvap, rhovecsvap, Eigen::ArrayXd::Ones(1), z, std::make_shared<MolarEnthalpySpecification>(0));
+    
+    SECTION("single phase"){
+        FlashOptions o; o.T_guess = 200; // The feed is a homogeneous vapor at the initial temperature
+        auto res = flash_PH(*model, aig, z, p, hvap, o);
+        CAPTURE(res.message);
+        CHECK(res.success);
+        CHECK(res.Nphases == 1);
+        CHECK(res.T == Approx(Tvap).epsilon(1e-6));
+        CHECK(res.p == Approx(p).epsilon(1e-6));
+        CHECK(res.rhovecs[0].sum() == Approx(rhovap).epsilon(1e-6));
+        CHECK(res.betas[0] == 1.0);
+        CHECK(res.num_phase_changes == 0);
+        CHECK(res.attempts.size() == 1);
+        check_record(res);
+    }
+    SECTION("remove phase"){
+        // Start from the two-phase split at the temperature of the two-phase state; the liquid disappears on the way to the vapor
+        FlashOptions o; o.T_guess = T;
+        auto res = flash_PH(*model, aig, z, p, hvap, o);
+        CAPTURE(res.message);
+        CHECK(res.success);
+        CHECK(res.attempts.front().Nphases == 2);
+        CHECK(res.Nphases == 1);
+        CHECK(res.num_phase_changes == 1);
+        CHECK(res.T == Approx(Tvap).epsilon(1e-6));
+        check_record(res);
+    }
+    SECTION("add phase"){
+        // Start from the homogeneous vapor; the converged single phase is unstable and the liquid is added
+        FlashOptions o; o.T_guess = 200;
+        auto res = flash_PH(*model, aig, z, p, h, o);
+        CAPTURE(res.message);
+        CHECK(res.success);
+        CHECK(res.attempts.front().Nphases == 1);
+        CHECK(res.Nphases == 2);
+        CHECK(res.num_phase_changes == 1);
+        CHECK(res.num_stability_tests >= 2);
+        CHECK(res.T == Approx(T).epsilon(1e-6));
+        CHECK(res.betas[0] == Approx(0.5).epsilon(1e-5));
+        check_record(res);
+        
+        // But not if the phase cannot be added
+        o.max_phase_changes = 0;
+        auto res0 = flash_PH(*model, aig, z, p, h, o);
+        CHECK(!res0.success);
+        CHECK(res0.message == "Maximum number of phase changes reached");
+        check_record(res0);
+        
+        // Nor if only one phase is allowed, the homogeneous state is the solution then
+        o = FlashOptions{}; o.T_guess = 200; o.max_phases = 1;
+        auto res1 = flash_PH(*model, aig, z, p, h, o);
+        CHECK(res1.success);
+        CHECK(res1.Nphases == 1);
+        CHECK(res1.num_stability_tests == 0);
+        check_record(res1);
+    }
+    SECTION("failing"){
+        // Too few Newton iterations; the phases are removed one at a time before giving up
+        FlashOptions o; o.T_guess = T; o.max_iter = 1;
+        auto res = flash_PH(*model, aig, z, p, hvap, o);
+        CHECK(!res.success);
+        CHECK(res.message == "Newton iterations did not converge");
+        CHECK(res.Nphases == 0);
+        CHECK(res.attempts.size() == 2);
+        for (const auto& attempt : res.attempts){
+            CHECK(!attempt.converged);
+            CHECK(attempt.num_iter == 1);
+        }
+        CHECK(res.attempts.front().Nphases == 2);
+        CHECK(res.attempts.back().Nphases == 1);
+        check_record(res);
+    }
+    SECTION("three phases"){
+        // The nitrogen + ethane three-phase state at the same temperature, with equal amounts of the three phases
+        auto m1 = build_multifluid_model({names[1]}, root);
+        auto anc1 = teqp::MultiFluidVLEAncillaries(nlohmann::json::parse(m1.get_meta()).at("pures")[0].at("ANCILLARIES"));
+        auto rhoLrhoV1 = make_multifluid_model({names[1]}, root)->pure_VLE_T(T, anc1.rhoL(T), anc1.rhoV(T), 10);
+        std::vector<nlohmann::json> traces = {
+            model->trace_VLE_isotherm_binary(T, rhovecL, rhovecV, opt),
+            model->trace_VLE_isotherm_binary(T, (Eigen::ArrayXd(2) << 0.0, rhoLrhoV1[0]).finished(), (Eigen::ArrayXd(2) << 0.0, rhoLrhoV1[1]).finished(), opt)
+        };
+        auto VLLEsoln = teqp::VLLE::find_VLLE_T_binary(*model, traces);
+        REQUIRE(VLLEsoln.size() == 1);
+        std::vector<Eigen::ArrayXd> rhovecs3;
+        for (auto k = 0; k < 3; ++k){
+            rhovecs3.push_back(tolist(VLLEsoln[0].at("polished")[k]));
+        }
+        auto betas3 = Eigen::ArrayXd::Constant(3, 1.0/3.0).eval();
+        Eigen::ArrayXd z3 = Eigen::ArrayXd::Zero(2);
+        for (const auto& rhovec : rhovecs3){
+            z3 += rhovec/rhovec.sum()/3.0;
+        }
+        double rho0 = rhovecs3[0].sum();
+        double p3 = rho0*model->get_R(z3)*T*(1 + model->get_Ar01(T, rho0, (rhovecs3[0]/rho0).eval()));
+        double h3 = get_property_of(T, rhovecs3, betas3, z3, std::make_shared<MolarEnthalpySpecification>(0));
+        
+        FlashOptions o; o.T_guess = T; o.max_phases = 3;
+        auto res = flash_PH(*model, aig, z3, p3, h3, o);
+        CAPTURE(res.message);
+        CHECK(res.success);
+        CHECK(res.Nphases == 3);
+        CHECK(res.T == Approx(T).epsilon(1e-6));
+        CHECK(res.p == Approx(p3).epsilon(1e-6));
+        REQUIRE(res.betas.size() == 3);
+        // The phases can come out in any order
+        std::vector<double> rho0s;
+        for (auto k = 0; k < 3; ++k){
+            rho0s.push_back(res.rhovecs[k][0]);
+        }
+        std::vector<double> expected;
+        for (const auto& rhovec : rhovecs3){
+            expected.push_back(rhovec[0]);
+        }
+        std::sort(rho0s.begin(), rho0s.end());
+        std::sort(expected.begin(), expected.end());
+        for (auto k = 0; k < 3; ++k){
+            CHECK(rho0s[k] == Approx(expected[k]).epsilon(1e-5));
+            CHECK(res.betas[k] == Approx(1.0/3.0).epsilon(1e-5));
+        }
+        check_record(res);
+    }
+    SECTION("no ideal gas"){ CHECK_THROWS(flash_PH(*model, nullptr, z, p, h, fopt)); }
+}
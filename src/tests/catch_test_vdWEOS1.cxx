@@ -7,3 +7,24 @@ using Catch::Approx;
 TEST_CASE("Simplest case","[vdW1]") {
     auto model = teqp::cppinterface::make_model(R"(  {"kind": "vdW1", "model": {"a": 1, "b": 2}} )"_json);
 }
+
+TEST_CASE("Virial fast path through the AbstractModel","[vdW1][virial]") {
+    auto model = teqp::cppinterface::make_model(R"(  {"kind": "vdW1", "model": {"a": 0.1363, "b": 3.219e-5}} )"_json);
+    Eigen::ArrayXd z(1); z = 1.0;
+    double T = 300, rho = 50;
+    auto Ar01 = model->get_Arxy(0, 1, T, rho, z);
+    auto Ar20 = model->get_Arxy(2, 0, T, rho, z);
+    
+    model->enable_virial_fastpath(200, 800, z);
+    CHECK(model->get_Arxy(0, 1, T, rho, z) == Approx(Ar01).epsilon(1e-8));
+    CHECK(model->get_Arxy(2, 0, T, rho, z) == Approx(Ar20).epsilon(1e-8));
+    // Dense states, temperatures out of the range, and other compositions are evaluated with the model
+    CHECK(model->get_Arxy(0, 1, T, 10000, z) == model->get_Ar01(T, 10000, z));
+    CHECK(model->get_Arxy(0, 1, 100, rho, z) == model->get_Ar01(100, rho, z));
+    Eigen::ArrayXd z2(1); z2 = 0.5;
+    CHECK(model->get_Arxy(0, 1, T, rho, z2) == model->get_Ar01(T, rho, z2));
+    
+    model->disable_virial_fastpath();
+    CHECK(model->get_Arxy(0, 1, T, rho, z) == Ar01);
+    CHECK_THROWS(model->enable_virial_fastpath(800, 200, z));
+}
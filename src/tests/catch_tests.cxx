@@ -28,6 +28,7 @@ CATCH_REGISTER_LISTENER(testRunListener)
 
 #include "teqp/algorithms/VLE.hpp"
 #include "teqp/algorithms/critical_tracing.hpp"
+#include "teqp/virial_fastpath.hpp"
 
 // Imports from boost
 #include <boost/multiprecision/cpp_bin_float.hpp>
@@ -147,6 +148,26 @@ TEST_CASE("Check virial coefficients for vdW", "[virial]")
 }
 
 
+TEST_CASE("Virial fast path for vdW", "[virial]")
+{
+    auto vdW = build_vdW_argon();
+    Eigen::ArrayXd molefrac(1); molefrac = 1.0;
+    VirialFastPath<decltype(vdW)> fast(vdW, molefrac, 200, 800);
+    using tdx = TDXDerivatives<decltype(vdW)>;
+
+    double T = 300, rho = 50;
+    for (auto [iT, iD] : std::vector<std::tuple<int, int>>{{0, 0}, {0, 1}, {0, 2}, {1, 0}, {2, 0}, {1, 1}}) {
+        auto r = fast.get_Arxy(iT, iD, T, rho);
+        CAPTURE(iT, iD);
+        CHECK(r.used_series);
+        CHECK(std::abs(r.value - tdx::get_Ar(iT, iD, vdW, T, rho, molefrac)) <= 2*r.error_estimate + 1e-14);
+    }
+    // Dense states and temperatures out of the range use the model
+    CHECK(!fast.get_Arxy(0, 1, T, 10000).used_series);
+    CHECK(!fast.get_Arxy(0, 1, 100, rho).used_series);
+    CHECK(fast.get_Arxy(0, 1, T, 10000).value == Approx(tdx::get_Ar01(vdW, T, 10000, molefrac)));
+}
+
 TEST_CASE("Check Hessian of Psir", "[virial]")
 {
     
@@ -258,6 +279,29 @@ TEST_CASE("Test all vdW derivatives good to numerical precision", "[vdW]")
     }
 }
 
+TEST_CASE("Fixed-order multicomplex derivatives of vdW", "[vdW][mcx]")
+{
+    auto model = vdWEOS1(1, 2);
+    double T = 300, rho = 0.02;
+    Eigen::ArrayXd z(1); z.fill(1.0);
+    using tdx = TDXDerivatives<decltype(model)>;
+
+    auto ad = tdx::get_Ar0n<5>(model, T, rho, z);
+    auto mcx = tdx::get_Ar0n<5, ADBackends::multicomplex>(model, T, rho, z);
+    for (auto n = 0; n <= 5; ++n) {
+        CAPTURE(n);
+        CHECK(mcx[n] == Approx(ad[n]).epsilon(1e-13));
+    }
+    CHECK(tdx::get_Arxy<2, 0, ADBackends::multicomplex>(model, T, rho, z) == Approx(tdx::get_Ar20(model, T, rho, z)).epsilon(1e-13));
+    CHECK(tdx::get_Arxy<1, 2, ADBackends::multicomplex>(model, T, rho, z) == Approx(tdx::get_Ar12(model, T, rho, z)).epsilon(1e-13));
+
+    // Elementary functions against their exact derivatives
+    auto ders = diff_fixed_mcx1<3>([](const auto& x) { return exp(x)*log(x); }, 1.3);
+    double e = std::exp(1.3), l = std::log(1.3);
+    CHECK(ders[1] == Approx(e*l + e/1.3));
+    CHECK(ders[2] == Approx(e*l + 2*e/1.3 - e/(1.3*1.3)));
+}
+
 TEST_CASE("Test infinite dilution critical locus derivatives", "[vdWcrit]")
 {
     // Argon + Xenon
@@ -392,6 +436,30 @@ TEST_CASE("Test psir gradient", "") {
     CHECK(err1 < 1e-12);
 }
 
+TEST_CASE("Test one-pass isochoric derivative bundle", "") {
+    const auto model = build_vdW();
+    const double T = 298.15;
+    using id = IsochoricDerivatives<decltype(model)>;
+    const Eigen::ArrayXd rhovec = (Eigen::ArrayXd(2) << 1000, 2000).finished();
+    auto b = id::build_Psir_derivative_bundle_autodiff(model, T, rhovec);
+    
+    auto [Psir, grad, H] = id::build_Psir_fgradHessian_autodiff(model, T, rhovec);
+    CHECK(b.Psir == Approx(Psir).epsilon(1e-14));
+    CHECK((b.gradient - grad).abs().maxCoeff() < 1e-12*grad.abs().maxCoeff());
+    CHECK((b.Hessian - H).cwiseAbs().maxCoeff() < 1e-12*H.cwiseAbs().maxCoeff());
+    CHECK(b.dPsirdT == Approx(id::get_dPsirdT_constrhovec(model, T, rhovec)).epsilon(1e-12));
+    auto d2 = id::build_d2PsirdTdrhoi_autodiff(model, T, rhovec);
+    CHECK((b.d2PsirdTdrhoi - d2).abs().maxCoeff() < 1e-12*d2.abs().maxCoeff());
+    CHECK(b.dpdT() == Approx(id::get_dpdT_constrhovec(model, T, rhovec)).epsilon(1e-12));
+    CHECK((b.dchempotdT() - id::get_dchempotdT_autodiff(model, T, rhovec)).abs().maxCoeff() < 1e-8);
+    CHECK((b.Psi_Hessian() - id::build_Psi_Hessian_autodiff(model, T, rhovec)).cwiseAbs().maxCoeff() < 1e-8);
+    
+    // The second temperature derivative by centered differences of the first
+    double h = 1e-3;
+    double d2PsirdT2 = (id::get_dPsirdT_constrhovec(model, T+h, rhovec) - id::get_dPsirdT_constrhovec(model, T-h, rhovec))/(2*h);
+    CHECK(b.d2PsirdT2 == Approx(d2PsirdT2).epsilon(1e-6));
+}
+
 TEST_CASE("Test extrapolate from critical point", "[extrapolate_from_critical]") {
     std::valarray<double> Tc_K = { 150.687};
     std::valarray<double> pc_Pa = { 4863000.0};